@@ -502,6 +502,34 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_format_cb setup,
                                         libvlc_video_cleanup_cb cleanup );
 
+/**
+ * Render video directly into a pool of application buffers.
+ * This only works in combination with libvlc_video_set_callbacks().
+ *
+ * By default, the lock callback is called for each picture, which is then
+ * copied into the locked buffer. With a pool, the lock callback is instead
+ * called once per buffer when the video output starts, until LibVLC has all
+ * the buffers it needs. The application may back them with shared memory or
+ * DMA buffers, as long as they follow the pitches and lines of the format.
+ *
+ * Video converters and filters then render into these buffers in place, and
+ * a buffer is reused as soon as LibVLC no longer references it. The display
+ * callback receives the picture identifier of the buffer to show. Pictures
+ * that need no conversion still get copied into a buffer of the pool. In
+ * either case, the contents of the buffer are only valid until the next
+ * display callback.
+ *
+ * The unlock callback is called once for each buffer when LibVLC gives it
+ * back, after the video output has stopped using it, and before the cleanup
+ * callback.
+ *
+ * \param mp the media player
+ * \param enable whether to render into a pool of application buffers
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_set_pool( libvlc_media_player_t *mp, bool enable );
+
 
 typedef struct
 {
@@ -1633,6 +1661,52 @@ LIBVLC_API
 void libvlc_chapter_descriptions_release( libvlc_chapter_description_t **p_chapters,
                                           unsigned i_count );
 
+/**
+ * Latency statistics of a pipeline stage, in microseconds
+ */
+typedef struct libvlc_latency_stats_t
+{
+    uint64_t i_samples; /**< Number of measurements */
+    int64_t  i_mean;    /**< Mean value */
+    int64_t  i_jitter;  /**< Standard deviation */
+    int64_t  i_p95;     /**< 95th percentile (upper bound) */
+    int64_t  i_max;     /**< Largest value */
+} libvlc_latency_stats_t;
+
+/**
+ * Latency statistics of a track, from demux to output
+ *
+ * Stages that do not apply to the track are left empty.
+ */
+typedef struct libvlc_track_latency_t
+{
+    libvlc_latency_stats_t decoder_queue; /**< Wait before decoding */
+    libvlc_latency_stats_t decode;        /**< Decoding time per block */
+    libvlc_latency_stats_t vout_queue;    /**< Wait before display */
+    libvlc_latency_stats_t lateness;      /**< Display lateness */
+    libvlc_latency_stats_t aout_depth;    /**< Audio output buffer depth */
+} libvlc_track_latency_t;
+
+/**
+ * Get the latency statistics of a track
+ *
+ * The statistics are updated with the media statistics, i.e. only if the
+ * "stats" option is enabled.
+ *
+ * \version LibVLC 4.0.0 and later.
+ *
+ * \param p_mi the media player
+ * \param i_track the track ID (as returned by libvlc_video_get_track() or
+ * libvlc_audio_get_track())
+ * \param p_latency structure that contains the latency statistics [OUT]
+ *
+ * \return true if the statistics are available, false otherwise
+ */
+LIBVLC_API bool
+libvlc_media_player_get_track_latency( libvlc_media_player_t *p_mi,
+                                       int i_track,
+                                       libvlc_track_latency_t *p_latency );
+
 /**
  * Set/unset the video crop ratio.
  *
@@ -51,12 +51,18 @@ struct filter_subpicture_callbacks
     subpicture_t *(*buffer_new)(filter_t *);
 };
 
+struct filter_audio_callbacks
+{
+    block_t *(*buffer_new)(filter_t *, size_t);
+};
+
 typedef struct filter_owner_t
 {
     union
     {
         const struct filter_video_callbacks *video;
         const struct filter_subpicture_callbacks *sub;
+        const struct filter_audio_callbacks *audio;
     };
     void *sys;
 } filter_owner_t;
@@ -180,6 +186,24 @@ static inline picture_t *filter_NewPicture( filter_t *p_filter )
     return pic;
 }
 
+/**
+ * This function will return a new block usable by p_filter as an output
+ * audio buffer. The owner may recycle the memory of blocks released by the
+ * audio output, so that filters that cannot process their input in place
+ * do not allocate in steady state.
+ * Provided for convenience.
+ *
+ * \param p_filter filter_t object
+ * \param i_size size of the buffer in bytes
+ * \return new block on success or NULL on failure
+ */
+static inline block_t *filter_NewAudioBuffer( filter_t *p_filter, size_t i_size )
+{
+    if ( p_filter->owner.audio != NULL && p_filter->owner.audio->buffer_new != NULL )
+        return p_filter->owner.audio->buffer_new( p_filter, i_size );
+    return block_Alloc( i_size );
+}
+
 /**
  * Flush a filter
  *
@@ -422,6 +446,17 @@ VLC_API filter_t *filter_chain_AppendFilter(filter_chain_t *chain,
 VLC_API int filter_chain_AppendConverter(filter_chain_t *chain,
     const es_format_t *fmt_out);
 
+/**
+ * Append a conversion by a given converter module to the chain.
+ *
+ * \param chain filter chain to append a filter to
+ * \param name converter module name, or NULL to probe all converters
+ * \param fmt_out filter output format
+ * \return a pointer to the converter or NULL on error
+ */
+VLC_API filter_t *filter_chain_AppendConverterByName(filter_chain_t *chain,
+    const char *name, const es_format_t *fmt_out);
+
 /**
  * Append new filter to filter chain from string.
  *
@@ -527,6 +527,130 @@ struct input_stats_t
     int64_t i_lost_abuffers;
 };
 
+/** Elementary stream pipeline stages, from demux to output */
+enum vlc_latency_stage
+{
+    VLC_LATENCY_DECODER_QUEUE, /**< Wait between demux and decoder */
+    VLC_LATENCY_DECODE,        /**< Decoding time per block */
+    VLC_LATENCY_VOUT_QUEUE,    /**< Wait between decoder and display */
+    VLC_LATENCY_LATENESS,      /**< Display lateness against the clock */
+    VLC_LATENCY_AOUT_DEPTH,    /**< Audio output buffer depth */
+};
+#define VLC_LATENCY_STAGE_COUNT 5
+
+/* Sub-buckets per power of two */
+#define VLC_LATENCY_SUB_BUCKETS 4
+/* Up to 2^25 us, i.e. about 33 s */
+#define VLC_LATENCY_BUCKETS (24 * VLC_LATENCY_SUB_BUCKETS)
+
+/**
+ * Latency histogram
+ *
+ * The buckets are logarithmic, with 4 linear sub-buckets per power of two of
+ * microseconds, so that the bound of a bucket is at most 25% above its
+ * values. The first 4 buckets count the values of 0 to 3 us, then the next 4
+ * buckets split the values from 4 to 7 us, and so on. The last bucket counts
+ * all larger values.
+ */
+struct vlc_latency_histogram
+{
+    uint64_t count; /**< Number of samples */
+    vlc_tick_t sum; /**< Sum of the samples */
+    vlc_tick_t max; /**< Largest sample */
+    double sum_squares; /**< Sum of the squared samples */
+    uint64_t buckets[VLC_LATENCY_BUCKETS];
+};
+
+/**
+ * Latency statistics of an elementary stream
+ *
+ * Stages that do not apply to the stream (e.g. audio output depth for a video
+ * stream) are left empty.
+ */
+struct vlc_es_latency
+{
+    struct vlc_latency_histogram stages[VLC_LATENCY_STAGE_COUNT];
+};
+
+/**
+ * Gets the latency histogram bucket of a value.
+ */
+static inline unsigned vlc_latency_GetBucket(vlc_tick_t value)
+{
+    uint64_t us = (value > 0) ? US_FROM_VLC_TICK(value) : 0;
+
+    if (us < VLC_LATENCY_SUB_BUCKETS)
+        return us;
+
+    /* Power of two, and the 2 bits below it */
+    unsigned exp = (sizeof (unsigned long long) * 8 - 1) - vlc_clzll(us);
+    unsigned bucket = (exp - 1) * VLC_LATENCY_SUB_BUCKETS
+                    + ((us >> (exp - 2)) & (VLC_LATENCY_SUB_BUCKETS - 1));
+
+    return (bucket < VLC_LATENCY_BUCKETS) ? bucket : VLC_LATENCY_BUCKETS - 1;
+}
+
+/**
+ * Adds a sample to a latency histogram.
+ *
+ * Negative values (i.e. early) are counted as zero.
+ */
+static inline void vlc_latency_Add(struct vlc_latency_histogram *h,
+                                   vlc_tick_t value)
+{
+    if (value < 0)
+        value = 0;
+
+    unsigned bucket = vlc_latency_GetBucket(value);
+
+    h->count++;
+    h->sum += value;
+    h->sum_squares += (double)value * (double)value;
+    if (value > h->max)
+        h->max = value;
+    h->buckets[bucket]++;
+}
+
+/**
+ * Adds all samples of a latency histogram into another one.
+ */
+static inline void vlc_latency_Merge(struct vlc_latency_histogram *restrict dst,
+                                     const struct vlc_latency_histogram *restrict src)
+{
+    dst->count += src->count;
+    dst->sum += src->sum;
+    dst->sum_squares += src->sum_squares;
+    if (src->max > dst->max)
+        dst->max = src->max;
+    for (unsigned i = 0; i < VLC_LATENCY_BUCKETS; i++)
+        dst->buckets[i] += src->buckets[i];
+}
+
+/**
+ * Gets the mean value of a latency histogram.
+ *
+ * \return the mean, or 0 if the histogram is empty
+ */
+static inline vlc_tick_t vlc_latency_GetMean(const struct vlc_latency_histogram *h)
+{
+    return (h->count > 0) ? h->sum / (vlc_tick_t)h->count : 0;
+}
+
+/**
+ * Gets the jitter, i.e. the standard deviation, of a latency histogram.
+ */
+VLC_API vlc_tick_t vlc_latency_GetJitter(const struct vlc_latency_histogram *h);
+
+/**
+ * Gets an upper bound of a percentile of a latency histogram.
+ *
+ * \param percent percentile, from 0 to 100
+ * \return the upper bound of the bucket containing the percentile
+ * (at most the largest sample), or 0 if the histogram is empty
+ */
+VLC_API vlc_tick_t vlc_latency_GetPercentile(const struct vlc_latency_histogram *h,
+                                             unsigned percent);
+
 /**
  * Access pf_readdir helper struct
  * \see vlc_readdir_helper_init()
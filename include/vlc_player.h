@@ -1457,6 +1457,24 @@ vlc_player_GetSubtitleTrackAt(vlc_player_t *player, size_t index)
 VLC_API const struct vlc_player_track *
 vlc_player_GetTrack(vlc_player_t *player, vlc_es_id_t *es_id);
 
+/**
+ * Get the latency statistics of a track
+ *
+ * The statistics are updated with the input statistics, i.e. only if the
+ * "stats" option is enabled.
+ *
+ * @warning The returned pointer becomes invalid when the player is unlocked.
+ * The referenced structure can be safely copied.
+ *
+ * @param player locked player instance
+ * @param es_id an ES ID (retrieved from vlc_player_cbs.on_track_list_changed or
+ * vlc_player_GetTrackAt())
+ * @return pointer to the latency statistics, or NULL if the track is not
+ * decoded or was terminated
+ */
+VLC_API const struct vlc_es_latency *
+vlc_player_GetTrackLatency(vlc_player_t *player, vlc_es_id_t *es_id);
+
 /**
  * Get and the video output used by a ES identifier
  *
@@ -48,6 +48,7 @@ enum vlc_module_properties
     VLC_MODULE_DESCRIPTION,
     VLC_MODULE_HELP,
     VLC_MODULE_TEXTDOMAIN,
+    VLC_MODULE_SIGNATURE,
     /* Insert new VLC_MODULE_* here */
 
     /* DO NOT EVER REMOVE, INSERT OR REPLACE ANY ITEM! It would break the ABI!
@@ -290,6 +291,23 @@ VLC_METADATA_EXPORTS
         goto error; \
 }
 
+/**
+ * Declares the leading bytes of the data handled by the module.
+ *
+ * Unless explicitly requested, a module declaring signatures is only probed
+ * if the data matches at least one of them, without mapping the plug-in. The
+ * signatures must therefore cover everything that the module accepts when it
+ * is not forced: modules accepting data by content type or file extension
+ * must not declare signatures.
+ *
+ * \param offset offset of the signature from the start of the data
+ * \param bytes signature, as a string literal (that may contain nul bytes)
+ */
+#define add_signature( offset, bytes ) \
+    if (vlc_module_set (VLC_MODULE_SIGNATURE, (unsigned)(offset), \
+                        (unsigned)(sizeof (bytes) - 1), (const char *)(bytes))) \
+        goto error;
+
 #define set_shortname( shortname ) \
     if (vlc_module_set (VLC_MODULE_SHORTNAME, (const char *)(shortname))) \
         goto error;
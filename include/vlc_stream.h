@@ -168,6 +168,7 @@ enum stream_query_e
     STREAM_GET_CONTENT_TYPE,    /**< arg1= char **         res=can fail */
     STREAM_GET_SIGNAL,      /**< arg1=double *pf_quality, arg2=double *pf_strength   res=can fail */
     STREAM_GET_TAGS,        /**< arg1=const block_t ** res=can fail */
+    STREAM_GET_VALIDATOR,   /**< arg1= char **  res=can fail */
 
     STREAM_SET_PAUSE_STATE = 0x200, /**< arg1= bool        res=can fail */
     STREAM_SET_TITLE,       /**< arg1= int          res=can fail */
@@ -372,6 +373,19 @@ static inline char *stream_ContentType( stream_t *s )
     return res;
 }
 
+/**
+ * Get the validator of a stream, identifying the current version of the
+ * resource (e.g. the HTTP entity tag), or NULL if unknown.
+ * Result must be free()'d.
+ */
+static inline char *stream_Validator( stream_t *s )
+{
+    char *res;
+    if( vlc_stream_Control( s, STREAM_GET_VALIDATOR, &res ) )
+        return NULL;
+    return res;
+}
+
 /**
  * Get the mime-type of a stream
  *
@@ -0,0 +1,157 @@
+/*****************************************************************************
+ * vlc_tracer.h: pipeline tracing interface
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_TRACER_H
+#define VLC_TRACER_H
+
+/**
+ * \defgroup tracer Tracer
+ * \ingroup os
+ * \brief Pipeline timing traces
+ *
+ * Functions to record where the media pipeline spends its time.
+ *
+ * Tracing is enabled at run time by selecting a tracer module. Otherwise,
+ * vlc_object_get_tracer() returns NULL, and every tracing function reduces
+ * to a NULL pointer check.
+ *
+ * @{
+ * \file
+ * Tracing functions
+ */
+
+/** Trace event types */
+enum vlc_tracer_phase
+{
+    VLC_TRACER_SPAN,    /**< Time interval */
+    VLC_TRACER_INSTANT, /**< Point in time */
+    VLC_TRACER_COUNTER, /**< Sampled value */
+};
+
+/**
+ * Trace event
+ */
+struct vlc_tracer_event
+{
+    enum vlc_tracer_phase phase;
+    const char *category; /**< Pipeline stage (static string) */
+    const char *name; /**< Event name (static string) */
+    vlc_tick_t ts; /**< Start time */
+    vlc_tick_t duration; /**< Span duration, or 0 */
+    unsigned long tid; /**< Emitter thread ID */
+    uintptr_t id; /**< Stream identifier or 0 */
+    vlc_tick_t pts; /**< Media timestamp, or VLC_TICK_INVALID */
+    int64_t value; /**< Counter value */
+};
+
+struct vlc_tracer_operations
+{
+    void (*trace)(void *opaque, const struct vlc_tracer_event *);
+    void (*destroy)(void *opaque);
+};
+
+struct vlc_tracer;
+
+/**
+ * Gets the tracer of an object.
+ *
+ * \return the tracer, or NULL if tracing is disabled
+ *
+ * \note The tracer is valid as long as the object is. Hot paths should look
+ * it up once and keep the pointer.
+ */
+VLC_API struct vlc_tracer *vlc_object_get_tracer(vlc_object_t *obj) VLC_USED;
+#define vlc_object_get_tracer(o) vlc_object_get_tracer(VLC_OBJECT(o))
+
+/**
+ * Emits a trace event.
+ */
+VLC_API void vlc_tracer_Trace(struct vlc_tracer *tracer,
+                              const struct vlc_tracer_event *ev);
+
+/**
+ * Gets the start time of a span.
+ *
+ * \return the current time, or VLC_TICK_INVALID if tracing is disabled
+ */
+static inline vlc_tick_t vlc_tracer_Now(struct vlc_tracer *tracer)
+{
+    return (tracer != NULL) ? vlc_tick_now() : VLC_TICK_INVALID;
+}
+
+/**
+ * Emits a span, from a vlc_tracer_Now() time until now.
+ *
+ * \param id stream identifier or 0
+ * \param pts timestamp of the traced block or picture, or VLC_TICK_INVALID
+ */
+static inline void vlc_tracer_Span(struct vlc_tracer *tracer,
+                                   const char *category, const char *name,
+                                   vlc_tick_t start, uintptr_t id,
+                                   vlc_tick_t pts)
+{
+    if (tracer == NULL || start == VLC_TICK_INVALID)
+        return;
+
+    struct vlc_tracer_event ev = {
+        .phase = VLC_TRACER_SPAN, .category = category, .name = name,
+        .ts = start, .duration = vlc_tick_now() - start,
+        .tid = vlc_thread_id(), .id = id, .pts = pts,
+    };
+    vlc_tracer_Trace(tracer, &ev);
+}
+
+/**
+ * Emits an instant event.
+ */
+static inline void vlc_tracer_Instant(struct vlc_tracer *tracer,
+                                      const char *category, const char *name,
+                                      uintptr_t id, vlc_tick_t pts)
+{
+    if (tracer == NULL)
+        return;
+
+    struct vlc_tracer_event ev = {
+        .phase = VLC_TRACER_INSTANT, .category = category, .name = name,
+        .ts = vlc_tick_now(), .tid = vlc_thread_id(), .id = id, .pts = pts,
+    };
+    vlc_tracer_Trace(tracer, &ev);
+}
+
+/**
+ * Emits a counter sample.
+ */
+static inline void vlc_tracer_Counter(struct vlc_tracer *tracer,
+                                      const char *category, const char *name,
+                                      uintptr_t id, int64_t value)
+{
+    if (tracer == NULL)
+        return;
+
+    struct vlc_tracer_event ev = {
+        .phase = VLC_TRACER_COUNTER, .category = category, .name = name,
+        .ts = vlc_tick_now(), .tid = vlc_thread_id(), .id = id,
+        .pts = VLC_TICK_INVALID, .value = value,
+    };
+    vlc_tracer_Trace(tracer, &ev);
+}
+
+/** @} */
+#endif
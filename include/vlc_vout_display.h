@@ -310,6 +310,22 @@ struct vout_display_t {
      */
     vout_display_info_t info;
 
+    /**
+     * Allocates the pictures to display (optional).
+     *
+     * Video converters and filters render into the pictures of this pool,
+     * which are then passed to \ref prepare and \ref display. A display can
+     * thus provide pictures in its own buffers and avoid copying them.
+     *
+     * If NULL, the pictures are allocated in main memory with the
+     * \ref fmt format.
+     *
+     * \param count number of pictures
+     * \return a pool of pictures with the \ref fmt format, released by the
+     * caller, or NULL on error
+     */
+    picture_pool_t *(*pool)(vout_display_t *, unsigned count);
+
     /**
      * Prepares a picture and an optional subpicture for display (optional).
      *
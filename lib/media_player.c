@@ -611,6 +611,7 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "vmem-data", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-setup", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-cleanup", VLC_VAR_ADDRESS);
+    var_Create (mp, "vmem-pool", VLC_VAR_BOOL);
     var_Create (mp, "vmem-chroma", VLC_VAR_STRING | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-width", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-height", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
@@ -1047,6 +1048,11 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
     var_SetAddress( mp, "vmem-cleanup", cleanup );
 }
 
+void libvlc_video_set_pool( libvlc_media_player_t *mp, bool enable )
+{
+    var_SetBool( mp, "vmem-pool", enable );
+}
+
 void libvlc_video_set_format( libvlc_media_player_t *mp, const char *chroma,
                               unsigned width, unsigned height, unsigned pitch )
 {
@@ -1576,6 +1582,62 @@ void libvlc_chapter_descriptions_release( libvlc_chapter_description_t **p_chapt
     free( p_chapters );
 }
 
+static void latency_stats_Convert( libvlc_latency_stats_t *dst,
+                                   const struct vlc_latency_histogram *src )
+{
+    dst->i_samples = src->count;
+    dst->i_mean = US_FROM_VLC_TICK( vlc_latency_GetMean( src ) );
+    dst->i_jitter = US_FROM_VLC_TICK( vlc_latency_GetJitter( src ) );
+    dst->i_p95 = US_FROM_VLC_TICK( vlc_latency_GetPercentile( src, 95 ) );
+    dst->i_max = US_FROM_VLC_TICK( src->max );
+}
+
+bool libvlc_media_player_get_track_latency( libvlc_media_player_t *p_mi,
+                                            int i_track,
+                                            libvlc_track_latency_t *p_latency )
+{
+    static const enum es_format_category_e cats[] = { VIDEO_ES, AUDIO_ES,
+                                                      SPU_ES };
+    const struct vlc_es_latency *latency = NULL;
+
+    vlc_player_t *player = p_mi->player;
+    vlc_player_Lock(player);
+
+    for( size_t i = 0; i < ARRAY_SIZE(cats) && latency == NULL; i++ )
+    {
+        size_t count = vlc_player_GetTrackCount(player, cats[i]);
+        for( size_t j = 0; j < count; j++ )
+        {
+            const struct vlc_player_track *track =
+                vlc_player_GetTrackAt(player, cats[i], j);
+            if (i_track == vlc_es_id_GetInputId(track->es_id))
+            {
+                latency = vlc_player_GetTrackLatency(player, track->es_id);
+                break;
+            }
+        }
+    }
+
+    if( latency != NULL )
+    {
+        const struct vlc_latency_histogram *stages = latency->stages;
+
+        latency_stats_Convert( &p_latency->decoder_queue,
+                               &stages[VLC_LATENCY_DECODER_QUEUE] );
+        latency_stats_Convert( &p_latency->decode,
+                               &stages[VLC_LATENCY_DECODE] );
+        latency_stats_Convert( &p_latency->vout_queue,
+                               &stages[VLC_LATENCY_VOUT_QUEUE] );
+        latency_stats_Convert( &p_latency->lateness,
+                               &stages[VLC_LATENCY_LATENESS] );
+        latency_stats_Convert( &p_latency->aout_depth,
+                               &stages[VLC_LATENCY_AOUT_DEPTH] );
+    }
+
+    vlc_player_Unlock(player);
+    return latency != NULL;
+}
+
 void libvlc_media_player_next_chapter( libvlc_media_player_t *p_mi )
 {
     vlc_player_t *player = p_mi->player;
@@ -37,21 +37,33 @@
 #include <vlc_url.h>
 
 #include "connmgr.h"
+#include "message.h"
 #include "resource.h"
 #include "file.h"
 #include "live.h"
+#include "parallel.h"
 
 typedef struct
 {
     struct vlc_http_mgr *manager;
     struct vlc_http_resource *resource;
+    struct vlc_http_parallel *parallel;
 } access_sys_t;
 
 static block_t *FileRead(stream_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
+    block_t *b;
+
+    if (sys->parallel != NULL)
+    {
+        b = vlc_http_parallel_read(sys->parallel);
+        if (b == vlc_http_error)
+            return NULL; /* interrupted */
+    }
+    else
+        b = vlc_http_file_read(sys->resource);
 
-    block_t *b = vlc_http_file_read(sys->resource);
     if (b == NULL)
         *eof = true;
     return b;
@@ -61,6 +73,10 @@ static int FileSeek(stream_t *access, uint64_t pos)
 {
     access_sys_t *sys = access->p_sys;
 
+    if (sys->parallel != NULL)
+        return vlc_http_parallel_seek(sys->parallel, pos) ? VLC_EGENERIC
+                                                          : VLC_SUCCESS;
+
     if (vlc_http_file_seek(sys->resource, pos))
         return VLC_EGENERIC;
     return VLC_SUCCESS;
@@ -104,6 +120,16 @@ static int FileControl(stream_t *access, int query, va_list args)
             *va_arg(args, char **) = vlc_http_file_get_type(sys->resource);
             break;
 
+        case STREAM_GET_VALIDATOR:
+        {
+            char *val = vlc_http_file_get_validator(sys->resource);
+            if (val == NULL)
+                return VLC_EGENERIC;
+
+            *va_arg(args, char **) = val;
+            break;
+        }
+
         case STREAM_SET_PAUSE_STATE:
             break;
 
@@ -162,6 +188,7 @@ static int Open(vlc_object_t *obj)
 
     sys->manager = NULL;
     sys->resource = NULL;
+    sys->parallel = NULL;
 
     void *jar = NULL;
     if (var_InheritBool(obj, "http-forward-cookies"))
@@ -184,11 +211,12 @@ static int Open(vlc_object_t *obj)
 
     sys->resource = (live ? vlc_http_live_create : vlc_http_file_create)(
         sys->manager, access->psz_url, ua, referer);
-    free(referer);
-    free(ua);
-
     if (sys->resource == NULL)
+    {
+        free(referer);
+        free(ua);
         goto error;
+    }
 
     if (vlc_credential_get(&crd, obj, NULL, NULL, NULL, NULL))
         vlc_http_res_set_login(sys->resource,
@@ -217,26 +245,38 @@ static int Open(vlc_object_t *obj)
         status = vlc_http_res_get_status(sys->resource);
     }
 
+    char *redir = NULL;
     if (status < 0)
-    {
         msg_Err(access, "HTTP connection failure");
-        goto error;
-    }
-
-    char *redir = vlc_http_res_get_redirect(sys->resource);
-    if (redir != NULL)
+    else if ((redir = vlc_http_res_get_redirect(sys->resource)) != NULL)
     {
         access->psz_url = redir;
         ret = VLC_ACCESS_REDIRECT;
-        goto error;
     }
-
-    if (status >= 300)
-    {
+    else if (status >= 300)
         msg_Err(access, "HTTP %d error", status);
-        goto error;
+    else if (!live)
+    {   /* Read ahead over several connections if possible */
+        unsigned conns = var_InheritInteger(obj, "http-parallel");
+        uintmax_t size = vlc_http_file_get_size(sys->resource);
+
+        if (conns > 1 && size != (uintmax_t)-1
+         && vlc_http_file_can_seek(sys->resource))
+            sys->parallel = vlc_http_parallel_create(obj, jar,
+                access->psz_url, ua, referer, crd.psz_username,
+                crd.psz_password, size, conns);
+        if (sys->parallel != NULL)
+            /* The data is read over the parallel connections only, and the
+             * response headers are still needed for the controls */
+            vlc_http_msg_abort(sys->resource->response);
     }
 
+    free(referer);
+    free(ua);
+
+    if (status < 0 || redir != NULL || status >= 300)
+        goto error;
+
     vlc_credential_store(&crd, obj);
     free(psz_realm);
     vlc_credential_clean(&crd);
@@ -259,6 +299,7 @@ static int Open(vlc_object_t *obj)
     return VLC_SUCCESS;
 
 error:
+    assert(sys->parallel == NULL);
     if (sys->resource != NULL)
         vlc_http_res_destroy(sys->resource);
     if (sys->manager != NULL)
@@ -275,6 +316,8 @@ static void Close(vlc_object_t *obj)
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
 
+    if (sys->parallel != NULL)
+        vlc_http_parallel_destroy(sys->parallel);
     vlc_http_res_destroy(sys->resource);
     vlc_http_mgr_destroy(sys->manager);
     free(sys);
@@ -292,6 +335,11 @@ vlc_module_begin()
     add_bool("http-continuous", false, N_("Continuous stream"),
              N_("Keep reading a resource that keeps being updated."), true)
         change_volatile()
+    add_integer("http-parallel", 1, N_("Parallel connections"),
+                N_("Number of connections used to read seekable files ahead "
+                   "with byte range requests. This can speed up downloads "
+                   "over links with a long round trip."), true)
+        change_integer_range(1, 16)
     add_bool("http-forward-cookies", true, N_("Cookies forwarding"),
              N_("Forward cookies across HTTP redirections."), true)
     add_string("http-referrer", NULL, N_("Referrer"),
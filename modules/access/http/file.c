@@ -43,6 +43,7 @@ struct vlc_http_file
 {
     struct vlc_http_resource resource;
     uintmax_t offset;
+    uintmax_t end; /**< last requested byte (or UINTMAX_MAX) */
 };
 
 static int vlc_http_file_req(const struct vlc_http_resource *res,
@@ -69,6 +70,13 @@ static int vlc_http_file_req(const struct vlc_http_resource *res,
         }
     }
 
+    if (file->end != UINTMAX_MAX)
+    {
+        assert(file->end >= *offset);
+        return vlc_http_msg_add_header(req, "Range", "bytes=%" PRIuMAX "-%"
+                                       PRIuMAX, *offset, file->end);
+    }
+
     if (vlc_http_msg_add_header(req, "Range", "bytes=%" PRIuMAX "-", *offset)
      && *offset != 0)
         return -1;
@@ -126,6 +134,7 @@ struct vlc_http_resource *vlc_http_file_create(struct vlc_http_mgr *mgr,
     }
 
     file->offset = 0;
+    file->end = UINTMAX_MAX;
     return &file->resource;
 }
 
@@ -201,7 +210,8 @@ bool vlc_http_file_can_seek(struct vlc_http_resource *res)
     return vlc_http_msg_can_seek(res->response);
 }
 
-int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
+static int vlc_http_file_reopen(struct vlc_http_resource *res,
+                                uintmax_t offset)
 {
     struct vlc_http_msg *resp = vlc_http_res_open(res, &offset);
     if (resp == NULL)
@@ -229,6 +239,24 @@ int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
     return 0;
 }
 
+int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    file->end = UINTMAX_MAX;
+    return vlc_http_file_reopen(res, offset);
+}
+
+int vlc_http_file_seek_range(struct vlc_http_resource *res, uintmax_t offset,
+                             uintmax_t length)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    assert(length > 0 && offset + length > offset);
+    file->end = offset + length - 1;
+    return vlc_http_file_reopen(res, offset);
+}
+
 block_t *vlc_http_file_read(struct vlc_http_resource *res)
 {
     struct vlc_http_file *file = (struct vlc_http_file *)res;
@@ -239,7 +267,8 @@ block_t *vlc_http_file_read(struct vlc_http_resource *res)
         if (res->response != NULL
          && vlc_http_msg_can_seek(res->response)
          && file->offset < vlc_http_msg_get_file_size(res->response)
-         && vlc_http_file_seek(res, file->offset) == 0)
+         && (file->end == UINTMAX_MAX || file->offset <= file->end)
+         && vlc_http_file_reopen(res, file->offset) == 0)
             block = vlc_http_res_read(res);
 
         if (block == vlc_http_error)
@@ -72,6 +72,20 @@ bool vlc_http_file_can_seek(struct vlc_http_resource *);
  */
 int vlc_http_file_seek(struct vlc_http_resource *, uintmax_t offset);
 
+/**
+ * Requests a byte range of an HTTP file.
+ *
+ * This works as vlc_http_file_seek(), except that only the given number of
+ * bytes are requested, so that the connection can be reused afterward.
+ *
+ * @param offset byte offset of next read
+ * @param length number of requested bytes (must be positive)
+ * @retval 0 if seek succeeded
+ * @retval -1 if seek failed
+ */
+int vlc_http_file_seek_range(struct vlc_http_resource *, uintmax_t offset,
+                             uintmax_t length);
+
 /**
  * Reads data.
  *
@@ -82,6 +96,7 @@ struct block_t *vlc_http_file_read(struct vlc_http_resource *);
 #define vlc_http_file_get_status vlc_http_res_get_status
 #define vlc_http_file_get_redirect vlc_http_res_get_redirect
 #define vlc_http_file_get_type vlc_http_res_get_type
+#define vlc_http_file_get_validator vlc_http_res_get_validator
 #define vlc_http_file_destroy vlc_http_res_destroy
 
 /** @} */
@@ -72,6 +72,7 @@ int main(void)
     assert(vlc_http_file_get_size(f) == (uintmax_t)-1);
     assert(!vlc_http_file_can_seek(f));
     assert(vlc_http_file_get_type(f) == NULL);
+    assert(vlc_http_file_get_validator(f) == NULL);
     assert(vlc_http_file_read(f) == NULL);
     vlc_http_res_destroy(f);
 
@@ -91,6 +92,9 @@ int main(void)
     str = vlc_http_file_get_type(f);
     assert(str != NULL && !strcmp(str, "video/mpeg"));
     free(str);
+    str = vlc_http_file_get_validator(f);
+    assert(str != NULL && !strcmp(str, "\"foobar42\""));
+    free(str);
 
     /* Seek failure */
     replies[0] = "HTTP/1.1 200 OK\r\nETag: \"foobar42\"\r\n\r\n";
@@ -110,6 +114,9 @@ int main(void)
     assert(f != NULL);
     assert(vlc_http_file_can_seek(f));
     assert(vlc_http_file_get_size(f) == 2345);
+    str = vlc_http_file_get_validator(f);
+    assert(str != NULL && !strcmp(str, "W/\"foobar42\""));
+    free(str);
     assert(vlc_http_file_read(f) == NULL);
 
     /* Seek success */
@@ -162,6 +169,7 @@ int main(void)
     assert(f != NULL);
     assert(vlc_http_file_get_size(f) == 9999);
     assert(vlc_http_file_get_redirect(f) == NULL);
+    assert(vlc_http_file_get_validator(f) == NULL);
     vlc_http_file_destroy(f);
 
     /* No entity tags */
@@ -175,6 +183,9 @@ int main(void)
     f = vlc_http_file_create(NULL, url, ua, NULL);
     assert(f != NULL);
     assert(vlc_http_file_can_seek(f));
+    str = vlc_http_file_get_validator(f);
+    assert(str != NULL && !strcmp(str, "Mon, 21 Oct 2013 20:13:22 GMT"));
+    free(str);
 
     replies[0] = "HTTP/1.1 206 Partial Content\r\n"
                  "Content-Range: bytes 1234-3455/3456\r\n"
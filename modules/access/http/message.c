@@ -189,6 +189,15 @@ const char *vlc_http_msg_get_path(const struct vlc_http_msg *m)
     return m->path;
 }
 
+void vlc_http_msg_abort(struct vlc_http_msg *m)
+{
+    if (m->payload != NULL)
+    {
+        vlc_http_stream_close(m->payload, true);
+        m->payload = NULL;
+    }
+}
+
 void vlc_http_msg_destroy(struct vlc_http_msg *m)
 {
     if (m->payload != NULL)
@@ -288,6 +288,14 @@ struct vlc_http_msg *vlc_http_msg_get_final(struct vlc_http_msg *) VLC_USED;
  */
 struct block_t *vlc_http_msg_read(struct vlc_http_msg *) VLC_USED;
 
+/**
+ * Aborts an HTTP message payload.
+ *
+ * Stops receiving the data of an HTTP message, keeping its headers. The
+ * message then reads as the end of the stream.
+ */
+void vlc_http_msg_abort(struct vlc_http_msg *);
+
 /** @} */
 
 /**
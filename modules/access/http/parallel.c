@@ -0,0 +1,492 @@
+/*****************************************************************************
+ * parallel.c: HTTP parallel ranges
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_interrupt.h>
+#include "conn.h"
+#include "connmgr.h"
+#include "message.h"
+#include "resource.h"
+#include "file.h"
+#include "parallel.h"
+
+#pragma GCC visibility push(default)
+
+#define PARALLEL_CHUNK_MIN (256 << 10)
+#define PARALLEL_CHUNK_MAX (16 << 20)
+/* Chunks are sized so that each request takes about that long */
+#define PARALLEL_CHUNK_TIME VLC_TICK_FROM_SEC(1)
+/* Number of chunks requested ahead of the read offset per connection */
+#define PARALLEL_AHEAD 2
+/* Number of attempts to resume an interrupted chunk */
+#define PARALLEL_RETRIES 3
+
+struct vlc_http_chunk
+{
+    struct vlc_http_chunk *next;
+    uintmax_t offset; /**< Offset of the first unread byte */
+    uintmax_t received; /**< Offset of the first missing byte */
+    uintmax_t end; /**< Offset after the last byte */
+    block_t *data; /**< Received unread data (from offset to received) */
+    block_t **tailp;
+    unsigned retries;
+    bool active; /**< Being received by a connection */
+    bool abandoned; /**< Removed from the list while being received */
+};
+
+struct vlc_http_parallel_conn
+{
+    struct vlc_http_parallel *owner;
+    struct vlc_http_mgr *manager;
+    struct vlc_http_resource *resource;
+    vlc_interrupt_t *interrupt;
+    vlc_thread_t thread;
+};
+
+struct vlc_http_parallel
+{
+    struct vlc_logger *logger;
+    uintmax_t size;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait_data;
+    vlc_cond_t wait_work;
+    struct vlc_http_chunk *chunks; /**< Contiguous chunks from offset */
+    uintmax_t offset; /**< Read offset */
+    uintmax_t next; /**< Offset of the next chunk to request */
+    size_t chunk_size;
+    bool failed;
+    bool interrupted;
+    bool closing;
+
+    unsigned count;
+    struct vlc_http_parallel_conn conns[];
+};
+
+static struct vlc_http_chunk *vlc_http_chunk_create(uintmax_t offset,
+                                                    uintmax_t end)
+{
+    struct vlc_http_chunk *c = malloc(sizeof (*c));
+    if (unlikely(c == NULL))
+        return NULL;
+
+    c->next = NULL;
+    c->offset = offset;
+    c->received = offset;
+    c->end = end;
+    c->data = NULL;
+    c->tailp = &c->data;
+    c->retries = 0;
+    c->active = false;
+    c->abandoned = false;
+    return c;
+}
+
+static void vlc_http_chunk_destroy(struct vlc_http_chunk *c)
+{
+    block_ChainRelease(c->data);
+    free(c);
+}
+
+static void vlc_http_chunk_append(struct vlc_http_chunk *c, block_t *block)
+{
+    uintmax_t start = c->received;
+
+    /* Drop what exceeds the requested range (if the server ignored it) */
+    if (block->i_buffer > c->end - start)
+        block->i_buffer = c->end - start;
+    c->received += block->i_buffer;
+
+    /* Drop what precedes the read offset (after a seek) */
+    if (c->received <= c->offset)
+    {
+        block_Release(block);
+        return;
+    }
+    if (start < c->offset)
+    {
+        size_t skip = c->offset - start;
+
+        block->p_buffer += skip;
+        block->i_buffer -= skip;
+    }
+
+    *c->tailp = block;
+    c->tailp = &block->p_next;
+}
+
+static void vlc_http_chunk_skip(struct vlc_http_chunk *c, uintmax_t offset)
+{
+    assert(offset >= c->offset && offset < c->end);
+
+    uintmax_t skip = offset - c->offset;
+
+    c->offset = offset;
+
+    while (skip > 0 && c->data != NULL)
+    {
+        block_t *block = c->data;
+
+        if (block->i_buffer > skip)
+        {
+            block->p_buffer += skip;
+            block->i_buffer -= skip;
+            break;
+        }
+
+        skip -= block->i_buffer;
+        c->data = block->p_next;
+        block_Release(block);
+    }
+
+    if (c->data == NULL)
+        c->tailp = &c->data;
+}
+
+/**
+ * Removes a chunk from the list.
+ */
+static void vlc_http_parallel_drop(struct vlc_http_chunk **restrict pp)
+{
+    struct vlc_http_chunk *c = *pp;
+
+    *pp = c->next;
+
+    if (c->active)
+        c->abandoned = true; /* the connection will destroy it */
+    else
+        vlc_http_chunk_destroy(c);
+}
+
+/**
+ * Selects the next chunk to receive.
+ */
+static struct vlc_http_chunk *
+vlc_http_parallel_pick(struct vlc_http_parallel *p)
+{
+    struct vlc_http_chunk **pp = &p->chunks;
+
+    /* Resume the earliest interrupted chunk first */
+    for (struct vlc_http_chunk *c = p->chunks; c != NULL; c = c->next)
+    {
+        if (!c->active && c->received < c->end
+         && c->retries <= PARALLEL_RETRIES)
+            return c;
+        pp = &c->next;
+    }
+
+    /* Otherwise request the next chunk, if within the read-ahead window */
+    if (p->failed || p->next >= p->size
+     || p->next - p->offset >= PARALLEL_AHEAD * p->count * p->chunk_size)
+        return NULL;
+
+    uintmax_t end = p->next + p->chunk_size;
+    if (end > p->size)
+        end = p->size;
+
+    struct vlc_http_chunk *c = vlc_http_chunk_create(p->next, end);
+    if (unlikely(c == NULL))
+        return NULL;
+
+    *pp = c;
+    p->next = end;
+    return c;
+}
+
+static void vlc_http_parallel_adapt(struct vlc_http_parallel *p,
+                                    uintmax_t bytes, vlc_tick_t elapsed)
+{
+    if (elapsed <= 0)
+        return;
+
+    uintmax_t target = bytes * PARALLEL_CHUNK_TIME / elapsed;
+    if (target > PARALLEL_CHUNK_MAX)
+        target = PARALLEL_CHUNK_MAX;
+
+    size_t size = (3 * p->chunk_size + target) / 4;
+    if (size < PARALLEL_CHUNK_MIN)
+        size = PARALLEL_CHUNK_MIN;
+
+    if (size > p->chunk_size * 5 / 4 || size < p->chunk_size * 3 / 4)
+        vlc_http_dbg(p->logger, "chunk size %zu -> %zu bytes "
+                     "(%ju bytes in %"PRId64" ms)", p->chunk_size, size,
+                     bytes, MS_FROM_VLC_TICK(elapsed));
+    p->chunk_size = size;
+}
+
+static void *vlc_http_parallel_thread(void *data)
+{
+    struct vlc_http_parallel_conn *conn = data;
+    struct vlc_http_parallel *p = conn->owner;
+
+    vlc_interrupt_set(conn->interrupt);
+
+    vlc_mutex_lock(&p->lock);
+    while (!p->closing)
+    {
+        struct vlc_http_chunk *c = vlc_http_parallel_pick(p);
+        if (c == NULL)
+        {
+            vlc_cond_wait(&p->wait_work, &p->lock);
+            continue;
+        }
+
+        uintmax_t offset = c->received;
+        uintmax_t length = c->end - c->received;
+        uintmax_t bytes = 0;
+
+        c->active = true;
+        vlc_mutex_unlock(&p->lock);
+
+        vlc_tick_t start = vlc_tick_now();
+        bool ok = vlc_http_file_seek_range(conn->resource, offset,
+                                           length) == 0;
+
+        while (ok)
+        {
+            block_t *block = vlc_http_file_read(conn->resource);
+
+            vlc_mutex_lock(&p->lock);
+            if (block == NULL || c->abandoned || p->closing)
+            {
+                vlc_mutex_unlock(&p->lock);
+                if (block != NULL)
+                    block_Release(block);
+                break;
+            }
+
+            bytes += block->i_buffer;
+            vlc_http_chunk_append(c, block);
+            ok = c->received < c->end;
+            vlc_cond_signal(&p->wait_data);
+            vlc_mutex_unlock(&p->lock);
+        }
+
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+
+        vlc_mutex_lock(&p->lock);
+        c->active = false;
+
+        if (c->abandoned)
+            vlc_http_chunk_destroy(c);
+        else if (c->received < c->end)
+        {
+            if (++c->retries > PARALLEL_RETRIES)
+            {
+                vlc_http_err(p->logger, "cannot receive bytes %ju-%ju",
+                             c->received, c->end - 1);
+                p->failed = true;
+            }
+        }
+        else
+            vlc_http_parallel_adapt(p, bytes, elapsed);
+
+        vlc_cond_signal(&p->wait_data);
+    }
+    vlc_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+static void vlc_http_parallel_conn_clean(struct vlc_http_parallel_conn *conn)
+{
+    if (conn->interrupt != NULL)
+        vlc_interrupt_destroy(conn->interrupt);
+    if (conn->resource != NULL)
+        vlc_http_res_destroy(conn->resource);
+    if (conn->manager != NULL)
+        vlc_http_mgr_destroy(conn->manager);
+}
+
+struct vlc_http_parallel *vlc_http_parallel_create(vlc_object_t *obj,
+    struct vlc_http_cookie_jar_t *jar, const char *uri, const char *ua,
+    const char *ref, const char *user, const char *pass, uintmax_t size,
+    unsigned conns)
+{
+    assert(conns > 0);
+
+    struct vlc_http_parallel *p = malloc(sizeof (*p)
+                                         + conns * sizeof (p->conns[0]));
+    if (unlikely(p == NULL))
+        return NULL;
+
+    p->logger = obj->logger;
+    p->size = size;
+    vlc_mutex_init(&p->lock);
+    vlc_cond_init(&p->wait_data);
+    vlc_cond_init(&p->wait_work);
+    p->chunks = NULL;
+    p->offset = 0;
+    p->next = 0;
+    p->chunk_size = PARALLEL_CHUNK_MIN;
+    p->failed = false;
+    p->closing = false;
+    p->count = 0;
+
+    /* The threads wait for all the connections to be set up */
+    vlc_mutex_lock(&p->lock);
+    p->interrupted = false;
+    for (unsigned i = 0; i < conns; i++)
+    {
+        struct vlc_http_parallel_conn *conn = &p->conns[i];
+
+        conn->owner = p;
+        conn->manager = vlc_http_mgr_create(obj, jar);
+        conn->resource = (conn->manager != NULL)
+            ? vlc_http_file_create(conn->manager, uri, ua, ref) : NULL;
+        conn->interrupt = vlc_interrupt_create();
+
+        if (conn->resource == NULL || conn->interrupt == NULL
+         || (user != NULL && vlc_http_res_set_login(conn->resource, user,
+                                                    pass))
+         || vlc_clone(&conn->thread, vlc_http_parallel_thread, conn,
+                      VLC_THREAD_PRIORITY_INPUT))
+        {
+            vlc_http_parallel_conn_clean(conn);
+            break;
+        }
+        p->count++;
+    }
+    vlc_mutex_unlock(&p->lock);
+
+    if (p->count == 0)
+    {
+        free(p);
+        return NULL;
+    }
+
+    vlc_http_dbg(p->logger, "reading over %u connections", p->count);
+    return p;
+}
+
+void vlc_http_parallel_destroy(struct vlc_http_parallel *p)
+{
+    vlc_mutex_lock(&p->lock);
+    p->closing = true;
+    vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+
+    for (unsigned i = 0; i < p->count; i++)
+    {
+        struct vlc_http_parallel_conn *conn = &p->conns[i];
+
+        vlc_interrupt_kill(conn->interrupt);
+        vlc_join(conn->thread, NULL);
+        vlc_http_parallel_conn_clean(conn);
+    }
+
+    while (p->chunks != NULL)
+        vlc_http_parallel_drop(&p->chunks);
+    free(p);
+}
+
+static void vlc_http_parallel_wake_up(void *data)
+{
+    struct vlc_http_parallel *p = data;
+
+    vlc_mutex_lock(&p->lock);
+    p->interrupted = true;
+    vlc_cond_signal(&p->wait_data);
+    vlc_mutex_unlock(&p->lock);
+}
+
+block_t *vlc_http_parallel_read(struct vlc_http_parallel *p)
+{
+    block_t *block = NULL;
+
+    /* Reset before registering, as a pending interrupt calls back at once */
+    vlc_mutex_lock(&p->lock);
+    p->interrupted = false;
+    vlc_mutex_unlock(&p->lock);
+
+    vlc_interrupt_register(vlc_http_parallel_wake_up, p);
+    vlc_mutex_lock(&p->lock);
+
+    while (p->offset < p->size)
+    {
+        struct vlc_http_chunk *c = p->chunks;
+
+        if (c != NULL && c->data != NULL)
+        {
+            assert(c->offset == p->offset);
+            block = c->data;
+            c->data = block->p_next;
+            if (c->data == NULL)
+                c->tailp = &c->data;
+            block->p_next = NULL;
+
+            c->offset += block->i_buffer;
+            p->offset += block->i_buffer;
+            if (c->offset == c->end)
+                vlc_http_parallel_drop(&p->chunks);
+
+            /* The read-ahead window moved */
+            vlc_cond_broadcast(&p->wait_work);
+            break;
+        }
+
+        if (p->failed)
+            break;
+        if (p->interrupted)
+        {
+            block = vlc_http_error;
+            break;
+        }
+
+        vlc_cond_wait(&p->wait_data, &p->lock);
+    }
+
+    vlc_mutex_unlock(&p->lock);
+    vlc_interrupt_unregister();
+    return block;
+}
+
+int vlc_http_parallel_seek(struct vlc_http_parallel *p, uintmax_t offset)
+{
+    struct vlc_http_chunk *c;
+
+    vlc_mutex_lock(&p->lock);
+    /* Keep the chunk containing the new offset and the following ones */
+    while ((c = p->chunks) != NULL && (c->end <= offset || c->offset > offset))
+        vlc_http_parallel_drop(&p->chunks);
+
+    if (c != NULL)
+        vlc_http_chunk_skip(c, offset);
+    else
+        p->next = offset;
+
+    for (c = p->chunks; c != NULL; c = c->next)
+        c->retries = 0;
+
+    p->offset = offset;
+    p->failed = false;
+    vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+    return 0;
+}
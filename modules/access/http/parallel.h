@@ -0,0 +1,83 @@
+/*****************************************************************************
+ * parallel.h: HTTP parallel ranges declarations
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/**
+ * \defgroup http_parallel Parallel ranges
+ * HTTP file read-ahead over several connections
+ * \ingroup http_res
+ *
+ * The read-ahead of a seekable HTTP file is split in chunks, which are
+ * requested concurrently with byte ranges, each connection having its own
+ * connection manager. The chunks are put back in order before being read.
+ * The chunk size adapts to the measured throughput, so that each request
+ * lasts long enough to amortize its round trip.
+ * @{
+ */
+
+#include <stdint.h>
+
+struct vlc_http_cookie_jar_t;
+struct vlc_http_parallel;
+struct block_t;
+
+/**
+ * Starts reading an HTTP file over several connections.
+ *
+ * @param obj parent VLC object
+ * @param jar cookie jar (or NULL)
+ * @param uri file URI
+ * @param ua user agent string (or NULL)
+ * @param ref referral URI (or NULL)
+ * @param user user name (or NULL)
+ * @param pass password (or NULL)
+ * @param size file size
+ * @param conns number of connections
+ * @return a parallel reader, or NULL on error.
+ */
+struct vlc_http_parallel *vlc_http_parallel_create(vlc_object_t *obj,
+    struct vlc_http_cookie_jar_t *jar, const char *uri, const char *ua,
+    const char *ref, const char *user, const char *pass, uintmax_t size,
+    unsigned conns);
+
+void vlc_http_parallel_destroy(struct vlc_http_parallel *);
+
+/**
+ * Reads data.
+ *
+ * Waits for the data at the current offset to be received.
+ *
+ * @return a block of data, NULL at the end of the file or on fatal error, or
+ * vlc_http_error if the wait was interrupted.
+ */
+struct block_t *vlc_http_parallel_read(struct vlc_http_parallel *);
+
+/**
+ * Sets the read offset.
+ *
+ * The chunks already received (or being received) after the new offset are
+ * kept, the others are discarded.
+ *
+ * @param offset byte offset of next read
+ * @retval 0 if seek succeeded
+ * @retval -1 if seek failed
+ */
+int vlc_http_parallel_seek(struct vlc_http_parallel *, uintmax_t offset);
+
+/** @} */
@@ -0,0 +1,297 @@
+/*****************************************************************************
+ * parallel_test.c: HTTP parallel ranges test
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "message.h"
+#include "parallel.h"
+
+const char vlc_module_name[] = "test_http_parallel";
+
+static const char url[] = "http://www.example.com/dir/file.ext";
+static const char ua[] = PACKAGE_NAME "/" PACKAGE_VERSION " (test suite)";
+
+/* Simulated link: round trip time and time to receive a block */
+#define TEST_RTT   VLC_TICK_FROM_MS(5)
+#define TEST_BLOCK 4096
+#define TEST_BLOCK_TIME VLC_TICK_FROM_US(200)
+
+static uintmax_t file_size;
+static atomic_uint requests;
+static atomic_uint failures; /* number of transfers to interrupt */
+static atomic_bool unreachable;
+
+static uint8_t file_byte(uintmax_t offset)
+{
+    return (offset * 7) ^ (offset >> 11);
+}
+
+static uintmax_t read_check(struct vlc_http_parallel *p, uintmax_t offset,
+                            uintmax_t length)
+{
+    uintmax_t done = 0;
+
+    while (done < length)
+    {
+        block_t *block = vlc_http_parallel_read(p);
+        if (block == NULL)
+            break;
+        assert(block != vlc_http_error);
+
+        for (size_t i = 0; i < block->i_buffer; i++)
+            assert(block->p_buffer[i] == file_byte(offset + done + i));
+
+        done += block->i_buffer;
+        block_Release(block);
+    }
+    return done;
+}
+
+static void test_parallel(unsigned conns)
+{
+    vlc_object_t obj;
+    struct vlc_http_parallel *p;
+
+    memset(&obj, 0, sizeof (obj));
+    atomic_store(&requests, 0);
+
+    p = vlc_http_parallel_create(&obj, NULL, url, ua, NULL, NULL, NULL,
+                                 file_size, conns);
+    assert(p != NULL);
+
+    /* Sequential reading */
+    vlc_tick_t start = vlc_tick_now();
+    assert(read_check(p, 0, file_size) == file_size);
+    assert(vlc_http_parallel_read(p) == NULL);
+    fprintf(stderr, "%u connections: %ju bytes in %"PRId64" ms "
+            "(%u requests)\n", conns, file_size,
+            MS_FROM_VLC_TICK(vlc_tick_now() - start), atomic_load(&requests));
+
+    /* Seek backward, then within the read-ahead window */
+    assert(vlc_http_parallel_seek(p, 1000) == 0);
+    assert(read_check(p, 1000, 5000) >= 5000);
+    assert(vlc_http_parallel_seek(p, 70000) == 0);
+    assert(read_check(p, 70000, 100000) >= 100000);
+
+    /* Seek forward, beyond the read-ahead window */
+    assert(vlc_http_parallel_seek(p, file_size - 3000000) == 0);
+    assert(read_check(p, file_size - 3000000, 3000000) == 3000000);
+    assert(vlc_http_parallel_read(p) == NULL);
+
+    /* Seek past the end */
+    assert(vlc_http_parallel_seek(p, file_size + 1) == 0);
+    assert(vlc_http_parallel_read(p) == NULL);
+
+    /* Interrupted requests are resumed */
+    atomic_store(&failures, 2);
+    assert(vlc_http_parallel_seek(p, 12345) == 0);
+    assert(read_check(p, 12345, file_size - 12345) == file_size - 12345);
+
+    /* Persistent failures are reported */
+    atomic_store(&unreachable, true);
+    assert(vlc_http_parallel_seek(p, 0) == 0);
+    assert(read_check(p, 0, file_size) < file_size);
+    atomic_store(&unreachable, false);
+
+    vlc_http_parallel_destroy(p);
+
+    /* Destruction with pending requests */
+    p = vlc_http_parallel_create(&obj, NULL, url, ua, NULL, NULL, NULL,
+                                 file_size, conns);
+    assert(p != NULL);
+    assert(read_check(p, 0, 1) >= 1);
+    vlc_http_parallel_destroy(p);
+}
+
+int main(void)
+{
+    file_size = (5 << 20) + 1234;
+
+    test_parallel(1);
+    test_parallel(4);
+    return 0;
+}
+
+/* Callback for vlc_http_msg_h2_frame */
+#include "h2frame.h"
+
+struct vlc_h2_frame *
+vlc_h2_frame_headers(uint_fast32_t id, uint_fast32_t mtu, bool eos,
+                     unsigned count, const char *const tab[][2])
+{
+    (void) id; (void) mtu; (void) count, (void) tab;
+    assert(!eos);
+    return NULL;
+}
+
+/* Callbacks for the HTTP requests */
+#include "conn.h"
+#include "connmgr.h"
+
+struct test_stream
+{
+    struct vlc_http_stream stream;
+    uintmax_t offset;
+    uintmax_t end;
+    bool fail;
+};
+
+static struct vlc_http_msg *stream_read_headers(struct vlc_http_stream *s)
+{
+    struct test_stream *ts = container_of(s, struct test_stream, stream);
+    char *answer;
+
+    vlc_tick_wait(vlc_tick_now() + TEST_RTT);
+
+    if (asprintf(&answer, "HTTP/1.1 206 Partial Content\r\n"
+                 "Content-Range: bytes %ju-%ju/%ju\r\n"
+                 "Content-Length: %ju\r\n\r\n", ts->offset, ts->end,
+                 file_size, ts->end + 1 - ts->offset) < 0)
+        abort();
+
+    struct vlc_http_msg *m = vlc_http_msg_headers(answer);
+    assert(m != NULL);
+    free(answer);
+    vlc_http_msg_attach(m, s);
+    return m;
+}
+
+static struct block_t *stream_read(struct vlc_http_stream *s)
+{
+    struct test_stream *ts = container_of(s, struct test_stream, stream);
+
+    if (ts->offset > ts->end)
+        return NULL;
+
+    vlc_tick_wait(vlc_tick_now() + TEST_BLOCK_TIME);
+
+    if (ts->fail)
+        return vlc_http_error;
+
+    size_t length = TEST_BLOCK;
+    if (length > ts->end + 1 - ts->offset)
+        length = ts->end + 1 - ts->offset;
+
+    block_t *block = block_Alloc(length);
+    assert(block != NULL);
+
+    for (size_t i = 0; i < length; i++)
+        block->p_buffer[i] = file_byte(ts->offset + i);
+    ts->offset += length;
+
+    /* Interrupt the transfer in the middle of a block */
+    if (ts->offset > ts->end / 2 && ts->end > TEST_BLOCK)
+    {
+        unsigned n = atomic_load(&failures);
+
+        while (n > 0 && !atomic_compare_exchange_weak(&failures, &n, n - 1));
+        ts->fail = n > 0;
+    }
+    return block;
+}
+
+static void stream_close(struct vlc_http_stream *s, bool abort)
+{
+    struct test_stream *ts = container_of(s, struct test_stream, stream);
+
+    (void) abort;
+    free(ts);
+}
+
+static const struct vlc_http_stream_cbs stream_callbacks =
+{
+    stream_read_headers,
+    stream_read,
+    stream_close,
+};
+
+struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
+                                          const char *host, unsigned port,
+                                          const struct vlc_http_msg *req)
+{
+    uintmax_t start, end;
+    char c;
+
+    assert(mgr != NULL);
+    assert(!https);
+    assert(!strcmp(host, "www.example.com"));
+    assert(port == 0);
+
+    const char *str = vlc_http_msg_get_header(req, "Range");
+    assert(str != NULL);
+    /* Every range must be bounded, so that connections can be reused */
+    int val = sscanf(str, "bytes=%ju-%ju%c", &start, &end, &c);
+    assert(val == 2);
+    assert(start <= end && end < file_size);
+
+    if (atomic_load(&unreachable))
+        return NULL;
+
+    struct test_stream *ts = malloc(sizeof (*ts));
+    assert(ts != NULL);
+    ts->stream.cbs = &stream_callbacks;
+    ts->offset = start;
+    ts->end = end;
+    ts->fail = false;
+
+    atomic_fetch_add(&requests, 1);
+    return vlc_http_msg_get_initial(&ts->stream);
+}
+
+struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
+{
+    assert(mgr != NULL);
+    return NULL;
+}
+
+struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
+                                         struct vlc_http_cookie_jar_t *jar)
+{
+    assert(obj != NULL);
+    assert(jar == NULL);
+    return malloc(1);
+}
+
+void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
+{
+    free(mgr);
+}
+
+void vlc_http_err(void *ctx, const char *fmt, ...)
+{
+    (void) ctx; (void) fmt;
+}
+
+void vlc_http_dbg(void *ctx, const char *fmt, ...)
+{
+    (void) ctx; (void) fmt;
+}
@@ -319,6 +319,18 @@ char *vlc_http_res_get_type(struct vlc_http_resource *res)
     return (type != NULL) ? strdup(type) : NULL;
 }
 
+char *vlc_http_res_get_validator(struct vlc_http_resource *res)
+{
+    int status = vlc_http_res_get_status(res);
+    if (status < 200 || status >= 300)
+        return NULL;
+
+    const char *str = vlc_http_msg_get_header(res->response, "ETag");
+    if (str == NULL)
+        str = vlc_http_msg_get_header(res->response, "Last-Modified");
+    return (str != NULL) ? strdup(str) : NULL;
+}
+
 struct block_t *vlc_http_res_read(struct vlc_http_resource *res)
 {
     int status = vlc_http_res_get_status(res);
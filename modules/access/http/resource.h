@@ -91,6 +91,14 @@ char *vlc_http_res_get_redirect(struct vlc_http_resource *);
  */
 char *vlc_http_res_get_type(struct vlc_http_resource *);
 
+/**
+ * Gets the validator of the entity.
+ *
+ * @return Heap-allocated entity tag, or failing that last modification date,
+ * or NULL if neither is known.
+ */
+char *vlc_http_res_get_validator(struct vlc_http_resource *);
+
 /**
  * Reads data.
  */
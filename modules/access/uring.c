@@ -0,0 +1,545 @@
+/*****************************************************************************
+ * uring.c: asynchronous file input using io_uring
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Unlike the filesystem access, this access does not block a thread in each
+ * read: it keeps several reads of consecutive blocks in flight, so that the
+ * device (or file server) can process them concurrently, and hands out the
+ * completed blocks in order. With O_DIRECT, the data is read straight into
+ * aligned blocks which are passed to the demuxer without copy, bypassing the
+ * page cache.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <liburing.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_interrupt.h>
+#include <vlc_plugin.h>
+
+#define URING_ALIGN 4096
+
+struct uring_slot
+{
+    block_t *block;
+    uint64_t offset;
+    int result;
+    bool busy; /**< owned by the kernel */
+    bool done;
+    bool discarded; /**< flushed while owned by the kernel */
+};
+
+typedef struct
+{
+    int fd;
+    int eventfd;
+    struct io_uring ring;
+
+    size_t align;
+    size_t block_size;
+    uint64_t size;
+    uint64_t offset; /**< offset of the next block to hand out */
+    uint64_t submitted; /**< offset of the next block to read */
+    size_t skip; /**< bytes to skip from the next block (unaligned seek) */
+    bool eof;
+
+    unsigned head; /**< index of the next slot to hand out */
+    unsigned queued; /**< number of slots in order from head */
+    unsigned busy; /**< number of slots owned by the kernel */
+    unsigned depth;
+    struct uring_slot slots[];
+} access_sys_t;
+
+static void AlignedRelease(block_t *block)
+{
+    free(block->p_start);
+    free(block);
+}
+
+static const struct vlc_block_callbacks aligned_cbs =
+{
+    AlignedRelease,
+};
+
+static block_t *AlignedAlloc(size_t align, size_t size)
+{
+    block_t *block = malloc(sizeof (*block));
+    void *buf = aligned_alloc(align, size);
+
+    if (unlikely(block == NULL || buf == NULL))
+    {
+        free(buf);
+        free(block);
+        return NULL;
+    }
+    return block_Init(block, &aligned_cbs, buf, size);
+}
+
+/**
+ * Queues reads of the following blocks, up to the queue depth.
+ */
+static void Submit(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    unsigned count = 0;
+
+    while (sys->queued < sys->depth && sys->submitted < sys->size)
+    {
+        unsigned idx = (sys->head + sys->queued) % sys->depth;
+        struct uring_slot *slot = &sys->slots[idx];
+
+        if (slot->busy)
+            break; /* discarded read still in flight */
+
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&sys->ring);
+        if (sqe == NULL)
+            break;
+
+        assert(slot->block == NULL);
+        slot->block = AlignedAlloc(sys->align, sys->block_size);
+        if (unlikely(slot->block == NULL))
+            break;
+
+        slot->offset = sys->submitted;
+        slot->busy = true;
+        slot->done = false;
+        io_uring_prep_read(sqe, sys->fd, slot->block->p_buffer,
+                           sys->block_size, slot->offset);
+        io_uring_sqe_set_data(sqe, slot);
+
+        sys->submitted += sys->block_size;
+        sys->queued++;
+        sys->busy++;
+        count++;
+    }
+
+    if (count > 0)
+        io_uring_submit(&sys->ring);
+}
+
+/**
+ * Processes the completed reads.
+ */
+static void Reap(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    struct io_uring_cqe *cqe;
+
+    while (io_uring_peek_cqe(&sys->ring, &cqe) == 0)
+    {
+        struct uring_slot *slot = io_uring_cqe_get_data(cqe);
+        int result = cqe->res;
+
+        io_uring_cqe_seen(&sys->ring, cqe);
+        if (slot == NULL)
+            continue; /* cancellation request */
+
+        assert(slot->busy);
+        slot->busy = false;
+        sys->busy--;
+
+        if (slot->discarded)
+        {
+            block_Release(slot->block);
+            slot->block = NULL;
+            slot->discarded = false;
+            continue;
+        }
+
+        slot->done = true;
+        slot->result = result;
+        if (result < 0 && result != -EAGAIN && result != -EINTR)
+            msg_Err(access, "read error at %"PRIu64": %s", slot->offset,
+                    vlc_strerror_c(-result));
+    }
+}
+
+/**
+ * Waits for a completion.
+ *
+ * @return 0 on success, -1 if interrupted.
+ */
+static int Wait(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    uint64_t counter;
+    struct pollfd ufd = { .fd = sys->eventfd, .events = POLLIN };
+
+    if (vlc_poll_i11e(&ufd, 1, -1) <= 0)
+        return -1;
+    /* the completions are checked by the caller, clear the counter */
+    if (read(sys->eventfd, &counter, sizeof (counter)) < 0)
+        assert(errno == EAGAIN);
+    return 0;
+}
+
+/**
+ * Discards all queued blocks, without waiting for the reads in flight: those
+ * are cancelled, and their blocks released as they complete.
+ */
+static void Flush(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < sys->depth; i++)
+    {
+        struct uring_slot *slot = &sys->slots[i];
+
+        if (slot->busy)
+        {   /* the kernel may still write to the block */
+            if (!slot->discarded)
+            {
+                struct io_uring_sqe *sqe = io_uring_get_sqe(&sys->ring);
+
+                if (sqe != NULL)
+                {
+                    io_uring_prep_cancel(sqe, slot, 0);
+                    io_uring_sqe_set_data(sqe, NULL);
+                    count++;
+                }
+                slot->discarded = true;
+            }
+            continue;
+        }
+
+        if (slot->block != NULL)
+        {
+            block_Release(slot->block);
+            slot->block = NULL;
+        }
+        slot->done = false;
+    }
+
+    if (count > 0)
+        io_uring_submit(&sys->ring);
+    sys->queued = 0;
+}
+
+static void Reposition(stream_t *access, uint64_t offset)
+{
+    access_sys_t *sys = access->p_sys;
+
+    Flush(access);
+    /* O_DIRECT requires aligned file offsets */
+    sys->submitted = offset & ~(uint64_t)(sys->align - 1);
+    sys->skip = offset - sys->submitted;
+    sys->offset = offset;
+}
+
+static block_t *Block(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->eof)
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    if (sys->queued == 0 && sys->submitted >= sys->size)
+    {
+        /* the file may have grown since it was opened */
+        struct stat st;
+
+        if (fstat(sys->fd, &st) == 0)
+            sys->size = st.st_size;
+        if (sys->submitted >= sys->size)
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
+    struct uring_slot *slot = &sys->slots[sys->head];
+
+    for (;;)
+    {
+        Reap(access);
+        if (slot->done)
+            break;
+
+        Submit(access);
+        if (sys->busy == 0)
+        {   /* nothing could be queued, there is nothing to wait for */
+            msg_Err(access, "cannot queue read at %"PRIu64, sys->submitted);
+            *eof = sys->eof = true;
+            return NULL;
+        }
+        if (Wait(access))
+            return NULL; /* interrupted, retry later */
+    }
+
+    block_t *block = slot->block;
+    int result = slot->result;
+
+    slot->block = NULL;
+    slot->done = false;
+    sys->head = (sys->head + 1) % sys->depth;
+    sys->queued--;
+
+    if (result < 0 || (size_t)result <= sys->skip)
+    {
+        block_Release(block);
+
+        if (result == -EAGAIN || result == -EINTR)
+        {   /* read again from the same offset */
+            Reposition(access, sys->offset);
+            return NULL;
+        }
+        if (result < 0)
+            *eof = sys->eof = true; /* fatal error */
+        else if (sys->offset >= sys->size)
+            *eof = true;
+        else
+            Reposition(access, sys->offset); /* truncated file? */
+        return NULL;
+    }
+
+    block->p_buffer += sys->skip;
+    block->i_buffer = result - sys->skip;
+    sys->skip = 0;
+    sys->offset += block->i_buffer;
+
+    if ((size_t)result < sys->block_size && sys->offset < sys->size)
+        /* short read, the following reads are not contiguous anymore */
+        Reposition(access, sys->offset);
+
+    return block;
+}
+
+static int Seek(stream_t *access, uint64_t offset)
+{
+    access_sys_t *sys = access->p_sys;
+
+    /* keep the queued reads if the offset is within the next block */
+    if (sys->queued > 0 && offset >= sys->offset
+     && offset < sys->slots[sys->head].offset + sys->block_size)
+    {
+        sys->skip += offset - sys->offset;
+        sys->offset = offset;
+    }
+    else
+        Reposition(access, offset);
+
+    sys->eof = false;
+    return VLC_SUCCESS;
+}
+
+static int Control(stream_t *access, int query, va_list args)
+{
+    access_sys_t *sys = access->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            break;
+
+        case STREAM_GET_SIZE:
+        {
+            struct stat st;
+
+            if (fstat(sys->fd, &st) == 0)
+                sys->size = st.st_size;
+            *va_arg(args, uint64_t *) = sys->size;
+            break;
+        }
+
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = VLC_TICK_FROM_MS(
+                var_InheritInteger(access, "file-caching"));
+            break;
+
+        case STREAM_SET_PAUSE_STATE:
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+
+    if (access->psz_filepath == NULL)
+        return VLC_EGENERIC;
+
+    bool direct = var_InheritBool(obj, "uring-direct");
+    unsigned depth = var_InheritInteger(obj, "uring-depth");
+    size_t block_size = var_InheritInteger(obj, "uring-block-size") << 10;
+    int fd = -1;
+
+#ifdef O_DIRECT
+    if (direct)
+    {
+        fd = vlc_open(access->psz_filepath, O_RDONLY | O_DIRECT);
+        if (fd == -1 && errno == EINVAL)
+        {
+            msg_Warn(access, "direct I/O not supported");
+            direct = false;
+        }
+    }
+#else
+    direct = false;
+#endif
+    if (fd == -1)
+        fd = vlc_open(access->psz_filepath, O_RDONLY);
+    if (fd == -1)
+    {
+        msg_Err(access, "cannot open file %s (%s)", access->psz_filepath,
+                vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode))
+        goto error; /* let the filesystem access deal with the rest */
+
+    access_sys_t *sys = malloc(sizeof (*sys) + depth * sizeof (sys->slots[0]));
+    if (unlikely(sys == NULL))
+        goto error;
+
+    sys->fd = fd;
+    sys->align = URING_ALIGN;
+    if (block_size < sys->align)
+        block_size = sys->align;
+    sys->block_size = block_size & ~(sys->align - 1);
+    sys->size = st.st_size;
+    sys->offset = 0;
+    sys->submitted = 0;
+    sys->skip = 0;
+    sys->eof = false;
+    sys->head = 0;
+    sys->queued = 0;
+    sys->busy = 0;
+    sys->depth = depth;
+    for (unsigned i = 0; i < depth; i++)
+    {
+        sys->slots[i].block = NULL;
+        sys->slots[i].busy = false;
+        sys->slots[i].done = false;
+        sys->slots[i].discarded = false;
+    }
+
+    int val = io_uring_queue_init(depth, &sys->ring, 0);
+    if (val < 0)
+    {
+        msg_Dbg(access, "io_uring not available: %s", vlc_strerror_c(-val));
+        free(sys);
+        goto error;
+    }
+
+    /* The event file descriptor signals completions, so that waits can be
+     * interrupted. */
+    sys->eventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (sys->eventfd == -1
+     || io_uring_register_eventfd(&sys->ring, sys->eventfd) < 0)
+    {
+        if (sys->eventfd != -1)
+            vlc_close(sys->eventfd);
+        io_uring_queue_exit(&sys->ring);
+        free(sys);
+        goto error;
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    access->pf_read = NULL;
+    access->pf_block = Block;
+    access->pf_seek = Seek;
+    access->pf_control = Control;
+    access->p_sys = sys;
+
+    msg_Dbg(access, "%u reads of %zu bytes in flight%s", depth,
+            sys->block_size, direct ? ", direct I/O" : "");
+    return VLC_SUCCESS;
+
+error:
+    vlc_close(fd);
+    return VLC_EGENERIC;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+    access_sys_t *sys = access->p_sys;
+
+    Flush(access);
+    /* The blocks of the reads that could not be cancelled belong to the
+     * kernel until they complete */
+    while (sys->busy > 0)
+    {
+        struct io_uring_cqe *cqe;
+
+        io_uring_wait_cqe(&sys->ring, &cqe);
+        Reap(access);
+    }
+    io_uring_unregister_eventfd(&sys->ring);
+    io_uring_queue_exit(&sys->ring);
+    vlc_close(sys->eventfd);
+    vlc_close(sys->fd);
+    free(sys);
+}
+
+#define DIRECT_TEXT N_("Direct I/O")
+#define DIRECT_LONGTEXT N_( \
+    "Read the file directly into the buffers, bypassing the page cache.")
+#define DEPTH_TEXT N_("Reads in flight")
+#define DEPTH_LONGTEXT N_( \
+    "Number of blocks read ahead concurrently.")
+#define BLOCK_SIZE_TEXT N_("Block size (kB)")
+#define BLOCK_SIZE_LONGTEXT N_( \
+    "Size of each read.")
+
+vlc_module_begin()
+    set_shortname(N_("io_uring"))
+    set_description(N_("Asynchronous file input (io_uring)"))
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_ACCESS)
+    add_bool("uring-direct", false, DIRECT_TEXT, DIRECT_LONGTEXT, true)
+    add_integer_with_range("uring-depth", 4, 1, 64,
+                           DEPTH_TEXT, DEPTH_LONGTEXT, true)
+    add_integer_with_range("uring-block-size", 512, 4, 65536,
+                           BLOCK_SIZE_TEXT, BLOCK_SIZE_LONGTEXT, true)
+    set_capability("access", 0)
+    add_shortcut("uring", "file")
+    set_callbacks(Open, Close)
+vlc_module_end()
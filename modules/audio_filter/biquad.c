@@ -0,0 +1,280 @@
+/*****************************************************************************
+ * biquad.c : biquad filters processing channels in SIMD lanes
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <stdalign.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "biquad.h"
+
+struct biquad_impl
+{
+    const char *name;
+    void (*bank)(const biquad_bank_t *, float *, float *, unsigned, unsigned,
+                 float, float);
+    void (*cascade)(const biquad_cascade_t *, float *, float *, unsigned,
+                    unsigned);
+};
+
+/*** C ***/
+static void BankC(const biquad_bank_t *bank, float *state, float *buf,
+                  unsigned frames, unsigned channels,
+                  float in_factor, float gain)
+{
+    const unsigned lanes = biquad_Lanes(channels);
+    float *x = state;
+    float *y = state + 2 * lanes;
+
+    for (unsigned n = 0; n < frames; n++)
+    {
+        for (unsigned c = 0; c < channels; c++)
+        {
+            const float xn = buf[c];
+            float o = 0.f;
+
+            for (unsigned j = 0; j < bank->bands; j++)
+            {
+                float *yj = &y[2 * j * lanes + c];
+                float v = bank->alpha[j] * (xn - x[lanes + c])
+                        + bank->gamma[j] * yj[0]
+                        - bank->beta[j] * yj[lanes];
+
+                yj[lanes] = yj[0];
+                yj[0] = v;
+                o += v * bank->amp[j];
+            }
+            x[lanes + c] = x[c];
+            x[c] = xn;
+            buf[c] = gain * (in_factor * xn + o);
+        }
+        buf += channels;
+    }
+}
+
+static void CascadeC(const biquad_cascade_t *cascade, float *state,
+                     float *buf, unsigned frames, unsigned channels)
+{
+    const unsigned lanes = biquad_Lanes(channels);
+
+    for (unsigned n = 0; n < frames; n++)
+    {
+        for (unsigned c = 0; c < channels; c++)
+        {
+            float v = buf[c];
+            const float *coeffs = cascade->coeffs;
+
+            for (unsigned i = 0; i < cascade->stages; i++)
+            {
+                float *s = &state[4 * i * lanes + c];
+                float out = v * coeffs[0] + s[0] * coeffs[1]
+                          + s[lanes] * coeffs[2] - s[2 * lanes] * coeffs[3]
+                          - s[3 * lanes] * coeffs[4];
+
+                s[lanes] = s[0];
+                s[0] = v;
+                s[3 * lanes] = s[2 * lanes];
+                s[2 * lanes] = out;
+                v = out;
+                coeffs += 5;
+            }
+            buf[c] = v;
+        }
+        buf += channels;
+    }
+}
+
+static const biquad_impl_t impl_c = { "C", BankC, CascadeC };
+
+/*** SSE ***/
+#ifdef HAVE_SSE2_INTRINSICS
+# include <xmmintrin.h>
+
+# define vec_t __m128
+# define BQ_NAME(x) x##SSE
+# define BQ_TARGET VLC_SSE
+# define BQ_WIDTH 4
+# define V_LOAD(p) _mm_load_ps(p)
+# define V_STORE(p, v) _mm_store_ps(p, v)
+# define V_ADD(a, b) _mm_add_ps(a, b)
+# define V_SUB(a, b) _mm_sub_ps(a, b)
+# define V_MUL(a, b) _mm_mul_ps(a, b)
+# define V_SET1(f) _mm_set1_ps(f)
+# define V_ZERO() _mm_setzero_ps()
+# include "biquad_tmpl.h"
+# undef vec_t
+# undef BQ_NAME
+# undef BQ_TARGET
+# undef BQ_WIDTH
+# undef V_LOAD
+# undef V_STORE
+# undef V_ADD
+# undef V_SUB
+# undef V_MUL
+# undef V_SET1
+# undef V_ZERO
+
+static const biquad_impl_t impl_sse = { "SSE", BankSSE, CascadeSSE };
+#endif
+
+/*** AVX ***/
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+
+# define vec_t __m256
+# define BQ_NAME(x) x##AVX
+# define BQ_TARGET __attribute__ ((__target__ ("avx")))
+# define BQ_WIDTH 8
+# define V_LOAD(p) _mm256_load_ps(p)
+# define V_STORE(p, v) _mm256_store_ps(p, v)
+# define V_ADD(a, b) _mm256_add_ps(a, b)
+# define V_SUB(a, b) _mm256_sub_ps(a, b)
+# define V_MUL(a, b) _mm256_mul_ps(a, b)
+# define V_SET1(f) _mm256_set1_ps(f)
+# define V_ZERO() _mm256_setzero_ps()
+# include "biquad_tmpl.h"
+# undef vec_t
+# undef BQ_NAME
+# undef BQ_TARGET
+# undef BQ_WIDTH
+# undef V_LOAD
+# undef V_STORE
+# undef V_ADD
+# undef V_SUB
+# undef V_MUL
+# undef V_SET1
+# undef V_ZERO
+
+static const biquad_impl_t impl_avx = { "AVX", BankAVX, CascadeAVX };
+#endif
+
+/*** NEON ***/
+#ifdef __ARM_NEON
+# include <arm_neon.h>
+
+# define vec_t float32x4_t
+# define BQ_NAME(x) x##NEON
+# define BQ_TARGET
+# define BQ_WIDTH 4
+# define V_LOAD(p) vld1q_f32(p)
+# define V_STORE(p, v) vst1q_f32(p, v)
+# define V_ADD(a, b) vaddq_f32(a, b)
+# define V_SUB(a, b) vsubq_f32(a, b)
+# define V_MUL(a, b) vmulq_f32(a, b)
+# define V_SET1(f) vdupq_n_f32(f)
+# define V_ZERO() vdupq_n_f32(0.f)
+# include "biquad_tmpl.h"
+# undef vec_t
+# undef BQ_NAME
+# undef BQ_TARGET
+# undef BQ_WIDTH
+# undef V_LOAD
+# undef V_STORE
+# undef V_ADD
+# undef V_SUB
+# undef V_MUL
+# undef V_SET1
+# undef V_ZERO
+
+static const biquad_impl_t impl_neon = { "NEON", BankNEON, CascadeNEON };
+#endif
+
+const biquad_impl_t *biquad_GetImpl(unsigned channels, bool simd)
+{
+    /* Mono cannot use more than one lane: the C code is faster */
+    if (simd && channels > 1)
+    {
+#ifdef HAVE_AVX2_INTRINSICS
+        if (channels > 4 && vlc_CPU_AVX())
+            return &impl_avx;
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+        if (vlc_CPU_SSE())
+            return &impl_sse;
+#endif
+#ifdef __ARM_NEON
+        if (vlc_CPU_ARM_NEON())
+            return &impl_neon;
+#endif
+    }
+    return &impl_c;
+}
+
+const char *biquad_ImplName(const biquad_impl_t *impl)
+{
+    return impl->name;
+}
+
+static float *StateNew(size_t count)
+{
+    size_t size = (count * sizeof (float) + 31) & ~(size_t)31;
+    float *state = aligned_alloc(32, size);
+    if (likely(state != NULL))
+        memset(state, 0, size);
+    return state;
+}
+
+float *biquad_BankStateNew(unsigned bands, unsigned channels)
+{
+    assert(channels <= BIQUAD_MAX_CHANNELS);
+    return StateNew((2 + 2 * bands) * biquad_Lanes(channels));
+}
+
+float *biquad_CascadeStateNew(unsigned stages, unsigned channels)
+{
+    assert(channels <= BIQUAD_MAX_CHANNELS);
+    return StateNew(4 * stages * biquad_Lanes(channels));
+}
+
+/* Flushes tiny values out of the states: when the input becomes silent,
+ * the recursions would otherwise decay into denormals, which are orders of
+ * magnitude slower to compute with. Done the same way for all
+ * implementations, so that they keep the same output. */
+static void StateFlushDenormals(float *state, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        if (fabsf(state[i]) < 1e-15f)
+            state[i] = 0.f;
+}
+
+void biquad_BankProcess(const biquad_impl_t *impl, const biquad_bank_t *bank,
+                        float *state, float *buf, unsigned frames,
+                        unsigned channels, float in_factor, float gain)
+{
+    assert(channels <= BIQUAD_MAX_CHANNELS);
+    impl->bank(bank, state, buf, frames, channels, in_factor, gain);
+    StateFlushDenormals(state, (2 + 2 * bank->bands) * biquad_Lanes(channels));
+}
+
+void biquad_CascadeProcess(const biquad_impl_t *impl,
+                           const biquad_cascade_t *cascade, float *state,
+                           float *buf, unsigned frames, unsigned channels)
+{
+    assert(channels <= BIQUAD_MAX_CHANNELS);
+    impl->cascade(cascade, state, buf, frames, channels);
+    StateFlushDenormals(state, 4 * cascade->stages * biquad_Lanes(channels));
+}
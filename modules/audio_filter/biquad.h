@@ -0,0 +1,93 @@
+/*****************************************************************************
+ * biquad.h : biquad filters processing channels in SIMD lanes
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_FILTER_BIQUAD_H
+#define VLC_AUDIO_FILTER_BIQUAD_H
+
+/*
+ * Interleaved frames are filtered one at a time, with all their channels at
+ * once: filter states keep the channels contiguous, in as many lanes as the
+ * widest vector holds. The SIMD and C implementations perform the same
+ * operations in the same order, so that their output is identical.
+ */
+
+#define BIQUAD_MAX_CHANNELS 32
+
+/** Number of lanes of a state vector for the given channels */
+static inline unsigned biquad_Lanes(unsigned channels)
+{
+    return (channels + 7) & ~7u;
+}
+
+/**
+ * Bank of parallel band-pass filters, as used by the 10 bands equalizer.
+ *
+ * Each output sample is gain * (in_factor * x + sum of amp[j] * y[j]),
+ * where y[j] is the output of the band j.
+ */
+typedef struct
+{
+    unsigned bands;
+    const float *alpha;
+    const float *beta;
+    const float *gamma;
+    const float *amp; /**< Gain of each band */
+} biquad_bank_t;
+
+/**
+ * Cascade of direct form 1 biquads, as used by the parametric equalizer.
+ *
+ * The 5 coefficients of each stage are b0, b1, b2, a1 and a2.
+ */
+typedef struct
+{
+    unsigned stages;
+    const float *coeffs;
+} biquad_cascade_t;
+
+typedef struct biquad_impl biquad_impl_t;
+
+/**
+ * Returns the fastest implementation for the CPU and the number of channels,
+ * or the C one.
+ */
+const biquad_impl_t *biquad_GetImpl(unsigned channels, bool simd);
+
+const char *biquad_ImplName(const biquad_impl_t *);
+
+/**
+ * Allocates a zeroed state for the given channels and bands or stages.
+ * \return the state, to be freed with aligned_free(), or NULL on error
+ */
+float *biquad_BankStateNew(unsigned bands, unsigned channels);
+float *biquad_CascadeStateNew(unsigned stages, unsigned channels);
+
+/**
+ * Filters interleaved samples in place.
+ */
+void biquad_BankProcess(const biquad_impl_t *, const biquad_bank_t *,
+                        float *state, float *buf, unsigned frames,
+                        unsigned channels, float in_factor, float gain);
+
+void biquad_CascadeProcess(const biquad_impl_t *, const biquad_cascade_t *,
+                           float *state, float *buf, unsigned frames,
+                           unsigned channels);
+
+#endif
@@ -0,0 +1,119 @@
+/*****************************************************************************
+ * biquad_tmpl.h : biquad filters SIMD kernels template
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Included by biquad.c once per instruction set, with:
+ *  - BQ_NAME(x): suffixes the kernels names,
+ *  - BQ_TARGET: function attributes,
+ *  - BQ_WIDTH: number of floats in a vector,
+ *  - vec_t and the V_* operations on vectors.
+ * Multiplications and additions are kept separate: fused multiply-add would
+ * round differently than the C implementation. */
+
+BQ_TARGET
+static void BQ_NAME(Bank)(const biquad_bank_t *bank, float *state, float *buf,
+                          unsigned frames, unsigned channels,
+                          float in_factor, float gain)
+{
+    const unsigned lanes = biquad_Lanes(channels);
+    float *x = state;
+    float *y = state + 2 * lanes;
+    alignas (32) float frame[BIQUAD_MAX_CHANNELS] = { 0 };
+    const vec_t f = V_SET1(in_factor);
+    const vec_t g = V_SET1(gain);
+
+    for (unsigned n = 0; n < frames; n++)
+    {
+        memcpy(frame, buf, channels * sizeof (float));
+
+        for (unsigned c = 0; c < channels; c += BQ_WIDTH)
+        {
+            const vec_t xn = V_LOAD(&frame[c]);
+            const vec_t x1 = V_LOAD(&x[c]);
+            const vec_t d = V_SUB(xn, V_LOAD(&x[lanes + c]));
+            vec_t o = V_ZERO();
+
+            for (unsigned j = 0; j < bank->bands; j++)
+            {
+                float *yj = &y[2 * j * lanes + c];
+                const vec_t y1 = V_LOAD(yj);
+                const vec_t y2 = V_LOAD(yj + lanes);
+                const vec_t v =
+                    V_SUB(V_ADD(V_MUL(V_SET1(bank->alpha[j]), d),
+                                V_MUL(V_SET1(bank->gamma[j]), y1)),
+                          V_MUL(V_SET1(bank->beta[j]), y2));
+
+                V_STORE(yj + lanes, y1);
+                V_STORE(yj, v);
+                o = V_ADD(o, V_MUL(v, V_SET1(bank->amp[j])));
+            }
+            V_STORE(&x[lanes + c], x1);
+            V_STORE(&x[c], xn);
+            V_STORE(&frame[c], V_MUL(g, V_ADD(V_MUL(f, xn), o)));
+        }
+
+        memcpy(buf, frame, channels * sizeof (float));
+        buf += channels;
+    }
+}
+
+BQ_TARGET
+static void BQ_NAME(Cascade)(const biquad_cascade_t *cascade, float *state,
+                             float *buf, unsigned frames, unsigned channels)
+{
+    const unsigned lanes = biquad_Lanes(channels);
+    alignas (32) float frame[BIQUAD_MAX_CHANNELS] = { 0 };
+
+    for (unsigned n = 0; n < frames; n++)
+    {
+        memcpy(frame, buf, channels * sizeof (float));
+
+        for (unsigned c = 0; c < channels; c += BQ_WIDTH)
+        {
+            vec_t v = V_LOAD(&frame[c]);
+            const float *coeffs = cascade->coeffs;
+
+            for (unsigned i = 0; i < cascade->stages; i++)
+            {
+                float *s = &state[4 * i * lanes + c];
+                const vec_t x1 = V_LOAD(s);
+                const vec_t x2 = V_LOAD(s + lanes);
+                const vec_t y1 = V_LOAD(s + 2 * lanes);
+                const vec_t y2 = V_LOAD(s + 3 * lanes);
+                const vec_t out =
+                    V_SUB(V_SUB(V_ADD(V_ADD(V_MUL(v, V_SET1(coeffs[0])),
+                                            V_MUL(x1, V_SET1(coeffs[1]))),
+                                      V_MUL(x2, V_SET1(coeffs[2]))),
+                                V_MUL(y1, V_SET1(coeffs[3]))),
+                          V_MUL(y2, V_SET1(coeffs[4])));
+
+                V_STORE(s + lanes, x1);
+                V_STORE(s, v);
+                V_STORE(s + 3 * lanes, y1);
+                V_STORE(s + 2 * lanes, out);
+                v = out;
+                coeffs += 5;
+            }
+            V_STORE(&frame[c], v);
+        }
+
+        memcpy(buf, frame, channels * sizeof (float));
+        buf += channels;
+    }
+}
@@ -0,0 +1,190 @@
+/*****************************************************************************
+ * correlate.c : cross-correlation search for the tempo scaler
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <limits.h>
+#include <stdalign.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "correlate.h"
+
+struct correlate_impl
+{
+    const char *name;
+    float (*dot)(const float *, const float *, unsigned);
+};
+
+/* Reduces the 8 partial sums of the vector implementations, then adds the
+ * products left over */
+static inline float DotReduce(const float *partial, const float *a,
+                              const float *b, unsigned n)
+{
+    float sum = (partial[0] + partial[2]) + (partial[1] + partial[3]);
+    for (unsigned i = 0; i < n; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+/*** C ***/
+/* Sums in the same order as the vector implementations, so that near-tied
+ * positions resolve the same way whatever the CPU */
+static float DotC(const float *a, const float *b, unsigned n)
+{
+    float lo[4] = { 0.f, 0.f, 0.f, 0.f }, hi[4] = { 0.f, 0.f, 0.f, 0.f };
+    unsigned i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        for (unsigned k = 0; k < 4; k++)
+        {
+            lo[k] += a[i + k] * b[i + k];
+            hi[k] += a[i + 4 + k] * b[i + 4 + k];
+        }
+
+    float partial[4];
+    for (unsigned k = 0; k < 4; k++)
+        partial[k] = lo[k] + hi[k];
+    return DotReduce(partial, a + i, b + i, n - i);
+}
+
+static const correlate_impl_t impl_c = { "C", DotC };
+
+/*** SSE ***/
+#ifdef HAVE_SSE2_INTRINSICS
+# include <xmmintrin.h>
+
+VLC_SSE
+static float DotSSE(const float *a, const float *b, unsigned n)
+{
+    __m128 lo = _mm_setzero_ps(), hi = _mm_setzero_ps();
+    unsigned i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        lo = _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                       _mm_loadu_ps(b + i)));
+        hi = _mm_add_ps(hi, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                       _mm_loadu_ps(b + i + 4)));
+    }
+
+    alignas (16) float partial[4];
+    _mm_store_ps(partial, _mm_add_ps(lo, hi));
+    return DotReduce(partial, a + i, b + i, n - i);
+}
+
+static const correlate_impl_t impl_sse = { "SSE", DotSSE };
+#endif
+
+/*** AVX ***/
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+
+__attribute__ ((__target__ ("avx")))
+static float DotAVX(const float *a, const float *b, unsigned n)
+{
+    __m256 acc = _mm256_setzero_ps();
+    unsigned i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                               _mm256_loadu_ps(b + i)));
+
+    alignas (16) float partial[4];
+    _mm_store_ps(partial, _mm_add_ps(_mm256_castps256_ps128(acc),
+                                     _mm256_extractf128_ps(acc, 1)));
+    return DotReduce(partial, a + i, b + i, n - i);
+}
+
+static const correlate_impl_t impl_avx = { "AVX", DotAVX };
+#endif
+
+/*** NEON ***/
+#ifdef __ARM_NEON
+# include <arm_neon.h>
+
+static float DotNEON(const float *a, const float *b, unsigned n)
+{
+    float32x4_t lo = vdupq_n_f32(0.f), hi = vdupq_n_f32(0.f);
+    unsigned i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        lo = vaddq_f32(lo, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        hi = vaddq_f32(hi, vmulq_f32(vld1q_f32(a + i + 4),
+                                     vld1q_f32(b + i + 4)));
+    }
+
+    float partial[4];
+    vst1q_f32(partial, vaddq_f32(lo, hi));
+    return DotReduce(partial, a + i, b + i, n - i);
+}
+
+static const correlate_impl_t impl_neon = { "NEON", DotNEON };
+#endif
+
+const correlate_impl_t *correlate_GetImpl(bool simd)
+{
+    if (simd)
+    {
+#ifdef HAVE_AVX2_INTRINSICS
+        if (vlc_CPU_AVX())
+            return &impl_avx;
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+        if (vlc_CPU_SSE())
+            return &impl_sse;
+#endif
+#ifdef __ARM_NEON
+        if (vlc_CPU_ARM_NEON())
+            return &impl_neon;
+#endif
+    }
+    return &impl_c;
+}
+
+const char *correlate_ImplName(const correlate_impl_t *impl)
+{
+    return impl->name;
+}
+
+unsigned correlate_BestOffset(const correlate_impl_t *impl,
+                              const float *pattern, unsigned samples,
+                              const float *signal, unsigned count,
+                              unsigned step)
+{
+    float best_corr = INT_MIN;
+    unsigned best_off = 0;
+
+    for (unsigned off = 0; off < count; off++)
+    {
+        float corr = impl->dot(pattern, signal, samples);
+        if (corr > best_corr)
+        {
+            best_corr = corr;
+            best_off = off;
+        }
+        signal += step;
+    }
+    return best_off;
+}
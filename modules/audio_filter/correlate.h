@@ -0,0 +1,54 @@
+/*****************************************************************************
+ * correlate.h : cross-correlation search for the tempo scaler
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_FILTER_CORRELATE_H
+#define VLC_AUDIO_FILTER_CORRELATE_H
+
+/*
+ * All the implementations sum the products in 8 interleaved partial sums,
+ * reduced the same way whatever the vector width, so that they return the
+ * same offsets, even when two positions correlate within a rounding error
+ * of each other.
+ */
+
+typedef struct correlate_impl correlate_impl_t;
+
+/**
+ * Returns the fastest implementation for the CPU, or the C one.
+ */
+const correlate_impl_t *correlate_GetImpl(bool simd);
+
+const char *correlate_ImplName(const correlate_impl_t *);
+
+/**
+ * Finds the position where the signal best matches the pattern.
+ *
+ * \param pattern samples to match
+ * \param samples number of samples of the pattern
+ * \param signal samples to search, at least samples + (count - 1) * step
+ * \param count number of positions to try
+ * \param step number of samples between two positions, i.e. of channels
+ * \return the index of the position with the highest dot product
+ */
+unsigned correlate_BestOffset(const correlate_impl_t *, const float *pattern,
+                              unsigned samples, const float *signal,
+                              unsigned count, unsigned step);
+
+#endif
@@ -38,9 +38,9 @@
 #include <vlc_filter.h>
 
 #include "equalizer_presets.h"
+#include "biquad.h"
 
 /* TODO:
- *  - optimize a bit (you can hardly do slower ;)
  *  - add tables for more bands (15 and 32 would be cool), maybe with auto coeffs
  *    computation (not too hard once the Q is found).
  *  - support for external preset
@@ -114,12 +114,11 @@ typedef struct
     bool b_2eqz;
 
     /* Filter state */
-    float x[32][2];
-    float y[32][128][2];
+    const biquad_impl_t *impl;
+    float *state;
 
     /* Second filter state */
-    float x2[32][2];
-    float y2[32][128][2];
+    float *state2;
 
     vlc_mutex_t lock;
 } filter_sys_t;
@@ -128,7 +127,7 @@ static block_t *DoWork( filter_t *, block_t * );
 
 #define EQZ_IN_FACTOR (0.25f)
 static int  EqzInit( filter_t *, int );
-static void EqzFilter( filter_t *, float *, float *, int, int );
+static void EqzFilter( filter_t *, float *, unsigned, unsigned );
 static void EqzClean( filter_t * );
 
 static int PresetCallback ( vlc_object_t *, char const *, vlc_value_t,
@@ -189,7 +188,7 @@ static void Close( vlc_object_t *p_this )
 static block_t * DoWork( filter_t * p_filter, block_t * p_in_buf )
 {
     EqzFilter( p_filter, (float*)p_in_buf->p_buffer,
-               (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples,
+               p_in_buf->i_nb_samples,
                aout_FormatNbChannels( &p_filter->fmt_in.audio ) );
     return p_in_buf;
 }
@@ -278,11 +277,15 @@ static int EqzInit( filter_t *p_filter, int i_rate )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     eqz_config_t cfg;
-    int i, ch;
+    int i;
+    unsigned i_channels = aout_FormatNbChannels( &p_filter->fmt_in.audio );
     vlc_value_t val1, val2, val3;
     vlc_object_t *p_aout = vlc_object_parent(p_filter);
     int i_ret = VLC_ENOMEM;
 
+    if( i_channels > BIQUAD_MAX_CHANNELS )
+        return VLC_EGENERIC;
+
     bool b_vlcFreqs = var_InheritBool( p_aout, "equalizer-vlcfreqs" );
     EqzCoeffs( i_rate, 1.0f, b_vlcFreqs, &cfg );
 
@@ -291,8 +294,13 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     p_sys->f_alpha = vlc_alloc( p_sys->i_band, sizeof(float) );
     p_sys->f_beta  = vlc_alloc( p_sys->i_band, sizeof(float) );
     p_sys->f_gamma = vlc_alloc( p_sys->i_band, sizeof(float) );
-    if( !p_sys->f_alpha || !p_sys->f_beta || !p_sys->f_gamma )
+    p_sys->f_amp   = NULL;
+    p_sys->state   = biquad_BankStateNew( p_sys->i_band, i_channels );
+    p_sys->state2  = biquad_BankStateNew( p_sys->i_band, i_channels );
+    if( !p_sys->f_alpha || !p_sys->f_beta || !p_sys->f_gamma ||
+        !p_sys->state || !p_sys->state2 )
         goto error;
+    p_sys->impl = biquad_GetImpl( i_channels, true );
 
     for( i = 0; i < p_sys->i_band; i++ )
     {
@@ -313,23 +321,6 @@ static int EqzInit( filter_t *p_filter, int i_rate )
         p_sys->f_amp[i] = 0.0f;
     }
 
-    /* Filter state */
-    for( ch = 0; ch < 32; ch++ )
-    {
-        p_sys->x[ch][0]  =
-        p_sys->x[ch][1]  =
-        p_sys->x2[ch][0] =
-        p_sys->x2[ch][1] = 0.0f;
-
-        for( i = 0; i < p_sys->i_band; i++ )
-        {
-            p_sys->y[ch][i][0]  =
-            p_sys->y[ch][i][1]  =
-            p_sys->y2[ch][i][0] =
-            p_sys->y2[ch][i][1] = 0.0f;
-        }
-    }
-
     var_Create( p_aout, "equalizer-bands", VLC_VAR_STRING | VLC_VAR_DOINHERIT );
     var_Create( p_aout, "equalizer-preset", VLC_VAR_STRING | VLC_VAR_DOINHERIT );
 
@@ -354,7 +345,6 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     {
         msg_Err(p_filter, "No preset selected");
         free( val2.psz_string );
-        free( p_sys->f_amp );
         i_ret = VLC_EGENERIC;
         goto error;
     }
@@ -366,8 +356,9 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     var_AddCallback( p_aout, "equalizer-preamp", PreampCallback, p_sys );
     var_AddCallback( p_aout, "equalizer-2pass", TwoPassCallback, p_sys );
 
-    msg_Dbg( p_filter, "equalizer loaded for %d Hz with %d bands %d pass",
-                        i_rate, p_sys->i_band, p_sys->b_2eqz ? 2 : 1 );
+    msg_Dbg( p_filter, "equalizer loaded for %d Hz with %d bands %d pass (%s)",
+                        i_rate, p_sys->i_band, p_sys->b_2eqz ? 2 : 1,
+                        biquad_ImplName( p_sys->impl ) );
     for( i = 0; i < p_sys->i_band; i++ )
     {
         msg_Dbg( p_filter, "   %.2f Hz -> factor:%f alpha:%f beta:%f gamma:%f",
@@ -380,69 +371,39 @@ error:
     free( p_sys->f_alpha );
     free( p_sys->f_beta );
     free( p_sys->f_gamma );
+    free( p_sys->f_amp );
+    aligned_free( p_sys->state );
+    aligned_free( p_sys->state2 );
     return i_ret;
 }
 
-static void EqzFilter( filter_t *p_filter, float *out, float *in,
-                       int i_samples, int i_channels )
+static void EqzFilter( filter_t *p_filter, float *buf,
+                       unsigned i_samples, unsigned i_channels )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    int i, ch, j;
 
     vlc_mutex_lock( &p_sys->lock );
-    for( i = 0; i < i_samples; i++ )
+    const biquad_bank_t bank = {
+        .bands = p_sys->i_band,
+        .alpha = p_sys->f_alpha,
+        .beta  = p_sys->f_beta,
+        .gamma = p_sys->f_gamma,
+        .amp   = p_sys->f_amp,
+    };
+
+    /* We add source PCM + filtered PCM */
+    if( p_sys->b_2eqz )
     {
-        for( ch = 0; ch < i_channels; ch++ )
-        {
-            const float x = in[ch];
-            float o = 0.0f;
-
-            for( j = 0; j < p_sys->i_band; j++ )
-            {
-                float y = p_sys->f_alpha[j] * ( x - p_sys->x[ch][1] ) +
-                          p_sys->f_gamma[j] * p_sys->y[ch][j][0] -
-                          p_sys->f_beta[j]  * p_sys->y[ch][j][1];
-
-                p_sys->y[ch][j][1] = p_sys->y[ch][j][0];
-                p_sys->y[ch][j][0] = y;
-
-                o += y * p_sys->f_amp[j];
-            }
-            p_sys->x[ch][1] = p_sys->x[ch][0];
-            p_sys->x[ch][0] = x;
-
-            /* Second filter */
-            if( p_sys->b_2eqz )
-            {
-                const float x2 = EQZ_IN_FACTOR * x + o;
-                o = 0.0f;
-                for( j = 0; j < p_sys->i_band; j++ )
-                {
-                    float y = p_sys->f_alpha[j] * ( x2 - p_sys->x2[ch][1] ) +
-                              p_sys->f_gamma[j] * p_sys->y2[ch][j][0] -
-                              p_sys->f_beta[j]  * p_sys->y2[ch][j][1];
-
-                    p_sys->y2[ch][j][1] = p_sys->y2[ch][j][0];
-                    p_sys->y2[ch][j][0] = y;
-
-                    o += y * p_sys->f_amp[j];
-                }
-                p_sys->x2[ch][1] = p_sys->x2[ch][0];
-                p_sys->x2[ch][0] = x2;
-
-                /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp * p_sys->f_gamp *( EQZ_IN_FACTOR * x2 + o );
-            }
-            else
-            {
-                /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp *( EQZ_IN_FACTOR * x + o );
-            }
-        }
-
-        in  += i_channels;
-        out += i_channels;
+        biquad_BankProcess( p_sys->impl, &bank, p_sys->state, buf,
+                            i_samples, i_channels, EQZ_IN_FACTOR, 1.0f );
+        biquad_BankProcess( p_sys->impl, &bank, p_sys->state2, buf,
+                            i_samples, i_channels, EQZ_IN_FACTOR,
+                            p_sys->f_gamp * p_sys->f_gamp );
     }
+    else
+        biquad_BankProcess( p_sys->impl, &bank, p_sys->state, buf,
+                            i_samples, i_channels, EQZ_IN_FACTOR,
+                            p_sys->f_gamp );
     vlc_mutex_unlock( &p_sys->lock );
 }
 
@@ -461,6 +422,8 @@ static void EqzClean( filter_t *p_filter )
     free( p_sys->f_gamma );
 
     free( p_sys->f_amp );
+    aligned_free( p_sys->state );
+    aligned_free( p_sys->state2 );
 }
 
 
@@ -139,7 +139,7 @@ static block_t *Resample (filter_t *filter, block_t *in)
     src.output_frames = ceil (src.src_ratio * src.input_frames);
     src.end_of_input = 0;
 
-    out = block_Alloc (src.output_frames * framesize);
+    out = filter_NewAudioBuffer (filter, src.output_frames * framesize);
     if (unlikely(out == NULL))
         goto error;
 
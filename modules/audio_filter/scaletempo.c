@@ -35,7 +35,8 @@
 
 #include <stdatomic.h>
 #include <string.h> /* for memset */
-#include <limits.h> /* form INT_MIN */
+
+#include "correlate.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -68,6 +69,8 @@ vlc_module_begin ()
         N_("Overlap Length"), N_("Percentage of stride to overlap"), true )
     add_integer_with_range( "scaletempo-search", 14, 0, 200,
         N_("Search Length"), N_("Length in milliseconds to search for best overlap position"), true )
+    add_bool( "scaletempo-simd", true,
+        N_("SIMD Search"), N_("Use the vector instructions of the CPU to search for the best overlap position"), true )
 #ifdef PITCH_SHIFTER
     add_float_with_range( "pitch-shift", 0, -12, 12,
         N_("Pitch Shift"), N_("Pitch shift in semitones."), false )
@@ -129,6 +132,7 @@ typedef struct
     void     *buf_pre_corr;
     void     *table_window;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
+    const correlate_impl_t *correlate;
 #ifdef PITCH_SHIFTER
     /* pitch */
     filter_t * resampler;
@@ -142,9 +146,7 @@ typedef struct
 static unsigned best_overlap_offset_float( filter_t *p_filter )
 {
     filter_sys_t *p = p_filter->p_sys;
-    float *pw, *po, *ppc, *search_start;
-    float best_corr = INT_MIN;
-    unsigned best_off = 0;
+    float *pw, *po, *ppc;
     unsigned i, off;
 
     pw  = p->table_window;
@@ -155,22 +157,12 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
       *ppc++ = *pw++ * *po++;
     }
 
-    search_start = (float *)p->buf_queue + p->samples_per_frame;
-    for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
-      if( corr > best_corr ) {
-        best_corr = corr;
-        best_off  = off;
-      }
-      search_start += p->samples_per_frame;
-    }
+    off = correlate_BestOffset( p->correlate, p->buf_pre_corr,
+                                p->samples_overlap - p->samples_per_frame,
+                                (float *)p->buf_queue + p->samples_per_frame,
+                                p->frames_search, p->samples_per_frame );
 
-    return best_off * p->bytes_per_frame;
+    return off * p->bytes_per_frame;
 }
 
 /*****************************************************************************
@@ -422,8 +414,12 @@ static int Open( vlc_object_t *p_this )
     p_sys->percent_overlap = var_InheritFloat( p_this, "scaletempo-overlap" );
     p_sys->ms_search       = var_InheritInteger( p_this, "scaletempo-search" );
 
-    msg_Dbg( p_this, "params: %i stride, %.3f overlap, %i search",
-             p_sys->ms_stride, p_sys->percent_overlap, p_sys->ms_search );
+    p_sys->correlate       = correlate_GetImpl(
+                                 var_InheritBool( p_this, "scaletempo-simd" ) );
+
+    msg_Dbg( p_this, "params: %i stride, %.3f overlap, %i search (%s)",
+             p_sys->ms_stride, p_sys->percent_overlap, p_sys->ms_search,
+             correlate_ImplName( p_sys->correlate ) );
 
     p_sys->buf_queue      = NULL;
     p_sys->buf_overlap    = NULL;
@@ -570,7 +566,7 @@ static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
                                    p_in_buf->i_buffer, 0 );
     if( i_outsize > 0 )
     {
-        p_out_buf = block_Alloc( i_outsize );
+        p_out_buf = filter_NewAudioBuffer( p_filter, i_outsize );
         if( p_out_buf == NULL )
         {
             block_Release( p_in_buf );
@@ -73,6 +73,9 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
     nextPlaylistupdate = 0;
     demux.i_nzpcr = VLC_TICK_INVALID;
     demux.i_firstpcr = VLC_TICK_INVALID;
+    demux.i_edgedistance = VLC_TICK_INVALID;
+    demux.catchup.setMaxRate(var_InheritFloat(p_demux, "adaptive-catchup-rate"));
+    demux.f_rateadjust = 1.0;
     vlc_mutex_init(&demux.lock);
     vlc_cond_init(&demux.cond);
     vlc_mutex_init(&lock);
@@ -479,7 +482,9 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
         vlc_mutex_lock(&demux.lock);
         demux.i_nzpcr = VLC_TICK_INVALID;
         demux.i_firstpcr = VLC_TICK_INVALID;
+        demux.i_edgedistance = VLC_TICK_INVALID;
         es_out_Control(p_demux->out, ES_OUT_RESET_PCR);
+        applyLatencyCatchUp();
         vlc_mutex_unlock(&demux.lock);
         break;
     case AbstractStream::status_demuxed:
@@ -489,6 +494,7 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
             demux.i_nzpcr = i_nzbarrier;
             vlc_tick_t pcr = VLC_TICK_0 + std::max(INT64_C(0), demux.i_nzpcr - VLC_TICK_FROM_MS(100));
             es_out_Control(p_demux->out, ES_OUT_SET_GROUP_PCR, 0, pcr);
+            applyLatencyCatchUp();
         }
         vlc_mutex_unlock(&demux.lock);
         break;
@@ -600,7 +606,9 @@ int PlaylistManager::doControl(int i_query, va_list args)
         }
 
         case DEMUX_GET_PTS_DELAY:
-            *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_SEC(1);
+            *va_arg (args, vlc_tick_t *) = bufferingLogic
+                                         ? bufferingLogic->getPtsDelay(playlist)
+                                         : AbstractBufferingLogic::DEFAULT_OUTPUT_DELAY;
             break;
 
         default:
@@ -645,6 +653,8 @@ void PlaylistManager::Run()
 
         int canc = vlc_savecancel();
         AbstractStream::buffering_status i_return = bufferize(i_nzpcr, i_min_buffering, i_extra_buffering);
+        if(bufferingLogic->getTargetLatency(playlist))
+            updateLiveEdgeDistance();
         vlc_restorecancel( canc );
 
         if(i_return != AbstractStream::buffering_lessthanmin)
@@ -680,6 +690,51 @@ void * PlaylistManager::managerThread(void *opaque)
     return NULL;
 }
 
+void PlaylistManager::updateLiveEdgeDistance()
+{
+    /* Media ahead of the demux position: queued, or available from the server */
+    vlc_tick_t distance = VLC_TICK_INVALID;
+    std::vector<AbstractStream *>::const_iterator it;
+    for(it=streams.begin(); it!=streams.end(); ++it)
+    {
+        AbstractStream *st = *it;
+        if(!st->isValid() || st->isDisabled() || !st->isSelected())
+            continue;
+        vlc_tick_t ahead = std::max(INT64_C(0), st->getDemuxedAmount()) +
+                           st->getMinAheadTime();
+        if(distance == VLC_TICK_INVALID || ahead < distance)
+            distance = ahead;
+    }
+
+    vlc_mutex_locker locker(&demux.lock);
+    demux.i_edgedistance = distance;
+}
+
+/* Catches up with the live edge by playing slightly faster than real
+ * time, which drains the buffered media and lets the demuxer read closer
+ * to the edge. demux.lock must be held */
+void PlaylistManager::applyLatencyCatchUp()
+{
+    double rate = 1.0;
+    /* Only catch up at normal speed, never over a user chosen rate */
+    if(demux.i_edgedistance != VLC_TICK_INVALID &&
+       var_InheritFloat(p_demux, "rate") == 1.f)
+    {
+        /* distance to the live edge plus what is held by the output */
+        demux.catchup.setTargetLatency(bufferingLogic->getTargetLatency(playlist));
+        rate = demux.catchup.update(demux.i_edgedistance +
+                                    bufferingLogic->getPtsDelay(playlist));
+    }
+    else
+    {
+        demux.catchup.reset();
+    }
+
+    if(rate != demux.f_rateadjust &&
+       es_out_ControlSetRateAdjust(p_demux->out, rate) == VLC_SUCCESS)
+        demux.f_rateadjust = rate;
+}
+
 void PlaylistManager::updateControlsPosition()
 {
     vlc_mutex_locker locker(&cached.lock);
@@ -850,6 +905,12 @@ AbstractBufferingLogic *PlaylistManager::createBufferingLogic() const
         v = var_InheritInteger(p_demux, "adaptive-maxbuffer");
         if(v)
             bl->setUserMaxBuffering(VLC_TICK_FROM_MS(v));
+        int lowlatency = var_InheritInteger(p_demux, "adaptive-lowlatency");
+        if(lowlatency != -1)
+            bl->setLowDelay(lowlatency == 1);
+        v = var_InheritInteger(p_demux, "adaptive-lowlatency-target");
+        if(v)
+            bl->setUserTargetLatency(VLC_TICK_FROM_MS(v));
     }
     return bl;
 }
@@ -23,6 +23,7 @@
 #define PLAYLISTMANAGER_H_
 
 #include "logic/AbstractAdaptationLogic.h"
+#include "logic/CatchUpLogic.hpp"
 #include "Streams.hpp"
 #include <vector>
 
@@ -86,6 +87,8 @@ namespace adaptive
             void unsetPeriod();
 
             void updateControlsPosition();
+            void updateLiveEdgeDistance();
+            void applyLatencyCatchUp();
 
             /* local factories */
             virtual AbstractAdaptationLogic *createLogic(AbstractAdaptationLogic::LogicType,
@@ -107,6 +110,9 @@ namespace adaptive
             {
                 vlc_tick_t  i_nzpcr;
                 vlc_tick_t  i_firstpcr;
+                vlc_tick_t  i_edgedistance;
+                CatchUpLogic catchup;
+                double      f_rateadjust;
                 mutable vlc_mutex_t lock;
                 vlc_cond_t  cond;
             } demux;
@@ -35,6 +35,7 @@
 #include "SharedResources.hpp"
 #include "playlist/BasePeriod.h"
 #include "logic/BufferingLogic.hpp"
+#include "logic/CatchUpLogic.hpp"
 #include "xml/DOMParser.h"
 
 #include "../dash/DASHManager.h"
@@ -85,6 +86,14 @@ static void Close   (vlc_object_t *);
 #define ADAPT_LOWLATENCY_TEXT N_("Low latency")
 #define ADAPT_LOWLATENCY_LONGTEXT N_("Overrides low latency parameters")
 
+#define ADAPT_LATENCY_TARGET_TEXT N_("Low latency target (ms)")
+#define ADAPT_LATENCY_TARGET_LONGTEXT N_("Latency to the live edge to maintain " \
+    "in low latency mode. Uses the stream's own target when 0.")
+
+#define ADAPT_CATCHUP_TEXT N_("Low latency catch-up rate")
+#define ADAPT_CATCHUP_LONGTEXT N_("Maximum playback speed-up used to get back " \
+    "to the target latency. Disables catch-up when 1.")
+
 static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::Default,
                                 AbstractAdaptationLogic::Predictive,
@@ -145,6 +154,11 @@ vlc_module_begin ()
                      ADAPT_MAXBUFFER_TEXT, NULL, true );
         add_integer( "adaptive-lowlatency", -1, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT, true );
             change_integer_list(rgi_latency, ppsz_latency)
+        add_integer( "adaptive-lowlatency-target", 0,
+                     ADAPT_LATENCY_TARGET_TEXT, ADAPT_LATENCY_TARGET_LONGTEXT, true )
+        add_float( "adaptive-catchup-rate", CatchUpLogic::DEFAULT_MAX_RATE,
+                   ADAPT_CATCHUP_TEXT, ADAPT_CATCHUP_LONGTEXT, true )
+            change_float_range( 1.0, 1.5 )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -291,13 +305,18 @@ static PlaylistManager * HandleDash(demux_t *p_demux, DOMParser &xmlParser,
                                     const std::string & playlisturl,
                                     AbstractAdaptationLogic::LogicType logic)
 {
+    TimelineElementHandler timelineHandler;
+    xmlParser.setElementHandler(&timelineHandler);
     if(!xmlParser.reset(p_demux->s) || !xmlParser.parse(true))
     {
+        xmlParser.setElementHandler(NULL);
         msg_Err(p_demux, "Cannot parse MPD");
         return NULL;
     }
+    xmlParser.setElementHandler(NULL);
     IsoffMainParser mpdparser(xmlParser.getRootNode(), VLC_OBJECT(p_demux),
                               p_demux->s, playlisturl);
+    mpdparser.setTimelineHandler(&timelineHandler);
     MPD *p_playlist = mpdparser.parse();
     if(p_playlist == NULL)
     {
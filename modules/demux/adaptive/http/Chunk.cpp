@@ -377,7 +377,8 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_tick_t time;
     } rate = {0,0};
 
-    ssize_t ret = connection->read(p_block->p_buffer, readsize);
+    /* Partial reads: chunked transfers are delivered as they arrive */
+    ssize_t ret = connection->readSome(p_block->p_buffer, readsize);
     if(ret <= 0)
     {
         block_Release(p_block);
@@ -394,7 +395,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_mutex_locker locker( &lock );
         buffered += p_block->i_buffer;
         block_ChainLastAppend(&pp_tail, p_block);
-        if((size_t) ret < readsize)
+        if(contentLength && buffered + consumed >= contentLength)
         {
             done = true;
             rate.size = buffered + consumed;
@@ -66,6 +66,11 @@ const std::string & AbstractConnection::getContentType() const
     return contentType;
 }
 
+ssize_t AbstractConnection::readSome(void *p_buffer, size_t len)
+{
+    return read(p_buffer, len);
+}
+
 HTTPConnection::HTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
                                Transport *socket_, const ConnectionParams &proxy, bool persistent)
     : AbstractConnection( p_object_ )
@@ -210,6 +215,18 @@ enum RequestStatus
 }
 
 ssize_t HTTPConnection::read(void *p_buffer, size_t len)
+{
+    return readData(p_buffer, len, false);
+}
+
+/* Returns as soon as a transfer chunk has been received, as chunked
+ * transfers of live CMAF segments are written while being produced */
+ssize_t HTTPConnection::readSome(void *p_buffer, size_t len)
+{
+    return readData(p_buffer, len, chunked);
+}
+
+ssize_t HTTPConnection::readData(void *p_buffer, size_t len, bool partial)
 {
     if( !connected() ||
        (!queryOk && bytesRead == 0) )
@@ -227,12 +244,12 @@ ssize_t HTTPConnection::read(void *p_buffer, size_t len)
     if(len > toRead)
         len = toRead;
 
-    ssize_t ret = ( chunked ) ? readChunk(p_buffer, len)
+    ssize_t ret = ( chunked ) ? readChunk(p_buffer, len, partial)
                               : transport->read(p_buffer, len);
     if(ret >= 0)
         bytesRead += ret;
 
-    if(ret < 0 || (size_t)ret < len || /* set EOF */
+    if(ret < 0 || (partial ? ret == 0 : (size_t)ret < len) || /* set EOF */
        (contentLength == bytesRead && connectionClose))
     {
         transport->disconnect();
@@ -312,7 +329,7 @@ enum RequestStatus
     return RequestStatus::Success;
 }
 
-ssize_t HTTPConnection::readChunk(void *p_buffer, size_t len)
+ssize_t HTTPConnection::readChunk(void *p_buffer, size_t len, bool partial)
 {
     size_t copied = 0;
 
@@ -354,6 +371,10 @@ ssize_t HTTPConnection::readChunk(void *p_buffer, size_t len)
             ssize_t in = transport->read(&crlf, 2);
             if(in < 2 || memcmp(crlf, "\r\n", 2))
                 return (copied == 0) ? -1 : copied;
+
+            /* don't wait for the next chunk */
+            if(partial && copied > 0)
+                break;
         }
     }
 
@@ -49,6 +49,7 @@ namespace adaptive
                 virtual enum RequestStatus
                                 request     (const std::string& path, const BytesRange & = BytesRange()) = 0;
                 virtual ssize_t read        (void *p_buffer, size_t len) = 0;
+                virtual ssize_t readSome    (void *p_buffer, size_t len);
 
                 virtual size_t  getContentLength() const;
                 virtual const std::string & getContentType() const;
@@ -75,6 +76,7 @@ namespace adaptive
                 virtual enum RequestStatus
                                 request     (const std::string& path, const BytesRange & = BytesRange());
                 virtual ssize_t read        (void *p_buffer, size_t len);
+                virtual ssize_t readSome    (void *p_buffer, size_t len);
 
                 void setUsed( bool );
                 const ConnectionParams &getRedirection() const;
@@ -92,7 +94,8 @@ namespace adaptive
                 virtual std::string extraRequestHeaders() const;
                 virtual std::string buildRequestHeader(const std::string &path) const;
 
-                ssize_t         readChunk   (void *p_buffer, size_t len);
+                ssize_t         readData    (void *p_buffer, size_t len, bool partial);
+                ssize_t         readChunk   (void *p_buffer, size_t len, bool partial);
                 enum RequestStatus parseReply();
                 std::string readLine();
                 std::string useragent;
@@ -41,12 +41,15 @@ const vlc_tick_t AbstractBufferingLogic::BUFFERING_LOWEST_LIMIT = VLC_TICK_FROM_
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MIN_BUFFERING = VLC_TICK_FROM_SEC(6);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MAX_BUFFERING = VLC_TICK_FROM_SEC(30);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_LIVE_BUFFERING = VLC_TICK_FROM_SEC(15);
+const vlc_tick_t AbstractBufferingLogic::DEFAULT_OUTPUT_DELAY = VLC_TICK_FROM_SEC(1);
+const vlc_tick_t AbstractBufferingLogic::DEFAULT_TARGET_LATENCY = VLC_TICK_FROM_SEC(3);
 
 AbstractBufferingLogic::AbstractBufferingLogic()
 {
     userMinBuffering = 0;
     userMaxBuffering = 0;
     userLiveDelay = 0;
+    userTargetLatency = 0;
 }
 
 void AbstractBufferingLogic::setLowDelay(bool b)
@@ -69,6 +72,11 @@ void AbstractBufferingLogic::setUserLiveDelay(vlc_tick_t v)
     userLiveDelay = v;
 }
 
+void AbstractBufferingLogic::setUserTargetLatency(vlc_tick_t v)
+{
+    userTargetLatency = v;
+}
+
 DefaultBufferingLogic::DefaultBufferingLogic()
     : AbstractBufferingLogic()
 {
@@ -103,7 +111,7 @@ uint64_t DefaultBufferingLogic::getStartSegmentNumber(BaseRepresentation *rep) c
 vlc_tick_t DefaultBufferingLogic::getMinBuffering(const AbstractPlaylist *p) const
 {
     if(isLowLatency(p))
-        return BUFFERING_LOWEST_LIMIT;
+        return std::min(BUFFERING_LOWEST_LIMIT, getLiveDelay(p) / 2);
 
     vlc_tick_t buffering = userMinBuffering ? userMinBuffering
                                             : DEFAULT_MIN_BUFFERING;
@@ -115,7 +123,7 @@ vlc_tick_t DefaultBufferingLogic::getMinBuffering(const AbstractPlaylist *p) con
 vlc_tick_t DefaultBufferingLogic::getMaxBuffering(const AbstractPlaylist *p) const
 {
     if(isLowLatency(p))
-        return getMinBuffering(p);
+        return getLiveDelay(p);
 
     vlc_tick_t buffering = userMaxBuffering ? userMaxBuffering
                                             : DEFAULT_MAX_BUFFERING;
@@ -128,8 +136,9 @@ vlc_tick_t DefaultBufferingLogic::getMaxBuffering(const AbstractPlaylist *p) con
 
 vlc_tick_t DefaultBufferingLogic::getLiveDelay(const AbstractPlaylist *p) const
 {
+    /* the output pts delay is part of the latency */
     if(isLowLatency(p))
-        return getMinBuffering(p);
+        return getTargetLatency(p) - getPtsDelay(p);
     vlc_tick_t delay = userLiveDelay ? userLiveDelay
                                      : DEFAULT_LIVE_BUFFERING;
     if(p->suggestedPresentationDelay.Get())
@@ -139,6 +148,24 @@ vlc_tick_t DefaultBufferingLogic::getLiveDelay(const AbstractPlaylist *p) const
     return std::max(delay, getMinBuffering(p));
 }
 
+vlc_tick_t DefaultBufferingLogic::getPtsDelay(const AbstractPlaylist *p) const
+{
+    if(isLowLatency(p))
+        return std::min(DEFAULT_OUTPUT_DELAY, getTargetLatency(p) / 4);
+    return DEFAULT_OUTPUT_DELAY;
+}
+
+vlc_tick_t DefaultBufferingLogic::getTargetLatency(const AbstractPlaylist *p) const
+{
+    if(!isLowLatency(p))
+        return 0;
+    vlc_tick_t latency = userTargetLatency ? userTargetLatency
+                                           : DEFAULT_TARGET_LATENCY;
+    if(!userTargetLatency && p->targetLatency.Get())
+        latency = p->targetLatency.Get();
+    return std::max(latency, VLC_TICK_FROM_MS(500));
+}
+
 uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *rep) const
 {
     AbstractPlaylist *playlist = rep->getPlaylist();
@@ -149,7 +176,8 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
     /* Try to never buffer up to really end */
     /* Enforce no overlap for demuxers segments 3.0.0 */
     /* FIXME: check duration instead ? */
-    const unsigned SAFETY_BUFFERING_EDGE_OFFSET = 1;
+    /* Low latency streams are fetched while being produced */
+    const unsigned SAFETY_BUFFERING_EDGE_OFFSET = isLowLatency(playlist) ? 0 : 1;
     const unsigned SAFETY_EXPURGING_OFFSET = 2;
 
     SegmentList *segmentList = rep->inheritSegmentList();
@@ -224,7 +252,8 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
         else if(mediaSegmentTemplate->duration.Get())
         {
             /* Compute playback offset and effective finished segment from wall time */
-            vlc_tick_t now = vlc_tick_from_sec(time(NULL));
+            vlc_tick_t now = vlc_tick_from_sec(time(NULL)) +
+                             rep->inheritAvailabilityTimeOffset();
             vlc_tick_t playbacktime = now - i_buffering;
             vlc_tick_t minavailtime = playlist->availabilityStartTime.Get() + rep->getPeriodStart();
             const uint64_t startnumber = mediaSegmentTemplate->inheritStartNumber();
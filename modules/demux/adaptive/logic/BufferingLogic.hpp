@@ -46,19 +46,25 @@ namespace adaptive
                 virtual vlc_tick_t getMinBuffering(const AbstractPlaylist *) const = 0;
                 virtual vlc_tick_t getMaxBuffering(const AbstractPlaylist *) const = 0;
                 virtual vlc_tick_t getLiveDelay(const AbstractPlaylist *) const = 0;
+                virtual vlc_tick_t getPtsDelay(const AbstractPlaylist *) const = 0;
+                virtual vlc_tick_t getTargetLatency(const AbstractPlaylist *) const = 0;
                 void setUserMinBuffering(vlc_tick_t);
                 void setUserMaxBuffering(vlc_tick_t);
                 void setUserLiveDelay(vlc_tick_t);
+                void setUserTargetLatency(vlc_tick_t);
                 void setLowDelay(bool);
                 static const vlc_tick_t BUFFERING_LOWEST_LIMIT;
                 static const vlc_tick_t DEFAULT_MIN_BUFFERING;
                 static const vlc_tick_t DEFAULT_MAX_BUFFERING;
                 static const vlc_tick_t DEFAULT_LIVE_BUFFERING;
+                static const vlc_tick_t DEFAULT_OUTPUT_DELAY;
+                static const vlc_tick_t DEFAULT_TARGET_LATENCY;
 
             protected:
                 vlc_tick_t userMinBuffering;
                 vlc_tick_t userMaxBuffering;
                 vlc_tick_t userLiveDelay;
+                vlc_tick_t userTargetLatency;
                 Undef<bool> userLowLatency;
         };
 
@@ -71,6 +77,8 @@ namespace adaptive
                 virtual vlc_tick_t getMinBuffering(const AbstractPlaylist *) const; /* impl */
                 virtual vlc_tick_t getMaxBuffering(const AbstractPlaylist *) const; /* impl */
                 virtual vlc_tick_t getLiveDelay(const AbstractPlaylist *) const; /* impl */
+                virtual vlc_tick_t getPtsDelay(const AbstractPlaylist *) const; /* impl */
+                virtual vlc_tick_t getTargetLatency(const AbstractPlaylist *) const; /* impl */
 
             protected:
                 vlc_tick_t getBufferingOffset(const AbstractPlaylist *) const;
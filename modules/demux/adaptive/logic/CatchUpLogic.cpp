@@ -0,0 +1,84 @@
+/*
+ * CatchUpLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2020 VideoLabs, VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "CatchUpLogic.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace adaptive::logic;
+
+const vlc_tick_t CatchUpLogic::TOLERANCE = VLC_TICK_FROM_MS(200);
+const vlc_tick_t CatchUpLogic::RANGE = VLC_TICK_FROM_SEC(2);
+const double     CatchUpLogic::RATE_STEP = 0.01;
+const double     CatchUpLogic::DEFAULT_MAX_RATE = 1.05;
+
+CatchUpLogic::CatchUpLogic()
+{
+    targetLatency = 0;
+    maxRate = DEFAULT_MAX_RATE;
+    rate = 1.0;
+}
+
+void CatchUpLogic::setMaxRate(double r)
+{
+    maxRate = r;
+}
+
+void CatchUpLogic::setTargetLatency(vlc_tick_t t)
+{
+    targetLatency = t;
+}
+
+double CatchUpLogic::update(vlc_tick_t latency)
+{
+    if(targetLatency == 0 || maxRate <= 1.0)
+    {
+        rate = 1.0;
+        return rate;
+    }
+
+    const vlc_tick_t excess = latency - targetLatency;
+    /* hysteresis: start above the tolerance, stop on target */
+    if(excess <= 0 || (rate == 1.0 && excess <= TOLERANCE))
+    {
+        rate = 1.0;
+        return rate;
+    }
+
+    /* Rates are quantized so the output is not retuned on every update */
+    const double ratio = std::min(1.0, (double) excess / RANGE);
+    const double steps = std::ceil((maxRate - 1.0) * ratio / RATE_STEP);
+    rate = std::min(maxRate, 1.0 + steps * RATE_STEP);
+    return rate;
+}
+
+double CatchUpLogic::getRate() const
+{
+    return rate;
+}
+
+void CatchUpLogic::reset()
+{
+    rate = 1.0;
+}
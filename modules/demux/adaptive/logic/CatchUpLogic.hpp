@@ -0,0 +1,56 @@
+/*
+ * CatchUpLogic.hpp
+ *****************************************************************************
+ * Copyright (C) 2020 VideoLabs, VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef CATCHUPLOGIC_HPP
+#define CATCHUPLOGIC_HPP
+
+#include <vlc_common.h>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        /* Chooses the playback speed that brings the latency back to
+         * its target: starts once the latency exceeds the target by more
+         * than TOLERANCE, speeds up in proportion to the excess, up to
+         * the maximum rate, and plays at normal speed again once the
+         * target is reached. */
+        class CatchUpLogic
+        {
+            public:
+                CatchUpLogic();
+                void setMaxRate(double);
+                void setTargetLatency(vlc_tick_t);
+                double update(vlc_tick_t latency);
+                double getRate() const;
+                void reset();
+                static const vlc_tick_t TOLERANCE;
+                static const vlc_tick_t RANGE;
+                static const double     RATE_STEP;
+                static const double     DEFAULT_MAX_RATE;
+
+            private:
+                vlc_tick_t targetLatency;
+                double maxRate;
+                double rate;
+        };
+    }
+}
+
+#endif // CATCHUPLOGIC_HPP
@@ -25,7 +25,7 @@
 
 #include "SegmentInfoCommon.h"
 #include <vlc_common.h>
-#include <list>
+#include <deque>
 
 namespace adaptive
 {
@@ -33,7 +33,18 @@ namespace adaptive
     {
         class SegmentTimeline : public TimescaleAble
         {
-            class Element;
+            class Element
+            {
+                public:
+                    Element(uint64_t, stime_t, uint64_t, stime_t);
+                    void debug(vlc_object_t *, int = 0) const;
+                    bool contains(stime_t) const;
+                    bool extends(const Element &) const;
+                    stime_t  t;
+                    stime_t  d;
+                    uint64_t r;
+                    uint64_t number;
+            };
 
             public:
                 SegmentTimeline(TimescaleAble *);
@@ -47,26 +58,20 @@ namespace adaptive
                 stime_t getTotalLength() const;
                 uint64_t maxElementNumber() const;
                 uint64_t minElementNumber() const;
+                size_t  getElementCount() const;
                 void pruneByPlaybackTime(vlc_tick_t);
                 size_t pruneBySequenceNumber(uint64_t);
                 void updateWith(SegmentTimeline &);
                 void debug(vlc_object_t *, int = 0) const;
 
             private:
-                std::list<Element *> elements;
+                /* Run length encoded: contiguous segments with the same
+                 * duration share one element, sorted by time and number */
+                std::deque<Element> elements;
                 stime_t totalLength;
 
-                class Element
-                {
-                    public:
-                        Element(uint64_t, stime_t, uint64_t, stime_t);
-                        void debug(vlc_object_t *, int = 0) const;
-                        bool contains(stime_t) const;
-                        stime_t  t;
-                        stime_t  d;
-                        uint64_t r;
-                        uint64_t number;
-                };
+                void appendElement(const Element &);
+                std::deque<Element>::const_iterator findByNumber(uint64_t) const;
         };
     }
 }
@@ -36,14 +36,16 @@ using namespace adaptive::xml;
 DOMParser::DOMParser() :
     root( NULL ),
     stream( NULL ),
-    vlc_reader( NULL )
+    vlc_reader( NULL ),
+    handler( NULL )
 {
 }
 
 DOMParser::DOMParser    (stream_t *stream) :
     root( NULL ),
     stream( stream ),
-    vlc_reader( NULL )
+    vlc_reader( NULL ),
+    handler( NULL )
 {
 }
 
@@ -77,6 +79,11 @@ bool    DOMParser::parse                    (bool b)
     return true;
 }
 
+void DOMParser::setElementHandler(ElementHandler *h)
+{
+    handler = h;
+}
+
 bool DOMParser::reset(stream_t *s)
 {
     stream = s;
@@ -95,14 +102,32 @@ Node* DOMParser::processNode(bool b_strict)
     const char *data;
     int type;
     std::stack<Node *> lifo;
+    unsigned skipped = 0; /* depth within an element consumed by the handler */
 
     while( (type = xml_ReaderNextNode(vlc_reader, &data)) > 0 )
     {
+        if(skipped)
+        {
+            if(type == XML_READER_STARTELEM && !xml_ReaderIsEmptyElement(vlc_reader))
+                skipped++;
+            else if(type == XML_READER_ENDELEM)
+                skipped--;
+            continue;
+        }
+
         switch(type)
         {
             case XML_READER_STARTELEM:
             {
                 bool empty = xml_ReaderIsEmptyElement(vlc_reader);
+                if(handler && !lifo.empty() &&
+                   handler->handleElement(lifo.top(), data, vlc_reader))
+                {
+                    if(!empty)
+                        skipped = 1;
+                    break;
+                }
+
                 Node *node = new (std::nothrow) Node();
                 if(node)
                 {
@@ -34,6 +34,17 @@ namespace adaptive
 {
     namespace xml
     {
+        class ElementHandler
+        {
+            public:
+                virtual ~ElementHandler() {}
+                /* Called on elements with their attributes still
+                 * pending. Returns true when consumed, no Node is then
+                 * created for it nor for its content. */
+                virtual bool handleElement(Node *parent, const char *name,
+                                           xml_reader_t *) = 0;
+        };
+
         class DOMParser
         {
             public:
@@ -45,12 +56,14 @@ namespace adaptive
                 bool                reset       (stream_t *);
                 Node*               getRootNode ();
                 void                print       ();
+                void                setElementHandler(ElementHandler *);
 
             private:
                 Node                *root;
                 stream_t            *stream;
 
                 xml_reader_t        *vlc_reader;
+                ElementHandler      *handler;
 
                 Node*   processNode             (bool);
                 void    addAttributesToNode     (Node *node);
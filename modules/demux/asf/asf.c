@@ -62,6 +62,9 @@ vlc_module_begin ()
     set_capability( "demux", 200 )
     set_callbacks( Open, Close )
     add_shortcut( "asf", "wmv" )
+    /* ASF header object GUID */
+    add_signature( 0, "\x30\x26\xB2\x75\x8E\x66\xCF\x11"
+                      "\xA6\xD9\x00\xAA\x00\x62\xCE\x6C" )
 vlc_module_end ()
 
 
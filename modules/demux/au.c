@@ -50,6 +50,7 @@ vlc_module_begin ()
     set_capability( "demux", 10 )
     set_callback( Open )
     add_shortcut( "au" )
+    add_signature( 0, ".snd" )
 vlc_module_end ()
 
 /*****************************************************************************
@@ -118,7 +118,6 @@ typedef struct
 
 typedef struct
 {
-    vlc_fourcc_t i_id;
     uint32_t     i_flags;
     uint64_t     i_pos;
     uint32_t     i_length;
@@ -126,16 +125,49 @@ typedef struct
 
 } avi_entry_t;
 
+/* Index entries are stored by blocks, relatively to the first entry of the
+ * block. A block falls back to plain entries when one does not fit. */
+#define AVI_INDEX_BLOCK 256
+#define AVI_INDEX_KEY   0x80000000 /* in avi_delta_t.i_length */
+
 typedef struct
 {
-    uint32_t        i_size;
-    uint32_t        i_max;
-    avi_entry_t     *p_entry;
+    uint32_t     i_pos;
+    uint32_t     i_length;
+    uint32_t     i_lengthtotal;
+
+} avi_delta_t;
+
+typedef struct
+{
+    uint64_t     i_pos;
+    uint64_t     i_lengthtotal;
+    avi_delta_t  *p_delta;
+    avi_entry_t  *p_entry;
+
+} avi_index_block_t;
+
+typedef struct
+{
+    uint32_t          i_size;
+    uint32_t          i_max;    /* allocated blocks */
+    avi_index_block_t *p_block;
+    uint64_t          i_lengthtotal;
+    bool              b_allkey;
+
+    /* OpenDML super index, the sub-indexes are loaded on demand */
+    avi_chunk_indx_t  *p_super;
+    uint32_t          i_super;   /* next sub-index to load */
+    uint64_t          i_pending; /* duration not loaded yet */
 
 } avi_index_t;
 static void avi_index_Init( avi_index_t * );
 static void avi_index_Clean( avi_index_t * );
 static void avi_index_Append( avi_index_t *, uint64_t *, avi_entry_t * );
+static uint64_t avi_index_Pos( const avi_index_t *, uint32_t );
+static uint32_t avi_index_Length( const avi_index_t *, uint32_t );
+static uint64_t avi_index_LengthTotal( const avi_index_t *, uint32_t );
+static bool     avi_index_IsKey( const avi_index_t *, uint32_t );
 
 typedef struct
 {
@@ -184,6 +216,8 @@ typedef struct
 
     uint64_t i_movi_begin;
     uint64_t i_movi_lastchunk_pos;   /* XXX position of last valid chunk */
+    uint64_t i_index_scan;           /* next packet to index, 0 if none */
+    stream_t *p_index_stream;        /* stream of the index scan, or NULL */
 
     /* number of streams and information */
     unsigned int i_track;
@@ -213,12 +247,17 @@ static int AVI_StreamBytesSet ( demux_t *,
 vlc_fourcc_t AVI_FourccGetCodec( unsigned int i_cat, vlc_fourcc_t );
 static int   AVI_GetKeyFlag    ( vlc_fourcc_t , uint8_t * );
 
-static int AVI_PacketGetHeader( demux_t *, avi_packet_t *p_pk );
-static int AVI_PacketNext     ( demux_t * );
-static int AVI_PacketSearch   ( demux_t * );
+static int AVI_PacketGetHeader( stream_t *, avi_packet_t *p_pk );
+static int AVI_PacketNext     ( stream_t * );
+static int AVI_PacketSearch   ( demux_t *, stream_t * );
 
 static void AVI_IndexLoad    ( demux_t * );
 static void AVI_IndexCreate  ( demux_t * );
+static void AVI_IndexScan    ( demux_t * );
+static bool AVI_IndexNeed    ( demux_t *, avi_track_t *, uint32_t i_ck );
+static bool AVI_IndexNeedBytes( demux_t *, avi_track_t *, uint64_t i_byte );
+static void AVI_IndexLoadPending( demux_t * );
+static uint64_t AVI_IndexTotal( const avi_track_t * );
 
 static void AVI_ExtractSubtitle( demux_t *, unsigned int i_stream, avi_chunk_list_t *, avi_chunk_STRING_t * );
 
@@ -282,6 +321,8 @@ static void Close ( vlc_object_t * p_this )
     }
     free( p_sys->track );
 
+    if( p_sys->p_index_stream )
+        vlc_stream_Delete( p_sys->p_index_stream );
     AVI_ChunkFreeRoot( p_demux->s, &p_sys->ck_root );
     if( p_sys->meta )
         vlc_meta_Delete( p_sys->meta );
@@ -716,8 +757,8 @@ aviindex:
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         const avi_track_t *tk = p_sys->track[i];
-        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.p_entry )
-            i_idx_totalframes = __MAX(i_idx_totalframes, tk->idx.i_size);
+        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.i_size )
+            i_idx_totalframes = __MAX(i_idx_totalframes, AVI_IndexTotal( tk ));
     }
     if( i_idx_totalframes != p_avih->i_totalframes &&
         p_sys->i_length < VLC_TICK_FROM_US( p_avih->i_totalframes *
@@ -790,9 +831,8 @@ aviindex:
             p_auds->p_wf->wFormatTag != WAVE_FORMAT_PCM &&
             tk->i_rate == p_auds->p_wf->nSamplesPerSec )
         {
-            int64_t i_track_length =
-                tk->idx.p_entry[tk->idx.i_size-1].i_length +
-                tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal;
+            AVI_IndexNeed( p_demux, tk, UINT32_MAX );
+            int64_t i_track_length = tk->idx.i_lengthtotal;
             vlc_tick_t i_length = VLC_TICK_FROM_US( p_avih->i_totalframes *
                                                     p_avih->i_microsecperframe );
 
@@ -975,6 +1015,8 @@ static int Demux_Seekable( demux_t *p_demux )
     /* cannot be more than 100 stream (dcXX or wbXX) */
     avi_track_toread_t toread[100];
 
+    if( p_sys->i_index_scan )
+        AVI_IndexScan( p_demux );
 
     /* detect new selected/unselected streams */
     for( i_track = 0; i_track < p_sys->i_track; i_track++ )
@@ -1030,9 +1072,9 @@ static int Demux_Seekable( demux_t *p_demux )
         avi_track_t *tk = p_sys->track[i_track];
 
         toread[i_track].b_ok = tk->b_activated && !tk->b_eof;
-        if( tk->i_idxposc < tk->idx.i_size )
+        if( AVI_IndexNeed( p_demux, tk, tk->i_idxposc ) )
         {
-            toread[i_track].i_posf = tk->idx.p_entry[tk->i_idxposc].i_pos;
+            toread[i_track].i_posf = avi_index_Pos( &tk->idx, tk->i_idxposc );
            if( tk->i_idxposb > 0 )
            {
                 toread[i_track].i_posf += 8 + tk->i_idxposb;
@@ -1115,12 +1157,13 @@ static int Demux_Seekable( demux_t *p_demux )
 
             /* no valid index, we will parse directly the stream
              * in case we fail we will disable all finished stream */
+            AVI_IndexLoadPending( p_demux );
             if( p_sys->b_seekable && p_sys->i_movi_lastchunk_pos >= p_sys->i_movi_begin + 12 )
             {
                 if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
                     return VLC_DEMUXER_EGENERIC;
 
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return( AVI_TrackStopFinishedStreams( p_demux ) ? 0 : 1 );
                 }
@@ -1135,7 +1178,7 @@ static int Demux_Seekable( demux_t *p_demux )
             {
                 avi_packet_t avi_pk;
 
-                if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+                if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
                 {
                     msg_Warn( p_demux,
                              "cannot get packet header, track disabled" );
@@ -1144,7 +1187,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if( avi_pk.i_stream >= p_sys->i_track ||
                     ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
                 {
-                    if( AVI_PacketNext( p_demux ) )
+                    if( AVI_PacketNext( p_demux->s ) )
                     {
                         msg_Warn( p_demux,
                                   "cannot skip packet, track disabled" );
@@ -1162,7 +1205,6 @@ static int Demux_Seekable( demux_t *p_demux )
 
                     /* add this chunk to the index */
                     avi_entry_t index;
-                    index.i_id     = avi_pk.i_fourcc;
                     index.i_flags  = AVI_GetKeyFlag(tk->fmt.i_codec, avi_pk.i_peek);
                     index.i_pos    = avi_pk.i_pos;
                     index.i_length = avi_pk.i_size;
@@ -1176,7 +1218,7 @@ static int Demux_Seekable( demux_t *p_demux )
                     }
                     else
                     {
-                        if( AVI_PacketNext( p_demux ) )
+                        if( AVI_PacketNext( p_demux->s ) )
                         {
                             msg_Warn( p_demux,
                                       "cannot skip packet, track disabled" );
@@ -1213,13 +1255,13 @@ static int Demux_Seekable( demux_t *p_demux )
                     i_toread = __MAX( i_toread, 100 );
                 }
             }
-            i_size = __MIN( tk->idx.p_entry[tk->i_idxposc].i_length -
+            i_size = __MIN( avi_index_Length( &tk->idx, tk->i_idxposc ) -
                                 tk->i_idxposb,
                             (size_t) i_toread );
         }
         else
         {
-            i_size = tk->idx.p_entry[tk->i_idxposc].i_length;
+            i_size = avi_index_Length( &tk->idx, tk->i_idxposc );
         }
 
         if( tk->i_idxposb == 0 )
@@ -1237,7 +1279,7 @@ static int Demux_Seekable( demux_t *p_demux )
         }
 
         p_frame->i_pts = VLC_TICK_0 + AVI_GetPTS( tk );
-        if( tk->idx.p_entry[tk->i_idxposc].i_flags&AVIIF_KEYFRAME )
+        if( avi_index_IsKey( &tk->idx, tk->i_idxposc ) )
         {
             p_frame->i_flags = BLOCK_FLAG_TYPE_I;
         }
@@ -1256,7 +1298,7 @@ static int Demux_Seekable( demux_t *p_demux )
             toread[i_track].i_toread -= i_size;
             tk->i_idxposb += i_size;
             if( tk->i_idxposb >=
-                    tk->idx.p_entry[tk->i_idxposc].i_length )
+                    avi_index_Length( &tk->idx, tk->i_idxposc ) )
             {
                 tk->i_idxposb = 0;
                 tk->i_idxposc++;
@@ -1264,7 +1306,7 @@ static int Demux_Seekable( demux_t *p_demux )
         }
         else
         {
-            int i_length = tk->idx.p_entry[tk->i_idxposc].i_length;
+            int i_length = avi_index_Length( &tk->idx, tk->i_idxposc );
 
             tk->i_idxposc++;
             if( tk->fmt.i_cat == AUDIO_ES )
@@ -1274,10 +1316,10 @@ static int Demux_Seekable( demux_t *p_demux )
             toread[i_track].i_toread--;
         }
 
-        if( tk->i_idxposc < tk->idx.i_size)
+        if( AVI_IndexNeed( p_demux, tk, tk->i_idxposc ) )
         {
             toread[i_track].i_posf =
-                tk->idx.p_entry[tk->i_idxposc].i_pos;
+                avi_index_Pos( &tk->idx, tk->i_idxposc );
             if( tk->i_idxposb > 0 )
             {
                 toread[i_track].i_posf += 8 + tk->i_idxposb;
@@ -1356,7 +1398,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
     {
         avi_packet_t    avi_pk;
 
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             return VLC_DEMUXER_EOF;
         }
@@ -1373,18 +1415,18 @@ static int Demux_UnSeekable( demux_t *p_demux )
                 case AVIFOURCC_JUNK:
                 case AVIFOURCC_LIST:
                 case AVIFOURCC_RIFF:
-                    return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                    return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                 case AVIFOURCC_idx1:
                     if( p_sys->b_odml )
                     {
-                        return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                        return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                     }
                     return VLC_DEMUXER_EOF;
                 default:
                     msg_Warn( p_demux,
                               "seems to have lost position @%"PRIu64", resync",
                               vlc_stream_Tell(p_demux->s) );
-                    if( AVI_PacketSearch( p_demux ) )
+                    if( AVI_PacketSearch( p_demux, p_demux->s ) )
                     {
                         msg_Err( p_demux, "resync failed" );
                         return VLC_DEMUXER_EGENERIC;
@@ -1411,7 +1453,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
             }
             else
             {
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return VLC_DEMUXER_EOF;
                 }
@@ -1522,8 +1564,8 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, double f_ratio, bool b_acc
                 goto failandresetpos;
             }
 
-            while( i_pos >= p_stream->idx.p_entry[p_stream->i_idxposc].i_pos +
-               p_stream->idx.p_entry[p_stream->i_idxposc].i_length + 8 )
+            while( i_pos >= avi_index_Pos( &p_stream->idx, p_stream->i_idxposc ) +
+               avi_index_Length( &p_stream->idx, p_stream->i_idxposc ) + 8 )
             {
                 /* search after i_idxposc */
                 if( AVI_StreamChunkSet( p_demux,
@@ -1787,14 +1829,12 @@ static vlc_tick_t AVI_GetPTS( avi_track_t *tk )
         /* we need a valid entry we will emulate one */
         if( idx >= tk->idx.i_size )
         {
-            /* use the last entry */
-            idx = tk->idx.i_size - 1;
-            i_count = tk->idx.p_entry[idx].i_lengthtotal
-                    + tk->idx.p_entry[idx].i_length;
+            /* use the end of the last entry */
+            i_count = tk->idx.i_lengthtotal;
         }
         else
         {
-            i_count = tk->idx.p_entry[idx].i_lengthtotal;
+            i_count = avi_index_LengthTotal( &tk->idx, idx );
         }
         return AVI_GetDPTS( tk, i_count + tk->i_idxposb );
     }
@@ -1812,12 +1852,13 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
     unsigned short i_loop_count = 0;
 
     /* find first chunk of i_stream that isn't in index */
+    AVI_IndexLoadPending( p_demux );
 
     if( p_sys->i_movi_lastchunk_pos >= p_sys->i_movi_begin + 12 )
     {
         if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
             return VLC_EGENERIC;
-        if( AVI_PacketNext( p_demux ) )
+        if( AVI_PacketNext( p_demux->s ) )
         {
             return VLC_EGENERIC;
         }
@@ -1830,7 +1871,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
     for( ;; )
     {
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             msg_Warn( p_demux, "cannot get packet header" );
             return VLC_EGENERIC;
@@ -1838,7 +1879,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
         if( avi_pk.i_stream >= p_sys->i_track ||
             ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
         {
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1852,7 +1893,6 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
             /* add this chunk to the index */
             avi_entry_t index;
-            index.i_id     = avi_pk.i_fourcc;
             index.i_flags  = AVI_GetKeyFlag(tk_pk->fmt.i_codec, avi_pk.i_peek);
             index.i_pos    = avi_pk.i_pos;
             index.i_length = avi_pk.i_size;
@@ -1864,7 +1904,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
                 return VLC_SUCCESS;
             }
 
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1882,7 +1922,7 @@ static int AVI_StreamChunkSet( demux_t *p_demux, unsigned int i_stream,
     p_stream->i_idxposc = i_ck;
     p_stream->i_idxposb = 0;
 
-    if(  i_ck >= p_stream->idx.i_size )
+    if( !AVI_IndexNeed( p_demux, p_stream, i_ck ) )
     {
         p_stream->i_idxposc = p_stream->idx.i_size - 1;
         do
@@ -1907,9 +1947,7 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
     demux_sys_t *p_sys = p_demux->p_sys;
     avi_track_t *p_stream = p_sys->track[i_stream];
 
-    if( ( p_stream->idx.i_size > 0 )
-        &&( i_byte < p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_lengthtotal +
-                p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_length ) )
+    if( AVI_IndexNeedBytes( p_demux, p_stream, i_byte ) )
     {
         /* index is valid to find the ck */
         /* uses dichototmie to be fast enougth */
@@ -1918,15 +1956,15 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
         int i_idxmin  = 0;
         for( ;; )
         {
-            if( p_stream->idx.p_entry[i_idxposc].i_lengthtotal > i_byte )
+            if( avi_index_LengthTotal( &p_stream->idx, i_idxposc ) > i_byte )
             {
                 i_idxmax  = i_idxposc ;
                 i_idxposc = ( i_idxmin + i_idxposc ) / 2 ;
             }
             else
             {
-                if( p_stream->idx.p_entry[i_idxposc].i_lengthtotal +
-                        p_stream->idx.p_entry[i_idxposc].i_length <= i_byte)
+                if( avi_index_LengthTotal( &p_stream->idx, i_idxposc ) +
+                        avi_index_Length( &p_stream->idx, i_idxposc ) <= i_byte)
                 {
                     i_idxmin  = i_idxposc ;
                     i_idxposc = (i_idxmax + i_idxposc ) / 2 ;
@@ -1935,7 +1973,7 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                 {
                     p_stream->i_idxposc = i_idxposc;
                     p_stream->i_idxposb = i_byte -
-                            p_stream->idx.p_entry[i_idxposc].i_lengthtotal;
+                            avi_index_LengthTotal( &p_stream->idx, i_idxposc );
                     return VLC_SUCCESS;
                 }
             }
@@ -1954,11 +1992,11 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                 return VLC_EGENERIC;
             }
 
-        } while( p_stream->idx.p_entry[p_stream->i_idxposc].i_lengthtotal +
-                    p_stream->idx.p_entry[p_stream->i_idxposc].i_length <= i_byte );
+        } while( avi_index_LengthTotal( &p_stream->idx, p_stream->i_idxposc ) +
+                    avi_index_Length( &p_stream->idx, p_stream->i_idxposc ) <= i_byte );
 
         p_stream->i_idxposb = i_byte -
-                       p_stream->idx.p_entry[p_stream->i_idxposc].i_lengthtotal;
+                       avi_index_LengthTotal( &p_stream->idx, p_stream->i_idxposc );
         return VLC_SUCCESS;
     }
 }
@@ -1992,7 +2030,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             {
                 if( tk->i_blocksize > 0 )
                 {
-                    tk->i_blockno += ( tk->idx.p_entry[i].i_length + tk->i_blocksize - 1 ) / tk->i_blocksize;
+                    tk->i_blockno += ( avi_index_Length( &tk->idx, i ) + tk->i_blocksize - 1 ) / tk->i_blocksize;
                 }
                 else
                 {
@@ -2013,8 +2051,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             //if( i_date < i_oldpts || 1 )
             {
                 while( p_stream->i_idxposc > 0 &&
-                   !( p_stream->idx.p_entry[p_stream->i_idxposc].i_flags &
-                                                                AVIIF_KEYFRAME ) )
+                   !avi_index_IsKey( &p_stream->idx, p_stream->i_idxposc ) )
                 {
                     if( AVI_StreamChunkSet( p_demux,
                                             i_stream,
@@ -2028,8 +2065,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             else
             {
                 while( p_stream->i_idxposc < p_stream->idx.i_size &&
-                        !( p_stream->idx.p_entry[p_stream->i_idxposc].i_flags &
-                                                                AVIIF_KEYFRAME ) )
+                        !avi_index_IsKey( &p_stream->idx, p_stream->i_idxposc ) )
                 {
                     if( AVI_StreamChunkSet( p_demux,
                                             i_stream,
@@ -2161,17 +2197,17 @@ static void AVI_ParseStreamHeader( vlc_fourcc_t i_id,
 /****************************************************************************
  *
  ****************************************************************************/
-static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
+static int AVI_PacketGetHeader( stream_t *s, avi_packet_t *p_pk )
 {
     const uint8_t *p_peek;
 
-    if( vlc_stream_Peek( p_demux->s, &p_peek, 16 ) < 16 )
+    if( vlc_stream_Peek( s, &p_peek, 16 ) < 16 )
     {
         return VLC_EGENERIC;
     }
     p_pk->i_fourcc  = VLC_FOURCC( p_peek[0], p_peek[1], p_peek[2], p_peek[3] );
     p_pk->i_size    = GetDWLE( p_peek + 4 );
-    p_pk->i_pos     = vlc_stream_Tell( p_demux->s );
+    p_pk->i_pos     = vlc_stream_Tell( s );
     if( p_pk->i_fourcc == AVIFOURCC_LIST || p_pk->i_fourcc == AVIFOURCC_RIFF )
     {
         p_pk->i_type = VLC_FOURCC( p_peek[8],  p_peek[9],
@@ -2188,12 +2224,12 @@ static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketNext( demux_t *p_demux )
+static int AVI_PacketNext( stream_t *s )
 {
     avi_packet_t    avi_ck;
     size_t          i_skip = 0;
 
-    if( AVI_PacketGetHeader( p_demux, &avi_ck ) )
+    if( AVI_PacketGetHeader( s, &avi_ck ) )
     {
         return VLC_EGENERIC;
     }
@@ -2218,7 +2254,7 @@ static int AVI_PacketNext( demux_t *p_demux )
     if( i_skip > SSIZE_MAX )
         return VLC_EGENERIC;
 
-    ssize_t i_ret = vlc_stream_Read( p_demux->s, NULL, i_skip );
+    ssize_t i_ret = vlc_stream_Read( s, NULL, i_skip );
     if( i_ret < 0 || (size_t) i_ret != i_skip )
     {
         return VLC_EGENERIC;
@@ -2226,7 +2262,7 @@ static int AVI_PacketNext( demux_t *p_demux )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketSearch( demux_t *p_demux )
+static int AVI_PacketSearch( demux_t *p_demux, stream_t *s )
 {
     demux_sys_t     *p_sys = p_demux->p_sys;
     avi_packet_t    avi_pk;
@@ -2234,11 +2270,11 @@ static int AVI_PacketSearch( demux_t *p_demux )
 
     for( ;; )
     {
-        if( vlc_stream_Read( p_demux->s, NULL, 1 ) != 1 )
+        if( vlc_stream_Read( s, NULL, 1 ) != 1 )
         {
             return VLC_EGENERIC;
         }
-        AVI_PacketGetHeader( p_demux, &avi_pk );
+        AVI_PacketGetHeader( s, &avi_pk );
         if( avi_pk.i_stream < p_sys->i_track &&
             ( avi_pk.i_cat == AUDIO_ES || avi_pk.i_cat == VIDEO_ES ) )
         {
@@ -2265,11 +2301,85 @@ static void avi_index_Init( avi_index_t *p_index )
 {
     p_index->i_size  = 0;
     p_index->i_max   = 0;
-    p_index->p_entry = NULL;
+    p_index->p_block = NULL;
+    p_index->i_lengthtotal = 0;
+    p_index->b_allkey = false;
+    p_index->p_super = NULL;
+    p_index->i_super = 0;
+    p_index->i_pending = 0;
 }
 static void avi_index_Clean( avi_index_t *p_index )
 {
-    free( p_index->p_entry );
+    for( uint32_t i = 0; i < p_index->i_size; i += AVI_INDEX_BLOCK )
+    {
+        free( p_index->p_block[i / AVI_INDEX_BLOCK].p_delta );
+        free( p_index->p_block[i / AVI_INDEX_BLOCK].p_entry );
+    }
+    free( p_index->p_block );
+    avi_index_Init( p_index );
+}
+static uint64_t avi_index_Pos( const avi_index_t *p_index, uint32_t i )
+{
+    const avi_index_block_t *p_block = &p_index->p_block[i / AVI_INDEX_BLOCK];
+    i %= AVI_INDEX_BLOCK;
+    if( p_block->p_entry )
+        return p_block->p_entry[i].i_pos;
+    return p_block->i_pos + p_block->p_delta[i].i_pos;
+}
+static uint32_t avi_index_Length( const avi_index_t *p_index, uint32_t i )
+{
+    const avi_index_block_t *p_block = &p_index->p_block[i / AVI_INDEX_BLOCK];
+    i %= AVI_INDEX_BLOCK;
+    if( p_block->p_entry )
+        return p_block->p_entry[i].i_length;
+    return p_block->p_delta[i].i_length & ~AVI_INDEX_KEY;
+}
+static uint64_t avi_index_LengthTotal( const avi_index_t *p_index, uint32_t i )
+{
+    const avi_index_block_t *p_block = &p_index->p_block[i / AVI_INDEX_BLOCK];
+    i %= AVI_INDEX_BLOCK;
+    if( p_block->p_entry )
+        return p_block->p_entry[i].i_lengthtotal;
+    return p_block->i_lengthtotal + p_block->p_delta[i].i_lengthtotal;
+}
+static bool avi_index_IsKey( const avi_index_t *p_index, uint32_t i )
+{
+    const avi_index_block_t *p_block = &p_index->p_block[i / AVI_INDEX_BLOCK];
+    i %= AVI_INDEX_BLOCK;
+    if( p_block->p_entry )
+        return p_block->p_entry[i].i_flags & AVIIF_KEYFRAME;
+    return p_block->p_delta[i].i_length & AVI_INDEX_KEY;
+}
+static void avi_index_SetAllKey( avi_index_t *p_index )
+{
+    p_index->b_allkey = true;
+    for( uint32_t i = 0; i < p_index->i_size; i++ )
+    {
+        avi_index_block_t *p_block = &p_index->p_block[i / AVI_INDEX_BLOCK];
+        if( p_block->p_entry )
+            p_block->p_entry[i % AVI_INDEX_BLOCK].i_flags |= AVIIF_KEYFRAME;
+        else
+            p_block->p_delta[i % AVI_INDEX_BLOCK].i_length |= AVI_INDEX_KEY;
+    }
+}
+static int avi_index_Widen( avi_index_block_t *p_block, uint32_t i_count )
+{
+    avi_entry_t *p_entry = vlc_alloc( AVI_INDEX_BLOCK, sizeof( *p_entry ) );
+    if( !p_entry )
+        return VLC_ENOMEM;
+
+    for( uint32_t i = 0; i < i_count; i++ )
+    {
+        const avi_delta_t *p_delta = &p_block->p_delta[i];
+        p_entry[i].i_flags  = p_delta->i_length & AVI_INDEX_KEY ? AVIIF_KEYFRAME : 0;
+        p_entry[i].i_pos    = p_block->i_pos + p_delta->i_pos;
+        p_entry[i].i_length = p_delta->i_length & ~AVI_INDEX_KEY;
+        p_entry[i].i_lengthtotal = p_block->i_lengthtotal + p_delta->i_lengthtotal;
+    }
+    free( p_block->p_delta );
+    p_block->p_delta = NULL;
+    p_block->p_entry = p_entry;
+    return VLC_SUCCESS;
 }
 static void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
                               avi_entry_t *p_entry )
@@ -2278,28 +2388,64 @@ static void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
     if( *pi_last_pos < p_entry->i_pos )
          *pi_last_pos = p_entry->i_pos;
 
-    /* add the entry */
-    if( p_index->i_size >= p_index->i_max )
+    const uint32_t i_block = p_index->i_size / AVI_INDEX_BLOCK;
+    const uint32_t i_count = p_index->i_size % AVI_INDEX_BLOCK;
+
+    /* start a new block */
+    if( i_count == 0 )
     {
-        p_index->i_max += 16384;
-        p_index->p_entry = realloc_or_free( p_index->p_entry,
-                                            p_index->i_max * sizeof( *p_index->p_entry ) );
-        if( !p_index->p_entry )
+        if( i_block >= p_index->i_max )
+        {
+            avi_index_block_t *p_block =
+                realloc( p_index->p_block, ( p_index->i_max + 64 ) *
+                                           sizeof( *p_index->p_block ) );
+            if( !p_block )
+                return;
+            p_index->p_block = p_block;
+            p_index->i_max  += 64;
+        }
+        avi_index_block_t *p_block = &p_index->p_block[i_block];
+        p_block->i_pos   = p_entry->i_pos;
+        p_block->i_lengthtotal = p_index->i_lengthtotal;
+        p_block->p_entry = NULL;
+        p_block->p_delta = vlc_alloc( AVI_INDEX_BLOCK, sizeof( *p_block->p_delta ) );
+        if( !p_block->p_delta )
             return;
     }
+
+    avi_index_block_t *p_block = &p_index->p_block[i_block];
+    uint32_t i_flags = p_entry->i_flags;
+    if( p_index->b_allkey )
+        i_flags |= AVIIF_KEYFRAME;
+
     /* calculate cumulate length */
-    if( p_index->i_size > 0 )
+    p_entry->i_lengthtotal = p_index->i_lengthtotal;
+
+    if( !p_block->p_entry &&
+        ( p_entry->i_pos < p_block->i_pos ||
+          p_entry->i_pos - p_block->i_pos > UINT32_MAX ||
+          p_entry->i_lengthtotal - p_block->i_lengthtotal > UINT32_MAX ||
+          p_entry->i_length >= AVI_INDEX_KEY ) &&
+        avi_index_Widen( p_block, i_count ) )
+        return;
+
+    if( p_block->p_entry )
     {
-        p_entry->i_lengthtotal =
-            p_index->p_entry[p_index->i_size - 1].i_length +
-                p_index->p_entry[p_index->i_size - 1].i_lengthtotal;
+        p_block->p_entry[i_count] = *p_entry;
+        p_block->p_entry[i_count].i_flags = i_flags;
     }
     else
     {
-        p_entry->i_lengthtotal = 0;
+        avi_delta_t *p_delta = &p_block->p_delta[i_count];
+        p_delta->i_pos    = p_entry->i_pos - p_block->i_pos;
+        p_delta->i_length = p_entry->i_length;
+        if( i_flags & AVIIF_KEYFRAME )
+            p_delta->i_length |= AVI_INDEX_KEY;
+        p_delta->i_lengthtotal = p_entry->i_lengthtotal - p_block->i_lengthtotal;
     }
 
-    p_index->p_entry[p_index->i_size++] = *p_entry;
+    p_index->i_lengthtotal += p_entry->i_length;
+    p_index->i_size++;
 }
 
 static int AVI_IndexFind_idx1( demux_t *p_demux,
@@ -2391,7 +2537,6 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             (i_cat == p_sys->track[i_stream]->fmt.i_cat || i_cat == UNKNOWN_ES ) )
         {
             avi_entry_t index;
-            index.i_id     = p_idx1->entry[i_index].i_fourcc;
             index.i_flags  = p_idx1->entry[i_index].i_flags&(~AVIIF_FIXKEYFRAME);
             index.i_pos    = p_idx1->entry[i_index].i_pos + i_offset;
             index.i_length = p_idx1->entry[i_index].i_length;
@@ -2410,14 +2555,14 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             if( p_sys->track[i_index]->i_samplesize )
             {
                 i_length = AVI_GetDPTS( p_sys->track[i_index],
-                                        p_index[i_index].p_entry[i].i_lengthtotal );
+                                        avi_index_LengthTotal( &p_index[i_index], i ) );
             }
             else
             {
                 i_length = AVI_GetDPTS( p_sys->track[i_index], i );
             }
             msg_Dbg( p_demux, "index stream %d @%ld time %ld", i_index,
-                     p_index[i_index].p_entry[i].i_pos, i_length );
+                     avi_index_Pos( &p_index[i_index], i ), i_length );
         }
     }
 #endif
@@ -2437,7 +2582,6 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.std[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.std[i].i_offset - 8;
             index.i_length = p_indx->idx.std[i].i_size&0x7fffffff;
@@ -2450,7 +2594,6 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.field[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.field[i].i_offset - 8;
             index.i_length = p_indx->idx.field[i].i_size;
@@ -2465,6 +2608,86 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     }
 }
 
+/* Loads the next sub-index of an OpenDML super index */
+static int AVI_IndexLoadNext( demux_t *p_demux, avi_index_t *p_index,
+                              uint64_t *pi_last_offset )
+{
+    avi_chunk_indx_t *p_super = p_index->p_super;
+    if( !p_super )
+        return VLC_EGENERIC;
+
+    const indx_super_entry_t *p_entry = &p_super->idx.super[p_index->i_super];
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+    avi_chunk_t ck_sub;
+
+    p_index->i_pending -= p_entry->i_duration;
+    if( ++p_index->i_super >= p_super->i_entriesinuse )
+        p_index->p_super = NULL;
+
+    if( vlc_stream_Seek( p_demux->s, p_entry->i_offset ) ||
+        AVI_ChunkRead( p_demux->s, &ck_sub, NULL  ) )
+    {
+        /* do not try the following sub-indexes */
+        p_index->p_super = NULL;
+    }
+    else
+    {
+        if( ck_sub.indx.i_indextype == AVI_INDEX_OF_CHUNKS )
+            __Parse_indx( p_demux, p_index, pi_last_offset, &ck_sub.indx );
+        AVI_ChunkClean( p_demux->s, &ck_sub );
+    }
+    if( !p_index->p_super )
+        p_index->i_pending = 0;
+
+    /* the demuxer reads on from where it was */
+    if( vlc_stream_Seek( p_demux->s, i_pos ) )
+    {
+        msg_Err( p_demux, "cannot seek back after loading a sub-index" );
+        p_index->p_super = NULL;
+        p_index->i_pending = 0;
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+/* Loads the pending sub-indexes until the entry i_ck is available */
+static bool AVI_IndexNeed( demux_t *p_demux, avi_track_t *tk, uint32_t i_ck )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    while( i_ck >= tk->idx.i_size &&
+           !AVI_IndexLoadNext( p_demux, &tk->idx, &p_sys->i_movi_lastchunk_pos ) );
+    return i_ck < tk->idx.i_size;
+}
+
+/* Loads the pending sub-indexes until the byte i_byte is available */
+static bool AVI_IndexNeedBytes( demux_t *p_demux, avi_track_t *tk, uint64_t i_byte )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    while( i_byte >= tk->idx.i_lengthtotal &&
+           !AVI_IndexLoadNext( p_demux, &tk->idx, &p_sys->i_movi_lastchunk_pos ) );
+    return i_byte < tk->idx.i_lengthtotal;
+}
+
+/* Loads all the pending sub-indexes, the stream must not be parsed for
+ * missing entries before that */
+static void AVI_IndexLoadPending( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        AVI_IndexNeed( p_demux, p_sys->track[i], UINT32_MAX );
+}
+
+/* Number of chunks (bytes if i_samplesize) of the fully loaded index */
+static uint64_t AVI_IndexTotal( const avi_track_t *tk )
+{
+    if( tk->i_samplesize )
+        return tk->idx.i_lengthtotal + tk->idx.i_pending * tk->i_samplesize;
+    return tk->idx.i_size + tk->idx.i_pending;
+}
+
 static void AVI_IndexLoad_indx( demux_t *p_demux,
                                 avi_index_t p_index[], uint64_t *pi_last_offset )
 {
@@ -2501,19 +2724,21 @@ static void AVI_IndexLoad_indx( demux_t *p_demux,
         {
             if ( !p_sys->b_seekable )
                 return;
-            avi_chunk_t    ck_sub;
+
+            /* Only the first sub-index is loaded now, the others are loaded
+             * when playback or seeking reaches them. That requires valid
+             * durations, and no idx1 to compare the index sizes with. */
+            bool b_lazy = p_sys->b_odml;
+            p_index[i_stream].p_super = p_indx;
             for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
             {
-                if( vlc_stream_Seek( p_demux->s,
-                                     p_indx->idx.super[i].i_offset ) ||
-                    AVI_ChunkRead( p_demux->s, &ck_sub, NULL  ) )
-                {
-                    break;
-                }
-                if( ck_sub.indx.i_indextype == AVI_INDEX_OF_CHUNKS )
-                    __Parse_indx( p_demux, &p_index[i_stream], pi_last_offset, &ck_sub.indx );
-                AVI_ChunkClean( p_demux->s, &ck_sub );
+                p_index[i_stream].i_pending += p_indx->idx.super[i].i_duration;
+                if( p_indx->idx.super[i].i_duration == 0 )
+                    b_lazy = false;
             }
+            do
+                AVI_IndexLoadNext( p_demux, &p_index[i_stream], pi_last_offset );
+            while( !b_lazy && p_index[i_stream].p_super );
         }
         else
         {
@@ -2546,6 +2771,7 @@ static void AVI_IndexLoad( demux_t *p_demux )
     /* Select the longest index */
     for( unsigned i = 0; i < p_sys->i_track; i++ )
     {
+        avi_index_Clean( &p_sys->track[i]->idx );
         if( p_idx_indx[i].i_size > p_idx_idx1[i].i_size )
         {
             msg_Dbg( p_demux, "selected ODML index for stream[%u]", i );
@@ -2568,20 +2794,50 @@ static void AVI_IndexLoad( demux_t *p_demux )
         /* Fix key flag */
         bool b_key = false;
         for( unsigned j = 0; !b_key && j < p_index->i_size; j++ )
-            b_key = p_index->p_entry[j].i_flags & AVIIF_KEYFRAME;
+            b_key = avi_index_IsKey( p_index, j );
         if( !b_key )
         {
             msg_Err( p_demux, "no key frame set for track %u", i );
-            for( unsigned j = 0; j < p_index->i_size; j++ )
-                p_index->p_entry[j].i_flags |= AVIIF_KEYFRAME;
+            avi_index_SetAllKey( p_index );
         }
 
         /* */
-        msg_Dbg( p_demux, "stream[%d] created %d index entries",
-                 i, p_index->i_size );
+        if( p_index->p_super )
+            msg_Dbg( p_demux, "stream[%d] created %d index entries, "
+                     "%"PRIu32" subindexes pending", i, p_index->i_size,
+                     p_index->p_super->i_entriesinuse - p_index->i_super );
+        else
+            msg_Dbg( p_demux, "stream[%d] created %d index entries",
+                     i, p_index->i_size );
     }
 }
 
+/* Opens the file again, for the index scan not to move the stream being
+ * played back, which would drop its buffer at every slice */
+static stream_t *AVI_IndexStreamOpen( demux_t *p_demux )
+{
+    const uint8_t *p_peek, *p_index_peek;
+
+    if( p_demux->psz_url == NULL || strncmp( p_demux->psz_url, "file://", 7 ) )
+        return NULL;
+
+    stream_t *s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( s == NULL )
+        return NULL;
+
+    /* check this is the same data, not filtered differently */
+    if( stream_Size( s ) != stream_Size( p_demux->s ) ||
+        vlc_stream_Peek( s, &p_index_peek, 12 ) < 12 ||
+        vlc_stream_Peek( p_demux->s, &p_peek, 12 ) < 12 ||
+        memcmp( p_peek, p_index_peek, 12 ) )
+    {
+        vlc_stream_Delete( s );
+        return NULL;
+    }
+    return s;
+}
+
+/* The index is built by the incremental index scan, see AVI_IndexScan() */
 static void AVI_IndexCreate( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -2589,12 +2845,6 @@ static void AVI_IndexCreate( demux_t *p_demux )
     avi_chunk_list_t *p_riff;
     avi_chunk_list_t *p_movi;
 
-    unsigned int i_stream;
-    uint32_t i_movi_end;
-
-    vlc_tick_t i_dialog_update;
-    vlc_dialog_id *p_dialog_id = NULL;
-
     p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
     p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0, true );
 
@@ -2604,46 +2854,63 @@ static void AVI_IndexCreate( demux_t *p_demux )
         return;
     }
 
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
-        avi_index_Init( &p_sys->track[i_stream]->idx );
+    for( unsigned i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+    {
+        avi_index_Clean( &p_sys->track[i_stream]->idx );
+        p_sys->track[i_stream]->i_idxposc = 0;
+        p_sys->track[i_stream]->i_idxposb = 0;
+    }
+    p_sys->i_movi_lastchunk_pos = 0;
 
-    i_movi_end = __MIN( (uint32_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
-                        stream_Size( p_demux->s ) );
+    if( p_sys->p_index_stream == NULL )
+        p_sys->p_index_stream = AVI_IndexStreamOpen( p_demux );
+    p_sys->i_index_scan = p_movi->i_chunk_pos + 12;
+    msg_Warn( p_demux, "creating index from LIST-movi incrementally%s",
+              p_sys->p_index_stream ? " on a separate stream" : "" );
+}
 
-    vlc_stream_Seek( p_demux->s, p_movi->i_chunk_pos + 12 );
-    msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
+/* Indexes the chunks following the last indexed one for a short while.
+ *
+ * This is not a background thread: it is called by the demuxer at every
+ * demux call until the end of the movi list is reached, as the stream and
+ * the index belong to the demux thread. The scan reads its own stream of the
+ * file if it could be opened. Otherwise it moves the demuxed stream back and
+ * forth, which costs I/O latency to the playback until the scan is over.
+ * Seeking past the scanned part parses the stream up to the target, as
+ * without any index. */
+static void AVI_IndexScan( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    stream_t *s = p_sys->p_index_stream ? p_sys->p_index_stream : p_demux->s;
+
+    avi_chunk_list_t *p_riff;
+    avi_chunk_list_t *p_movi;
 
+    uint64_t i_movi_end;
+    const vlc_tick_t i_deadline = vlc_tick_now() + VLC_TICK_FROM_MS(10);
 
-    /* Only show dialog if AVI is > 10MB */
-    i_dialog_update = vlc_tick_now();
-    if( stream_Size( p_demux->s ) > 10000000 )
+    p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
+    p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0, true );
+    i_movi_end = __MIN( p_movi->i_chunk_pos + p_movi->i_chunk_size,
+                        (uint64_t) stream_Size( s ) );
+
+    /* the demuxer may have indexed chunks past the scan already */
+    if( p_sys->i_movi_lastchunk_pos >= p_sys->i_index_scan )
     {
-        p_dialog_id =
-            vlc_dialog_display_progress( p_demux, false, 0.0, _("Cancel"),
-                                         _("Broken or missing AVI Index"),
-                                         _("Fixing AVI Index...") );
+        if( vlc_stream_Seek( s, p_sys->i_movi_lastchunk_pos ) ||
+            AVI_PacketNext( s ) )
+            goto done;
     }
+    else if( vlc_stream_Tell( s ) != p_sys->i_index_scan &&
+             vlc_stream_Seek( s, p_sys->i_index_scan ) )
+        goto done;
 
-    for( ;; )
+    while( vlc_tick_now() < i_deadline )
     {
         avi_packet_t pk;
 
-        /* Don't update/check dialog too often */
-        if( p_dialog_id != NULL && vlc_tick_now() - i_dialog_update > VLC_TICK_FROM_MS(100) )
-        {
-            if( vlc_dialog_is_cancelled( p_demux, p_dialog_id ) )
-                break;
-
-            double f_current = vlc_stream_Tell( p_demux->s );
-            double f_size    = stream_Size( p_demux->s );
-            double f_pos     = f_current / f_size;
-            vlc_dialog_update_progress( p_demux, p_dialog_id, f_pos );
-
-            i_dialog_update = vlc_tick_now();
-        }
-
-        if( AVI_PacketGetHeader( p_demux, &pk ) )
-            break;
+        if( AVI_PacketGetHeader( s, &pk ) )
+            goto done;
 
         if( pk.i_stream < p_sys->i_track &&
             pk.i_cat == p_sys->track[pk.i_stream]->fmt.i_cat )
@@ -2651,11 +2918,9 @@ static void AVI_IndexCreate( demux_t *p_demux )
             avi_track_t *tk = p_sys->track[pk.i_stream];
 
             avi_entry_t index;
-            index.i_id      = pk.i_fourcc;
             index.i_flags   = AVI_GetKeyFlag(tk->fmt.i_codec, pk.i_peek);
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
-            index.i_lengthtotal = pk.i_size;
             avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
         }
         else
@@ -2670,12 +2935,12 @@ static void AVI_IndexCreate( demux_t *p_demux )
                                             AVIFOURCC_RIFF, 1, true );
 
                     msg_Dbg( p_demux, "looking for new RIFF chunk" );
-                    if( !p_sysx || vlc_stream_Seek( p_demux->s,
+                    if( !p_sysx || vlc_stream_Seek( s,
                                          p_sysx->i_chunk_pos + 24 ) )
-                        goto print_stat;
-                    break;
+                        goto done;
+                    continue;
                 }
-                goto print_stat;
+                goto done;
 
             case AVIFOURCC_RIFF:
                     msg_Dbg( p_demux, "new RIFF chunk found" );
@@ -2687,30 +2952,37 @@ static void AVI_IndexCreate( demux_t *p_demux )
 
             default:
                 msg_Warn( p_demux, "need resync, probably broken avi" );
-                if( AVI_PacketSearch( p_demux ) )
+                if( AVI_PacketSearch( p_demux, s ) )
                 {
                     msg_Warn( p_demux, "lost sync, abord index creation" );
-                    goto print_stat;
+                    goto done;
                 }
+                continue;
             }
         }
 
         if( ( !p_sys->b_odml && pk.i_pos + pk.i_size >= i_movi_end ) ||
-            AVI_PacketNext( p_demux ) )
+            AVI_PacketNext( s ) )
         {
-            break;
+            goto done;
         }
     }
+    p_sys->i_index_scan = vlc_stream_Tell( s );
+    return;
 
-print_stat:
-    if( p_dialog_id != NULL )
-        vlc_dialog_release( p_demux, p_dialog_id );
-
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+done:
+    p_sys->i_index_scan = 0;
+    if( p_sys->p_index_stream )
+    {
+        vlc_stream_Delete( p_sys->p_index_stream );
+        p_sys->p_index_stream = NULL;
+    }
+    for( unsigned i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
     {
-        msg_Dbg( p_demux, "stream[%d] creating %d index entries",
+        msg_Dbg( p_demux, "stream[%d] created %d index entries",
                 i_stream, p_sys->track[i_stream]->idx.i_size );
     }
+    p_sys->i_length = AVI_MovieGetLength( p_demux );
 }
 
 /* */
@@ -2973,7 +3245,7 @@ static int AVI_TrackStopFinishedStreams( demux_t *p_demux )
     for( i = 0; i < p_sys->i_track; i++ )
     {
         avi_track_t *tk = p_sys->track[i];
-        if( tk->i_idxposc >= tk->idx.i_size )
+        if( !AVI_IndexNeed( p_demux, tk, tk->i_idxposc ) )
         {
             tk->b_eof = true;
         }
@@ -3000,21 +3272,12 @@ static vlc_tick_t  AVI_MovieGetLength( demux_t *p_demux )
         vlc_tick_t i_length;
 
         /* fix length for each stream */
-        if( tk->idx.i_size < 1 || !tk->idx.p_entry )
+        if( tk->idx.i_size < 1 )
         {
             continue;
         }
 
-        if( tk->i_samplesize )
-        {
-            i_length = AVI_GetDPTS( tk,
-                                    tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal +
-                                        tk->idx.p_entry[tk->idx.i_size-1].i_length );
-        }
-        else
-        {
-            i_length = AVI_GetDPTS( tk, tk->idx.i_size );
-        }
+        i_length = AVI_GetDPTS( tk, AVI_IndexTotal( tk ) );
 
         msg_Dbg( p_demux,
                  "stream[%d] length:%"PRId64" (based on index)",
@@ -114,7 +114,9 @@ bool DASHManager::updatePlaylist()
             return false;
         }
 
+        TimelineElementHandler timelineHandler;
         xml::DOMParser parser(mpdstream);
+        parser.setElementHandler(&timelineHandler);
         if(!parser.parse(true))
         {
             vlc_stream_Delete(mpdstream);
@@ -124,6 +126,7 @@ bool DASHManager::updatePlaylist()
 
         IsoffMainParser mpdparser(parser.getRootNode(), VLC_OBJECT(p_demux),
                                   mpdstream, Helper::getDirectoryPath(url).append("/"));
+        mpdparser.setTimelineHandler(&timelineHandler);
         MPD *newmpd = mpdparser.parse();
         if(newmpd)
         {
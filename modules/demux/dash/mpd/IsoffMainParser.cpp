@@ -58,12 +58,18 @@ IsoffMainParser::IsoffMainParser    (Node *root_, vlc_object_t *p_object_,
     p_stream = stream;
     p_object = p_object_;
     playlisturl = streambaseurl_;
+    timelineHandler = NULL;
 }
 
 IsoffMainParser::~IsoffMainParser   ()
 {
 }
 
+void IsoffMainParser::setTimelineHandler(const TimelineElementHandler *h)
+{
+    timelineHandler = h;
+}
+
 template <class T>
 static void parseAvailability(MPD *mpd, Node *node, T *s)
 {
@@ -98,6 +104,7 @@ MPD * IsoffMainParser::parse()
     {
         parseMPDAttributes(mpd, root);
         parseProgramInformation(DOMHelper::getFirstChildElementByName(root, "ProgramInformation"), mpd);
+        parseServiceDescription(DOMHelper::getFirstChildElementByName(root, "ServiceDescription"), mpd);
         parseMPDBaseUrl(mpd, root);
         parsePeriods(mpd, root);
         mpd->debug();
@@ -494,28 +501,42 @@ void IsoffMainParser::parseTimeline(Node *node, MediaSegmentTemplate *templ)
     SegmentTimeline *timeline = new (std::nothrow) SegmentTimeline(templ);
     if(timeline)
     {
-        std::vector<Node *> elements = DOMHelper::getElementByTagName(node, "S", false);
-        std::vector<Node *>::const_iterator it;
-        for(it = elements.begin(); it != elements.end(); ++it)
+        const std::vector<TimelineElementHandler::Entry> *entries = NULL;
+        std::vector<TimelineElementHandler::Entry> domentries;
+        if(timelineHandler)
+            entries = timelineHandler->getEntries(node);
+        if(!entries)
         {
-            const Node *s = *it;
-            if(!s->hasAttribute("d")) /* Mandatory */
-                continue;
-            stime_t d = Integer<stime_t>(s->getAttributeValue("d"));
-            int64_t r = 0; // never repeats by default
-            if(s->hasAttribute("r"))
+            std::vector<Node *> elements = DOMHelper::getElementByTagName(node, "S", false);
+            std::vector<Node *>::const_iterator it;
+            for(it = elements.begin(); it != elements.end(); ++it)
             {
-                r = Integer<int64_t>(s->getAttributeValue("r"));
-                if(r < 0)
-                    r = std::numeric_limits<unsigned>::max();
+                const Node *s = *it;
+                if(!s->hasAttribute("d")) /* Mandatory */
+                    continue;
+                stime_t d = Integer<stime_t>(s->getAttributeValue("d"));
+                int64_t r = 0; // never repeats by default
+                if(s->hasAttribute("r"))
+                    r = Integer<int64_t>(s->getAttributeValue("r"));
+                stime_t t = 0;
+                if(s->hasAttribute("t"))
+                    t = Integer<stime_t>(s->getAttributeValue("t"));
+                domentries.push_back(TimelineElementHandler::Entry(t, d, r, s->hasAttribute("t")));
             }
+            entries = &domentries;
+        }
 
-            if(s->hasAttribute("t"))
-            {
-                stime_t t = Integer<stime_t>(s->getAttributeValue("t"));
-                timeline->addElement(number, d, r, t);
-            }
-            else timeline->addElement(number, d, r);
+        std::vector<TimelineElementHandler::Entry>::const_iterator it;
+        for(it = entries->begin(); it != entries->end(); ++it)
+        {
+            uint64_t r = (*it).r;
+            if((*it).r < 0)
+                r = std::numeric_limits<unsigned>::max();
+
+            if((*it).hasTime)
+                timeline->addElement(number, (*it).d, r, (*it).t);
+            else
+                timeline->addElement(number, (*it).d, r);
 
             number += (1 + r);
         }
@@ -523,6 +544,20 @@ void IsoffMainParser::parseTimeline(Node *node, MediaSegmentTemplate *templ)
     }
 }
 
+void IsoffMainParser::parseServiceDescription(Node *node, MPD *mpd)
+{
+    if(!node)
+        return;
+
+    /* Low latency DASH target, in milliseconds */
+    Node *latency = DOMHelper::getFirstChildElementByName(node, "Latency");
+    if(latency && latency->hasAttribute("target"))
+    {
+        uint64_t target = Integer<uint64_t>(latency->getAttributeValue("target"));
+        mpd->targetLatency.Set(VLC_TICK_FROM_MS(target));
+    }
+}
+
 void IsoffMainParser::parseProgramInformation(Node * node, MPD *mpd)
 {
     if(!node)
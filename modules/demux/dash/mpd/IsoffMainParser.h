@@ -30,6 +30,7 @@
 #endif
 
 #include "../../adaptive/playlist/SegmentInfoCommon.h"
+#include "TimelineElementHandler.h"
 #include "Profile.hpp"
 
 #include <cstdlib>
@@ -43,10 +44,6 @@ namespace adaptive
         class SegmentInformation;
         class MediaSegmentTemplate;
     }
-    namespace xml
-    {
-        class Node;
-    }
 }
 
 namespace dash
@@ -67,6 +64,7 @@ namespace dash
                                              stream_t *p_stream, const std::string &);
                 virtual ~IsoffMainParser    ();
                 MPD *   parse();
+                void    setTimelineHandler  (const TimelineElementHandler *);
 
             private:
                 mpd::Profile getProfile     () const;
@@ -82,11 +80,13 @@ namespace dash
                 size_t  parseSegmentList    (MPD *, xml::Node *, SegmentInformation *);
                 size_t  parseSegmentTemplate(MPD *, xml::Node *, SegmentInformation *);
                 void    parseProgramInformation(xml::Node *, MPD *);
+                void    parseServiceDescription(xml::Node *, MPD *);
 
                 xml::Node       *root;
                 vlc_object_t    *p_object;
                 stream_t        *p_stream;
                 std::string      playlisturl;
+                const TimelineElementHandler *timelineHandler;
         };
     }
 }
@@ -0,0 +1,81 @@
+/*****************************************************************************
+ * TimelineElementHandler.cpp: SegmentTimeline entries collector
+ *****************************************************************************
+ * Copyright (C) 2020 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "TimelineElementHandler.h"
+#include "../../adaptive/xml/Node.h"
+
+#include <vlc_common.h>
+#include <vlc_xml.h>
+#include <cstdlib>
+#include <cstring>
+
+using namespace dash::mpd;
+using namespace adaptive::xml;
+
+TimelineElementHandler::Entry::Entry(stime_t t_, stime_t d_, int64_t r_, bool hasTime_)
+{
+    t = t_;
+    d = d_;
+    r = r_;
+    hasTime = hasTime_;
+}
+
+bool TimelineElementHandler::handleElement(Node *parent, const char *name,
+                                           xml_reader_t *reader)
+{
+    if(strcmp(name, "S") || parent->getName() != "SegmentTimeline")
+        return false;
+
+    Entry entry(0, 0, 0, false);
+    const char *attr, *value;
+    while((attr = xml_ReaderNextAttr(reader, &value)) != NULL)
+    {
+        if(!strcmp(attr, "t"))
+        {
+            entry.t = strtoll(value, NULL, 10);
+            entry.hasTime = true;
+        }
+        else if(!strcmp(attr, "d"))
+            entry.d = strtoll(value, NULL, 10);
+        else if(!strcmp(attr, "r"))
+            entry.r = strtoll(value, NULL, 10);
+    }
+
+    if(entry.d <= 0) /* Mandatory */
+        return true;
+
+    std::vector<Entry> &list = entries[parent];
+    if(!list.empty() && !entry.hasTime && entry.r >= 0 &&
+       list.back().d == entry.d && list.back().r >= 0)
+        list.back().r += entry.r + 1;
+    else
+        list.push_back(entry);
+    return true;
+}
+
+const std::vector<TimelineElementHandler::Entry> *
+TimelineElementHandler::getEntries(const Node *node) const
+{
+    std::map<const Node *, std::vector<Entry> >::const_iterator it = entries.find(node);
+    return (it != entries.end()) ? &(*it).second : NULL;
+}
@@ -0,0 +1,59 @@
+/*****************************************************************************
+ * TimelineElementHandler.h: SegmentTimeline entries collector
+ *****************************************************************************
+ * Copyright (C) 2020 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef TIMELINEELEMENTHANDLER_H_
+#define TIMELINEELEMENTHANDLER_H_
+
+#include "../../adaptive/xml/DOMParser.h"
+#include "../../adaptive/Time.hpp"
+
+#include <map>
+#include <vector>
+
+namespace dash
+{
+    namespace mpd
+    {
+        using namespace adaptive;
+
+        /* Stores SegmentTimeline S entries while the MPD is being read,
+         * run length merged, instead of one DOM Node per segment */
+        class TimelineElementHandler : public xml::ElementHandler
+        {
+            public:
+                class Entry
+                {
+                    public:
+                        Entry(stime_t, stime_t, int64_t, bool);
+                        stime_t t;
+                        stime_t d;
+                        int64_t r;
+                        bool    hasTime;
+                };
+                /* impl */
+                virtual bool handleElement(xml::Node *, const char *, xml_reader_t *);
+                const std::vector<Entry> * getEntries(const xml::Node *) const;
+
+            private:
+                std::map<const xml::Node *, std::vector<Entry> > entries;
+        };
+    }
+}
+
+#endif /* TIMELINEELEMENTHANDLER_H_ */
@@ -67,6 +67,11 @@ bool M3U8::isLive() const
     return b_live;
 }
 
+bool M3U8::isLowLatency() const
+{
+    return targetLatency.Get() != 0;
+}
+
 void M3U8::debug()
 {
     std::vector<BasePeriod *>::const_iterator i;
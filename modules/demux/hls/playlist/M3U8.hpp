@@ -36,6 +36,7 @@ namespace hls
                 virtual ~M3U8();
 
                 virtual bool                    isLive() const;
+                virtual bool                    isLowLatency() const;
                 virtual void                    debug();
 
             private:
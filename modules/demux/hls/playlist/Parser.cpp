@@ -304,6 +304,27 @@ void M3U8Parser::parseSegments(vlc_object_t *, Representation *rep, const std::l
                 rep->targetDuration = static_cast<const SingleValueTag *>(tag)->getValue().decimal();
                 break;
 
+            /* Low latency HLS: partial segments are not fetched, but the
+             * playlist latency target is honored */
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const Attribute *holdBack = static_cast<const AttributesTag *>(tag)->
+                                            getAttributeByName("PART-HOLD-BACK");
+                if(holdBack)
+                    rep->getPlaylist()->targetLatency.Set(vlc_tick_from_sec(holdBack->floatingPoint()));
+            }
+            break;
+
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *partTarget = static_cast<const AttributesTag *>(tag)->
+                                              getAttributeByName("PART-TARGET");
+                /* PART-HOLD-BACK is at least three times the part duration */
+                if(partTarget && rep->getPlaylist()->targetLatency.Get() == 0)
+                    rep->getPlaylist()->targetLatency.Set(3 * vlc_tick_from_sec(partTarget->floatingPoint()));
+            }
+            break;
+
             case SingleValueTag::EXTXPLAYLISTTYPE:
                 rep->b_live = (static_cast<const SingleValueTag *>(tag)->getValue().value != "VOD");
                 break;
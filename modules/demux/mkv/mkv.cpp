@@ -53,6 +53,7 @@ vlc_module_begin ()
     set_description( N_("Matroska stream demuxer" ) )
     set_capability( "demux", 50 )
     set_callbacks( Open, Close )
+    add_signature( 0, "\x1A\x45\xDF\xA3" ) /* EBML header */
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
 
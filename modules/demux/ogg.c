@@ -56,6 +56,11 @@
 static int  Open ( vlc_object_t * );
 static void Close( vlc_object_t * );
 
+#define SEEK_CACHE_TEXT N_("Remember seek positions")
+#define SEEK_CACHE_LONGTEXT N_( \
+    "Keep the positions found while playing and seeking in a file in the " \
+    "cache directory, so that later seeks in the same file are faster." )
+
 vlc_module_begin ()
     set_shortname ( "OGG" )
     set_description( N_("OGG demuxer" ) )
@@ -64,6 +69,8 @@ vlc_module_begin ()
     set_capability( "demux", 50 )
     set_callbacks( Open, Close )
     add_shortcut( "ogg" )
+    add_bool( "ogg-seek-cache", true,
+              SEEK_CACHE_TEXT, SEEK_CACHE_LONGTEXT, true )
 vlc_module_end ()
 
 
@@ -237,6 +244,7 @@ static int Open( vlc_object_t * p_this )
 
     p_sys->i_length = -1;
     p_sys->b_preparsing_done = false;
+    vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &p_sys->b_seekable );
 
     /* Set exported functions */
     p_demux->pf_demux = Demux;
@@ -397,6 +405,10 @@ static int Demux( demux_t * p_demux )
 
             vlc_tick_t i_lastdts = Ogg_GetLastDTS( p_demux );
 
+            /* The index is saved with the serial numbers of the streams,
+             * before they are moved away */
+            Oggseek_IndexSave( p_demux );
+
             /* We keep the ES to try reusing it in Ogg_BeginningOfStream
              * only 1 ES is supported (common case for ogg web radio) */
             if( p_sys->i_streams == 1 && p_sys->pp_stream[0]->p_es )
@@ -429,7 +441,10 @@ static int Demux( demux_t * p_demux )
             /* Find the real duration */
             vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_canseek );
             if ( b_canseek )
+            {
                 Oggseek_ProbeEnd( p_demux );
+                Oggseek_IndexLoad( p_demux );
+            }
         }
         else
         {
@@ -461,6 +476,14 @@ static int Demux( demux_t * p_demux )
          */
         if( Ogg_ReadPage( p_demux, &p_sys->current_page ) != VLC_SUCCESS )
             return VLC_DEMUXER_EOF; /* EOF */
+
+        /* Remember where the page starts, for later seeks */
+        if( p_sys->b_seekable )
+            OggSeek_IndexPage( p_demux, &p_sys->current_page,
+                               vlc_stream_Tell( p_demux->s )
+                               - ( p_sys->oy.fill - p_sys->oy.returned )
+                               - p_sys->current_page.header_len
+                               - p_sys->current_page.body_len );
         /* Test for End of Stream */
         if( ogg_page_eos( &p_sys->current_page ) )
         {
@@ -2204,6 +2227,7 @@ static int Ogg_BeginningOfStream( demux_t *p_demux )
 
         /* initialise kframe index */
         p_stream->idx=NULL;
+        p_stream->i_idx = p_stream->i_idx_max = 0;
 
         if ( p_stream->fmt.i_bitrate == 0  &&
              ( p_stream->fmt.i_cat == VIDEO_ES ||
@@ -2230,6 +2254,10 @@ static void Ogg_EndOfStream( demux_t *p_demux )
     demux_sys_t *p_ogg = p_demux->p_sys  ;
     int i_stream;
 
+    /* Only the first group of streams is indexed */
+    Oggseek_IndexSave( p_demux );
+    p_ogg->b_index_cache = false;
+
     for( i_stream = 0 ; i_stream < p_ogg->i_streams; i_stream++ )
         Ogg_LogicalStreamDelete( p_demux, p_ogg->pp_stream[i_stream] );
     free( p_ogg->pp_stream );
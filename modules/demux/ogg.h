@@ -94,6 +94,8 @@ typedef struct logical_stream_s
 
     /* keyframe index for seeking, created as we discover keyframes */
     demux_index_entry_t *idx;
+    size_t i_idx;
+    size_t i_idx_max;
 
     /* Skeleton data */
     ogg_skeleton_t *p_skel;
@@ -222,6 +224,11 @@ typedef struct
     /* Length in second, if available. */
     int64_t i_length;
 
+    /* seek index of the current streams, persisted in the cache directory */
+    bool b_seekable;
+    bool b_index_cache;
+    bool b_index_dirty;
+
     bool b_slave;
 
 } demux_sys_t;
@@ -35,12 +35,21 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_configuration.h>
 #include <vlc_demux.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_memstream.h>
+#include <vlc_strings.h>
 
 #include <ogg/ogg.h>
 #include <limits.h>
 
 #include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "ogg.h"
 #include "oggseek.h"
@@ -60,115 +69,428 @@ typedef struct packetStartCoordinates
 * index entries
 *************************************************************/
 
-/* free all entries in index list */
+#define OGGSEEK_CACHE_DIR   "ogg"
+#define OGGSEEK_CACHE_MAGIC "VLC ogg seek index 1"
+/* the least recently played files are forgotten beyond these bounds */
+#define OGGSEEK_CACHE_MAX_FILES 256
+#define OGGSEEK_CACHE_MAX_AGE   (90 * 24 * 3600)
+
+/* free all entries in index */
 
 void oggseek_index_entries_free ( demux_index_entry_t *idx )
 {
-    demux_index_entry_t *idx_next;
+    free( idx );
+}
+
+/* returns the number of entries located before i_pagepos */
+
+static size_t OggSeekIndexLookup( const logical_stream_t *p_stream,
+                                  int64_t i_pagepos )
+{
+    size_t i_low = 0;
+    size_t i_high = p_stream->i_idx;
 
-    while ( idx != NULL )
+    while ( i_low < i_high )
     {
-        idx_next = idx->p_next;
-        free( idx );
-        idx = idx_next;
+        size_t i_mid = ( i_low + i_high ) / 2;
+        if ( p_stream->idx[i_mid].i_pagepos < i_pagepos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
+    return i_low;
 }
 
+/* We insert into index, sorting by pagepos (as a page can match multiple
+   time stamps). Entries which would break the time ordering are ignored. */
+bool OggSeek_IndexAdd ( logical_stream_t *p_stream,
+                        vlc_tick_t i_timestamp,
+                        int64_t i_pagepos )
+{
+    if ( p_stream == NULL ) return false;
+
+    if ( i_timestamp == VLC_TICK_INVALID || i_pagepos < 1 ) return false;
 
-/* internal function to create a new list member */
+    size_t i = OggSeekIndexLookup( p_stream, i_pagepos );
 
-static demux_index_entry_t *index_entry_new( void )
-{
-    demux_index_entry_t *idx = xmalloc( sizeof( demux_index_entry_t ) );
-    if ( !idx ) return NULL;
-    idx->p_next = idx->p_prev = NULL;
-    idx->i_pagepos_end = -1;
-    return idx;
+    if ( i < p_stream->i_idx && ( p_stream->idx[i].i_pagepos == i_pagepos ||
+                                  p_stream->idx[i].i_value < i_timestamp ) )
+        return false;
+    if ( i > 0 && p_stream->idx[i - 1].i_value > i_timestamp )
+        return false;
+
+    if ( p_stream->i_idx == p_stream->i_idx_max )
+    {
+        size_t i_max = p_stream->i_idx_max ? p_stream->i_idx_max * 2 : 64;
+        demux_index_entry_t *p_realloc =
+            realloc( p_stream->idx, i_max * sizeof( *p_realloc ) );
+        if ( !p_realloc ) return false;
+        p_stream->idx = p_realloc;
+        p_stream->i_idx_max = i_max;
+    }
+
+    memmove( &p_stream->idx[i + 1], &p_stream->idx[i],
+             ( p_stream->i_idx - i ) * sizeof( *p_stream->idx ) );
+    p_stream->idx[i].i_value = i_timestamp;
+    p_stream->idx[i].i_pagepos = i_pagepos;
+    p_stream->i_idx++;
+
+    return true;
 }
 
-/* We insert into index, sorting by pagepos (as a page can match multiple
-   time stamps) */
-const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
-                                             vlc_tick_t i_timestamp,
-                                             int64_t i_pagepos )
+/* Records the position of a page with a known granule, for codecs where
+   every packet can be decoded on its own */
+static void OggSeekIndexGranule( demux_sys_t *p_sys, logical_stream_t *p_stream,
+                                 int64_t i_granule, int64_t i_pagepos )
 {
-    demux_index_entry_t *idx;
-    demux_index_entry_t *last_idx = NULL;
+    if ( i_granule <= 0 || p_stream->b_oggds ||
+         Ogg_GetKeyframeGranule( p_stream, 0xFF00FF00 ) != 0xFF00FF00 )
+        return;
 
-    if ( p_stream == NULL ) return NULL;
+    vlc_tick_t i_time = Ogg_GranuleToTime( p_stream, i_granule,
+                                           !p_stream->b_contiguous, false );
+    if ( i_time == VLC_TICK_INVALID )
+        return;
 
-    idx = p_stream->idx;
+    /* Keep the index sparse */
+    size_t i = OggSeekIndexLookup( p_stream, i_pagepos );
+    if ( i > 0 && i_time - p_stream->idx[i - 1].i_value < OGGSEEK_INDEX_SPACING )
+        return;
+    if ( i < p_stream->i_idx &&
+         p_stream->idx[i].i_value - i_time < OGGSEEK_INDEX_SPACING )
+        return;
 
-    if ( i_timestamp == VLC_TICK_INVALID || i_pagepos < 1 ) return NULL;
+    if ( OggSeek_IndexAdd( p_stream, i_time, i_pagepos ) )
+        p_sys->b_index_dirty = true;
+}
 
-    if ( idx == NULL )
+void OggSeek_IndexPage( demux_t *p_demux, const ogg_page *p_page,
+                        int64_t i_pagepos )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for ( int i = 0; i < p_sys->i_streams; i++ )
     {
-        demux_index_entry_t *ie = index_entry_new();
-        if ( !ie ) return NULL;
-        ie->i_value = i_timestamp;
-        ie->i_pagepos = i_pagepos;
-        p_stream->idx = ie;
-        return ie;
+        logical_stream_t *p_stream = p_sys->pp_stream[i];
+        if ( p_stream->i_serial_no != ogg_page_serialno( p_page ) )
+            continue;
+        if ( !p_stream->b_force_backup && i_pagepos >= p_stream->i_data_start )
+            OggSeekIndexGranule( p_sys, p_stream,
+                                 ogg_page_granulepos( p_page ), i_pagepos );
+        break;
     }
+}
+
+/* Finds the entries around i_timestamp. The lower bound is set if an entry
+   is at or before the timestamp, the upper one if an entry is after it.
+   pi_span is set to the time between both bounds, if both are known. */
+static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestamp,
+                               int64_t *pi_pos_lower, int64_t *pi_pos_upper,
+                               vlc_tick_t *pi_span )
+{
+    size_t i_low = 0;
+    size_t i_high = p_stream->i_idx;
 
-    while ( idx != NULL )
+    /* entries values are sorted too */
+    while ( i_low < i_high )
     {
-        if ( idx->i_pagepos > i_pagepos ) break;
-        last_idx = idx;
-        idx = idx->p_next;
+        size_t i_mid = ( i_low + i_high ) / 2;
+        if ( p_stream->idx[i_mid].i_value <= i_timestamp )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
 
-    /* new entry; insert after last_idx */
-    idx = index_entry_new();
-    if ( !idx ) return NULL;
-    if ( last_idx != NULL )
+    *pi_span = INT64_MAX;
+    if ( i_low < p_stream->i_idx )
+        *pi_pos_upper = p_stream->idx[i_low].i_pagepos;
+    if ( i_low == 0 )
+        return false;
+
+    *pi_pos_lower = p_stream->idx[i_low - 1].i_pagepos;
+    if ( i_low < p_stream->i_idx )
+        *pi_span = p_stream->idx[i_low].i_value - p_stream->idx[i_low - 1].i_value;
+    return true;
+}
+
+/* The cache file is named after the stream location, and starts with the
+   stream size and the serial numbers of its logical streams. Each following
+   line is an entry: "serial time position". */
+
+static char *OggSeekCachePath( demux_t *p_demux )
+{
+    if ( p_demux->psz_url == NULL )
+        return NULL;
+
+    char *psz_dir = config_GetUserDir( VLC_CACHE_DIR );
+    if ( psz_dir == NULL )
+        return NULL;
+
+    vlc_hash_md5_t md5;
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, p_demux->psz_url, strlen( p_demux->psz_url ) );
+    vlc_hash_FinishHex( &md5, psz_hash );
+
+    char *psz_path;
+    if ( asprintf( &psz_path, "%s"DIR_SEP OGGSEEK_CACHE_DIR DIR_SEP"%s",
+                   psz_dir, psz_hash ) == -1 )
+        psz_path = NULL;
+    free( psz_dir );
+    return psz_path;
+}
+
+static char *OggSeekCacheHeader( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    struct vlc_memstream header;
+
+    vlc_memstream_open( &header );
+    vlc_memstream_printf( &header, OGGSEEK_CACHE_MAGIC" %"PRId64,
+                          p_sys->i_total_length );
+    for ( int i = 0; i < p_sys->i_streams; i++ )
+        vlc_memstream_printf( &header, " %"PRIu32,
+                              (uint32_t) p_sys->pp_stream[i]->i_serial_no );
+    vlc_memstream_putc( &header, '\n' );
+    return vlc_memstream_close( &header ) ? NULL : header.ptr;
+}
+
+void Oggseek_IndexLoad( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    p_sys->b_index_cache = false;
+    p_sys->b_index_dirty = false;
+
+    if ( p_sys->i_total_length <= 0 || p_sys->i_streams == 0 ||
+         !var_InheritBool( p_demux, "ogg-seek-cache" ) )
+        return;
+
+    char *psz_path = OggSeekCachePath( p_demux );
+    if ( psz_path == NULL )
+        return;
+    p_sys->b_index_cache = true;
+
+    FILE *file = vlc_fopen( psz_path, "rt" );
+    if ( file == NULL )
+        goto out;
+
+    char *psz_header = OggSeekCacheHeader( p_demux );
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    unsigned count = 0;
+
+    /* Ignore the entries if the stream changed */
+    if ( psz_header == NULL || getline( &line, &len, file ) <= 0 ||
+         strcmp( line, psz_header ) )
     {
-        idx->p_next = last_idx->p_next;
-        last_idx->p_next = idx;
-        idx->p_prev = last_idx;
+        msg_Dbg( p_demux, "ignoring stale seek index %s", psz_path );
+        goto error;
     }
-    else
+
+    while ( ( read = getline( &line, &len, file ) ) > 0 )
     {
-        idx->p_next = p_stream->idx;
-        p_stream->idx = idx;
+        uint32_t i_serial;
+        int64_t i_time, i_pagepos;
+
+        if ( sscanf( line, "%"SCNu32" %"SCNd64" %"SCNd64,
+                     &i_serial, &i_time, &i_pagepos ) != 3 ||
+             i_pagepos >= p_sys->i_total_length )
+            continue;
+
+        for ( int i = 0; i < p_sys->i_streams; i++ )
+        {
+            logical_stream_t *p_stream = p_sys->pp_stream[i];
+            if ( (uint32_t) p_stream->i_serial_no == i_serial )
+            {
+                if ( i_pagepos >= p_stream->i_data_start &&
+                     OggSeek_IndexAdd( p_stream, i_time, i_pagepos ) )
+                    count++;
+                break;
+            }
+        }
     }
 
-    if ( idx->p_next != NULL )
+    msg_Dbg( p_demux, "loaded %u entries from seek index %s", count, psz_path );
+    /* written back on close, so that it is kept as recently used */
+    p_sys->b_index_dirty = count > 0;
+error:
+    free( psz_header );
+    free( line );
+    fclose( file );
+out:
+    free( psz_path );
+}
+
+static int OggSeekCacheSaveEntries( demux_t *p_demux, FILE *file )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    char *psz_header = OggSeekCacheHeader( p_demux );
+    if ( psz_header == NULL )
+        return -1;
+    int i_ret = fputs( psz_header, file );
+    free( psz_header );
+    if ( i_ret == EOF )
+        return -1;
+
+    for ( int i = 0; i < p_sys->i_streams; i++ )
     {
-        idx->p_next->p_prev = idx;
+        const logical_stream_t *p_stream = p_sys->pp_stream[i];
+        for ( size_t j = 0; j < p_stream->i_idx; j++ )
+            if ( fprintf( file, "%"PRIu32" %"PRId64" %"PRId64"\n",
+                          (uint32_t) p_stream->i_serial_no,
+                          p_stream->idx[j].i_value,
+                          p_stream->idx[j].i_pagepos ) < 0 )
+                return -1;
     }
 
-    idx->i_value = i_timestamp;
-    idx->i_pagepos = i_pagepos;
+    return fflush( file ) ? -1 : 0;
+}
+
+struct oggseek_cache_file
+{
+    time_t i_mtime;
+    char *psz_path;
+};
 
-    return idx;
+static int OggSeekCacheFileCmp( const void *a, const void *b )
+{
+    const struct oggseek_cache_file *fa = a, *fb = b;
+    /* most recent first */
+    return ( fa->i_mtime < fb->i_mtime ) - ( fa->i_mtime > fb->i_mtime );
 }
 
-static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestamp,
-                               int64_t *pi_pos_lower, int64_t *pi_pos_upper )
+/* Removes the index files written too long ago, then the oldest ones
+ * beyond OGGSEEK_CACHE_MAX_FILES */
+static void OggSeekCachePrune( demux_t *p_demux, const char *psz_dir )
 {
-    demux_index_entry_t *idx = p_stream->idx;
+    DIR *dir = vlc_opendir( psz_dir );
+    if ( dir == NULL )
+        return;
+
+    struct oggseek_cache_file *p_files = NULL;
+    size_t i_files = 0, i_max = 0;
+    const char *psz_name;
 
-    while ( idx != NULL )
+    while ( ( psz_name = vlc_readdir( dir ) ) != NULL )
     {
-        if ( idx->i_value <= i_timestamp )
+        if ( psz_name[0] == '.' )
+            continue;
+
+        char *psz_path;
+        if ( asprintf( &psz_path, "%s"DIR_SEP"%s", psz_dir, psz_name ) == -1 )
+            break;
+
+        struct stat st;
+        if ( vlc_stat( psz_path, &st ) || !S_ISREG( st.st_mode ) )
         {
-            if ( !idx->p_next ) /* found on last index */
-            {
-                *pi_pos_lower = idx->i_pagepos;
-                return true;
-            }
-            if ( idx->p_next->i_value > i_timestamp )
+            free( psz_path );
+            continue;
+        }
+
+        if ( i_files == i_max )
+        {
+            size_t i_new = i_max ? 2 * i_max : 64;
+            struct oggseek_cache_file *p_new =
+                realloc( p_files, i_new * sizeof( *p_files ) );
+            if ( p_new == NULL )
             {
-                *pi_pos_lower = idx->i_pagepos;
-                *pi_pos_upper = idx->p_next->i_pagepos;
-                return true;
+                free( psz_path );
+                break;
             }
+            p_files = p_new;
+            i_max = i_new;
         }
-        idx = idx->p_next;
+        p_files[i_files].i_mtime = st.st_mtime;
+        p_files[i_files].psz_path = psz_path;
+        i_files++;
     }
+    closedir( dir );
 
-    return false;
+    if ( i_files > 0 )
+        qsort( p_files, i_files, sizeof( *p_files ), OggSeekCacheFileCmp );
+
+    const time_t i_oldest = time( NULL ) - OGGSEEK_CACHE_MAX_AGE;
+    unsigned i_removed = 0;
+    for ( size_t i = 0; i < i_files; i++ )
+    {
+        if ( i >= OGGSEEK_CACHE_MAX_FILES || p_files[i].i_mtime < i_oldest )
+        {
+            if ( vlc_unlink( p_files[i].psz_path ) == 0 )
+                i_removed++;
+        }
+        free( p_files[i].psz_path );
+    }
+    free( p_files );
+
+    if ( i_removed > 0 )
+        msg_Dbg( p_demux, "removed %u old seek indexes", i_removed );
+}
+
+void Oggseek_IndexSave( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if ( !p_sys->b_index_cache || !p_sys->b_index_dirty )
+        return;
+    p_sys->b_index_dirty = false;
+
+    char *psz_path = OggSeekCachePath( p_demux );
+    if ( psz_path == NULL )
+        return;
+
+    char *psz_tmp;
+    if ( asprintf( &psz_tmp, "%s.%"PRIu32, psz_path, (uint32_t)getpid() ) == -1 )
+    {
+        free( psz_path );
+        return;
+    }
+
+    char *psz_subdir = NULL;
+    char *psz_dir = config_GetUserDir( VLC_CACHE_DIR );
+    if ( psz_dir )
+    {
+        vlc_mkdir( psz_dir, 0700 );
+        if ( asprintf( &psz_subdir, "%s"DIR_SEP OGGSEEK_CACHE_DIR, psz_dir ) != -1 )
+            vlc_mkdir( psz_subdir, 0700 );
+        else
+            psz_subdir = NULL;
+    }
+    free( psz_dir );
+
+    FILE *file = vlc_fopen( psz_tmp, "wt" );
+    if ( file == NULL )
+    {
+        msg_Dbg( p_demux, "cannot create %s: %s", psz_tmp,
+                 vlc_strerror_c( errno ) );
+        goto out;
+    }
+
+    if ( OggSeekCacheSaveEntries( p_demux, file ) )
+    {
+        msg_Warn( p_demux, "cannot write %s: %s", psz_tmp,
+                  vlc_strerror_c( errno ) );
+        fclose( file );
+        vlc_unlink( psz_tmp );
+        goto out;
+    }
+
+#if !defined( _WIN32 ) && !defined( __OS2__ )
+    vlc_rename( psz_tmp, psz_path ); /* atomically replace old index */
+    fclose( file );
+#else
+    vlc_unlink( psz_path );
+    fclose( file );
+    vlc_rename( psz_tmp, psz_path );
+#endif
+    if ( psz_subdir )
+        OggSeekCachePrune( p_demux, psz_subdir );
+out:
+    free( psz_subdir );
+    free( psz_tmp );
+    free( psz_path );
 }
 
 /*********************************************************************
@@ -694,6 +1016,7 @@ static int64_t OggBisectSearchByTime( demux_t *p_demux, logical_stream_t *p_stre
         if ( current.i_pos != -1 && current.i_granule != -1 )
         {
             /* found a page */
+            OggSeekIndexGranule( p_sys, p_stream, current.i_granule, current.i_pos );
 
             if ( current.i_timestamp <= i_targettime )
             {
@@ -777,16 +1100,21 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
     demux_sys_t *p_sys  = p_demux->p_sys;
     int64_t i_lowerpos = -1;
     int64_t i_upperpos = -1;
+    vlc_tick_t i_span;
     bool b_found = false;
+    bool b_indexed = false;
 
     /* Search in skeleton */
     Ogg_GetBoundsUsingSkeletonIndex( p_stream, i_time, &i_lowerpos, &i_upperpos );
     if ( i_lowerpos != -1 ) b_found = true;
 
-    /* And also search in our own index */
-    if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos, &i_upperpos ) )
+    /* And also search in our own index, which can be used as is if its
+     * entries are close enough */
+    if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos,
+                                       &i_upperpos, &i_span ) )
     {
-        b_found = true;
+        b_indexed = true;
+        b_found = ( i_span <= 2 * OGGSEEK_INDEX_SPACING );
     }
 
     /* Or try to be smart with audio fixed bitrate streams */
@@ -796,17 +1124,28 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
         /* But only if there's no keyframe/preload requirements */
         /* FIXME: add function to get preload time by codec, ex: opus */
         i_lowerpos = VLC_TICK_0 + (i_time - VLC_TICK_0) * p_sys->i_bitrate / INT64_C(8000000);
+        i_upperpos = -1;
         b_found = true;
     }
 
-    /* or search */
+    /* or search, within the index bounds */
     if ( !b_found && b_fastseek )
     {
-        i_lowerpos = OggBisectSearchByTime( p_demux, p_stream, i_time,
-                                            p_stream->i_data_start, p_sys->i_total_length );
-        b_found = ( i_lowerpos != -1 );
+        int64_t i_pos = OggBisectSearchByTime( p_demux, p_stream, i_time,
+                            b_indexed ? i_lowerpos : p_stream->i_data_start,
+                            i_upperpos != -1 ? i_upperpos : p_sys->i_total_length );
+        if ( i_pos != -1 )
+        {
+            i_lowerpos = i_pos;
+            i_upperpos = -1;
+            b_found = true;
+        }
     }
 
+    /* or fall back to the nearest indexed position */
+    if ( !b_found && b_indexed )
+        b_found = true;
+
     if ( !b_found ) return -1;
 
     if ( i_lowerpos < p_stream->i_data_start || i_upperpos > p_sys->i_total_length )
@@ -889,8 +1228,9 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     }
     OggDebug( msg_Dbg( p_demux, "Search bounds set to %"PRId64" %"PRId64" using skeleton index", i_offset_lower, i_offset_upper ) );
 
+    vlc_tick_t i_span;
     OggNoDebug(
-        OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper )
+        OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper, &i_span )
     );
 
     i_offset_lower = __MAX( i_offset_lower, p_stream->i_data_start );
@@ -907,8 +1247,9 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     }
     /* Insert keyframe position into index */
     OggNoDebug(
-    if ( i_pagepos >= p_stream->i_data_start )
-        OggSeek_IndexAdd( p_stream, i_time, i_pagepos )
+    if ( i_pagepos >= p_stream->i_data_start &&
+         OggSeek_IndexAdd( p_stream, i_time, i_pagepos ) )
+        p_sys->b_index_dirty = true;
     );
 
     OggDebug( msg_Dbg( p_demux, "=================== Seeked To %"PRId64" time %"PRId64, i_pagepos, i_time ) );
@@ -722,4 +722,6 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 142 )
     set_callbacks( Open, Close )
+    add_signature( 0, "RIFF" )
+    add_signature( 0, "RF64" )
 vlc_module_end ()
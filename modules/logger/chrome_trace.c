@@ -0,0 +1,150 @@
+/*****************************************************************************
+ * chrome_trace.c: Chrome trace event format tracer
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * The output is a JSON array of trace events, as documented in the
+ * "Trace Event Format" specification, and can be loaded as is in
+ * chrome://tracing or in the Perfetto UI.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#define VLC_MODULE_LICENSE VLC_LICENSE_GPL_2_PLUS
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_tracer.h>
+
+#include <errno.h>
+#include <inttypes.h>
+
+typedef struct
+{
+    FILE *stream;
+    bool first;
+} vlc_tracer_sys_t;
+
+#define TRACE_FILENAME "vlc-trace.json"
+
+static void TraceJson(void *opaque, const struct vlc_tracer_event *ev)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    FILE *stream = sys->stream;
+    static const char phase[] = {
+        [VLC_TRACER_SPAN] = 'X',
+        [VLC_TRACER_INSTANT] = 'i',
+        [VLC_TRACER_COUNTER] = 'C',
+    };
+
+    flockfile(stream);
+    fputs(sys->first ? "\n" : ",\n", stream);
+    sys->first = false;
+
+    /* Names and categories are static strings from the core: they do not
+     * need to be escaped. */
+    fprintf(stream, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\","
+            "\"ts\":%"PRId64",\"pid\":0,\"tid\":%lu", ev->name, ev->category,
+            phase[ev->phase], US_FROM_VLC_TICK(ev->ts), ev->tid);
+
+    switch (ev->phase)
+    {
+        case VLC_TRACER_SPAN:
+            fprintf(stream, ",\"dur\":%"PRId64, US_FROM_VLC_TICK(ev->duration));
+            break;
+        case VLC_TRACER_INSTANT:
+            fputs(",\"s\":\"t\"", stream); /* thread scope */
+            break;
+        case VLC_TRACER_COUNTER:
+            fprintf(stream, ",\"id\":%"PRIuPTR",\"args\":{\"value\":%"PRId64"}",
+                    ev->id, ev->value);
+            break;
+    }
+
+    if (ev->phase != VLC_TRACER_COUNTER)
+    {
+        fprintf(stream, ",\"args\":{\"id\":%"PRIuPTR, ev->id);
+        if (ev->pts != VLC_TICK_INVALID)
+            fprintf(stream, ",\"pts\":%"PRId64, US_FROM_VLC_TICK(ev->pts));
+        putc_unlocked('}', stream);
+    }
+    putc_unlocked('}', stream);
+    funlockfile(stream);
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    fputs("\n]\n", sys->stream);
+    fclose(sys->stream);
+    free(sys);
+}
+
+static const struct vlc_tracer_operations json_ops =
+{
+    TraceJson,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                                void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    char *path = var_InheritString(obj, "chrome-trace-file");
+    const char *filename = (path != NULL) ? path : TRACE_FILENAME;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->stream = vlc_fopen(filename, "wt");
+    if (sys->stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        free(path);
+        free(sys);
+        return NULL;
+    }
+    free(path);
+
+    fputc('[', sys->stream);
+    sys->first = true;
+
+    *sysp = sys;
+    return &json_ops;
+}
+
+#define TRACE_FILE_TEXT N_("Trace filename")
+#define TRACE_FILE_LONGTEXT N_("Specify the trace filename.")
+
+vlc_module_begin()
+    set_shortname(N_("Chrome trace"))
+    set_description(N_("Chrome trace event format tracer"))
+    set_category(CAT_ADVANCED)
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+
+    add_savefile("chrome-trace-file", NULL, TRACE_FILE_TEXT,
+                 TRACE_FILE_LONGTEXT)
+vlc_module_end ()
@@ -28,11 +28,19 @@
 #endif
 
 #include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <vlc_common.h>
 #include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
 
 #include "vlc.h"
 #include "libs.h"
@@ -118,21 +126,60 @@ static const luaL_Reg p_reg_parse[] =
 };
 
 /*****************************************************************************
- * Called through lua_scripts_batch_execute to call 'probe' on
- * the script pointed by psz_filename.
+ * Playlist scripts registry
+ *
+ * The scripts are compiled, and their probe hints read, once per process.
+ * Opening a stream then only loads and probes the scripts whose hints match.
+ * The registry is saved in the user cache directory, so that the next runs
+ * only compile the scripts that changed.
  *****************************************************************************/
-static int probe_luascript(vlc_object_t *obj, const char *filename,
-                           const luabatch_context_t *ctx)
+enum
+{
+    HINT_ACCESS,
+    HINT_HOST,
+    HINT_EXTENSION,
+    HINT_MIME,
+    HINT_COUNT,
+};
+
+static const char *const hint_names[HINT_COUNT] =
+{
+    [HINT_ACCESS] = "access",
+    [HINT_HOST] = "host",
+    [HINT_EXTENSION] = "extension",
+    [HINT_MIME] = "mime",
+};
+
+struct playlist_script
+{
+    char *filename;
+    void *bytecode; /* NULL to load the file again */
+    size_t bytecode_size;
+    char **hints[HINT_COUNT]; /* NULL-terminated, NULL matches anything */
+    int64_t mtime; /* of the compiled file, 0 if unknown */
+    uint64_t size;
+};
+
+static vlc_mutex_t registry_lock = VLC_STATIC_MUTEX;
+static struct
+{
+    struct playlist_script *scripts;
+    size_t count;
+    bool loaded;
+    /* scripts of the previous run, while registering */
+    struct playlist_script *cached;
+    size_t cached_count;
+    size_t reused;
+} registry;
+
+static lua_State *vlclua_playlist_NewState(stream_t *s, const char *filename)
 {
-    stream_t *s = (stream_t *)obj;
     struct vlclua_playlist *sys = s->p_sys;
 
     /* Initialise Lua state structure */
     lua_State *L = luaL_newstate();
     if( !L )
-        return VLC_ENOMEM;
-
-    sys->L = L;
+        return NULL;
 
     /* Load Lua libraries */
     luaL_openlibs( L ); /* FIXME: Don't open all the libs? */
@@ -163,11 +210,526 @@ static int probe_luascript(vlc_object_t *obj, const char *filename,
     if (vlclua_add_modules_path(L, filename))
     {
         msg_Warn(s, "error setting the module search path for %s", filename);
+        lua_close(L);
+        return NULL;
+    }
+    return L;
+}
+
+static int vlclua_playlist_dump(lua_State *L, const void *p, size_t size,
+                                void *data)
+{
+    struct playlist_script *script = data;
+    uint8_t *buf = realloc(script->bytecode, script->bytecode_size + size);
+
+    if (unlikely(buf == NULL))
+        return 1;
+    memcpy(buf + script->bytecode_size, p, size);
+    script->bytecode = buf;
+    script->bytecode_size += size;
+    (void) L;
+    return 0;
+}
+
+/* Reads a string or a table of strings */
+static char **vlclua_playlist_hint(lua_State *L)
+{
+    char **list;
+
+    if (lua_isstring(L, -1))
+    {
+        list = malloc(2 * sizeof (*list));
+        if (unlikely(list == NULL))
+            return NULL;
+        list[0] = strdup(lua_tostring(L, -1));
+        list[1] = NULL;
+    }
+    else if (lua_istable(L, -1))
+    {
+        size_t n = lua_objlen(L, -1), j = 0;
+        list = malloc((n + 1) * sizeof (*list));
+        if (unlikely(list == NULL))
+            return NULL;
+        for (size_t i = 1; i <= n; i++)
+        {
+            lua_rawgeti(L, -1, i);
+            if (lua_isstring(L, -1))
+                list[j++] = strdup(lua_tostring(L, -1));
+            lua_pop(L, 1);
+        }
+        list[j] = NULL;
+    }
+    else
+        return NULL;
+
+    if (list[0] == NULL)
+    {   /* no usable patterns: not a restriction */
+        free(list);
+        list = NULL;
+    }
+    return list;
+}
+
+static void vlclua_playlist_hint_free(char **list)
+{
+    if (list == NULL)
+        return;
+    for (char **p = list; *p != NULL; p++)
+        free(*p);
+    free(list);
+}
+
+static void vlclua_playlist_script_clean(struct playlist_script *script)
+{
+    free(script->filename);
+    free(script->bytecode);
+    for (unsigned i = 0; i < HINT_COUNT; i++)
+        vlclua_playlist_hint_free(script->hints[i]);
+}
+
+/*****************************************************************************
+ * Registry cache
+ *****************************************************************************/
+#define REGISTRY_CACHE_NAME "lua_playlist.dat"
+/* Magic, with the version of the bytecode format */
+#define REGISTRY_CACHE_STRING \
+    "lua playlist "PACKAGE_VERSION" "LUA_RELEASE" 1"
+
+static char *vlclua_playlist_cache_path(void)
+{
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    char *path;
+
+    if (dir == NULL
+     || asprintf(&path, "%s"DIR_SEP REGISTRY_CACHE_NAME, dir) == -1)
+        path = NULL;
+    free(dir);
+    return path;
+}
+
+static int CacheLoadImmediate(void *out, block_t *in, size_t size)
+{
+    if (in->i_buffer < size)
+        return -1;
+
+    memcpy(out, in->p_buffer, size);
+    in->p_buffer += size;
+    in->i_buffer -= size;
+    return 0;
+}
+
+static int CacheLoadBuffer(void **out, block_t *in, size_t size)
+{
+    if (size == 0)
+    {
+        *out = NULL;
+        return 0;
+    }
+    if (in->i_buffer < size)
+        return -1;
+
+    *out = malloc(size);
+    if (unlikely(*out == NULL))
+        return -1;
+    return CacheLoadImmediate(*out, in, size);
+}
+
+static int CacheLoadString(char **out, block_t *in)
+{
+    uint16_t size;
+
+    if (CacheLoadImmediate(&size, in, sizeof (size)) || size == 0
+     || in->i_buffer < size || in->p_buffer[size - 1] != '\0')
+        return -1;
+    return CacheLoadBuffer((void **)out, in, size);
+}
+
+static int CacheLoadHint(char ***out, block_t *in)
+{
+    uint16_t count;
+
+    *out = NULL;
+    if (CacheLoadImmediate(&count, in, sizeof (count)))
+        return -1;
+    if (count == 0)
+        return 0;
+
+    char **list = calloc(count + 1, sizeof (*list));
+    if (unlikely(list == NULL))
+        return -1;
+    *out = list;
+    for (uint16_t i = 0; i < count; i++)
+        if (CacheLoadString(&list[i], in))
+            return -1;
+    return 0;
+}
+
+static int CacheLoadScript(struct playlist_script *script, block_t *in)
+{
+    uint32_t size;
+
+    if (CacheLoadString(&script->filename, in)
+     || CacheLoadImmediate(&script->mtime, in, sizeof (script->mtime))
+     || CacheLoadImmediate(&script->size, in, sizeof (script->size))
+     || CacheLoadImmediate(&size, in, sizeof (size))
+     || CacheLoadBuffer(&script->bytecode, in, size))
+        return -1;
+    script->bytecode_size = size;
+
+    for (unsigned i = 0; i < HINT_COUNT; i++)
+        if (CacheLoadHint(&script->hints[i], in))
+            return -1;
+    return 0;
+}
+
+/* Reads the scripts registered by the previous run, if any */
+static void vlclua_playlist_cache_load(stream_t *s)
+{
+    char *path = vlclua_playlist_cache_path();
+    if (path == NULL)
+        return;
+
+    block_t *file = block_FilePath(path, false);
+    free(path);
+    if (file == NULL)
+        return;
+
+    block_t in = *file;
+    const size_t len = strlen(REGISTRY_CACHE_STRING);
+    uint32_t count;
+
+    if (in.i_buffer < len || memcmp(in.p_buffer, REGISTRY_CACHE_STRING, len))
+        goto out; /* other version */
+    in.p_buffer += len;
+    in.i_buffer -= len;
+    if (CacheLoadImmediate(&count, &in, sizeof (count)) || count > 65536)
+        goto corrupt;
+
+    registry.cached = calloc(count, sizeof (*registry.cached));
+    if (unlikely(registry.cached == NULL))
+        goto out;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        registry.cached_count++;
+        if (CacheLoadScript(&registry.cached[i], &in))
+            goto corrupt;
+    }
+    goto out;
+
+corrupt:
+    msg_Warn(s, "Lua playlist scripts cache is corrupted");
+    for (size_t i = 0; i < registry.cached_count; i++)
+        vlclua_playlist_script_clean(&registry.cached[i]);
+    free(registry.cached);
+    registry.cached = NULL;
+    registry.cached_count = 0;
+out:
+    block_Release(file);
+}
+
+/* Takes the script from the cache if the file did not change since */
+static bool vlclua_playlist_cache_take(struct playlist_script *script)
+{
+    for (size_t i = 0; i < registry.cached_count; i++)
+    {
+        struct playlist_script *cached = &registry.cached[i];
+
+        if (cached->filename == NULL
+         || strcmp(cached->filename, script->filename))
+            continue;
+        if (cached->mtime != script->mtime || cached->size != script->size)
+            return false;
+
+        script->bytecode = cached->bytecode;
+        script->bytecode_size = cached->bytecode_size;
+        memcpy(script->hints, cached->hints, sizeof (script->hints));
+        free(cached->filename);
+        memset(cached, 0, sizeof (*cached));
+        return true;
+    }
+    return false;
+}
+
+#define SAVE_IMMEDIATE(a) \
+    if (fwrite(&(a), sizeof (a), 1, file) != 1) \
+        goto error
+
+static int CacheSaveString(FILE *file, const char *str)
+{
+    uint16_t size = strlen(str) + 1;
+
+    SAVE_IMMEDIATE(size);
+    if (fwrite(str, 1, size, file) != size)
+        goto error;
+    return 0;
+error:
+    return -1;
+}
+
+static int CacheSaveScript(FILE *file, const struct playlist_script *script)
+{
+    uint32_t size = script->bytecode_size;
+
+    if (CacheSaveString(file, script->filename))
         goto error;
+    SAVE_IMMEDIATE(script->mtime);
+    SAVE_IMMEDIATE(script->size);
+    SAVE_IMMEDIATE(size);
+    if (size > 0 && fwrite(script->bytecode, 1, size, file) != size)
+        goto error;
+
+    for (unsigned i = 0; i < HINT_COUNT; i++)
+    {
+        uint16_t count = 0;
+
+        if (script->hints[i] != NULL)
+            while (script->hints[i][count] != NULL)
+                count++;
+        SAVE_IMMEDIATE(count);
+        for (uint16_t j = 0; j < count; j++)
+            if (CacheSaveString(file, script->hints[i][j]))
+                goto error;
+    }
+    return 0;
+error:
+    return -1;
+}
+
+static void vlclua_playlist_cache_save(stream_t *s)
+{
+    char *path = vlclua_playlist_cache_path();
+    char *tmp;
+
+    if (path == NULL)
+        return;
+    if (asprintf(&tmp, "%s.%"PRIu32, path, (uint32_t)getpid()) == -1)
+    {
+        free(path);
+        return;
+    }
+
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    if (dir != NULL)
+        vlc_mkdir(dir, 0700);
+    free(dir);
+
+    FILE *file = vlc_fopen(tmp, "wb");
+    if (file == NULL)
+    {
+        msg_Warn(s, "cannot create %s: %s", tmp, vlc_strerror_c(errno));
+        goto out;
+    }
+
+    uint32_t count = registry.count;
+
+    if (fputs(REGISTRY_CACHE_STRING, file) == EOF)
+        goto error;
+    SAVE_IMMEDIATE(count);
+    for (size_t i = 0; i < registry.count; i++)
+        if (CacheSaveScript(file, &registry.scripts[i]))
+            goto error;
+    if (fflush(file))
+        goto error;
+
+#if !defined( _WIN32 ) && !defined( __OS2__ )
+    vlc_rename(tmp, path); /* atomically replace old cache */
+    fclose(file);
+#else
+    vlc_unlink(path);
+    fclose(file);
+    vlc_rename(tmp, path);
+#endif
+    goto out;
+
+error:
+    msg_Warn(s, "cannot write %s: %s", tmp, vlc_strerror_c(errno));
+    fclose(file);
+    vlc_unlink(tmp);
+out:
+    free(tmp);
+    free(path);
+}
+
+/*****************************************************************************
+ * Called through lua_scripts_batch_execute to compile the script pointed by
+ * psz_filename and read its probe_hints.
+ *****************************************************************************/
+static int register_luascript(vlc_object_t *obj, const char *filename,
+                              const luabatch_context_t *ctx)
+{
+    stream_t *s = (stream_t *)obj;
+    struct playlist_script *tab = realloc(registry.scripts,
+                                          (registry.count + 1) * sizeof (*tab));
+    if (unlikely(tab == NULL))
+        return VLC_EGENERIC;
+    registry.scripts = tab;
+
+    struct playlist_script *script = &tab[registry.count];
+    memset(script, 0, sizeof (*script));
+    script->filename = strdup(filename);
+    if (unlikely(script->filename == NULL))
+        return VLC_EGENERIC;
+    registry.count++;
+
+    struct stat st;
+    if (vlc_stat(filename, &st) == 0)
+    {
+        script->mtime = st.st_mtime;
+        script->size = st.st_size;
+        if (vlclua_playlist_cache_take(script))
+        {   /* unchanged since the previous run */
+            registry.reused++;
+            return VLC_EGENERIC;
+        }
+    }
+
+    /* Scripts failing here are kept without bytecode nor hints: errors are
+     * then reported whenever they are probed, as before. */
+    lua_State *L = vlclua_playlist_NewState(s, filename);
+    if (L == NULL)
+        return VLC_EGENERIC;
+
+    if (vlclua_loadfile(obj, L, filename) == 0)
+    {
+        lua_pushvalue(L, -1);
+#if LUA_VERSION_NUM >= 503
+        int ret = lua_dump(L, vlclua_playlist_dump, script, 0);
+#else
+        int ret = lua_dump(L, vlclua_playlist_dump, script);
+#endif
+        lua_pop(L, 1);
+        if (ret != 0)
+        {
+            free(script->bytecode);
+            script->bytecode = NULL;
+            script->bytecode_size = 0;
+        }
+
+        if (lua_pcall(L, 0, 0, 0) == 0)
+        {
+            lua_getglobal(L, "probe_hints");
+            if (lua_istable(L, -1))
+                for (unsigned i = 0; i < HINT_COUNT; i++)
+                {
+                    lua_getfield(L, -1, hint_names[i]);
+                    script->hints[i] = vlclua_playlist_hint(L);
+                    lua_pop(L, 1);
+                }
+        }
     }
+    lua_close(L);
+    (void) ctx;
+    return VLC_EGENERIC; /* carry on with the next script */
+}
+
+static const struct playlist_script *vlclua_playlist_scripts(stream_t *s,
+                                                             size_t *count)
+{
+    vlc_mutex_lock(&registry_lock);
+    if (!registry.loaded)
+    {
+        vlc_tick_t start = vlc_tick_now();
+        vlclua_playlist_cache_load(s);
+        vlclua_scripts_batch_execute(VLC_OBJECT(s), "playlist",
+                                     register_luascript, NULL);
+        registry.loaded = true;
+        msg_Dbg(s, "registered %zu Lua playlist scripts (%zu from the cache) "
+                "in %"PRId64" us", registry.count, registry.reused,
+                US_FROM_VLC_TICK(vlc_tick_now() - start));
+
+        /* Save if scripts were compiled, or removed since */
+        if (registry.reused < registry.count
+         || registry.reused < registry.cached_count)
+            vlclua_playlist_cache_save(s);
+        for (size_t i = 0; i < registry.cached_count; i++)
+            vlclua_playlist_script_clean(&registry.cached[i]);
+        free(registry.cached);
+        registry.cached = NULL;
+        registry.cached_count = 0;
+    }
+    *count = registry.count;
+    vlc_mutex_unlock(&registry_lock);
+    /* never modified once loaded */
+    return registry.scripts;
+}
+
+static bool MatchString(const char *value, size_t len, const char *hint)
+{
+    return strlen(hint) == len && !strncasecmp(value, hint, len);
+}
+
+/* The host or any of its subdomains */
+static bool MatchHost(const char *value, size_t len, const char *hint)
+{
+    size_t hlen = strlen(hint);
+    if (hlen > len || strncasecmp(value + len - hlen, hint, hlen))
+        return false;
+    return hlen == len || value[len - hlen - 1] == '.';
+}
+
+static bool MatchExtension(const char *value, size_t len, const char *hint)
+{
+    size_t hlen = strlen(hint);
+    return hlen < len && value[len - hlen - 1] == '.'
+        && !strncasecmp(value + len - hlen, hint, hlen);
+}
+
+static bool MatchHint(char *const *hint, const char *value, size_t len,
+                      bool (*match)(const char *, size_t, const char *))
+{
+    if (hint == NULL)
+        return true;
+    if (value == NULL)
+        return false;
+    for (; *hint != NULL; hint++)
+        if (match(value, len, *hint))
+            return true;
+    return false;
+}
+
+static bool vlclua_playlist_match(const struct playlist_script *script,
+                                  const struct vlclua_playlist *sys,
+                                  const char *mime)
+{
+    const char *path = sys->path;
+
+    return MatchHint(script->hints[HINT_ACCESS], sys->access,
+                     sys->access ? strlen(sys->access) : 0, MatchString)
+        && MatchHint(script->hints[HINT_HOST], path,
+                     path ? strcspn(path, "/:?#") : 0, MatchHost)
+        && MatchHint(script->hints[HINT_EXTENSION], path,
+                     path ? strlen(path) : 0, MatchExtension)
+        && MatchHint(script->hints[HINT_MIME], mime,
+                     mime ? strlen(mime) : 0, MatchString);
+}
+
+/*****************************************************************************
+ * Calls 'probe' on a registered script.
+ *****************************************************************************/
+static int probe_luascript(stream_t *s, const struct playlist_script *script)
+{
+    struct vlclua_playlist *sys = s->p_sys;
+    const char *filename = script->filename;
+
+    lua_State *L = vlclua_playlist_NewState(s, filename);
+    if( !L )
+        return VLC_ENOMEM;
+
+    sys->L = L;
 
     /* Load and run the script(s) */
-    if (vlclua_dofile(VLC_OBJECT(s), L, filename))
+    int ret;
+    if (script->bytecode != NULL
+     && luaL_loadbuffer(L, script->bytecode, script->bytecode_size,
+                        filename) == 0)
+        ret = lua_pcall(L, 0, LUA_MULTRET, 0);
+    else
+    {   /* not compiled, or by another build of Lua */
+        lua_settop(L, 0);
+        ret = vlclua_dofile(VLC_OBJECT(s), L, filename);
+    }
+    if (ret)
     {
         msg_Warn(s, "error loading script %s: %s", filename,
                  lua_tostring(L, lua_gettop(L)));
@@ -201,7 +763,6 @@ static int probe_luascript(vlc_object_t *obj, const char *filename,
         }
     }
 
-    (void) ctx;
 error:
     lua_pop( L, 1 );
     lua_close(sys->L);
@@ -300,8 +861,24 @@ int Import_LuaPlaylist(vlc_object_t *obj)
         }
     }
 
-    int ret = vlclua_scripts_batch_execute(VLC_OBJECT(s), "playlist",
-                                           probe_luascript, NULL);
+    size_t count, probed = 0;
+    const struct playlist_script *scripts = vlclua_playlist_scripts(s, &count);
+    char *mime = stream_MimeType(s->s);
+    vlc_tick_t start = vlc_tick_now();
+    int ret = VLC_EGENERIC;
+
+    for (size_t i = 0; i < count && ret != VLC_SUCCESS; i++)
+    {
+        if (!vlclua_playlist_match(&scripts[i], sys, mime))
+            continue;
+        msg_Dbg(s, "Trying Lua playlist script %s", scripts[i].filename);
+        ret = probe_luascript(s, &scripts[i]);
+        probed++;
+    }
+    free(mime);
+    msg_Dbg(s, "probed %zu of %zu Lua playlist scripts in %"PRId64" us",
+            probed, count, US_FROM_VLC_TICK(vlc_tick_now() - start));
+
     if (ret != VLC_SUCCESS)
     {
         free(sys->access);
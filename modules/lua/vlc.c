@@ -652,17 +652,17 @@ int vlclua_add_modules_path( lua_State *L, const char *psz_filename )
     return 0;
 }
 
-/** Replacement for luaL_dofile, using VLC's input capabilities */
-int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
+/** Replacement for luaL_loadfile, using VLC's input capabilities */
+int vlclua_loadfile( vlc_object_t *p_this, lua_State *L, const char *curi )
 {
     char *uri = ToLocaleDup( curi );
     if( !strstr( uri, "://" ) ) {
-        int ret = luaL_dofile( L, uri );
+        int ret = luaL_loadfile( L, uri );
         free( uri );
         return ret;
     }
     if( !strncasecmp( uri, "file://", 7 ) ) {
-        int ret = luaL_dofile( L, uri + 7 );
+        int ret = luaL_loadfile( L, uri + 7 );
         free( uri );
         return ret;
     }
@@ -685,10 +685,17 @@ int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
     int i_ret = ( i_read == i_size ) ? 0 : 1;
     if( !i_ret )
         i_ret = luaL_loadbuffer( L, p_buffer, (size_t) i_size, uri );
-    if( !i_ret )
-        i_ret = lua_pcall( L, 0, LUA_MULTRET, 0 );
     vlc_stream_Delete( s );
     free( p_buffer );
     free( uri );
     return i_ret;
 }
+
+/** Replacement for luaL_dofile, using VLC's input capabilities */
+int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *uri )
+{
+    int i_ret = vlclua_loadfile( p_this, L, uri );
+    if( !i_ret )
+        i_ret = lua_pcall( L, 0, LUA_MULTRET, 0 );
+    return i_ret;
+}
@@ -174,6 +174,7 @@ char *vlclua_find_file( const char *psz_luadirname, const char *psz_name );
  * Replace Lua file reader by VLC input. Allows loadings scripts in Zip pkg.
  *****************************************************************************/
 int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *url );
+int vlclua_loadfile( vlc_object_t *p_this, lua_State *L, const char *url );
 
 /*****************************************************************************
  * Playlist and meta data internal utilities.
@@ -26,6 +26,8 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
+
 #include <vlc_common.h>
 
 #include "csa.h"
@@ -131,6 +133,8 @@ int csa_UseKey( vlc_object_t *p_caller, csa_t *c, bool use_odd )
 #ifndef TS_NO_CSA_CK_MSG
         msg_Dbg( p_caller, "using the %s key for scrambling",
                  use_odd ? "odd" : "even" );
+#else
+    VLC_UNUSED(p_caller);
 #endif
     return VLC_SUCCESS;
 }
@@ -610,3 +614,452 @@ static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] )
     }
 }
 
+/*****************************************************************************
+ * Bitsliced stream cypher
+ *****************************************************************************
+ * The stream cypher dominates the scrambling cost and is only made of
+ * nibble wide registers, small s-boxes and xors, so it is computed for
+ * CSA_BATCH_SIZE packets at once: bit i of every csa_word_t holds the state
+ * of the packet i. The block cypher keeps using the byte oriented tables.
+ *****************************************************************************/
+typedef uint64_t csa_word_t;
+#define CSA_WORD_BITS (8 * sizeof(csa_word_t))
+
+static_assert( CSA_WORD_BITS == CSA_BATCH_SIZE, "invalid csa batch size" );
+
+typedef struct
+{
+    csa_word_t A[11][4];
+    csa_word_t B[11][4];
+    csa_word_t X[4], Y[4], Z[4];
+    csa_word_t D[4], E[4], F[4];
+    csa_word_t p, q, r;
+} csa_bs_t;
+
+/* Generated from the algebraic normal form of sbox1..sbox7 */
+static inline void csa_BsSbox1( csa_word_t x4, csa_word_t x3, csa_word_t x2,
+                                csa_word_t x1, csa_word_t x0,
+                                csa_word_t *o1, csa_word_t *o0 )
+{
+    const csa_word_t m01 = x0 & x1;
+    const csa_word_t m02 = x0 & x2;
+    const csa_word_t m12 = x1 & x2;
+    const csa_word_t m03 = x0 & x3;
+    const csa_word_t m13 = x1 & x3;
+    const csa_word_t m23 = x2 & x3;
+    const csa_word_t m04 = x0 & x4;
+    const csa_word_t m24 = x2 & x4;
+    const csa_word_t m34 = x3 & x4;
+    const csa_word_t m013 = m01 & x3;
+    const csa_word_t m023 = m02 & x3;
+    const csa_word_t m123 = m12 & x3;
+    const csa_word_t m014 = m01 & x4;
+    const csa_word_t m124 = m12 & x4;
+    const csa_word_t m134 = m13 & x4;
+    const csa_word_t m234 = m23 & x4;
+    const csa_word_t m0134 = m013 & x4;
+    const csa_word_t m0234 = m023 & x4;
+    const csa_word_t m1234 = m123 & x4;
+    *o1 = ~( x0 ^ x1 ^ m01 ^ m02 ^ m12 ^ m03 ^ m13 ^ m23 ^ m023 ^ m123 ^ x4
+             ^ m014 ^ m24 ^ m124 ^ m34 ^ m134 ^ m0134 ^ m234 ^ m1234 );
+    *o0 = x1 ^ m02 ^ x3 ^ m03 ^ m013 ^ m04 ^ m34 ^ m134 ^ m234 ^ m0234;
+}
+
+static inline void csa_BsSbox2( csa_word_t x4, csa_word_t x3, csa_word_t x2,
+                                csa_word_t x1, csa_word_t x0,
+                                csa_word_t *o1, csa_word_t *o0 )
+{
+    const csa_word_t m01 = x0 & x1;
+    const csa_word_t m02 = x0 & x2;
+    const csa_word_t m12 = x1 & x2;
+    const csa_word_t m03 = x0 & x3;
+    const csa_word_t m13 = x1 & x3;
+    const csa_word_t m23 = x2 & x3;
+    const csa_word_t m24 = x2 & x4;
+    const csa_word_t m34 = x3 & x4;
+    const csa_word_t m012 = m01 & x2;
+    const csa_word_t m013 = m01 & x3;
+    const csa_word_t m023 = m02 & x3;
+    const csa_word_t m014 = m01 & x4;
+    const csa_word_t m124 = m12 & x4;
+    const csa_word_t m034 = m03 & x4;
+    const csa_word_t m134 = m13 & x4;
+    const csa_word_t m234 = m23 & x4;
+    const csa_word_t m0134 = m013 & x4;
+    const csa_word_t m0234 = m023 & x4;
+    *o1 = ~( x0 ^ x1 ^ m02 ^ m12 ^ m012 ^ x3 ^ m124 ^ m034 ^ m134 ^ m0134
+             ^ m234 );
+    *o0 = ~( x1 ^ x2 ^ m02 ^ m013 ^ m023 ^ m014 ^ m24 ^ m34 ^ m0134 ^ m0234 );
+}
+
+static inline void csa_BsSbox3( csa_word_t x4, csa_word_t x3, csa_word_t x2,
+                                csa_word_t x1, csa_word_t x0,
+                                csa_word_t *o1, csa_word_t *o0 )
+{
+    const csa_word_t m01 = x0 & x1;
+    const csa_word_t m02 = x0 & x2;
+    const csa_word_t m12 = x1 & x2;
+    const csa_word_t m03 = x0 & x3;
+    const csa_word_t m13 = x1 & x3;
+    const csa_word_t m23 = x2 & x3;
+    const csa_word_t m14 = x1 & x4;
+    const csa_word_t m24 = x2 & x4;
+    const csa_word_t m012 = m01 & x2;
+    const csa_word_t m013 = m01 & x3;
+    const csa_word_t m123 = m12 & x3;
+    const csa_word_t m014 = m01 & x4;
+    const csa_word_t m024 = m02 & x4;
+    const csa_word_t m124 = m12 & x4;
+    const csa_word_t m034 = m03 & x4;
+    const csa_word_t m234 = m23 & x4;
+    const csa_word_t m0124 = m012 & x4;
+    const csa_word_t m1234 = m123 & x4;
+    *o1 = ~( x0 ^ x1 ^ m02 ^ m12 ^ m012 ^ x3 ^ m03 ^ m13 ^ m013 ^ m23 ^ m123
+             ^ x4 ^ m14 ^ m014 ^ m24 ^ m024 ^ m124 ^ m0124 ^ m034 ^ m234
+             ^ m1234 );
+    *o0 = x1 ^ m01 ^ m02 ^ x3 ^ x4;
+}
+
+static inline void csa_BsSbox4( csa_word_t x4, csa_word_t x3, csa_word_t x2,
+                                csa_word_t x1, csa_word_t x0,
+                                csa_word_t *o1, csa_word_t *o0 )
+{
+    const csa_word_t m01 = x0 & x1;
+    const csa_word_t m12 = x1 & x2;
+    const csa_word_t m03 = x0 & x3;
+    const csa_word_t m23 = x2 & x3;
+    const csa_word_t m04 = x0 & x4;
+    const csa_word_t m14 = x1 & x4;
+    const csa_word_t m34 = x3 & x4;
+    const csa_word_t m012 = m01 & x2;
+    const csa_word_t m013 = m01 & x3;
+    const csa_word_t m123 = m12 & x3;
+    const csa_word_t m034 = m03 & x4;
+    const csa_word_t m234 = m23 & x4;
+    const csa_word_t m0124 = m012 & x4;
+    const csa_word_t m0134 = m013 & x4;
+    const csa_word_t m1234 = m123 & x4;
+    *o1 = ~( x0 ^ m01 ^ x2 ^ m012 ^ x3 ^ m123 ^ x4 ^ m04 ^ m14 ^ m0124 ^ m34
+             ^ m034 ^ m0134 ^ m234 ^ m1234 );
+    *o0 = ~( x1 ^ m01 ^ x2 ^ m03 ^ m013 ^ m23 ^ m04 ^ m14 ^ m0124 ^ m34
+             ^ m034 ^ m0134 ^ m234 ^ m1234 );
+}
+
+static inline void csa_BsSbox5( csa_word_t x4, csa_word_t x3, csa_word_t x2,
+                                csa_word_t x1, csa_word_t x0,
+                                csa_word_t *o1, csa_word_t *o0 )
+{
+    const csa_word_t m01 = x0 & x1;
+    const csa_word_t m02 = x0 & x2;
+    const csa_word_t m12 = x1 & x2;
+    const csa_word_t m03 = x0 & x3;
+    const csa_word_t m13 = x1 & x3;
+    const csa_word_t m04 = x0 & x4;
+    const csa_word_t m14 = x1 & x4;
+    const csa_word_t m24 = x2 & x4;
+    const csa_word_t m34 = x3 & x4;
+    const csa_word_t m012 = m01 & x2;
+    const csa_word_t m013 = m01 & x3;
+    const csa_word_t m023 = m02 & x3;
+    const csa_word_t m123 = m12 & x3;
+    const csa_word_t m024 = m02 & x4;
+    const csa_word_t m124 = m12 & x4;
+    const csa_word_t m034 = m03 & x4;
+    const csa_word_t m134 = m13 & x4;
+    const csa_word_t m0124 = m012 & x4;
+    const csa_word_t m0134 = m013 & x4;
+    const csa_word_t m0234 = m023 & x4;
+    const csa_word_t m1234 = m123 & x4;
+    *o1 = ~( x0 ^ x1 ^ m01 ^ m02 ^ m12 ^ m012 ^ x3 ^ m03 ^ m013 ^ m023
+             ^ m123 ^ m04 ^ m14 ^ m24 ^ m124 ^ m0124 ^ m034 ^ m134 ^ m0234
+             ^ m1234 );
+    *o0 = m01 ^ x2 ^ m02 ^ m012 ^ m03 ^ m13 ^ m023 ^ m04 ^ m24 ^ m024 ^ m124
+          ^ m0124 ^ m34 ^ m034 ^ m134 ^ m0134;
+}
+
+static inline void csa_BsSbox6( csa_word_t x4, csa_word_t x3, csa_word_t x2,
+                                csa_word_t x1, csa_word_t x0,
+                                csa_word_t *o1, csa_word_t *o0 )
+{
+    const csa_word_t m01 = x0 & x1;
+    const csa_word_t m02 = x0 & x2;
+    const csa_word_t m12 = x1 & x2;
+    const csa_word_t m03 = x0 & x3;
+    const csa_word_t m13 = x1 & x3;
+    const csa_word_t m23 = x2 & x3;
+    const csa_word_t m012 = m01 & x2;
+    const csa_word_t m013 = m01 & x3;
+    const csa_word_t m023 = m02 & x3;
+    const csa_word_t m123 = m12 & x3;
+    const csa_word_t m014 = m01 & x4;
+    const csa_word_t m124 = m12 & x4;
+    const csa_word_t m034 = m03 & x4;
+    const csa_word_t m0124 = m012 & x4;
+    const csa_word_t m0134 = m013 & x4;
+    const csa_word_t m1234 = m123 & x4;
+    *o1 = x1 ^ m02 ^ m013 ^ m23 ^ m023 ^ x4 ^ m014 ^ m034;
+    *o0 = x0 ^ x2 ^ m12 ^ m012 ^ m13 ^ m23 ^ m123 ^ m014 ^ m124 ^ m0124
+          ^ m0134 ^ m1234;
+}
+
+static inline void csa_BsSbox7( csa_word_t x4, csa_word_t x3, csa_word_t x2,
+                                csa_word_t x1, csa_word_t x0,
+                                csa_word_t *o1, csa_word_t *o0 )
+{
+    const csa_word_t m01 = x0 & x1;
+    const csa_word_t m12 = x1 & x2;
+    const csa_word_t m13 = x1 & x3;
+    const csa_word_t m23 = x2 & x3;
+    const csa_word_t m04 = x0 & x4;
+    const csa_word_t m24 = x2 & x4;
+    const csa_word_t m012 = m01 & x2;
+    const csa_word_t m013 = m01 & x3;
+    const csa_word_t m123 = m12 & x3;
+    const csa_word_t m014 = m01 & x4;
+    const csa_word_t m124 = m12 & x4;
+    const csa_word_t m134 = m13 & x4;
+    const csa_word_t m0124 = m012 & x4;
+    const csa_word_t m0134 = m013 & x4;
+    const csa_word_t m1234 = m123 & x4;
+    *o1 = x0 ^ x1 ^ m01 ^ x2 ^ x3 ^ m013 ^ m04 ^ m014 ^ m24 ^ m124 ^ m0124
+          ^ m0134 ^ m1234;
+    *o0 = x0 ^ m01 ^ x2 ^ m12 ^ m012 ^ x3 ^ m23 ^ x4 ^ m134 ^ m0134;
+}
+
+/* Swaps rows and columns of a 64x64 bits matrix */
+static void csa_BsTranspose( csa_word_t m[64] )
+{
+    csa_word_t mask = UINT64_C(0x00000000FFFFFFFF);
+    for( unsigned j = 32; j != 0; j >>= 1, mask ^= mask << j )
+    {
+        for( unsigned k = 0; k < 64; k = ((k | j) + 1) & ~j )
+        {
+            csa_word_t t = ( (m[k] >> j) ^ m[k | j] ) & mask;
+            m[k] ^= t << j;
+            m[k | j] ^= t;
+        }
+    }
+}
+
+/* Runs 4 clocks of the bitsliced cypher, 2 output bits per clock.
+ * in (when initialising) holds the 8 bits of one input byte and out
+ * receives the 8 bits of the output byte. */
+static void csa_BsStreamByte( csa_bs_t *s, const csa_word_t *in,
+                              csa_word_t out[8] )
+{
+    for( int j = 0; j < 4; j++ )
+    {
+        csa_word_t s1[2], s2[2], s3[2], s4[2], s5[2], s6[2], s7[2];
+        csa_word_t next_A1[4], next_B1[4], extra_B[4], sum[4];
+
+        csa_BsSbox1( s->A[4][0], s->A[1][2], s->A[6][1], s->A[7][3], s->A[9][0], &s1[1], &s1[0] );
+        csa_BsSbox2( s->A[2][1], s->A[3][2], s->A[6][3], s->A[7][0], s->A[9][1], &s2[1], &s2[0] );
+        csa_BsSbox3( s->A[1][3], s->A[2][0], s->A[5][1], s->A[5][3], s->A[6][2], &s3[1], &s3[0] );
+        csa_BsSbox4( s->A[3][3], s->A[1][1], s->A[2][3], s->A[4][2], s->A[8][0], &s4[1], &s4[0] );
+        csa_BsSbox5( s->A[5][2], s->A[4][3], s->A[6][0], s->A[8][1], s->A[9][2], &s5[1], &s5[0] );
+        csa_BsSbox6( s->A[3][1], s->A[4][1], s->A[5][0], s->A[7][2], s->A[9][3], &s6[1], &s6[0] );
+        csa_BsSbox7( s->A[2][2], s->A[3][0], s->A[7][1], s->A[8][2], s->A[8][3], &s7[1], &s7[0] );
+
+        /* 4x4 xor producing the extra nibble for T3 */
+        extra_B[3] = s->B[3][0] ^ s->B[6][1] ^ s->B[7][2] ^ s->B[9][3];
+        extra_B[2] = s->B[6][0] ^ s->B[8][1] ^ s->B[3][3] ^ s->B[4][2];
+        extra_B[1] = s->B[5][3] ^ s->B[8][2] ^ s->B[4][0] ^ s->B[5][1];
+        extra_B[0] = s->B[9][2] ^ s->B[6][3] ^ s->B[3][1] ^ s->B[8][0];
+
+        for( int b = 0; b < 4; b++ )
+        {
+            /* T1 and T2, the input nibbles are only used on init */
+            next_A1[b] = s->A[10][b] ^ s->X[b];
+            next_B1[b] = s->B[7][b] ^ s->B[10][b] ^ s->Y[b];
+            if( in )
+            {
+                const csa_word_t in1 = in[4 + b], in2 = in[b];
+                next_A1[b] ^= s->D[b] ^ ((j % 2) ? in2 : in1);
+                next_B1[b] ^= (j % 2) ? in1 : in2;
+            }
+        }
+
+        /* if p=1, rotate next_B1 left */
+        const csa_word_t b3 = next_B1[3];
+        for( int b = 3; b > 0; b-- )
+            next_B1[b] ^= ( next_B1[b] ^ next_B1[b - 1] ) & s->p;
+        next_B1[0] ^= ( next_B1[0] ^ b3 ) & s->p;
+
+        /* T4 = sum, carry of Z + E + r */
+        csa_word_t carry = s->r;
+        for( int b = 0; b < 4; b++ )
+        {
+            const csa_word_t x = s->Z[b] ^ s->E[b];
+            sum[b] = x ^ carry;
+            carry = ( s->Z[b] & s->E[b] ) | ( carry & x );
+        }
+
+        for( int b = 0; b < 4; b++ )
+        {
+            /* T3 */
+            s->D[b] = s->E[b] ^ s->Z[b] ^ extra_B[b];
+
+            const csa_word_t next_E = s->F[b];
+            s->F[b] = s->E[b] ^ ( ( s->E[b] ^ sum[b] ) & s->q );
+            s->E[b] = next_E;
+        }
+        s->r ^= ( s->r ^ carry ) & s->q;
+
+        memmove( s->A[2], s->A[1], 9 * sizeof(s->A[1]) );
+        memmove( s->B[2], s->B[1], 9 * sizeof(s->B[1]) );
+        memcpy( s->A[1], next_A1, sizeof(next_A1) );
+        memcpy( s->B[1], next_B1, sizeof(next_B1) );
+
+        s->X[3] = s4[0]; s->X[2] = s3[0]; s->X[1] = s2[1]; s->X[0] = s1[1];
+        s->Y[3] = s6[0]; s->Y[2] = s5[0]; s->Y[1] = s4[1]; s->Y[0] = s3[1];
+        s->Z[3] = s2[0]; s->Z[2] = s1[0]; s->Z[1] = s6[1]; s->Z[0] = s5[1];
+        s->p = s7[1];
+        s->q = s7[0];
+
+        if( out )
+        {
+            /* 2 output bits are a function of the 4 bits of D */
+            out[7 - 2*j] = s->D[2] ^ s->D[3];
+            out[6 - 2*j] = s->D[0] ^ s->D[1];
+        }
+    }
+}
+
+/* Loads the control word and the first cypher block of each packet */
+static void csa_BsStreamInit( csa_bs_t *s, const uint8_t *ck,
+                              csa_word_t sb[64] )
+{
+    memset( s, 0, sizeof(*s) );
+    for( int i = 0; i < 4; i++ )
+    {
+        for( int b = 0; b < 4; b++ )
+        {
+            s->A[1+2*i+0][b] = ( ck[i]   >> (4 + b) ) & 1 ? ~(csa_word_t)0 : 0;
+            s->A[1+2*i+1][b] = ( ck[i]   >> b )       & 1 ? ~(csa_word_t)0 : 0;
+            s->B[1+2*i+0][b] = ( ck[4+i] >> (4 + b) ) & 1 ? ~(csa_word_t)0 : 0;
+            s->B[1+2*i+1][b] = ( ck[4+i] >> b )       & 1 ? ~(csa_word_t)0 : 0;
+        }
+    }
+
+    csa_BsTranspose( sb );
+    for( int i = 0; i < 8; i++ )
+        csa_BsStreamByte( s, &sb[8 * i], NULL );
+}
+
+/* Produces the next 8 bytes of key stream of every packet, lane by lane */
+static void csa_BsStreamNext( csa_bs_t *s, csa_word_t cb[64] )
+{
+    for( int i = 0; i < 8; i++ )
+        csa_BsStreamByte( s, NULL, &cb[8 * i] );
+    csa_BsTranspose( cb );
+}
+
+static void csa_EncryptBs( csa_t *c, uint8_t **pp_pkts, int i_pkts,
+                           int i_pkt_size )
+{
+    uint8_t *ck = c->use_odd ? c->o_ck : c->e_ck;
+    uint8_t *kk = c->use_odd ? c->o_kk : c->e_kk;
+
+    int pi_hdr[CSA_BATCH_SIZE];
+    int pi_blocks[CSA_BATCH_SIZE];
+    int pi_residue[CSA_BATCH_SIZE];
+    csa_word_t words[64] = { 0 };
+    int i_max_calls = 0;
+
+    for( int k = 0; k < i_pkts; k++ )
+    {
+        uint8_t *pkt = pp_pkts[k];
+
+        /* set transport scrambling control */
+        pkt[3] |= c->use_odd ? 0xc0 : 0x80;
+
+        pi_hdr[k] = 4;
+        if( pkt[3]&0x20 )
+        {
+            /* skip adaption field */
+            pi_hdr[k] += pkt[4] + 1;
+        }
+        pi_blocks[k] = (i_pkt_size - pi_hdr[k]) / 8;
+        pi_residue[k] = (i_pkt_size - pi_hdr[k]) % 8;
+
+        if( pi_blocks[k] <= 0 )
+        {
+            pkt[3] &= 0x3f;
+            pi_blocks[k] = 0;
+            continue;
+        }
+
+        /* Block cypher, last block first. Each cypher block replaces the
+         * clear block it was computed from. */
+        uint8_t *p_data = &pkt[pi_hdr[k]];
+        uint8_t ib[8] = { 0 }, block[8];
+        for( int i = pi_blocks[k]; i > 0; i-- )
+        {
+            for( int j = 0; j < 8; j++ )
+                block[j] = p_data[8*(i-1)+j] ^ ib[j];
+            csa_BlockCypher( kk, block, ib );
+            memcpy( &p_data[8*(i-1)], ib, 8 );
+        }
+
+        words[k] = GetQWLE( p_data );
+
+        /* one stream output per following block, and one for the residue */
+        int i_calls = pi_blocks[k] - 1 + ( pi_residue[k] > 0 );
+        if( i_calls > i_max_calls )
+            i_max_calls = i_calls;
+    }
+
+    if( i_max_calls == 0 )
+        return;
+
+    csa_bs_t state;
+    csa_BsStreamInit( &state, ck, words );
+
+    /* The first block is sent as is, then the stream is xored over the
+     * following blocks and the residue */
+    for( int i = 1; i <= i_max_calls; i++ )
+    {
+        csa_BsStreamNext( &state, words );
+
+        for( int k = 0; k < i_pkts; k++ )
+        {
+            if( i > pi_blocks[k] )
+                continue;
+
+            uint8_t *p_data = &pp_pkts[k][pi_hdr[k] + 8*i];
+            int i_len = ( i < pi_blocks[k] ) ? 8 : pi_residue[k];
+            for( int j = 0; j < i_len; j++ )
+                p_data[j] ^= words[k] >> (8 * j);
+        }
+    }
+}
+
+/*****************************************************************************
+ * csa_EncryptBatch:
+ *****************************************************************************/
+int csa_EncryptBatch( csa_t *c, uint8_t **pp_pkts, int i_pkts, int i_pkt_size )
+{
+    int i_sliced = 0;
+
+    while( i_pkts > 0 )
+    {
+        int i_count = __MIN( i_pkts, CSA_BATCH_SIZE );
+
+        /* The bitsliced cypher costs the same for 1 or CSA_BATCH_SIZE
+         * packets */
+        if( i_count < CSA_BATCH_MIN )
+        {
+            for( int k = 0; k < i_count; k++ )
+                csa_Encrypt( c, pp_pkts[k], i_pkt_size );
+        }
+        else
+        {
+            csa_EncryptBs( c, pp_pkts, i_count, i_pkt_size );
+            i_sliced += i_count;
+        }
+
+        pp_pkts += i_count;
+        i_pkts -= i_count;
+    }
+    return i_sliced;
+}
@@ -30,6 +30,12 @@ typedef struct csa_t csa_t;
 #define csa_UseKey  __csa_UseKey
 #define csa_Decrypt __csa_decrypt
 #define csa_Encrypt __csa_encrypt
+#define csa_EncryptBatch __csa_encrypt_batch
+
+/* Number of packets scrambled at once by csa_EncryptBatch */
+#define CSA_BATCH_SIZE 64
+/* Below this count, packets are scrambled one by one */
+#define CSA_BATCH_MIN  8
 
 csa_t *csa_New( void );
 void   csa_Delete( csa_t * );
@@ -39,5 +45,8 @@ int    csa_UseKey( vlc_object_t *p_caller, csa_t *, bool use_odd );
 
 void   csa_Decrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
 void   csa_Encrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
+/* Same as csa_Encrypt() for several packets, with the current key.
+ * Returns the number of packets scrambled by the bitsliced cypher. */
+int    csa_EncryptBatch( csa_t *, uint8_t **pp_pkts, int i_pkts, int i_pkt_size );
 
 #endif /* _CSA_H */
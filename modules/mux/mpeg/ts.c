@@ -1784,30 +1784,49 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     }
 
     /* msg_Dbg( p_mux, "real pck=%d", i_packet_count ); */
-    for (int i = 0; i < i_packet_count; i++ )
+    for (int i = 0; i < i_packet_count; )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
-        vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
-
-        p_ts->i_dts    = i_new_dts;
-        p_ts->i_length = i_pcr_length / i_packet_count;
+        /* Packets are scrambled by batches */
+        block_t *pp_ts[CSA_BATCH_SIZE];
+        uint8_t *pp_scrambled[CSA_BATCH_SIZE];
+        int i_batch = 0, i_scrambled = 0;
 
-        if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
+        for( ; i_batch < CSA_BATCH_SIZE && i < i_packet_count; i++ )
         {
-            /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
-            TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
+            block_t *p_ts = BufferChainGet( p_chain_ts );
+            vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
+
+            p_ts->i_dts    = i_new_dts;
+            p_ts->i_length = i_pcr_length / i_packet_count;
+
+            if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
+            {
+                /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
+                TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
+            }
+            if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
+                pp_scrambled[i_scrambled++] = p_ts->p_buffer;
+
+            pp_ts[i_batch++] = p_ts;
         }
-        if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
+
+        if( i_scrambled > 0 )
         {
             vlc_mutex_lock( &p_sys->csa_lock );
-            csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
+            csa_EncryptBatch( p_sys->csa, pp_scrambled, i_scrambled,
+                              p_sys->i_csa_pkt_size );
             vlc_mutex_unlock( &p_sys->csa_lock );
         }
 
-        /* latency */
-        p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+        for( int j = 0; j < i_batch; j++ )
+        {
+            block_t *p_ts = pp_ts[j];
+
+            /* latency */
+            p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
 
-        sout_AccessOutWrite( p_mux->p_access, p_ts );
+            sout_AccessOutWrite( p_mux->p_access, p_ts );
+        }
     }
 }
 
@@ -20,6 +20,8 @@
  *****************************************************************************/
 #include <vlc_bits.h>
 
+#include "startcode_helper.h"
+
 static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi_prev, size_t i_count )
 {
     for( size_t i=0; i<i_count; i++ )
@@ -74,7 +76,7 @@ struct hxxx_bsfw_ep3b_ctx_s
     size_t i_bytesize;
 };
 
-static void hxxx_bsfw_ep3b_ctx_init( struct hxxx_bsfw_ep3b_ctx_s *ctx )
+static inline void hxxx_bsfw_ep3b_ctx_init( struct hxxx_bsfw_ep3b_ctx_s *ctx )
 {
     ctx->i_prev = 0;
     ctx->i_bytepos = 0;
@@ -83,16 +85,16 @@ static void hxxx_bsfw_ep3b_ctx_init( struct hxxx_bsfw_ep3b_ctx_s *ctx )
 
 static size_t hxxx_ep3b_total_size( const uint8_t *p, const uint8_t *p_end )
 {
-    /* compute final size */
-    unsigned i_prev = 0;
-    size_t i = 0;
-    while( p < p_end )
-    {
-        uint8_t *n = hxxx_ep3b_to_rbsp( (uint8_t *)p, (uint8_t *)p_end, &i_prev, 1 );
-        if( n > p )
-            ++i;
-        p = n;
-    }
+    /* compute final size: same as forwarding byte per byte with
+     * hxxx_ep3b_to_rbsp(), which never looks at the first byte, nor escapes
+     * the last one, and restarts its history after each escape */
+    size_t i = p_end - p;
+    if( i == 0 )
+        return 0;
+    for( const uint8_t *ep = startcode_FindEP3B( p + 1, p_end );
+         ep != NULL && ep + 3 < p_end;
+         ep = startcode_FindEP3B( ep + 3, p_end ) )
+        --i;
     return i;
 }
 
@@ -22,9 +22,16 @@
 
 #include <vlc_cpu.h>
 
-#if !defined(CAN_COMPILE_SSE2) && defined(HAVE_SSE2_INTRINSICS)
+#ifdef HAVE_SSE2_INTRINSICS
    #include <emmintrin.h>
 #endif
+#ifdef HAVE_AVX2_INTRINSICS
+   #include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && !defined(WORDS_BIGENDIAN)
+   #include <arm_neon.h>
+   #define STARTCODE_NEON
+#endif
 
 /* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
  * by using a 4 times faster trick than single byte lookup. */
@@ -140,16 +147,125 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+/* Looks up 0x00 0x00 c at every position of a vector at once: the vectors
+ * loaded at p, p+1 and p+2 are compared, so that each lane of the result is
+ * a full match. Unaligned loads are fast enough there. */
+static inline const uint8_t * startcode_FindZeroes_C( const uint8_t *p, const uint8_t *end, uint8_t c )
+{
+    for (; end - p >= 3; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
+            return p;
+    }
+    return NULL;
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+__attribute__ ((__target__ ("sse2")))
+static inline const uint8_t * startcode_FindZeroes_SSE2( const uint8_t *p, const uint8_t *end, uint8_t c )
+{
+    const __m128i zeros = _mm_setzero_si128();
+    const __m128i last = _mm_set1_epi8( c );
+
+    for (; end - p >= 16 + 2; p += 16)
+    {
+        __m128i v = _mm_and_si128(
+            _mm_cmpeq_epi8( _mm_loadu_si128((const __m128i *)p), zeros ),
+            _mm_cmpeq_epi8( _mm_loadu_si128((const __m128i *)(p + 1)), zeros ) );
+        v = _mm_and_si128( v,
+            _mm_cmpeq_epi8( _mm_loadu_si128((const __m128i *)(p + 2)), last ) );
+        unsigned match = _mm_movemask_epi8( v );
+        if (match)
+            return p + vlc_ctz( match );
+    }
+    return startcode_FindZeroes_C( p, end, c );
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindZeroes_AVX2( const uint8_t *p, const uint8_t *end, uint8_t c )
+{
+    const __m256i zeros = _mm256_setzero_si256();
+    const __m256i last = _mm256_set1_epi8( c );
+
+    for (; end - p >= 32 + 2; p += 32)
+    {
+        __m256i v = _mm256_and_si256(
+            _mm256_cmpeq_epi8( _mm256_loadu_si256((const __m256i *)p), zeros ),
+            _mm256_cmpeq_epi8( _mm256_loadu_si256((const __m256i *)(p + 1)), zeros ) );
+        v = _mm256_and_si256( v,
+            _mm256_cmpeq_epi8( _mm256_loadu_si256((const __m256i *)(p + 2)), last ) );
+        unsigned match = _mm256_movemask_epi8( v );
+        if (match)
+            return p + vlc_ctz( match );
+    }
+    return startcode_FindZeroes_C( p, end, c );
+}
+#endif
+
+#ifdef STARTCODE_NEON
+/* NEON has no byte mask: lanes are all ones or zeroes, so the first match is
+ * the first non zero byte of the 64-bits halves. */
+static inline const uint8_t * startcode_FindZeroes_NEON( const uint8_t *p, const uint8_t *end, uint8_t c )
+{
+    const uint8x16_t zeros = vdupq_n_u8( 0 );
+    const uint8x16_t last = vdupq_n_u8( c );
+
+    for (; end - p >= 16 + 2; p += 16)
+    {
+        uint8x16_t v = vandq_u8( vceqq_u8( vld1q_u8( p ), zeros ),
+                                 vceqq_u8( vld1q_u8( p + 1 ), zeros ) );
+        v = vandq_u8( v, vceqq_u8( vld1q_u8( p + 2 ), last ) );
+        uint64x2_t w = vreinterpretq_u64_u8( v );
+        uint64_t lo = vgetq_lane_u64( w, 0 );
+        uint64_t hi = vgetq_lane_u64( w, 1 );
+        if (lo)
+            return p + vlc_ctzll( lo ) / 8;
+        if (hi)
+            return p + 8 + vlc_ctzll( hi ) / 8;
+    }
+    return startcode_FindZeroes_C( p, end, c );
+}
+#endif
+
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return startcode_FindZeroes_AVX2(p, end, 0x01);
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+    /* much faster than startcode_FindAnnexB_SSE2() when zeroes are frequent,
+     * as it does not stop on each of them */
+    if (vlc_CPU_SSE2())
+        return startcode_FindZeroes_SSE2(p, end, 0x01);
+#elif defined(CAN_COMPILE_SSE2)
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
+#endif
+#ifdef STARTCODE_NEON
+    if (vlc_CPU_ARM_NEON())
+        return startcode_FindZeroes_NEON(p, end, 0x01);
+#endif
+    return startcode_FindAnnexB_Bits(p, end);
 }
-#else
-    #define startcode_FindAnnexB startcode_FindAnnexB_Bits
+
+/* Looks up an emulation prevention sequence 0x00 0x00 0x03 */
+static inline const uint8_t * startcode_FindEP3B( const uint8_t *p, const uint8_t *end )
+{
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return startcode_FindZeroes_AVX2(p, end, 0x03);
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2())
+        return startcode_FindZeroes_SSE2(p, end, 0x03);
 #endif
+#ifdef STARTCODE_NEON
+    if (vlc_CPU_ARM_NEON())
+        return startcode_FindZeroes_NEON(p, end, 0x03);
+#endif
+    return startcode_FindZeroes_C(p, end, 0x03);
+}
 
 #endif
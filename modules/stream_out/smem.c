@@ -59,11 +59,13 @@
 
 #define T_VIDEO_PRERENDER_CALLBACK N_( "Video prerender callback" )
 #define LT_VIDEO_PRERENDER_CALLBACK N_( "Address of the video prerender callback function. " \
-                                "This function will set the buffer where render will be done." )
+                                "This function will set the buffer where render will be done. " \
+                                "Without it, the postrender callback gets the buffer of VLC, without copy." )
 
 #define T_AUDIO_PRERENDER_CALLBACK N_( "Audio prerender callback" )
 #define LT_AUDIO_PRERENDER_CALLBACK N_( "Address of the audio prerender callback function. " \
-                                        "This function will set the buffer where render will be done." )
+                                        "This function will set the buffer where render will be done. " \
+                                        "Without it, the postrender callback gets the buffer of VLC, without copy." )
 
 #define T_VIDEO_POSTRENDER_CALLBACK N_( "Video postrender callback" )
 #define LT_VIDEO_POSTRENDER_CALLBACK N_( "Address of the video postrender callback function. " \
@@ -150,8 +152,6 @@ typedef struct
     bool time_sync;
 } sout_stream_sys_t;
 
-void VideoPrerenderDefaultCallback( void* p_video_data, uint8_t** pp_pixel_buffer, size_t size );
-void AudioPrerenderDefaultCallback( void* p_audio_data, uint8_t** pp_pcm_buffer, size_t size );
 void VideoPostrenderDefaultCallback( void* p_video_data, uint8_t* p_pixel_buffer, int width, int height,
                                      int pixel_pitch, size_t size, vlc_tick_t pts );
 void AudioPostrenderDefaultCallback( void* p_audio_data, uint8_t* p_pcm_buffer, unsigned int channels,
@@ -162,16 +162,6 @@ void AudioPostrenderDefaultCallback( void* p_audio_data, uint8_t* p_pcm_buffer,
  * Default empty callbacks
  *****************************************************************************/
 
-void VideoPrerenderDefaultCallback( void* p_video_data, uint8_t** pp_pixel_buffer, size_t size )
-{
-    VLC_UNUSED( p_video_data ); VLC_UNUSED( pp_pixel_buffer ); VLC_UNUSED( size );
-}
-
-void AudioPrerenderDefaultCallback( void* p_audio_data, uint8_t** pp_pcm_buffer, size_t size )
-{
-    VLC_UNUSED( p_audio_data ); VLC_UNUSED( pp_pcm_buffer ); VLC_UNUSED( size );
-}
-
 void VideoPostrenderDefaultCallback( void* p_video_data, uint8_t* p_pixel_buffer, int width, int height,
                                      int pixel_pitch, size_t size, vlc_tick_t pts )
 {
@@ -211,14 +201,10 @@ static int Open( vlc_object_t *p_this )
     psz_tmp = var_GetString( p_stream, SOUT_PREFIX_VIDEO "prerender-callback" );
     p_sys->pf_video_prerender_callback = (void (*) (void *, uint8_t**, size_t))(intptr_t)atoll( psz_tmp );
     free( psz_tmp );
-    if (p_sys->pf_video_prerender_callback == NULL)
-        p_sys->pf_video_prerender_callback = VideoPrerenderDefaultCallback;
 
     psz_tmp = var_GetString( p_stream, SOUT_PREFIX_AUDIO "prerender-callback" );
     p_sys->pf_audio_prerender_callback = (void (*) (void* , uint8_t**, size_t))(intptr_t)atoll( psz_tmp );
     free( psz_tmp );
-    if (p_sys->pf_audio_prerender_callback == NULL)
-        p_sys->pf_audio_prerender_callback = AudioPrerenderDefaultCallback;
 
     psz_tmp = var_GetString( p_stream, SOUT_PREFIX_VIDEO "postrender-callback" );
     p_sys->pf_video_postrender_callback = (void (*) (void*, uint8_t*, int, int, int, size_t, vlc_tick_t))(intptr_t)atoll( psz_tmp );
@@ -360,18 +346,26 @@ static int SendVideo( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
     size_t i_size = p_buffer->i_buffer;
     uint8_t* p_pixels = NULL;
 
-    /* Calling the prerender callback to get user buffer */
-    p_sys->pf_video_prerender_callback( id->p_data, &p_pixels, i_size );
-
-    if (!p_pixels)
+    if( p_sys->pf_video_prerender_callback == NULL )
     {
-        msg_Err( p_stream, "No buffer given!" );
-        block_ChainRelease( p_buffer );
-        return VLC_EGENERIC;
+        /* No user buffer: lend ours until the postrender callback returns */
+        p_pixels = p_buffer->p_buffer;
+    }
+    else
+    {
+        /* Calling the prerender callback to get user buffer */
+        p_sys->pf_video_prerender_callback( id->p_data, &p_pixels, i_size );
+
+        if (!p_pixels)
+        {
+            msg_Err( p_stream, "No buffer given!" );
+            block_ChainRelease( p_buffer );
+            return VLC_EGENERIC;
+        }
+
+        /* Copying data into user buffer */
+        memcpy( p_pixels, p_buffer->p_buffer, i_size );
     }
-
-    /* Copying data into user buffer */
-    memcpy( p_pixels, p_buffer->p_buffer, i_size );
     /* Calling the postrender callback to tell the user his buffer is ready */
     p_sys->pf_video_postrender_callback( id->p_data, p_pixels,
                                          id->format.video.i_width, id->format.video.i_height,
@@ -397,17 +391,25 @@ static int SendAudio( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
     }
 
     i_samples = i_size / ( ( id->format.audio.i_bitspersample / 8 ) * id->format.audio.i_channels );
-    /* Calling the prerender callback to get user buffer */
-    p_sys->pf_audio_prerender_callback( id->p_data, &p_pcm_buffer, i_size );
-    if (!p_pcm_buffer)
+    if( p_sys->pf_audio_prerender_callback == NULL )
     {
-        msg_Err( p_stream, "No buffer given!" );
-        block_ChainRelease( p_buffer );
-        return VLC_EGENERIC;
+        /* No user buffer: lend ours until the postrender callback returns */
+        p_pcm_buffer = p_buffer->p_buffer;
+    }
+    else
+    {
+        /* Calling the prerender callback to get user buffer */
+        p_sys->pf_audio_prerender_callback( id->p_data, &p_pcm_buffer, i_size );
+        if (!p_pcm_buffer)
+        {
+            msg_Err( p_stream, "No buffer given!" );
+            block_ChainRelease( p_buffer );
+            return VLC_EGENERIC;
+        }
+
+        /* Copying data into user buffer */
+        memcpy( p_pcm_buffer, p_buffer->p_buffer, i_size );
     }
-
-    /* Copying data into user buffer */
-    memcpy( p_pcm_buffer, p_buffer->p_buffer, i_size );
     /* Calling the postrender callback to tell the user his buffer is ready */
     p_sys->pf_audio_postrender_callback( id->p_data, p_pcm_buffer,
                                          id->format.audio.i_channels, id->format.audio.i_rate, i_samples,
@@ -50,6 +50,8 @@ void transcode_encoder_delete( transcode_encoder_t *p_enc )
         {
             block_ChainRelease( p_enc->p_buffers );
             picture_fifo_Delete( p_enc->pp_pics );
+            if( p_enc->p_sched )
+                transcode_sched_chain_Delete( p_enc->p_sched );
         }
         es_format_Clean( &p_enc->p_encoder->fmt_in );
         es_format_Clean( &p_enc->p_encoder->fmt_out );
@@ -201,6 +203,12 @@ int transcode_encoder_open( transcode_encoder_t *p_enc,
     }
 }
 
+bool transcode_encoder_rescheduled( const transcode_encoder_t *p_enc )
+{
+    return p_enc->p_encoder->fmt_in.i_cat == VIDEO_ES &&
+           transcode_encoder_video_rescheduled( p_enc );
+}
+
 int transcode_encoder_drain( transcode_encoder_t *p_enc, block_t **out )
 {
     if( !transcode_encoder_opened( p_enc ) )
@@ -44,6 +44,7 @@ typedef struct
                 unsigned int i_count;
                 int          i_priority;
                 uint32_t     pool_size;
+                bool         b_auto;
             } threads;
         } video;
         struct
@@ -77,6 +78,8 @@ void transcode_encoder_close( transcode_encoder_t * );
 bool transcode_encoder_opened( const transcode_encoder_t * );
 int transcode_encoder_open( transcode_encoder_t *, const transcode_encoder_config_t * );
 int transcode_encoder_drain( transcode_encoder_t *, block_t ** );
+/* Whether the encoder should be restarted to apply a new share of CPUs */
+bool transcode_encoder_rescheduled( const transcode_encoder_t * );
 
 int transcode_encoder_test( encoder_t *p_encoder,
                             const transcode_encoder_config_t *p_cfg,
@@ -17,6 +17,7 @@
  * along with this program; if not, If not, see https://www.gnu.org/licenses/
  *****************************************************************************/
 #include <vlc_picture_fifo.h>
+#include "../scheduler.h"
 
 struct transcode_encoder_t
 {
@@ -31,6 +32,14 @@ struct transcode_encoder_t
     /* output buffers */
     block_t         *p_buffers;
     bool b_threaded;
+
+    /* threads scheduler accounting */
+    transcode_sched_chain_t *p_sched;
+    unsigned         i_sched_threads; /* share the encoder was opened with */
+    vlc_tick_t      *p_queued_dates; /* FIFO of the pictures push dates */
+    unsigned         i_queued_first;
+    unsigned         i_queued_count;
+    unsigned         i_queued_size;
 };
 
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
@@ -41,6 +50,7 @@ int transcode_encoder_spu_open( transcode_encoder_t *p_enc,
                                 const transcode_encoder_config_t *p_cfg );
 
 void transcode_encoder_video_close( transcode_encoder_t *p_enc );
+bool transcode_encoder_video_rescheduled( const transcode_encoder_t *p_enc );
 
 block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t *p_pic );
 block_t * transcode_encoder_audio_encode( transcode_encoder_t *p_enc, block_t *p_block );
@@ -27,6 +27,8 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
+
 #include <vlc_common.h>
 #include <vlc_modules.h>
 #include <vlc_codec.h>
@@ -350,12 +352,47 @@ int transcode_encoder_video_test( encoder_t *p_encoder,
     return p_module != NULL ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+static void EncoderPushDate( transcode_encoder_t *p_enc, vlc_tick_t i_date )
+{
+    if( !p_enc->p_queued_dates )
+        return;
+    assert( p_enc->i_queued_count < p_enc->i_queued_size );
+    unsigned i_index = ( p_enc->i_queued_first + p_enc->i_queued_count++ )
+                       % p_enc->i_queued_size;
+    p_enc->p_queued_dates[i_index] = i_date;
+}
+
+static vlc_tick_t EncoderPopDate( transcode_encoder_t *p_enc )
+{
+    if( !p_enc->p_queued_dates || p_enc->i_queued_count == 0 )
+        return vlc_tick_now();
+    vlc_tick_t i_date = p_enc->p_queued_dates[p_enc->i_queued_first];
+    p_enc->i_queued_first = ( p_enc->i_queued_first + 1 ) % p_enc->i_queued_size;
+    p_enc->i_queued_count--;
+    return i_date;
+}
+
+static block_t * EncoderEncodePicture( transcode_encoder_t *p_enc,
+                                       picture_t *p_pic, vlc_tick_t i_queued )
+{
+    if( !p_enc->p_sched || !p_pic )
+        return p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+
+    vlc_tick_t i_start = vlc_tick_now();
+    block_t *p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+    vlc_tick_t i_end = vlc_tick_now();
+    transcode_sched_chain_Report( p_enc->p_sched, i_end, i_end - i_start,
+                                  i_end - i_queued );
+    return p_block;
+}
+
 static void* EncoderThread( void *obj )
 {
     transcode_encoder_t *p_enc = obj;
     picture_t *p_pic = NULL;
     int canc = vlc_savecancel ();
     block_t *p_block = NULL;
+    vlc_tick_t i_queued;
 
     vlc_mutex_lock( &p_enc->lock_out );
 
@@ -368,9 +405,10 @@ static void* EncoderThread( void *obj )
 
         if( p_pic )
         {
+            i_queued = EncoderPopDate( p_enc );
             /* release lock while encoding */
             vlc_mutex_unlock( &p_enc->lock_out );
-            p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+            p_block = EncoderEncodePicture( p_enc, p_pic, i_queued );
             picture_Release( p_pic );
             vlc_mutex_lock( &p_enc->lock_out );
 
@@ -385,7 +423,8 @@ static void* EncoderThread( void *obj )
     while( (p_pic = picture_fifo_Pop( p_enc->pp_pics )) != NULL )
     {
         vlc_sem_post( &p_enc->picture_pool_has_room );
-        p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+        i_queued = EncoderPopDate( p_enc );
+        p_block = EncoderEncodePicture( p_enc, p_pic, i_queued );
         picture_Release( p_pic );
         block_ChainAppend( &p_enc->p_buffers, p_block );
     }
@@ -442,18 +481,46 @@ void transcode_encoder_video_close( transcode_encoder_t *p_enc )
     /* Close encoder */
     module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
     p_enc->p_encoder->p_module = NULL;
+
+    /* The chain, and its measured load, is kept for the next opening */
+    free( p_enc->p_queued_dates );
+    p_enc->p_queued_dates = NULL;
+}
+
+bool transcode_encoder_video_rescheduled( const transcode_encoder_t *p_enc )
+{
+    /* The thread count of an encoder is fixed once opened */
+    return p_enc->p_sched && p_enc->p_encoder->p_module &&
+           transcode_sched_chain_GetThreads( p_enc->p_sched ) != p_enc->i_sched_threads;
 }
 
 int transcode_encoder_video_open( transcode_encoder_t *p_enc,
                                    const transcode_encoder_config_t *p_cfg )
 {
-    p_enc->p_encoder->i_threads = p_cfg->video.threads.i_count;
+    unsigned i_threads = p_cfg->video.threads.i_count;
+    bool b_threaded = i_threads > 0;
+
+    if( p_cfg->video.threads.b_auto )
+    {
+        if( !p_enc->p_sched )
+            p_enc->p_sched = transcode_sched_chain_New( VLC_OBJECT(p_enc->p_encoder) );
+        if( p_enc->p_sched )
+        {
+            /* Only offload the encoder to its own thread if the chain is
+             * given more than a single CPU */
+            i_threads = transcode_sched_chain_GetThreads( p_enc->p_sched );
+            b_threaded = i_threads > 1;
+            p_enc->i_sched_threads = i_threads;
+        }
+    }
+
+    p_enc->p_encoder->i_threads = i_threads;
     p_enc->p_encoder->p_cfg = p_cfg->p_config_chain;
 
     p_enc->p_encoder->p_module =
         module_need( p_enc->p_encoder, "encoder", p_cfg->psz_name, true );
     if( !p_enc->p_encoder->p_module )
-        return VLC_EGENERIC;
+        goto error;
 
     p_enc->p_encoder->fmt_in.video.i_chroma = p_enc->p_encoder->fmt_in.i_codec;
 
@@ -465,32 +532,59 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
     vlc_cond_init( &p_enc->cond );
     p_enc->p_buffers = NULL;
     p_enc->b_abort = false;
+    p_enc->b_threaded = false;
 
-    if( p_cfg->video.threads.i_count > 0 )
+    if( b_threaded )
     {
+        if( p_enc->p_sched )
+        {
+            p_enc->p_queued_dates = vlc_alloc( p_cfg->video.threads.pool_size,
+                                               sizeof(*p_enc->p_queued_dates) );
+            if( !p_enc->p_queued_dates )
+            {
+                module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
+                p_enc->p_encoder->p_module = NULL;
+                goto error;
+            }
+            p_enc->i_queued_size = p_cfg->video.threads.pool_size;
+            p_enc->i_queued_first = 0;
+            p_enc->i_queued_count = 0;
+        }
+
         if( vlc_clone( &p_enc->thread, EncoderThread, p_enc, p_cfg->video.threads.i_priority ) )
         {
             module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
             p_enc->p_encoder->p_module = NULL;
-            return VLC_EGENERIC;
+            goto error;
         }
         p_enc->b_threaded = true;
     }
 
     return VLC_SUCCESS;
+
+error:
+    if( p_enc->p_sched )
+    {
+        transcode_sched_chain_Delete( p_enc->p_sched );
+        p_enc->p_sched = NULL;
+    }
+    free( p_enc->p_queued_dates );
+    p_enc->p_queued_dates = NULL;
+    return VLC_EGENERIC;
 }
 
 block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t *p_pic )
 {
     if( !p_enc->b_threaded )
     {
-        return p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+        return EncoderEncodePicture( p_enc, p_pic, vlc_tick_now() );
     }
 
     vlc_sem_wait( &p_enc->picture_pool_has_room );
     vlc_mutex_lock( &p_enc->lock_out );
     picture_Hold( p_pic );
     picture_fifo_Push( p_enc->pp_pics, p_pic );
+    EncoderPushDate( p_enc, vlc_tick_now() );
     vlc_cond_signal( &p_enc->cond );
     vlc_mutex_unlock( &p_enc->lock_out );
     return NULL;
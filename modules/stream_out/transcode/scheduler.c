@@ -0,0 +1,215 @@
+/*****************************************************************************
+ * scheduler.c: transcoding threads scheduler
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, If not, see https://www.gnu.org/licenses/
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+
+#include "scheduler.h"
+
+/* Statistics are computed, and loads updated, over that period */
+#define SCHED_WINDOW VLC_TICK_FROM_SEC(2)
+/* Applying a new share restarts the encoder: changes of load only move the
+ * shares that often, and by more than a quarter */
+#define SCHED_RESHARE_DELAY VLC_TICK_FROM_SEC(10)
+/* Loads are expressed in thousandths of a CPU */
+#define SCHED_LOAD_UNIT    1000
+/* Unmeasured chains are assumed to need a full CPU */
+#define SCHED_LOAD_DEFAULT SCHED_LOAD_UNIT
+/* Lower bound so that idle chains keep a share */
+#define SCHED_LOAD_MIN     (SCHED_LOAD_UNIT / 10)
+
+struct transcode_sched_chain_t
+{
+    struct vlc_list node;
+    vlc_object_t   *p_obj;
+    unsigned        i_id;
+    unsigned        i_load;
+    unsigned        i_threads;
+    vlc_tick_t      i_reshared; /* date of the last change of share */
+
+    /* Current statistics window */
+    vlc_tick_t      i_start;
+    unsigned        i_frames;
+    vlc_tick_t      i_busy;
+    vlc_tick_t      i_latency_sum;
+    vlc_tick_t      i_latency_max;
+
+    /* Lifetime totals */
+    vlc_tick_t      i_created;
+    uint64_t        i_total_frames;
+};
+
+static struct
+{
+    vlc_mutex_t     lock;
+    struct vlc_list chains;
+    unsigned        i_next_id;
+} sched = {
+    VLC_STATIC_MUTEX,
+    VLC_LIST_INITIALIZER(&sched.chains),
+    0,
+};
+
+static unsigned ChainLoad( const transcode_sched_chain_t *p_chain )
+{
+    return __MAX( p_chain->i_load, SCHED_LOAD_MIN );
+}
+
+/* Splits the CPUs between all the chains, in proportion of their load.
+ * Unless b_force, as when a chain comes or goes, the share of a chain only
+ * moves if it changed by more than a quarter, and not more often than
+ * SCHED_RESHARE_DELAY. Must be called with the lock held. */
+static void Reshare( vlc_tick_t now, bool b_force )
+{
+    unsigned i_cpus = vlc_GetCPUCount();
+    uint64_t i_total = 0;
+    transcode_sched_chain_t *p_chain;
+
+    vlc_list_foreach( p_chain, &sched.chains, node )
+        i_total += ChainLoad( p_chain );
+
+    vlc_list_foreach( p_chain, &sched.chains, node )
+    {
+        /* rounded to the nearest */
+        uint64_t i_share = ( (uint64_t) i_cpus * ChainLoad( p_chain )
+                             + i_total / 2 ) / i_total;
+        unsigned i_threads = VLC_CLIP( i_share, 1, i_cpus );
+        unsigned i_prev = p_chain->i_threads;
+
+        if( i_threads == i_prev )
+            continue;
+        if( i_prev != 0 && !b_force )
+        {
+            unsigned i_diff = i_threads > i_prev ? i_threads - i_prev
+                                                 : i_prev - i_threads;
+            if( 4 * i_diff <= i_prev )
+                continue;
+            if( now - p_chain->i_reshared < SCHED_RESHARE_DELAY )
+                continue;
+        }
+
+        p_chain->i_threads = i_threads;
+        p_chain->i_reshared = now;
+        msg_Dbg( p_chain->p_obj, "chain %u: using %u threads out of %u CPUs",
+                 p_chain->i_id, i_threads, i_cpus );
+    }
+}
+
+transcode_sched_chain_t * transcode_sched_chain_New( vlc_object_t *p_obj )
+{
+    transcode_sched_chain_t *p_chain = malloc( sizeof(*p_chain) );
+    if( !p_chain )
+        return NULL;
+
+    p_chain->p_obj = p_obj;
+    p_chain->i_load = SCHED_LOAD_DEFAULT;
+    p_chain->i_threads = 0;
+    p_chain->i_created = p_chain->i_reshared = vlc_tick_now();
+    p_chain->i_start = VLC_TICK_INVALID;
+    p_chain->i_frames = 0;
+    p_chain->i_busy = 0;
+    p_chain->i_latency_sum = 0;
+    p_chain->i_latency_max = 0;
+    p_chain->i_total_frames = 0;
+
+    vlc_mutex_lock( &sched.lock );
+    p_chain->i_id = sched.i_next_id++;
+    vlc_list_append( &p_chain->node, &sched.chains );
+    Reshare( p_chain->i_created, true );
+    vlc_mutex_unlock( &sched.lock );
+
+    return p_chain;
+}
+
+void transcode_sched_chain_Delete( transcode_sched_chain_t *p_chain )
+{
+    vlc_tick_t now = vlc_tick_now();
+
+    vlc_mutex_lock( &sched.lock );
+    vlc_list_remove( &p_chain->node );
+    Reshare( now, true );
+    vlc_mutex_unlock( &sched.lock );
+
+    vlc_tick_t i_elapsed = now - p_chain->i_created;
+    if( i_elapsed > 0 )
+        msg_Dbg( p_chain->p_obj, "chain %u: %"PRIu64" frames in %"PRId64" ms "
+                 "(%.2f fps)", p_chain->i_id, p_chain->i_total_frames,
+                 MS_FROM_VLC_TICK(i_elapsed),
+                 (double) p_chain->i_total_frames * CLOCK_FREQ / i_elapsed );
+    free( p_chain );
+}
+
+unsigned transcode_sched_chain_GetThreads( transcode_sched_chain_t *p_chain )
+{
+    vlc_mutex_lock( &sched.lock );
+    unsigned i_threads = p_chain->i_threads;
+    vlc_mutex_unlock( &sched.lock );
+    return i_threads;
+}
+
+void transcode_sched_chain_Report( transcode_sched_chain_t *p_chain,
+                                   vlc_tick_t now, vlc_tick_t i_busy,
+                                   vlc_tick_t i_latency )
+{
+    vlc_mutex_lock( &sched.lock );
+    if( p_chain->i_start == VLC_TICK_INVALID )
+        p_chain->i_start = now - i_busy;
+    p_chain->i_frames++;
+    p_chain->i_total_frames++;
+    p_chain->i_busy += i_busy;
+    p_chain->i_latency_sum += i_latency;
+    if( i_latency > p_chain->i_latency_max )
+        p_chain->i_latency_max = i_latency;
+
+    vlc_tick_t i_elapsed = now - p_chain->i_start;
+    if( i_elapsed < SCHED_WINDOW )
+    {
+        vlc_mutex_unlock( &sched.lock );
+        return;
+    }
+
+    /* Smooth the load so that a single slow window does not skew the
+     * shares of the other chains */
+    unsigned i_load = p_chain->i_busy * SCHED_LOAD_UNIT / i_elapsed;
+    p_chain->i_load = ( 3 * p_chain->i_load + i_load ) / 4;
+
+    double f_fps = (double) p_chain->i_frames * CLOCK_FREQ / i_elapsed;
+    vlc_tick_t i_latency_avg = p_chain->i_latency_sum / p_chain->i_frames;
+    vlc_tick_t i_latency_max = p_chain->i_latency_max;
+    unsigned i_load_avg = p_chain->i_load;
+
+    p_chain->i_start = now;
+    p_chain->i_frames = 0;
+    p_chain->i_busy = 0;
+    p_chain->i_latency_sum = 0;
+    p_chain->i_latency_max = 0;
+
+    Reshare( now, false );
+    unsigned i_threads = p_chain->i_threads;
+    vlc_mutex_unlock( &sched.lock );
+
+    msg_Dbg( p_chain->p_obj, "chain %u: %.2f fps, latency %"PRId64" ms "
+             "(max %"PRId64" ms), load %u.%02u CPUs, %u threads",
+             p_chain->i_id, f_fps, MS_FROM_VLC_TICK(i_latency_avg),
+             MS_FROM_VLC_TICK(i_latency_max), i_load_avg / SCHED_LOAD_UNIT,
+             i_load_avg % SCHED_LOAD_UNIT / 10, i_threads );
+}
@@ -0,0 +1,40 @@
+/*****************************************************************************
+ * scheduler.h: transcoding threads scheduler
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, If not, see https://www.gnu.org/licenses/
+ *****************************************************************************/
+
+/*
+ * The scheduler is shared by all the transcode instances of the process.
+ * Every opened video encoder registers a chain and reports the time spent
+ * encoding each frame. The available CPUs are then split between the
+ * registered chains in proportion of their measured load, and the shares are
+ * updated as chains are added, removed or report a different load.
+ */
+
+typedef struct transcode_sched_chain_t transcode_sched_chain_t;
+
+transcode_sched_chain_t * transcode_sched_chain_New( vlc_object_t * );
+void transcode_sched_chain_Delete( transcode_sched_chain_t * );
+
+/* Number of threads the chain should use, from its current share of CPUs */
+unsigned transcode_sched_chain_GetThreads( transcode_sched_chain_t * );
+
+/* Account one frame encoded at i_now.
+ * i_busy is the time spent encoding it, i_latency the time elapsed since it
+ * was handed to the encoder (including queueing). */
+void transcode_sched_chain_Report( transcode_sched_chain_t *, vlc_tick_t i_now,
+                                   vlc_tick_t i_busy, vlc_tick_t i_latency );
@@ -122,6 +122,11 @@
 #define THREADS_TEXT N_("Number of threads")
 #define THREADS_LONGTEXT N_( \
     "Number of threads used for the transcoding." )
+#define AUTO_THREADS_TEXT N_("Adaptive threads")
+#define AUTO_THREADS_LONGTEXT N_( \
+    "Share the available CPUs between all the video encoders of the " \
+    "process according to their measured load, instead of using a fixed " \
+    "number of threads." )
 #define HP_TEXT N_("High priority")
 #define HP_LONGTEXT N_( \
     "Runs the optional encoder thread at the OUTPUT priority instead of " \
@@ -211,6 +216,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "threads", 0, THREADS_TEXT,
                  THREADS_LONGTEXT, true )
         change_integer_range( 0, 32 )
+    add_bool( SOUT_CFG_PREFIX "auto-threads", false, AUTO_THREADS_TEXT,
+              AUTO_THREADS_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "pool-size", 10, POOL_TEXT, POOL_LONGTEXT, true )
         change_integer_range( 1, 1000 )
     add_bool( SOUT_CFG_PREFIX "high-priority", false, HP_TEXT, HP_LONGTEXT,
@@ -224,7 +231,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "auto-threads", NULL
 };
 
 /*****************************************************************************
@@ -325,6 +332,7 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
 
     p_cfg->video.threads.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
     p_cfg->video.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+    p_cfg->video.threads.b_auto = var_GetBool( p_stream, SOUT_CFG_PREFIX "auto-threads" );
 
     if( var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" ) )
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_OUTPUT;
@@ -525,6 +525,48 @@ static void tag_last_block_with_flag( block_t **out, int i_flag )
     }
 }
 
+/* Reopens the encoder with the same formats, as when its thread count
+ * changes. The new instance starts a new sequence, with its own extradata,
+ * so the downstream ES is replaced if that extradata differs, once the
+ * blocks of the previous sequence went to the old one. */
+static int transcode_video_encoder_restart( sout_stream_t *p_stream,
+                                            sout_stream_id_sys_t *id,
+                                            block_t **out )
+{
+    const es_format_t *p_fmt_out = transcode_encoder_format_out( id->encoder );
+    es_format_t fmt_prev;
+    es_format_Copy( &fmt_prev, p_fmt_out );
+
+    es_format_t fmt_new;
+    es_format_Copy( &fmt_new, p_fmt_out );
+    free( fmt_new.p_extra );
+    fmt_new.p_extra = NULL;
+    fmt_new.i_extra = 0;
+    transcode_encoder_update_format_out( id->encoder, &fmt_new );
+    es_format_Clean( &fmt_new );
+
+    int i_ret = transcode_encoder_open( id->encoder, id->p_enccfg );
+    if( i_ret == VLC_SUCCESS && id->downstream_id &&
+        ( p_fmt_out->i_extra != fmt_prev.i_extra ||
+          ( fmt_prev.i_extra > 0 &&
+            memcmp( p_fmt_out->p_extra, fmt_prev.p_extra, fmt_prev.i_extra ) ) ) )
+    {
+        msg_Dbg( p_stream, "encoder extradata changed, replacing the stream" );
+        if( *out &&
+            sout_StreamIdSend( p_stream->p_next, id->downstream_id, *out ) )
+            i_ret = VLC_EGENERIC;
+        *out = NULL;
+        sout_StreamIdDel( p_stream->p_next, id->downstream_id );
+        id->downstream_id =
+            id->pf_transcode_downstream_add( p_stream, &id->p_decoder->fmt_in,
+                                             p_fmt_out );
+        if( !id->downstream_id )
+            i_ret = VLC_EGENERIC;
+    }
+    es_format_Clean( &fmt_prev );
+    return i_ret;
+}
+
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
@@ -721,6 +763,17 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
             tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
             b_eos = false;
         }
+        else if( transcode_encoder_rescheduled( id->encoder ) )
+        {
+            msg_Dbg( p_stream, "restarting encoder with its new share of CPUs" );
+            bool b_drained = transcode_encoder_drain( id->encoder, out ) == VLC_SUCCESS;
+            transcode_encoder_close( id->encoder );
+            tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
+            /* the picture already went to the filters */
+            if( !b_drained ||
+                transcode_video_encoder_restart( p_stream, id, out ) != VLC_SUCCESS )
+                id->b_error = true;
+        }
 
         continue;
 error:
@@ -729,7 +782,8 @@ error:
         id->b_error = true;
     } while( p_pics );
 
-    if( id->p_enccfg->video.threads.i_count >= 1 )
+    if( id->p_enccfg->video.threads.i_count >= 1 ||
+        id->p_enccfg->video.threads.b_auto )
     {
         /* Pick up any return data the encoder thread wants to output. */
         block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
@@ -31,6 +31,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
+#include <vlc_modules.h>
 #include <vlc_mouse.h>
 #include <vlc_picture.h>
 
@@ -60,6 +61,10 @@ static int BuildChromaResize( filter_t * );
 static int BuildChromaChain( filter_t *p_filter );
 static int BuildFilterChain( filter_t *p_filter );
 
+static int TryTransformChain( filter_t *p_filter, int i_path );
+static int TryChromaResize( filter_t *p_filter, int i_path );
+static int TryChromaChain( filter_t *p_filter, int i_path );
+
 static int CreateChain( filter_t *p_filter, const es_format_t *p_fmt_mid );
 static int CreateResizeChromaChain( filter_t *p_filter, const es_format_t *p_fmt_mid );
 static filter_t * AppendTransform( filter_chain_t *p_chain, const es_format_t *p_fmt_in,
@@ -110,10 +115,24 @@ static const vlc_fourcc_t *get_allowed_chromas( filter_t *p_filter )
     }
 }
 
+#define CHAIN_STEPS_MAX 2
+
+typedef struct
+{
+    /* Converter module of each step, empty for a transform */
+    char modules[CHAIN_STEPS_MAX][32];
+} chain_steps_t;
+
 typedef struct
 {
     filter_chain_t *p_chain;
     filter_t *p_video_filter;
+
+    /* Converter modules of the path being built, either probed or, if
+     * b_cached, taken from the path cache */
+    chain_steps_t steps;
+    unsigned i_step;
+    bool b_cached;
 } filter_sys_t;
 
 /* Restart filter callback */
@@ -274,89 +293,298 @@ static picture_t *Chain( filter_t *p_filter, picture_t *p_pic )
     return filter_chain_VideoFilter( p_sys->p_chain, p_pic );
 }
 
+/*****************************************************************************
+ * Path cache
+ *****************************************************************************
+ * Each builder tries a few paths, i.e. orders of conversions or middle
+ * chromas, probing all the converters at every step until one path works.
+ * The first chain for some formats remembers the path that worked and the
+ * converter module of each of its steps: the next chains with the same
+ * formats append these modules by name without probing. If none worked, the
+ * next chains fail right away, but only for a while, since an allocation
+ * failure looks the same as a missing converter.
+ *****************************************************************************/
+#define PATH_CACHE_SIZE 64
+#define PATH_NONE (-1)
+#ifndef PATH_NONE_DELAY /* shortened by the tests */
+# define PATH_NONE_DELAY VLC_TICK_FROM_SEC(10)
+#endif
+
+typedef struct
+{
+    vlc_fourcc_t i_chroma;
+    uint32_t i_rmask, i_gmask, i_bmask;
+    unsigned i_width, i_height;
+    unsigned i_visible_width, i_visible_height;
+    video_orientation_t orientation;
+    video_color_primaries_t primaries;
+    video_transfer_func_t transfer;
+    video_color_space_t space;
+    video_color_range_t color_range;
+} chain_format_t;
+
+typedef struct
+{
+    /* Converters may depend on the options of the instance */
+    libvlc_int_t *p_libvlc;
+    int (*pf_try)( filter_t *, int );
+    int i_level;
+    bool b_allow_fmt_out_change;
+    chain_format_t in;
+    chain_format_t out;
+} chain_key_t;
+
+typedef struct
+{
+    int i_path;
+    chain_steps_t steps;
+    vlc_tick_t i_expiry; /* for PATH_NONE only */
+} chain_path_t;
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct
+    {
+        chain_key_t key;
+        chain_path_t path;
+    } entries[PATH_CACHE_SIZE];
+    unsigned i_count;
+    unsigned i_next;
+} path_cache = { .lock = VLC_STATIC_MUTEX };
+
+static void ChainFormatInit( chain_format_t *p_dst, const video_format_t *p_fmt )
+{
+    p_dst->i_chroma         = p_fmt->i_chroma;
+    p_dst->i_rmask          = p_fmt->i_rmask;
+    p_dst->i_gmask          = p_fmt->i_gmask;
+    p_dst->i_bmask          = p_fmt->i_bmask;
+    p_dst->i_width          = p_fmt->i_width;
+    p_dst->i_height         = p_fmt->i_height;
+    p_dst->i_visible_width  = p_fmt->i_visible_width;
+    p_dst->i_visible_height = p_fmt->i_visible_height;
+    p_dst->orientation      = p_fmt->orientation;
+    p_dst->primaries        = p_fmt->primaries;
+    p_dst->transfer         = p_fmt->transfer;
+    p_dst->space            = p_fmt->space;
+    p_dst->color_range      = p_fmt->color_range;
+}
+
+static bool ChainKeyInit( chain_key_t *p_key, filter_t *p_filter,
+                          int (*pf_try)( filter_t *, int ) )
+{
+    /* Hardware converters depend on the decoder device, not only on the
+     * formats */
+    if( p_filter->vctx_in != NULL )
+        return false;
+
+    /* zero the padding, keys are compared with memcmp() */
+    memset( p_key, 0, sizeof( *p_key ) );
+    p_key->p_libvlc = vlc_object_instance( p_filter );
+    p_key->pf_try = pf_try;
+    /* Deeper chains have fewer levels left to recurse */
+    p_key->i_level = var_GetInteger( p_filter, "chain-level" );
+    p_key->b_allow_fmt_out_change = p_filter->b_allow_fmt_out_change;
+    ChainFormatInit( &p_key->in, &p_filter->fmt_in.video );
+    ChainFormatInit( &p_key->out, &p_filter->fmt_out.video );
+    return true;
+}
+
+static bool PathCacheGet( const chain_key_t *p_key, chain_path_t *p_path )
+{
+    bool b_found = false;
+
+    vlc_mutex_lock( &path_cache.lock );
+    for( unsigned i = 0; i < path_cache.i_count; i++ )
+    {
+        if( !memcmp( &path_cache.entries[i].key, p_key, sizeof( *p_key ) ) )
+        {
+            *p_path = path_cache.entries[i].path;
+            b_found = p_path->i_path != PATH_NONE
+                   || p_path->i_expiry > vlc_tick_now();
+            break;
+        }
+    }
+    vlc_mutex_unlock( &path_cache.lock );
+    return b_found;
+}
+
+static void PathCachePut( const chain_key_t *p_key, const chain_path_t *p_path )
+{
+    vlc_mutex_lock( &path_cache.lock );
+    unsigned i;
+    for( i = 0; i < path_cache.i_count; i++ )
+        if( !memcmp( &path_cache.entries[i].key, p_key, sizeof( *p_key ) ) )
+            break;
+
+    if( i == path_cache.i_count )
+    {
+        /* Replace the oldest entry once full */
+        i = path_cache.i_next;
+        path_cache.i_next = ( path_cache.i_next + 1 ) % PATH_CACHE_SIZE;
+        if( path_cache.i_count < PATH_CACHE_SIZE )
+            path_cache.i_count++;
+        path_cache.entries[i].key = *p_key;
+    }
+    path_cache.entries[i].path = *p_path;
+    vlc_mutex_unlock( &path_cache.lock );
+}
+
+static int BuildPath( filter_t *p_filter, int (*pf_try)( filter_t *, int ) )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    chain_key_t key;
+    chain_path_t path;
+    const bool b_cache = ChainKeyInit( &key, p_filter, pf_try );
+
+    if( b_cache && PathCacheGet( &key, &path ) )
+    {
+        if( path.i_path == PATH_NONE )
+        {
+            msg_Dbg( p_filter, "no chain for these formats (cached)" );
+            return VLC_EGENERIC;
+        }
+        msg_Dbg( p_filter, "Trying cached path %d", path.i_path );
+        p_sys->steps = path.steps;
+        p_sys->b_cached = true;
+        int i_ret = pf_try( p_filter, path.i_path );
+        p_sys->b_cached = false;
+        if( i_ret == VLC_SUCCESS )
+            return VLC_SUCCESS;
+        /* The cached modules did not load, probe them all again */
+    }
+
+    for( int i_path = 0; ; i_path++ )
+    {
+        int i_ret = pf_try( p_filter, i_path );
+        if( i_ret == VLC_SUCCESS )
+        {
+            if( b_cache )
+            {
+                path.i_path = i_path;
+                path.steps = p_sys->steps;
+                path.i_expiry = VLC_TICK_INVALID;
+                PathCachePut( &key, &path );
+            }
+            return VLC_SUCCESS;
+        }
+        if( i_ret == VLC_ENOITEM )
+            break;
+    }
+
+    if( b_cache )
+    {
+        path.i_path = PATH_NONE;
+        path.i_expiry = vlc_tick_now() + PATH_NONE_DELAY;
+        PathCachePut( &key, &path );
+    }
+    return VLC_EGENERIC;
+}
+
 /*****************************************************************************
  * Builders
  *****************************************************************************/
 
 static int BuildTransformChain( filter_t *p_filter )
 {
+    return BuildPath( p_filter, TryTransformChain );
+}
 
+static int BuildChromaResize( filter_t *p_filter )
+{
+    return BuildPath( p_filter, TryChromaResize );
+}
+
+static int BuildChromaChain( filter_t *p_filter )
+{
+    return BuildPath( p_filter, TryChromaChain );
+}
+
+static int TryTransformChain( filter_t *p_filter, int i_path )
+{
     es_format_t fmt_mid;
     int i_ret;
 
-    /* Lets try transform first, then (potentially) resize+chroma */
-    msg_Dbg( p_filter, "Trying to build transform, then chroma+resize" );
-    es_format_Copy( &fmt_mid, &p_filter->fmt_in );
-    video_format_TransformTo(&fmt_mid.video, p_filter->fmt_out.video.orientation);
-    i_ret = CreateChain( p_filter, &fmt_mid );
-    es_format_Clean( &fmt_mid );
-    if( i_ret == VLC_SUCCESS )
-        return VLC_SUCCESS;
+    switch( i_path )
+    {
+        case 0:
+            /* Lets try transform first, then (potentially) resize+chroma */
+            msg_Dbg( p_filter, "Trying to build transform, then chroma+resize" );
+            es_format_Copy( &fmt_mid, &p_filter->fmt_in );
+            video_format_TransformTo(&fmt_mid.video, p_filter->fmt_out.video.orientation);
+            break;
+        case 1:
+            /* Lets try resize+chroma first, then transform */
+            msg_Dbg( p_filter, "Trying to build chroma+resize" );
+            EsFormatMergeSize( &fmt_mid, &p_filter->fmt_out, &p_filter->fmt_in );
+            break;
+        default:
+            return VLC_ENOITEM;
+    }
 
-    /* Lets try resize+chroma first, then transform */
-    msg_Dbg( p_filter, "Trying to build chroma+resize" );
-    EsFormatMergeSize( &fmt_mid, &p_filter->fmt_out, &p_filter->fmt_in );
     i_ret = CreateChain( p_filter, &fmt_mid );
     es_format_Clean( &fmt_mid );
     return i_ret;
 }
 
-static int BuildChromaResize( filter_t *p_filter )
+static int TryChromaResize( filter_t *p_filter, int i_path )
 {
     es_format_t fmt_mid;
     int i_ret;
 
-    /* Lets try resizing and then doing the chroma conversion */
-    msg_Dbg( p_filter, "Trying to build resize+chroma" );
-    EsFormatMergeSize( &fmt_mid, &p_filter->fmt_in, &p_filter->fmt_out );
-    i_ret = CreateResizeChromaChain( p_filter, &fmt_mid );
-    es_format_Clean( &fmt_mid );
-
-    if( i_ret == VLC_SUCCESS )
-        return VLC_SUCCESS;
-
-    /* Lets try it the other way arround (chroma and then resize) */
-    msg_Dbg( p_filter, "Trying to build chroma+resize" );
-    EsFormatMergeSize( &fmt_mid, &p_filter->fmt_out, &p_filter->fmt_in );
-    i_ret = CreateChain( p_filter, &fmt_mid );
+    switch( i_path )
+    {
+        case 0:
+            /* Lets try resizing and then doing the chroma conversion */
+            msg_Dbg( p_filter, "Trying to build resize+chroma" );
+            EsFormatMergeSize( &fmt_mid, &p_filter->fmt_in, &p_filter->fmt_out );
+            i_ret = CreateResizeChromaChain( p_filter, &fmt_mid );
+            break;
+        case 1:
+            /* Lets try it the other way arround (chroma and then resize) */
+            msg_Dbg( p_filter, "Trying to build chroma+resize" );
+            EsFormatMergeSize( &fmt_mid, &p_filter->fmt_out, &p_filter->fmt_in );
+            i_ret = CreateChain( p_filter, &fmt_mid );
+            break;
+        default:
+            return VLC_ENOITEM;
+    }
     es_format_Clean( &fmt_mid );
-    if( i_ret == VLC_SUCCESS )
-        return VLC_SUCCESS;
 
-    return VLC_EGENERIC;
+    return i_ret == VLC_SUCCESS ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
-static int BuildChromaChain( filter_t *p_filter )
+static int TryChromaChain( filter_t *p_filter, int i_path )
 {
     es_format_t fmt_mid;
-    int i_ret = VLC_EGENERIC;
+    int i_ret;
 
     /* Now try chroma format list */
     const vlc_fourcc_t *pi_allowed_chromas = get_allowed_chromas( p_filter );
-    for( int i = 0; pi_allowed_chromas[i]; i++ )
-    {
-        const vlc_fourcc_t i_chroma = pi_allowed_chromas[i];
-        if( i_chroma == p_filter->fmt_in.i_codec ||
-            i_chroma == p_filter->fmt_out.i_codec )
-            continue;
-
-        msg_Dbg( p_filter, "Trying to use chroma %4.4s as middle man",
-                 (char*)&i_chroma );
+    for( int i = 0; i < i_path; i++ )
+        if( !pi_allowed_chromas[i] )
+            return VLC_ENOITEM;
+
+    const vlc_fourcc_t i_chroma = pi_allowed_chromas[i_path];
+    if( !i_chroma )
+        return VLC_ENOITEM;
+    if( i_chroma == p_filter->fmt_in.i_codec ||
+        i_chroma == p_filter->fmt_out.i_codec )
+        return VLC_EGENERIC;
 
-        es_format_Copy( &fmt_mid, &p_filter->fmt_in );
-        fmt_mid.i_codec        =
-        fmt_mid.video.i_chroma = i_chroma;
-        fmt_mid.video.i_rmask  = 0;
-        fmt_mid.video.i_gmask  = 0;
-        fmt_mid.video.i_bmask  = 0;
-        video_format_FixRgb(&fmt_mid.video);
+    msg_Dbg( p_filter, "Trying to use chroma %4.4s as middle man",
+             (char*)&i_chroma );
 
-        i_ret = CreateChain( p_filter, &fmt_mid );
-        es_format_Clean( &fmt_mid );
+    es_format_Copy( &fmt_mid, &p_filter->fmt_in );
+    fmt_mid.i_codec        =
+    fmt_mid.video.i_chroma = i_chroma;
+    fmt_mid.video.i_rmask  = 0;
+    fmt_mid.video.i_gmask  = 0;
+    fmt_mid.video.i_bmask  = 0;
+    video_format_FixRgb(&fmt_mid.video);
 
-        if( i_ret == VLC_SUCCESS )
-            break;
-    }
+    i_ret = CreateChain( p_filter, &fmt_mid );
+    es_format_Clean( &fmt_mid );
 
     return i_ret;
 }
@@ -429,14 +657,58 @@ static int BuildFilterChain( filter_t *p_filter )
 /*****************************************************************************
  *
  *****************************************************************************/
-static int CreateChain( filter_t *p_filter, const es_format_t *p_fmt_mid )
+static void ResetSteps( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     filter_chain_Reset( p_sys->p_chain, &p_filter->fmt_in, p_filter->vctx_in, &p_filter->fmt_out );
+    p_sys->i_step = 0;
+}
+
+/* Appends the converter of the next step: the cached module if any, else
+ * the first converter that accepts the formats, whose name is recorded */
+static int AppendConverterStep( filter_t *p_filter, const es_format_t *p_fmt_out )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned i_step = p_sys->i_step++;
+    assert( i_step < CHAIN_STEPS_MAX );
+    char *psz_module = p_sys->steps.modules[i_step];
+
+    filter_t *p_conv = filter_chain_AppendConverterByName( p_sys->p_chain,
+        p_sys->b_cached && psz_module[0] ? psz_module : NULL, p_fmt_out );
+    if( p_conv == NULL )
+        return VLC_EGENERIC;
+
+    if( !p_sys->b_cached )
+    {
+        const char *psz_name = module_get_object( p_conv->p_module );
+        /* Too long a name is probed again next time */
+        if( strlen( psz_name ) >= sizeof( p_sys->steps.modules[i_step] ) )
+            psz_name = "";
+        strcpy( psz_module, psz_name );
+    }
+    return VLC_SUCCESS;
+}
+
+static filter_t *AppendTransformStep( filter_t *p_filter,
+                                      const es_format_t *p_fmt_in,
+                                      const es_format_t *p_fmt_out )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned i_step = p_sys->i_step++;
+    assert( i_step < CHAIN_STEPS_MAX );
+    if( !p_sys->b_cached )
+        p_sys->steps.modules[i_step][0] = '\0';
+    return AppendTransform( p_sys->p_chain, p_fmt_in, p_fmt_out );
+}
+
+static int CreateChain( filter_t *p_filter, const es_format_t *p_fmt_mid )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    ResetSteps( p_filter );
 
     if( p_filter->fmt_in.video.orientation != p_fmt_mid->video.orientation)
     {
-        filter_t *p_transform = AppendTransform( p_sys->p_chain, &p_filter->fmt_in, p_fmt_mid );
+        filter_t *p_transform = AppendTransformStep( p_filter, &p_filter->fmt_in, p_fmt_mid );
         // Check if filter was enough:
         if( p_transform == NULL )
             return VLC_EGENERIC;
@@ -448,19 +720,19 @@ static int CreateChain( filter_t *p_filter, const es_format_t *p_fmt_mid )
     }
     else
     {
-        if( filter_chain_AppendConverter( p_sys->p_chain, p_fmt_mid ) )
+        if( AppendConverterStep( p_filter, p_fmt_mid ) )
             return VLC_EGENERIC;
     }
 
     if( p_fmt_mid->video.orientation != p_filter->fmt_out.video.orientation)
     {
-        if( AppendTransform( p_sys->p_chain, p_fmt_mid,
-                             &p_filter->fmt_out ) == NULL )
+        if( AppendTransformStep( p_filter, p_fmt_mid,
+                                 &p_filter->fmt_out ) == NULL )
             goto error;
     }
     else
     {
-        if( filter_chain_AppendConverter( p_sys->p_chain, &p_filter->fmt_out ) )
+        if( AppendConverterStep( p_filter, &p_filter->fmt_out ) )
             goto error;
     }
     p_filter->vctx_out = filter_chain_GetVideoCtxOut( p_sys->p_chain );
@@ -474,9 +746,9 @@ error:
 static int CreateResizeChromaChain( filter_t *p_filter, const es_format_t *p_fmt_mid )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    filter_chain_Reset( p_sys->p_chain, &p_filter->fmt_in, p_filter->vctx_in, &p_filter->fmt_out );
+    ResetSteps( p_filter );
 
-    int i_ret = filter_chain_AppendConverter( p_sys->p_chain, p_fmt_mid );
+    int i_ret = AppendConverterStep( p_filter, p_fmt_mid );
     if( i_ret != VLC_SUCCESS )
         return i_ret;
 
@@ -491,11 +763,11 @@ static int CreateResizeChromaChain( filter_t *p_filter, const es_format_t *p_fmt
                         filter_chain_GetFmtOut( p_sys->p_chain ) );
         fmt_out.video.i_chroma = p_filter->fmt_out.video.i_chroma;
 
-        i_ret = filter_chain_AppendConverter( p_sys->p_chain, &fmt_out );
+        i_ret = AppendConverterStep( p_filter, &fmt_out );
         es_format_Clean( &fmt_out );
     }
     else
-        i_ret = filter_chain_AppendConverter( p_sys->p_chain, &p_filter->fmt_out );
+        i_ret = AppendConverterStep( p_filter, &p_filter->fmt_out );
 
     if( i_ret != VLC_SUCCESS )
         filter_chain_Clear( p_sys->p_chain );
@@ -32,6 +32,7 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
 
@@ -57,6 +58,9 @@ static int DenoiseCallback( vlc_object_t *p_this, char const *psz_var,
 #define CHROMA_SPAT_TEXT        N_("Spatial chroma strength (0-254)")
 #define LUMA_TEMP_TEXT          N_("Temporal luma strength (0-254)")
 #define CHROMA_TEMP_TEXT        N_("Temporal chroma strength (0-254)")
+#define THREADS_TEXT            N_("Threads")
+#define THREADS_LONGTEXT        N_("Number of threads used to filter " \
+                                   "the pictures (0 = automatic).")
 
 vlc_module_begin()
     set_shortname(N_("HQ Denoiser 3D"))
@@ -73,6 +77,8 @@ vlc_module_begin()
             LUMA_TEMP_TEXT, LUMA_TEMP_TEXT, false)
     add_float_with_range(FILTER_PREFIX "chroma-temp", 4.5, 0.0, 254.0,
             CHROMA_TEMP_TEXT, CHROMA_TEMP_TEXT, false)
+    add_integer_with_range(FILTER_PREFIX "threads", 0, 0, 64,
+            THREADS_TEXT, THREADS_LONGTEXT, true)
 
     add_shortcut("hqdn3d")
 
@@ -80,13 +86,33 @@ vlc_module_begin()
 vlc_module_end()
 
 static const char *const filter_options[] = {
-    "luma-spat", "chroma-spat", "luma-temp", "chroma-temp", NULL
+    "luma-spat", "chroma-spat", "luma-temp", "chroma-temp", "threads", NULL
 };
 
 /*****************************************************************************
  * filter_sys_t
  *****************************************************************************/
+typedef struct filter_sys_t filter_sys_t;
+
+/* One plane, processed by all the threads in bands */
+typedef struct
+{
+    const uint8_t *src;
+    uint8_t *dst;
+    int w, h, src_pitch, dst_pitch;
+    unsigned short *ant;
+    int *spat, *temp;
+    bool spatial;
+} plane_job_t;
+
 typedef struct
+{
+    filter_sys_t *sys;
+    vlc_thread_t thread;
+    unsigned index;
+} worker_t;
+
+struct filter_sys_t
 {
     const vlc_chroma_description_t *chroma;
     int w[3], h[3];
@@ -95,7 +121,162 @@ typedef struct
     bool   b_recalc_coefs;
     vlc_mutex_t coefs_mutex;
     float  luma_spat, luma_temp, chroma_spat, chroma_temp;
-} filter_sys_t;
+
+    /* Split passes, when parallel or vectorized */
+    bool split;
+    unsigned int *horiz;
+    void (*horizontal)(const unsigned char *, unsigned int *,
+                       int, int, int, int, int *, int *);
+    void (*vertical)(const unsigned char *, const unsigned int *,
+                     unsigned char *, unsigned int *, unsigned short *,
+                     int, int, int, int, int, int, int *, int *);
+
+    /* Worker threads, the filter thread being the first one */
+    unsigned thread_count;
+    worker_t *workers;
+    vlc_mutex_t lock;
+    vlc_cond_t wait_job;
+    vlc_cond_t wait_done;
+    unsigned generation;
+    unsigned pending;
+    bool quit;
+    const plane_job_t *job;
+    void (*run)(filter_sys_t *, const plane_job_t *, unsigned index);
+};
+
+/*****************************************************************************
+ * Parallel passes
+ *****************************************************************************/
+static void RunHorizontal(filter_sys_t *sys, const plane_job_t *job,
+                          unsigned index)
+{
+    /* Bands of 8 lines, the last one takes the remaining lines */
+    int groups = (job->h + 7) / 8;
+    int y0 = 8 * (groups * index / sys->thread_count);
+    int y1 = 8 * (groups * (index + 1) / sys->thread_count);
+
+    if (y1 > job->h)
+        y1 = job->h;
+    if (y0 < y1)
+        sys->horizontal(job->src, sys->horiz, job->w, y0, y1, job->src_pitch,
+                      job->spat, job->temp);
+}
+
+static void RunVertical(filter_sys_t *sys, const plane_job_t *job,
+                        unsigned index)
+{
+    /* Bands of whole vectors, the last one takes the remaining columns */
+    int vectors = (job->w + 7) / 8;
+    int x0 = 8 * (vectors * index / sys->thread_count);
+    int x1 = 8 * (vectors * (index + 1) / sys->thread_count);
+
+    if (x1 > job->w)
+        x1 = job->w;
+    if (x0 < x1)
+        sys->vertical(job->src, job->spatial ? sys->horiz : NULL, job->dst,
+                      sys->cfg.Line, job->ant, job->w, job->h, x0, x1,
+                      job->src_pitch, job->dst_pitch, job->spat, job->temp);
+}
+
+static void *Worker(void *data)
+{
+    worker_t *worker = data;
+    filter_sys_t *sys = worker->sys;
+    unsigned generation = 0;
+
+    vlc_mutex_lock(&sys->lock);
+    for (;;)
+    {
+        while (!sys->quit && sys->generation == generation)
+            vlc_cond_wait(&sys->wait_job, &sys->lock);
+        if (sys->quit)
+            break;
+        generation = sys->generation;
+        vlc_mutex_unlock(&sys->lock);
+
+        sys->run(sys, sys->job, worker->index);
+
+        vlc_mutex_lock(&sys->lock);
+        if (--sys->pending == 0)
+            vlc_cond_signal(&sys->wait_done);
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
+/* Runs a pass on all the threads and waits for its completion */
+static void RunJob(filter_sys_t *sys, const plane_job_t *job,
+                   void (*run)(filter_sys_t *, const plane_job_t *, unsigned))
+{
+    if (sys->thread_count > 1)
+    {
+        vlc_mutex_lock(&sys->lock);
+        sys->job = job;
+        sys->run = run;
+        sys->pending = sys->thread_count - 1;
+        sys->generation++;
+        vlc_cond_broadcast(&sys->wait_job);
+        vlc_mutex_unlock(&sys->lock);
+    }
+
+    run(sys, job, 0);
+
+    if (sys->thread_count > 1)
+    {
+        vlc_mutex_lock(&sys->lock);
+        while (sys->pending > 0)
+            vlc_cond_wait(&sys->wait_done, &sys->lock);
+        vlc_mutex_unlock(&sys->lock);
+    }
+}
+
+static void StopWorkers(filter_sys_t *sys, unsigned count)
+{
+    vlc_mutex_lock(&sys->lock);
+    sys->quit = true;
+    vlc_cond_broadcast(&sys->wait_job);
+    vlc_mutex_unlock(&sys->lock);
+
+    for (unsigned i = 0; i < count; i++)
+        vlc_join(sys->workers[i].thread, NULL);
+    free(sys->workers);
+}
+
+static void DenoisePlane(filter_sys_t *sys, picture_t *src, picture_t *dst,
+                         int plane, int *spat, int *temp)
+{
+    struct vf_priv_s *cfg = &sys->cfg;
+
+    if (!sys->split)
+    {
+        deNoise(src->p[plane].p_pixels, dst->p[plane].p_pixels,
+                cfg->Line, &cfg->Frame[plane], sys->w[plane], sys->h[plane],
+                src->p[plane].i_pitch, dst->p[plane].i_pitch,
+                spat, spat, temp);
+        return;
+    }
+
+    plane_job_t job = {
+        .src = src->p[plane].p_pixels,
+        .dst = dst->p[plane].p_pixels,
+        .w = sys->w[plane],
+        .h = sys->h[plane],
+        .src_pitch = src->p[plane].i_pitch,
+        .dst_pitch = dst->p[plane].i_pitch,
+        .spat = spat,
+        .temp = temp,
+        .spatial = spat[0] != 0,
+    };
+
+    job.ant = deNoiseFrameAnt(job.src, &cfg->Frame[plane], job.w, job.h,
+                              job.src_pitch);
+    if (!job.ant)
+        return;
+
+    if (job.spatial)
+        RunJob(sys, &job, RunHorizontal);
+    RunJob(sys, &job, RunVertical);
+}
 
 /*****************************************************************************
  * Open
@@ -109,7 +290,7 @@ static int Open(vlc_object_t *this)
     const video_format_t *fmt_out = &filter->fmt_out.video;
     const vlc_fourcc_t fourcc_in  = fmt_in->i_chroma;
     const vlc_fourcc_t fourcc_out = fmt_out->i_chroma;
-    int wmax = 0;
+    int wmax = 0, hmax = 0;
 
     const vlc_chroma_description_t *chroma =
             vlc_fourcc_GetChromaDescription(fourcc_in);
@@ -136,6 +317,7 @@ static int Open(vlc_object_t *this)
         sys->w[i] = fmt_in->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
         if (sys->w[i] > wmax) wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
+        if (sys->h[i] > hmax) hmax = sys->h[i];
     }
     cfg->Line = malloc(wmax*sizeof(unsigned int));
     if (!cfg->Line) {
@@ -146,6 +328,77 @@ static int Open(vlc_object_t *this)
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
                       filter->p_cfg);
 
+    /* The original single pass is the fastest on a single scalar thread */
+    unsigned threads = var_InheritInteger(filter, FILTER_PREFIX "threads");
+    if (threads == 0)
+        threads = vlc_GetCPUCount();
+    /* Each thread needs a few lines */
+    if (threads > (unsigned)hmax / 16)
+        threads = hmax / 16;
+    if (threads < 1)
+        threads = 1;
+
+    const char *simd = NULL;
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2()) {
+        sys->horizontal = deNoiseHorizontalAVX2;
+        sys->vertical = deNoiseVerticalAVX2;
+        simd = "AVX2";
+    } else
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE4_1()) {
+        sys->horizontal = deNoiseHorizontalSSE4;
+        sys->vertical = deNoiseVerticalSSE4;
+        simd = "SSE4.1";
+    } else
+#endif
+#ifdef __ARM_NEON
+    if (vlc_CPU_ARM_NEON()) {
+        sys->horizontal = deNoiseHorizontalNEON;
+        sys->vertical = deNoiseVerticalNEON;
+        simd = "NEON";
+    } else
+#endif
+    {
+        sys->horizontal = deNoiseHorizontal;
+        sys->vertical = deNoiseVertical;
+    }
+    sys->split = threads > 1 || sys->vertical != deNoiseVertical;
+    sys->thread_count = 1;
+
+    if (sys->split) {
+        sys->horiz = vlc_alloc(wmax * hmax, sizeof(unsigned int));
+        if (!sys->horiz) {
+            free(cfg->Line);
+            free(sys);
+            return VLC_ENOMEM;
+        }
+    }
+
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait_job);
+    vlc_cond_init(&sys->wait_done);
+    if (threads > 1) {
+        sys->workers = vlc_alloc(threads - 1, sizeof(*sys->workers));
+        if (sys->workers) {
+            unsigned i;
+            for (i = 0; i < threads - 1; i++) {
+                sys->workers[i].sys = sys;
+                sys->workers[i].index = i + 1;
+                if (vlc_clone(&sys->workers[i].thread, Worker,
+                              &sys->workers[i], VLC_THREAD_PRIORITY_VIDEO))
+                    break;
+            }
+            if (i == threads - 1)
+                sys->thread_count = threads;
+            else
+                StopWorkers(sys, i);
+        }
+    }
+    msg_Dbg(filter, "using %u thread(s)%s%s", sys->thread_count,
+            simd ? " with " : "", simd ? simd : "");
+
 
     vlc_mutex_init( &sys->coefs_mutex );
     sys->b_recalc_coefs = true;
@@ -179,9 +432,13 @@ static void Close(vlc_object_t *this)
     var_DelCallback( filter, FILTER_PREFIX "luma-temp", DenoiseCallback, sys );
     var_DelCallback( filter, FILTER_PREFIX "chroma-temp", DenoiseCallback, sys );
 
+    if (sys->thread_count > 1)
+        StopWorkers(sys, sys->thread_count - 1);
+
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
     }
+    free(sys->horiz);
     free(cfg->Line);
     free(sys);
 }
@@ -218,24 +475,9 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
+    DenoisePlane(sys, src, dst, 0, cfg->Coefs[0], cfg->Coefs[1]);
+    DenoisePlane(sys, src, dst, 1, cfg->Coefs[2], cfg->Coefs[3]);
+    DenoisePlane(sys, src, dst, 2, cfg->Coefs[2], cfg->Coefs[3]);
 
     if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
     {
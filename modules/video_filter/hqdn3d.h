@@ -104,28 +104,40 @@ static void deNoiseSpacial(
     }
 }
 
-static void deNoise(unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
-                    unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical, int *Temporal)
+/* Previous frame of the plane, initialized from the first one */
+static unsigned short *deNoiseFrameAnt(const unsigned char *Frame,
+                                       unsigned short **FrameAntPtr,
+                                       int W, int H, int sStride)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
     unsigned short* FrameAnt=(*FrameAntPtr);
 
     if(!FrameAnt){
         (*FrameAntPtr)=FrameAnt=malloc(W*H*sizeof(unsigned short));
         if(!FrameAnt)
-            return;
+            return NULL;
         for (long Y = 0; Y < H; Y++){
             unsigned short* dst=&FrameAnt[Y*W];
-            unsigned char* src=Frame+Y*sStride;
+            const unsigned char* src=Frame+Y*sStride;
             for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
         }
     }
+    return FrameAnt;
+}
+
+static void deNoise(unsigned char *Frame,        // mpi->planes[x]
+                    unsigned char *FrameDest,    // dmpi->planes[x]
+                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
+                    unsigned short **FrameAntPtr,
+                    int W, int H, int sStride, int dStride,
+                    int *Horizontal, int *Vertical, int *Temporal)
+{
+    long sLineOffs = 0, dLineOffs = 0;
+    unsigned int PixelAnt;
+    unsigned int PixelDst;
+    unsigned short* FrameAnt=deNoiseFrameAnt(Frame, FrameAntPtr, W, H, sStride);
+
+    if(!FrameAnt)
+        return;
 
     if(!Horizontal[0] && !Vertical[0]){
         deNoiseTemporal(Frame, FrameDest, FrameAnt,
@@ -174,6 +186,511 @@ static void deNoise(unsigned char *Frame,        // mpi->planes[x]
     }
 }
 
+//===========================================================================//
+
+/* deNoise() split in passes which can run in parallel, with the same output.
+ * The horizontal pass only depends on the pixels of the same line, so lines
+ * can be processed in any order. The vertical and temporal passes only depend
+ * on the pixels of the same column, so columns can be processed in any order,
+ * several at once in SIMD lanes. */
+
+/* Without temporal filtering, deNoiseSpacial() filters the whole first line
+ * against its first pixel: this is kept for the output to be the same. */
+static void deNoiseHorizontal(const unsigned char *Frame, // mpi->planes[x]
+                              unsigned int *Horiz,        // W*H pixels
+                              int W, int Y0, int Y1, int sStride,
+                              int *Horizontal, int *Temporal)
+{
+    for (long Y = Y0; Y < Y1; Y++){
+        const unsigned char *src = Frame + Y*sStride;
+        unsigned int *dst = Horiz + Y*W;
+        unsigned int PixelAnt = dst[0] = src[0]<<16;
+
+        if (Y == 0 && !Temporal[0]){
+            for (long X = 1; X < W; X++)
+                dst[X] = LowPassMul(PixelAnt, src[X]<<16, Horizontal);
+            continue;
+        }
+        for (long X = 1; X < W; X++)
+            PixelAnt = dst[X] = LowPassMul(PixelAnt, src[X]<<16, Horizontal);
+    }
+}
+
+/* Filters the columns X0 to X1 (excluded). Without Horiz, the spatial
+ * filtering is disabled and only the temporal one applies, whatever its
+ * strength, as in deNoise(). */
+static void deNoiseVertical(const unsigned char *Frame,  // mpi->planes[x]
+                            const unsigned int *Horiz,   // W*H pixels or NULL
+                            unsigned char *FrameDest,    // dmpi->planes[x]
+                            unsigned int *LineAnt,       // vf->priv->Line
+                            unsigned short *FrameAnt,
+                            int W, int H, int X0, int X1,
+                            int sStride, int dStride,
+                            int *Vertical, int *Temporal)
+{
+    const int Temp = !Horiz || Temporal[0];
+
+    for (long Y = 0; Y < H; Y++){
+        for (long X = X0; X < X1; X++){
+            unsigned int PixelDst;
+
+            if (Horiz){
+                PixelDst = Horiz[Y*W+X];
+                /* First line has no top neighbor */
+                if (Y > 0)
+                    PixelDst = LowPassMul(LineAnt[X], PixelDst, Vertical);
+                LineAnt[X] = PixelDst;
+            } else
+                PixelDst = Frame[Y*sStride+X]<<16;
+
+            if (Temp){
+                PixelDst = LowPassMul(FrameAnt[Y*W+X]<<8, PixelDst, Temporal);
+                FrameAnt[Y*W+X] = ((PixelDst+0x1000007F)>>8);
+            }
+            FrameDest[Y*dStride+X]= ((PixelDst+0x10007FFF)>>16);
+        }
+    }
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+
+/* The coefficients are gathered 8 at a time. The differences are always
+ * positive once offset, so the logical shift matches the arithmetic one. */
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i LowPassMulAVX2(__m256i PrevMul, __m256i CurrMul,
+                                     const int *Coef)
+{
+    __m256i d = _mm256_sub_epi32(PrevMul, CurrMul);
+    d = _mm256_srli_epi32(_mm256_add_epi32(d, _mm256_set1_epi32(0x10007FF)),
+                          12);
+    return _mm256_add_epi32(CurrMul, _mm256_i32gather_epi32(Coef, d, 4));
+}
+
+/* Narrows 8 32-bits lanes to their low 16 bits */
+__attribute__ ((__target__ ("avx2")))
+static inline __m128i Pack16AVX2(__m256i v)
+{
+    v = _mm256_and_si256(v, _mm256_set1_epi32(0xFFFF));
+    v = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08);
+    return _mm256_castsi256_si128(v);
+}
+
+/* Transposes 8 vectors of 8 32-bits lanes */
+__attribute__ ((__target__ ("avx2")))
+static inline void Transpose8x8AVX2(__m256i *r)
+{
+    __m256i t[8], u[8];
+
+    for (int i = 0; i < 8; i += 2){
+        t[i]   = _mm256_unpacklo_epi32(r[i], r[i+1]);
+        t[i+1] = _mm256_unpackhi_epi32(r[i], r[i+1]);
+    }
+    for (int i = 0; i < 8; i += 4){
+        u[i]   = _mm256_unpacklo_epi64(t[i], t[i+2]);
+        u[i+1] = _mm256_unpackhi_epi64(t[i], t[i+2]);
+        u[i+2] = _mm256_unpacklo_epi64(t[i+1], t[i+3]);
+        u[i+3] = _mm256_unpackhi_epi64(t[i+1], t[i+3]);
+    }
+    for (int i = 0; i < 4; i++){
+        r[i]   = _mm256_permute2x128_si256(u[i], u[i+4], 0x20);
+        r[i+4] = _mm256_permute2x128_si256(u[i], u[i+4], 0x31);
+    }
+}
+
+/* Filters 8 lines at once, one per lane: blocks of 8x8 pixels are
+ * transposed so that each vector holds a column. */
+__attribute__ ((__target__ ("avx2")))
+static void deNoiseHorizontalAVX2(const unsigned char *Frame,
+                                  unsigned int *Horiz,
+                                  int W, int Y0, int Y1, int sStride,
+                                  int *Horizontal, int *Temporal)
+{
+    const int XV = W & ~7;
+    long Y = Y0;
+
+    if (Y == 0 && !Temporal[0] && Y < Y1){
+        deNoiseHorizontal(Frame, Horiz, W, 0, 1, sStride,
+                          Horizontal, Temporal);
+        Y++;
+    }
+
+    for (; Y + 8 <= Y1 && XV > 0; Y += 8){
+        __m256i PixelAnt = _mm256_setzero_si256();
+
+        for (long X = 0; X < XV; X += 8){
+            __m256i r[8];
+
+            for (int i = 0; i < 8; i++)
+                r[i] = _mm256_slli_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(
+                    (const __m128i *)&Frame[(Y+i)*sStride+X])), 16);
+            Transpose8x8AVX2(r);
+
+            /* First pixel on each line doesn't have previous pixel */
+            PixelAnt = r[0] = X ? LowPassMulAVX2(PixelAnt, r[0], Horizontal)
+                                : r[0];
+            for (int i = 1; i < 8; i++)
+                PixelAnt = r[i] = LowPassMulAVX2(PixelAnt, r[i], Horizontal);
+
+            Transpose8x8AVX2(r);
+            for (int i = 0; i < 8; i++)
+                _mm256_storeu_si256((__m256i *)&Horiz[(Y+i)*W+X], r[i]);
+        }
+
+        /* Remaining columns, carrying on from the last filtered ones */
+        for (int i = 0; i < 8; i++){
+            const unsigned char *src = Frame + (Y+i)*sStride;
+            unsigned int *dst = Horiz + (Y+i)*W;
+
+            for (long X = XV; X < W; X++)
+                dst[X] = LowPassMul(dst[X-1], src[X]<<16, Horizontal);
+        }
+    }
+
+    if (Y < Y1)
+        deNoiseHorizontal(Frame, Horiz, W, Y, Y1, sStride,
+                          Horizontal, Temporal);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void deNoiseVerticalAVX2(const unsigned char *Frame,
+                                const unsigned int *Horiz,
+                                unsigned char *FrameDest,
+                                unsigned int *LineAnt,
+                                unsigned short *FrameAnt,
+                                int W, int H, int X0, int X1,
+                                int sStride, int dStride,
+                                int *Vertical, int *Temporal)
+{
+    const int Temp = !Horiz || Temporal[0];
+    const int XV = X0 + ((X1 - X0) & ~7);
+
+    for (long Y = 0; Y < H; Y++){
+        for (long X = X0; X < XV; X += 8){
+            __m256i PixelDst;
+
+            if (Horiz){
+                PixelDst = _mm256_loadu_si256((const __m256i *)&Horiz[Y*W+X]);
+                if (Y > 0)
+                    PixelDst = LowPassMulAVX2(
+                        _mm256_loadu_si256((const __m256i *)&LineAnt[X]),
+                        PixelDst, Vertical);
+                _mm256_storeu_si256((__m256i *)&LineAnt[X], PixelDst);
+            } else
+                PixelDst = _mm256_slli_epi32(_mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64((const __m128i *)&Frame[Y*sStride+X])), 16);
+
+            if (Temp){
+                __m256i Prev = _mm256_cvtepu16_epi32(
+                    _mm_loadu_si128((const __m128i *)&FrameAnt[Y*W+X]));
+                PixelDst = LowPassMulAVX2(_mm256_slli_epi32(Prev, 8),
+                                          PixelDst, Temporal);
+                Prev = _mm256_srli_epi32(_mm256_add_epi32(PixelDst,
+                                            _mm256_set1_epi32(0x1000007F)), 8);
+                _mm_storeu_si128((__m128i *)&FrameAnt[Y*W+X], Pack16AVX2(Prev));
+            }
+            PixelDst = _mm256_srli_epi32(_mm256_add_epi32(PixelDst,
+                                            _mm256_set1_epi32(0x10007FFF)), 16);
+            __m128i Dst = _mm_and_si128(Pack16AVX2(PixelDst),
+                                        _mm_set1_epi16(0xFF));
+            _mm_storel_epi64((__m128i *)&FrameDest[Y*dStride+X],
+                             _mm_packus_epi16(Dst, Dst));
+        }
+    }
+
+    if (XV < X1)
+        deNoiseVertical(Frame, Horiz, FrameDest, LineAnt, FrameAnt,
+                        W, H, XV, X1, sStride, dStride, Vertical, Temporal);
+}
+#endif
+
+#ifdef HAVE_SSE2_INTRINSICS
+#include <smmintrin.h>
+
+/* Without gathers, the 4 coefficients are looked up one lane at a time:
+ * the rest of the fixed-point arithmetic is still done on 4 pixels. */
+__attribute__ ((__target__ ("sse4.1")))
+static inline __m128i LowPassMulSSE4(__m128i PrevMul, __m128i CurrMul,
+                                     const int *Coef)
+{
+    __m128i d = _mm_sub_epi32(PrevMul, CurrMul);
+    d = _mm_srli_epi32(_mm_add_epi32(d, _mm_set1_epi32(0x10007FF)), 12);
+
+    __m128i c = _mm_cvtsi32_si128(Coef[_mm_cvtsi128_si32(d)]);
+    c = _mm_insert_epi32(c, Coef[_mm_extract_epi32(d, 1)], 1);
+    c = _mm_insert_epi32(c, Coef[_mm_extract_epi32(d, 2)], 2);
+    c = _mm_insert_epi32(c, Coef[_mm_extract_epi32(d, 3)], 3);
+    return _mm_add_epi32(CurrMul, c);
+}
+
+/* Loads 4 pixels, as 16.16 fixed-point values */
+__attribute__ ((__target__ ("sse4.1")))
+static inline __m128i Load4SSE4(const unsigned char *p)
+{
+    int32_t v;
+
+    memcpy(&v, p, sizeof (v));
+    return _mm_slli_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(v)), 16);
+}
+
+__attribute__ ((__target__ ("sse4.1")))
+static inline void Transpose4x4SSE4(__m128i *r)
+{
+    __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]);
+    __m128i t1 = _mm_unpackhi_epi32(r[0], r[1]);
+    __m128i t2 = _mm_unpacklo_epi32(r[2], r[3]);
+    __m128i t3 = _mm_unpackhi_epi32(r[2], r[3]);
+
+    r[0] = _mm_unpacklo_epi64(t0, t2);
+    r[1] = _mm_unpackhi_epi64(t0, t2);
+    r[2] = _mm_unpacklo_epi64(t1, t3);
+    r[3] = _mm_unpackhi_epi64(t1, t3);
+}
+
+/* Filters 4 lines at once, one per lane, as deNoiseHorizontalAVX2() */
+__attribute__ ((__target__ ("sse4.1")))
+static void deNoiseHorizontalSSE4(const unsigned char *Frame,
+                                  unsigned int *Horiz,
+                                  int W, int Y0, int Y1, int sStride,
+                                  int *Horizontal, int *Temporal)
+{
+    const int XV = W & ~3;
+    long Y = Y0;
+
+    if (Y == 0 && !Temporal[0] && Y < Y1){
+        deNoiseHorizontal(Frame, Horiz, W, 0, 1, sStride,
+                          Horizontal, Temporal);
+        Y++;
+    }
+
+    for (; Y + 4 <= Y1 && XV > 0; Y += 4){
+        __m128i PixelAnt = _mm_setzero_si128();
+
+        for (long X = 0; X < XV; X += 4){
+            __m128i r[4];
+
+            for (int i = 0; i < 4; i++)
+                r[i] = Load4SSE4(&Frame[(Y+i)*sStride+X]);
+            Transpose4x4SSE4(r);
+
+            /* First pixel on each line doesn't have previous pixel */
+            PixelAnt = r[0] = X ? LowPassMulSSE4(PixelAnt, r[0], Horizontal)
+                                : r[0];
+            for (int i = 1; i < 4; i++)
+                PixelAnt = r[i] = LowPassMulSSE4(PixelAnt, r[i], Horizontal);
+
+            Transpose4x4SSE4(r);
+            for (int i = 0; i < 4; i++)
+                _mm_storeu_si128((__m128i *)&Horiz[(Y+i)*W+X], r[i]);
+        }
+
+        /* Remaining columns, carrying on from the last filtered ones */
+        for (int i = 0; i < 4; i++){
+            const unsigned char *src = Frame + (Y+i)*sStride;
+            unsigned int *dst = Horiz + (Y+i)*W;
+
+            for (long X = XV; X < W; X++)
+                dst[X] = LowPassMul(dst[X-1], src[X]<<16, Horizontal);
+        }
+    }
+
+    if (Y < Y1)
+        deNoiseHorizontal(Frame, Horiz, W, Y, Y1, sStride,
+                          Horizontal, Temporal);
+}
+
+__attribute__ ((__target__ ("sse4.1")))
+static void deNoiseVerticalSSE4(const unsigned char *Frame,
+                                const unsigned int *Horiz,
+                                unsigned char *FrameDest,
+                                unsigned int *LineAnt,
+                                unsigned short *FrameAnt,
+                                int W, int H, int X0, int X1,
+                                int sStride, int dStride,
+                                int *Vertical, int *Temporal)
+{
+    const int Temp = !Horiz || Temporal[0];
+    const int XV = X0 + ((X1 - X0) & ~3);
+
+    for (long Y = 0; Y < H; Y++){
+        for (long X = X0; X < XV; X += 4){
+            __m128i PixelDst;
+
+            if (Horiz){
+                PixelDst = _mm_loadu_si128((const __m128i *)&Horiz[Y*W+X]);
+                if (Y > 0)
+                    PixelDst = LowPassMulSSE4(
+                        _mm_loadu_si128((const __m128i *)&LineAnt[X]),
+                        PixelDst, Vertical);
+                _mm_storeu_si128((__m128i *)&LineAnt[X], PixelDst);
+            } else
+                PixelDst = Load4SSE4(&Frame[Y*sStride+X]);
+
+            if (Temp){
+                __m128i Prev = _mm_cvtepu16_epi32(
+                    _mm_loadl_epi64((const __m128i *)&FrameAnt[Y*W+X]));
+                PixelDst = LowPassMulSSE4(_mm_slli_epi32(Prev, 8),
+                                          PixelDst, Temporal);
+                Prev = _mm_srli_epi32(_mm_add_epi32(PixelDst,
+                                         _mm_set1_epi32(0x1000007F)), 8);
+                Prev = _mm_and_si128(Prev, _mm_set1_epi32(0xFFFF));
+                _mm_storel_epi64((__m128i *)&FrameAnt[Y*W+X],
+                                 _mm_packus_epi32(Prev, Prev));
+            }
+            PixelDst = _mm_srli_epi32(_mm_add_epi32(PixelDst,
+                                         _mm_set1_epi32(0x10007FFF)), 16);
+            PixelDst = _mm_and_si128(PixelDst, _mm_set1_epi32(0xFF));
+            PixelDst = _mm_packus_epi32(PixelDst, PixelDst);
+            int32_t Dst = _mm_cvtsi128_si32(_mm_packus_epi16(PixelDst,
+                                                             PixelDst));
+            memcpy(&FrameDest[Y*dStride+X], &Dst, sizeof (Dst));
+        }
+    }
+
+    if (XV < X1)
+        deNoiseVertical(Frame, Horiz, FrameDest, LineAnt, FrameAnt,
+                        W, H, XV, X1, sStride, dStride, Vertical, Temporal);
+}
+#endif
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+
+/* The 4 coefficients are loaded one lane at a time, as with SSE4.1 */
+static inline uint32x4_t LowPassMulNEON(uint32x4_t PrevMul, uint32x4_t CurrMul,
+                                        const int *Coef)
+{
+    uint32x4_t d = vsubq_u32(PrevMul, CurrMul);
+    d = vshrq_n_u32(vaddq_u32(d, vdupq_n_u32(0x10007FF)), 12);
+
+    uint32x4_t c = vdupq_n_u32(0);
+    c = vld1q_lane_u32((const uint32_t *)&Coef[vgetq_lane_u32(d, 0)], c, 0);
+    c = vld1q_lane_u32((const uint32_t *)&Coef[vgetq_lane_u32(d, 1)], c, 1);
+    c = vld1q_lane_u32((const uint32_t *)&Coef[vgetq_lane_u32(d, 2)], c, 2);
+    c = vld1q_lane_u32((const uint32_t *)&Coef[vgetq_lane_u32(d, 3)], c, 3);
+    return vaddq_u32(CurrMul, c);
+}
+
+/* Loads 4 pixels, as 16.16 fixed-point values */
+static inline uint32x4_t Load4NEON(const unsigned char *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof (v));
+    uint16x8_t w = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(v)));
+    return vshlq_n_u32(vmovl_u16(vget_low_u16(w)), 16);
+}
+
+static inline void Transpose4x4NEON(uint32x4_t *r)
+{
+    uint32x4x2_t t0 = vtrnq_u32(r[0], r[1]);
+    uint32x4x2_t t1 = vtrnq_u32(r[2], r[3]);
+
+    r[0] = vcombine_u32(vget_low_u32(t0.val[0]), vget_low_u32(t1.val[0]));
+    r[1] = vcombine_u32(vget_low_u32(t0.val[1]), vget_low_u32(t1.val[1]));
+    r[2] = vcombine_u32(vget_high_u32(t0.val[0]), vget_high_u32(t1.val[0]));
+    r[3] = vcombine_u32(vget_high_u32(t0.val[1]), vget_high_u32(t1.val[1]));
+}
+
+/* Filters 4 lines at once, one per lane, as deNoiseHorizontalAVX2() */
+static void deNoiseHorizontalNEON(const unsigned char *Frame,
+                                  unsigned int *Horiz,
+                                  int W, int Y0, int Y1, int sStride,
+                                  int *Horizontal, int *Temporal)
+{
+    const int XV = W & ~3;
+    long Y = Y0;
+
+    if (Y == 0 && !Temporal[0] && Y < Y1){
+        deNoiseHorizontal(Frame, Horiz, W, 0, 1, sStride,
+                          Horizontal, Temporal);
+        Y++;
+    }
+
+    for (; Y + 4 <= Y1 && XV > 0; Y += 4){
+        uint32x4_t PixelAnt = vdupq_n_u32(0);
+
+        for (long X = 0; X < XV; X += 4){
+            uint32x4_t r[4];
+
+            for (int i = 0; i < 4; i++)
+                r[i] = Load4NEON(&Frame[(Y+i)*sStride+X]);
+            Transpose4x4NEON(r);
+
+            /* First pixel on each line doesn't have previous pixel */
+            PixelAnt = r[0] = X ? LowPassMulNEON(PixelAnt, r[0], Horizontal)
+                                : r[0];
+            for (int i = 1; i < 4; i++)
+                PixelAnt = r[i] = LowPassMulNEON(PixelAnt, r[i], Horizontal);
+
+            Transpose4x4NEON(r);
+            for (int i = 0; i < 4; i++)
+                vst1q_u32(&Horiz[(Y+i)*W+X], r[i]);
+        }
+
+        /* Remaining columns, carrying on from the last filtered ones */
+        for (int i = 0; i < 4; i++){
+            const unsigned char *src = Frame + (Y+i)*sStride;
+            unsigned int *dst = Horiz + (Y+i)*W;
+
+            for (long X = XV; X < W; X++)
+                dst[X] = LowPassMul(dst[X-1], src[X]<<16, Horizontal);
+        }
+    }
+
+    if (Y < Y1)
+        deNoiseHorizontal(Frame, Horiz, W, Y, Y1, sStride,
+                          Horizontal, Temporal);
+}
+
+static void deNoiseVerticalNEON(const unsigned char *Frame,
+                                const unsigned int *Horiz,
+                                unsigned char *FrameDest,
+                                unsigned int *LineAnt,
+                                unsigned short *FrameAnt,
+                                int W, int H, int X0, int X1,
+                                int sStride, int dStride,
+                                int *Vertical, int *Temporal)
+{
+    const int Temp = !Horiz || Temporal[0];
+    const int XV = X0 + ((X1 - X0) & ~3);
+
+    for (long Y = 0; Y < H; Y++){
+        for (long X = X0; X < XV; X += 4){
+            uint32x4_t PixelDst;
+
+            if (Horiz){
+                PixelDst = vld1q_u32(&Horiz[Y*W+X]);
+                if (Y > 0)
+                    PixelDst = LowPassMulNEON(vld1q_u32(&LineAnt[X]),
+                                              PixelDst, Vertical);
+                vst1q_u32(&LineAnt[X], PixelDst);
+            } else
+                PixelDst = Load4NEON(&Frame[Y*sStride+X]);
+
+            if (Temp){
+                uint32x4_t Prev = vmovl_u16(vld1_u16(&FrameAnt[Y*W+X]));
+                PixelDst = LowPassMulNEON(vshlq_n_u32(Prev, 8),
+                                          PixelDst, Temporal);
+                Prev = vshrq_n_u32(vaddq_u32(PixelDst,
+                                             vdupq_n_u32(0x1000007F)), 8);
+                vst1_u16(&FrameAnt[Y*W+X], vmovn_u32(Prev));
+            }
+            PixelDst = vshrq_n_u32(vaddq_u32(PixelDst,
+                                             vdupq_n_u32(0x10007FFF)), 16);
+            uint16x4_t Dst16 = vmovn_u32(PixelDst);
+            uint8x8_t Dst = vmovn_u16(vcombine_u16(Dst16, Dst16));
+            vst1_lane_u32((uint32_t *)&FrameDest[Y*dStride+X],
+                          vreinterpret_u32_u8(Dst), 0);
+        }
+    }
+
+    if (XV < X1)
+        deNoiseVertical(Frame, Horiz, FrameDest, LineAnt, FrameAnt,
+                        W, H, XV, X1, sStride, dStride, Vertical, Temporal);
+}
+#endif
+
 
 //===========================================================================//
 
@@ -41,6 +41,8 @@
 #include <vlc_strings.h>
 #include <vlc_fs.h>
 
+#include "scene_queue.h"
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -50,7 +52,7 @@ static void Destroy     ( vlc_object_t * );
 static picture_t *Filter( filter_t *, picture_t * );
 
 static void SnapshotRatio( filter_t *p_filter, picture_t *p_pic );
-static void SavePicture( filter_t *, picture_t * );
+static void QueuePicture( filter_t *, picture_t * );
 
 /*****************************************************************************
  * Module descriptor
@@ -87,6 +89,15 @@ static void SavePicture( filter_t *, picture_t * );
                             "creating one file per image. In this case, " \
                              "the number is not appended to the filename." )
 
+#define THREADS_TEXT N_( "Encoding threads" )
+#define THREADS_LONGTEXT N_( "Number of threads encoding the images " \
+                             "(0 = automatic)." )
+
+#define BACKLOG_TEXT N_( "Maximum pending images" )
+#define BACKLOG_LONGTEXT N_( "Maximum number of images waiting to be " \
+                             "encoded. Further images are dropped until " \
+                             "the encoding catches up." )
+
 #define SCENE_HELP N_("Send your video to picture files")
 #define CFG_PREFIX "scene-"
 
@@ -116,30 +127,30 @@ vlc_module_begin ()
     add_integer_with_range( CFG_PREFIX "ratio", 50, 1, INT_MAX,
                             RATIO_TEXT, RATIO_LONGTEXT, false )
 
+    /* Encoding */
+    add_integer_with_range( CFG_PREFIX "threads", 0, 0, 32,
+                            THREADS_TEXT, THREADS_LONGTEXT, true )
+    add_integer_with_range( CFG_PREFIX "backlog", 4, 1, 64,
+                            BACKLOG_TEXT, BACKLOG_LONGTEXT, true )
+
     set_callbacks( Create, Destroy )
 vlc_module_end ()
 
 static const char *const ppsz_vfilter_options[] = {
-    "format", "width", "height", "ratio", "prefix", "path", "replace", NULL
+    "format", "width", "height", "ratio", "prefix", "path", "replace",
+    "threads", "backlog", NULL
 };
 
-typedef struct scene_t {
-    picture_t       *p_pic;
-    video_format_t  format;
-} scene_t;
-
 /*****************************************************************************
  * filter_sys_t: private data
  *****************************************************************************/
 typedef struct
 {
-    image_handler_t *p_image;
-    scene_t scene;
+    scene_queue_t queue;
 
     char *psz_path;
     char *psz_prefix;
     char *psz_format;
-    vlc_fourcc_t i_format;
     int32_t i_width;
     int32_t i_height;
     int32_t i_ratio;  /* save every n-th frame */
@@ -167,21 +178,12 @@ static int Create( vlc_object_t *p_this )
     if( p_filter->p_sys == NULL )
         return VLC_ENOMEM;
 
-    p_sys->p_image = image_HandlerCreate( p_this );
-    if( !p_sys->p_image )
-    {
-        msg_Err( p_this, "Couldn't get handle to image conversion routines." );
-        free( p_sys );
-        return VLC_EGENERIC;
-    }
-
     p_sys->psz_format = var_CreateGetString( p_this, CFG_PREFIX "format" );
-    p_sys->i_format = image_Type2Fourcc( p_sys->psz_format );
-    if( !p_sys->i_format )
+    vlc_fourcc_t i_format = image_Type2Fourcc( p_sys->psz_format );
+    if( !i_format )
     {
         msg_Err( p_filter, "Could not find FOURCC for image type '%s'",
                  p_sys->psz_format );
-        image_HandlerDelete( p_sys->p_image );
         free( p_sys->psz_format );
         free( p_sys );
         return VLC_EGENERIC;
@@ -197,6 +199,32 @@ static int Create( vlc_object_t *p_this )
     if( p_sys->psz_path == NULL )
         p_sys->psz_path = config_GetUserDir( VLC_PICTURES_DIR );
 
+    scene_queue_t *p_queue = &p_sys->queue;
+    int i_backlog = var_CreateGetInteger( p_this, CFG_PREFIX "backlog" );
+    scene_queue_Init( p_queue, p_this, i_format, __MAX(i_backlog, 1),
+                      p_sys->b_replace );
+
+    /* A single file must be written in order */
+    unsigned i_threads = var_CreateGetInteger( p_this, CFG_PREFIX "threads" );
+    if( i_threads == 0 )
+        i_threads = vlc_GetCPUCount();
+    if( i_threads > p_queue->i_backlog )
+        i_threads = p_queue->i_backlog;
+    if( p_sys->b_replace || i_threads < 1 )
+        i_threads = 1;
+
+    if( scene_queue_StartWorkers( p_queue, i_threads ) )
+    {
+        msg_Err( p_this, "Couldn't get handle to image conversion routines." );
+        free( p_sys->psz_format );
+        free( p_sys->psz_prefix );
+        free( p_sys->psz_path );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+    msg_Dbg( p_filter, "encoding with %u thread(s), up to %u pending images",
+             p_queue->i_workers, p_queue->i_backlog );
+
     p_filter->pf_video_filter = Filter;
 
     return VLC_SUCCESS;
@@ -210,10 +238,12 @@ static void Destroy( vlc_object_t *p_this )
     filter_t *p_filter = (filter_t *)p_this;
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    image_HandlerDelete( p_sys->p_image );
+    /* The pending images are still saved */
+    scene_queue_Clean( &p_sys->queue );
+    if( p_sys->queue.i_dropped > 0 )
+        msg_Warn( p_filter, "%u images dropped, the encoding being too slow",
+                  p_sys->queue.i_dropped );
 
-    if( p_sys->scene.p_pic )
-        picture_Release( p_sys->scene.p_pic );
     free( p_sys->psz_format );
     free( p_sys->psz_prefix );
     free( p_sys->psz_path );
@@ -243,9 +273,6 @@ static void SnapshotRatio( filter_t *p_filter, picture_t *p_pic )
     }
     p_sys->i_frames++;
 
-    if( p_sys->scene.p_pic )
-        picture_Release( p_sys->scene.p_pic );
-
     if( (p_sys->i_width <= 0) && (p_sys->i_height > 0) )
     {
         p_sys->i_width = (p_pic->format.i_width * p_sys->i_height) / p_pic->format.i_height;
@@ -260,37 +287,18 @@ static void SnapshotRatio( filter_t *p_filter, picture_t *p_pic )
         p_sys->i_height = p_pic->format.i_height;
     }
 
-    p_sys->scene.p_pic = picture_NewFromFormat( &p_pic->format );
-    if( p_sys->scene.p_pic )
-    {
-        picture_Copy( p_sys->scene.p_pic, p_pic );
-        SavePicture( p_filter, p_sys->scene.p_pic );
-    }
+    QueuePicture( p_filter, p_pic );
 }
 
 /*****************************************************************************
- * Save Picture to disk
+ * Queue Picture: hand the picture over to the encoding threads
  *****************************************************************************/
-static void SavePicture( filter_t *p_filter, picture_t *p_pic )
+static void QueuePicture( filter_t *p_filter, picture_t *p_pic )
 {
     filter_sys_t *p_sys = (filter_sys_t *)p_filter->p_sys;
-    video_format_t fmt_in, fmt_out;
-    char *psz_filename = NULL;
-    char *psz_temp = NULL;
+    char *psz_filename;
     int i_ret;
 
-    video_format_Init( &fmt_out, p_sys->i_format );
-
-    /* Save snapshot psz_format to a memory zone */
-    fmt_in = p_pic->format;
-    fmt_out.i_sar_num = fmt_out.i_sar_den = 1;
-    fmt_out.i_width = p_sys->i_width;
-    fmt_out.i_height = p_sys->i_height;
-
-    /*
-     * Save the snapshot to a temporary file and
-     * switch it to the real name afterwards.
-     */
     if( p_sys->b_replace )
         i_ret = asprintf( &psz_filename, "%s" DIR_SEP "%s.%s",
                           p_sys->psz_path, p_sys->psz_prefix,
@@ -302,40 +310,10 @@ static void SavePicture( filter_t *p_filter, picture_t *p_pic )
 
     if( i_ret == -1 )
     {
-        msg_Err( p_filter, "could not create snapshot %s", psz_filename );
-        goto error;
-    }
-
-    i_ret = asprintf( &psz_temp, "%s.swp", psz_filename );
-    if( i_ret == -1 )
-    {
-        msg_Err( p_filter, "could not create snapshot temporarily file %s", psz_temp );
-        goto error;
-    }
-
-    /* Save the image */
-    i_ret = image_WriteUrl( p_sys->p_image, p_pic, &fmt_in, &fmt_out,
-                            psz_temp );
-    if( i_ret != VLC_SUCCESS )
-    {
-        msg_Err( p_filter, "could not create snapshot %s", psz_temp );
-    }
-    else
-    {
-        /* switch to the final destination */
-#if defined (_WIN32) || defined(__OS2__)
-        vlc_unlink( psz_filename );
-#endif
-        i_ret = vlc_rename( psz_temp, psz_filename );
-        if( i_ret == -1 )
-        {
-            msg_Err( p_filter, "could not rename snapshot %s: %s",
-                     psz_filename, vlc_strerror_c(errno) );
-            goto error;
-        }
+        msg_Err( p_filter, "could not create snapshot" );
+        return;
     }
 
-error:
-    free( psz_temp );
-    free( psz_filename );
+    scene_queue_Push( &p_sys->queue, p_pic, psz_filename,
+                      p_sys->i_width, p_sys->i_height );
 }
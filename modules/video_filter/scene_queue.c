@@ -0,0 +1,271 @@
+/*****************************************************************************
+ * scene_queue.c : encoding queue of the scene video filter
+ *****************************************************************************
+ * Copyright (C) 2004-2008 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_image.h>
+#include <vlc_fs.h>
+
+#include "scene_queue.h"
+
+struct scene_worker_t {
+    scene_queue_t   *p_queue;
+    vlc_thread_t    thread;
+    image_handler_t *p_image;
+};
+
+static void JobDelete( scene_job_t *p_job )
+{
+    picture_Release( p_job->p_pic );
+    free( p_job->psz_filename );
+    free( p_job );
+}
+
+void scene_queue_Init( scene_queue_t *p_queue, vlc_object_t *p_obj,
+                       vlc_fourcc_t i_format, unsigned i_backlog,
+                       bool b_replace )
+{
+    p_queue->p_obj = p_obj;
+    p_queue->i_format = i_format;
+    p_queue->b_replace = b_replace;
+
+    vlc_mutex_init( &p_queue->lock );
+    vlc_cond_init( &p_queue->wait );
+    vlc_list_init( &p_queue->jobs );
+    p_queue->i_pending = 0;
+    p_queue->i_backlog = i_backlog > 0 ? i_backlog : 1;
+    p_queue->i_dropped = 0;
+    p_queue->b_quit = false;
+    p_queue->p_workers = NULL;
+    p_queue->i_workers = 0;
+}
+
+void scene_queue_Clean( scene_queue_t *p_queue )
+{
+    scene_queue_StopWorkers( p_queue );
+
+    scene_job_t *p_job;
+    vlc_list_foreach( p_job, &p_queue->jobs, node )
+    {
+        vlc_list_remove( &p_job->node );
+        JobDelete( p_job );
+    }
+    p_queue->i_pending = 0;
+}
+
+/*****************************************************************************
+ * Push: hand the picture over to the encoding threads
+ *****************************************************************************/
+void scene_queue_Push( scene_queue_t *p_queue, picture_t *p_pic,
+                       char *psz_filename, int32_t i_width, int32_t i_height )
+{
+    vlc_mutex_lock( &p_queue->lock );
+
+    /* A newer image of the same file supersedes the pending one */
+    if( p_queue->b_replace )
+    {
+        scene_job_t *p_old;
+        vlc_list_foreach( p_old, &p_queue->jobs, node )
+        {
+            vlc_list_remove( &p_old->node );
+            p_queue->i_pending--;
+            JobDelete( p_old );
+        }
+    }
+
+    /* Drop the image rather than stalling the video */
+    if( p_queue->i_pending >= p_queue->i_backlog )
+    {
+        p_queue->i_dropped++;
+        vlc_mutex_unlock( &p_queue->lock );
+        msg_Dbg( p_queue->p_obj, "dropping %s, %u images pending",
+                 psz_filename, p_queue->i_pending );
+        free( psz_filename );
+        return;
+    }
+
+    scene_job_t *p_job = malloc( sizeof( *p_job ) );
+    if( unlikely(p_job == NULL) )
+    {
+        vlc_mutex_unlock( &p_queue->lock );
+        free( psz_filename );
+        return;
+    }
+    p_job->p_pic = picture_Hold( p_pic );
+    p_job->psz_filename = psz_filename;
+    p_job->i_width = i_width;
+    p_job->i_height = i_height;
+    vlc_list_append( &p_job->node, &p_queue->jobs );
+    p_queue->i_pending++;
+    vlc_cond_signal( &p_queue->wait );
+    vlc_mutex_unlock( &p_queue->lock );
+}
+
+/*****************************************************************************
+ * Save Picture to disk
+ *****************************************************************************/
+static void SavePicture( scene_worker_t *p_worker, const scene_job_t *p_job )
+{
+    scene_queue_t *p_queue = p_worker->p_queue;
+    picture_t *p_pic = p_job->p_pic;
+    const char *psz_filename = p_job->psz_filename;
+    video_format_t fmt_in, fmt_out;
+    char *psz_temp = NULL;
+    int i_ret;
+
+    video_format_Init( &fmt_out, p_queue->i_format );
+
+    /* Save snapshot psz_format to a memory zone */
+    fmt_in = p_pic->format;
+    fmt_out.i_sar_num = fmt_out.i_sar_den = 1;
+    fmt_out.i_width = p_job->i_width;
+    fmt_out.i_height = p_job->i_height;
+
+    /*
+     * Save the snapshot to a temporary file and
+     * switch it to the real name afterwards.
+     */
+    i_ret = asprintf( &psz_temp, "%s.swp", psz_filename );
+    if( i_ret == -1 )
+    {
+        msg_Err( p_queue->p_obj,
+                 "could not create snapshot temporarily file for %s",
+                 psz_filename );
+        return;
+    }
+
+    /* Save the image */
+    i_ret = image_WriteUrl( p_worker->p_image, p_pic, &fmt_in, &fmt_out,
+                            psz_temp );
+    if( i_ret != VLC_SUCCESS )
+    {
+        msg_Err( p_queue->p_obj, "could not create snapshot %s", psz_temp );
+        vlc_unlink( psz_temp ); /* opened before encoding */
+    }
+    else
+    {
+        /* switch to the final destination */
+#if defined (_WIN32) || defined(__OS2__)
+        vlc_unlink( psz_filename );
+#endif
+        i_ret = vlc_rename( psz_temp, psz_filename );
+        if( i_ret == -1 )
+        {
+            msg_Err( p_queue->p_obj, "could not rename snapshot %s: %s",
+                     psz_filename, vlc_strerror_c(errno) );
+        }
+    }
+
+    free( psz_temp );
+}
+
+/*****************************************************************************
+ * Encoding threads
+ *****************************************************************************/
+static void *Worker( void *p_data )
+{
+    scene_worker_t *p_worker = p_data;
+    scene_queue_t *p_queue = p_worker->p_queue;
+
+    vlc_mutex_lock( &p_queue->lock );
+    for( ;; )
+    {
+        while( vlc_list_is_empty( &p_queue->jobs ) && !p_queue->b_quit )
+            vlc_cond_wait( &p_queue->wait, &p_queue->lock );
+
+        scene_job_t *p_job =
+            vlc_list_first_entry_or_null( &p_queue->jobs, scene_job_t, node );
+        if( p_job == NULL )
+            break; /* quitting, and nothing left to save */
+        vlc_list_remove( &p_job->node );
+        vlc_mutex_unlock( &p_queue->lock );
+
+        SavePicture( p_worker, p_job );
+        JobDelete( p_job );
+
+        vlc_mutex_lock( &p_queue->lock );
+        p_queue->i_pending--;
+    }
+    vlc_mutex_unlock( &p_queue->lock );
+    return NULL;
+}
+
+static void JoinWorkers( scene_queue_t *p_queue, unsigned i_count )
+{
+    vlc_mutex_lock( &p_queue->lock );
+    p_queue->b_quit = true;
+    vlc_cond_broadcast( &p_queue->wait );
+    vlc_mutex_unlock( &p_queue->lock );
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        vlc_join( p_queue->p_workers[i].thread, NULL );
+        image_HandlerDelete( p_queue->p_workers[i].p_image );
+    }
+    free( p_queue->p_workers );
+    p_queue->p_workers = NULL;
+    p_queue->i_workers = 0;
+    p_queue->b_quit = false;
+}
+
+void scene_queue_StopWorkers( scene_queue_t *p_queue )
+{
+    JoinWorkers( p_queue, p_queue->i_workers );
+}
+
+/* Each thread has its own image handler, as these cache their converters
+ * and encoders */
+int scene_queue_StartWorkers( scene_queue_t *p_queue, unsigned i_count )
+{
+    assert( p_queue->i_workers == 0 );
+
+    p_queue->p_workers = vlc_alloc( i_count, sizeof( *p_queue->p_workers ) );
+    if( p_queue->p_workers == NULL )
+        return VLC_ENOMEM;
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        scene_worker_t *p_worker = &p_queue->p_workers[i];
+
+        p_worker->p_queue = p_queue;
+        p_worker->p_image = image_HandlerCreate( p_queue->p_obj );
+        if( p_worker->p_image == NULL )
+        {
+            JoinWorkers( p_queue, i );
+            return VLC_EGENERIC;
+        }
+        if( vlc_clone( &p_worker->thread, Worker, p_worker,
+                       VLC_THREAD_PRIORITY_LOW ) )
+        {
+            image_HandlerDelete( p_worker->p_image );
+            JoinWorkers( p_queue, i );
+            return VLC_EGENERIC;
+        }
+    }
+    p_queue->i_workers = i_count;
+    return VLC_SUCCESS;
+}
@@ -0,0 +1,69 @@
+/*****************************************************************************
+ * scene_queue.h : encoding queue of the scene video filter
+ *****************************************************************************
+ * Copyright (C) 2004-2008 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_SCENE_QUEUE_H
+#define VLC_SCENE_QUEUE_H
+
+#include <vlc_list.h>
+
+/* Image waiting to be encoded: the picture is held, not copied, as pictures
+ * are not modified once output by a filter. */
+typedef struct scene_job_t {
+    picture_t       *p_pic;
+    char            *psz_filename;
+    int32_t         i_width;
+    int32_t         i_height;
+    struct vlc_list node;
+} scene_job_t;
+
+typedef struct scene_worker_t scene_worker_t;
+
+/* Images are encoded by a pool of threads, so that the video is never
+ * stalled: beyond the backlog, the new images are dropped. */
+typedef struct
+{
+    vlc_object_t *p_obj;
+    vlc_fourcc_t i_format;
+    bool b_replace; /* a single file, a newer image supersedes the pending */
+
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;
+    struct vlc_list jobs;
+    unsigned i_pending; /* queued and being encoded */
+    unsigned i_backlog;
+    unsigned i_dropped;
+    bool b_quit;
+    scene_worker_t *p_workers;
+    unsigned i_workers;
+} scene_queue_t;
+
+void scene_queue_Init( scene_queue_t *, vlc_object_t *, vlc_fourcc_t i_format,
+                       unsigned i_backlog, bool b_replace );
+/* Saves the pending images, unless the workers are stopped */
+void scene_queue_Clean( scene_queue_t * );
+
+/* Takes the filename, holds the picture */
+void scene_queue_Push( scene_queue_t *, picture_t *, char *psz_filename,
+                       int32_t i_width, int32_t i_height );
+
+int  scene_queue_StartWorkers( scene_queue_t *, unsigned i_count );
+/* Returns once the queued images are saved */
+void scene_queue_StopWorkers( scene_queue_t * );
+
+#endif
@@ -34,6 +34,8 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_vout_display.h>
+#include <vlc_atomic.h>
+#include <vlc_list.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -47,6 +49,10 @@
 #define T_PITCH N_("Pitch")
 #define LT_PITCH N_("Video memory buffer pitch in bytes.")
 
+#define T_POOL N_("Application buffers pool")
+#define LT_POOL N_("Render directly into a pool of buffers given by the " \
+                   "application instead of copying each picture.")
+
 #define T_CHROMA N_("Chroma")
 #define LT_CHROMA N_("Output chroma for the memory image as a 4-character " \
                       "string, eg. \"RV32\".")
@@ -70,6 +76,8 @@ vlc_module_begin()
         change_private()
     add_string("vmem-chroma", "RV16", T_CHROMA, LT_CHROMA, true)
         change_private()
+    add_bool("vmem-pool", false, T_POOL, LT_POOL, true)
+        change_private()
     add_obsolete_string("vmem-lock") /* obsoleted since 1.1.1 */
     add_obsolete_string("vmem-unlock") /* obsoleted since 1.1.1 */
     add_obsolete_string("vmem-data") /* obsoleted since 1.1.1 */
@@ -80,9 +88,13 @@ vlc_module_end()
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
+/* Buffer of the application pool */
 typedef struct
 {
+    vout_display_sys_t *sys;
     void *id;
+    void *planes[PICTURE_PLANE_MAX];
+    struct vlc_list node;
 } picture_sys_t;
 
 /* NOTE: the callback prototypes must match those of LibVLC */
@@ -96,11 +108,23 @@ struct vout_display_sys_t {
 
     unsigned pitches[PICTURE_PLANE_MAX];
     unsigned lines[PICTURE_PLANE_MAX];
+
+    /* Application pool: the pictures may outlive the display, so they hold
+     * a reference on it and the application is cleaned up after the last
+     * buffer is given back. */
+    vlc_atomic_rc_t rc;
+    vlc_mutex_t lock_buffers;
+    struct vlc_list buffers;
+    /* Buffers to copy the pictures not in the pool to, in turns, so that the
+     * one displayed last is not overwritten before the next display */
+    picture_t *spares[2];
+    unsigned spare;
 };
 
 typedef unsigned (*vlc_format_cb)(void **, char *, unsigned *, unsigned *,
                                   unsigned *, unsigned *);
 
+static picture_pool_t *Pool(vout_display_t *, unsigned);
 static void           Prepare(vout_display_t *, picture_t *, subpicture_t *, vlc_tick_t);
 static void           Display(vout_display_t *, picture_t *);
 static int            Control(vout_display_t *, int, va_list);
@@ -131,6 +155,12 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     sys->cleanup = var_InheritAddress(vd, "vmem-cleanup");
     sys->opaque = var_InheritAddress(vd, "vmem-data");
 
+    vlc_atomic_rc_init(&sys->rc);
+    vlc_mutex_init(&sys->lock_buffers);
+    vlc_list_init(&sys->buffers);
+    sys->spares[0] = sys->spares[1] = NULL;
+    sys->spare = 0;
+
     /* Define the video format */
     video_format_t fmt;
     video_format_ApplyRotation(&fmt, fmtp);
@@ -216,6 +246,7 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     *fmtp = fmt;
 
     vd->sys     = sys;
+    vd->pool    = var_InheritBool(vd, "vmem-pool") ? Pool : NULL;
     vd->prepare = Prepare;
     vd->display = Display;
     vd->control = Control;
@@ -225,15 +256,146 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     return VLC_SUCCESS;
 }
 
-static void Close(vout_display_t *vd)
+static void Release(vout_display_sys_t *sys)
 {
-    vout_display_sys_t *sys = vd->sys;
+    if (!vlc_atomic_rc_dec(&sys->rc))
+        return;
 
+    assert(vlc_list_is_empty(&sys->buffers));
     if (sys->cleanup)
         sys->cleanup(sys->opaque);
     free(sys);
 }
 
+static void SparesRelease(vout_display_sys_t *sys)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sys->spares); i++)
+        if (sys->spares[i] != NULL) {
+            picture_Release(sys->spares[i]);
+            sys->spares[i] = NULL;
+        }
+}
+
+static void Close(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    SparesRelease(sys);
+    Release(sys);
+}
+
+/*****************************************************************************
+ * Application pool
+ *****************************************************************************/
+static void BufferDelete(picture_sys_t *picsys)
+{
+    vout_display_sys_t *sys = picsys->sys;
+
+    vlc_mutex_lock(&sys->lock_buffers);
+    vlc_list_remove(&picsys->node);
+    vlc_mutex_unlock(&sys->lock_buffers);
+
+    /* Give the buffer back to the application */
+    if (sys->unlock != NULL)
+        sys->unlock(sys->opaque, picsys->id, picsys->planes);
+    free(picsys);
+    Release(sys);
+}
+
+static void BufferDestroy(picture_t *pic)
+{
+    BufferDelete(pic->p_sys);
+}
+
+static picture_t *BufferNew(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    picture_sys_t *picsys = calloc(1, sizeof (*picsys));
+    if (unlikely(picsys == NULL))
+        return NULL;
+
+    picsys->sys = sys;
+    picsys->id = sys->lock(sys->opaque, picsys->planes);
+
+    vlc_atomic_rc_inc(&sys->rc);
+    vlc_mutex_lock(&sys->lock_buffers);
+    vlc_list_append(&picsys->node, &sys->buffers);
+    vlc_mutex_unlock(&sys->lock_buffers);
+
+    if (picsys->planes[0] == NULL) {
+        msg_Err(vd, "no buffer given by the application");
+        BufferDelete(picsys);
+        return NULL;
+    }
+
+    picture_resource_t rsc = {
+        .p_sys = picsys,
+        .pf_destroy = BufferDestroy,
+    };
+    for (unsigned i = 0; i < PICTURE_PLANE_MAX; i++) {
+        rsc.p[i].p_pixels = picsys->planes[i];
+        rsc.p[i].i_lines  = sys->lines[i];
+        rsc.p[i].i_pitch  = sys->pitches[i];
+    }
+
+    picture_t *pic = picture_NewFromResource(&vd->fmt, &rsc);
+    if (unlikely(pic == NULL))
+        BufferDelete(picsys);
+    return pic;
+}
+
+static picture_sys_t *BufferFind(vout_display_sys_t *sys, const picture_t *pic)
+{
+    picture_sys_t *picsys, *found = NULL;
+
+    vlc_mutex_lock(&sys->lock_buffers);
+    vlc_list_foreach(picsys, &sys->buffers, node)
+        if (picsys == pic->p_sys) {
+            found = picsys;
+            break;
+        }
+    vlc_mutex_unlock(&sys->lock_buffers);
+    return found;
+}
+
+static picture_pool_t *Pool(vout_display_t *vd, unsigned count)
+{
+    vout_display_sys_t *sys = vd->sys;
+    picture_t *pictures[count];
+    unsigned i;
+
+    for (i = 0; i < count; i++) {
+        pictures[i] = BufferNew(vd);
+        if (pictures[i] == NULL)
+            goto error;
+    }
+
+    picture_pool_t *pool = picture_pool_New(count, pictures);
+    if (pool == NULL)
+        goto error;
+
+    /* More buffers for the pictures rendered outside of the pool */
+    SparesRelease(sys);
+    for (size_t j = 0; j < ARRAY_SIZE(sys->spares); j++) {
+        sys->spares[j] = BufferNew(vd);
+        if (sys->spares[j] == NULL) {
+            SparesRelease(sys);
+            picture_pool_Release(pool);
+            return NULL;
+        }
+    }
+    sys->spare = 0;
+
+    msg_Dbg(vd, "rendering into %zu application buffers",
+            count + ARRAY_SIZE(sys->spares));
+    return pool;
+
+error:
+    while (i > 0)
+        picture_Release(pictures[--i]);
+    return NULL;
+}
+
 static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
                     vlc_tick_t date)
 {
@@ -242,6 +404,21 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
     picture_resource_t rsc = { .p_sys = NULL };
     void *planes[PICTURE_PLANE_MAX];
 
+    if (vd->pool != NULL) {
+        picture_sys_t *picsys = BufferFind(sys, pic);
+
+        /* Rendered in place, or copied to the next spare buffer */
+        picture_t *spare = sys->spares[sys->spare];
+        if (picsys == NULL && likely(spare != NULL)) {
+            picture_CopyPixels(spare, pic);
+            picsys = spare->p_sys;
+            sys->spare = (sys->spare + 1) % ARRAY_SIZE(sys->spares);
+        }
+        sys->pic_opaque = picsys != NULL ? picsys->id : NULL;
+        (void) subpic;
+        return;
+    }
+
     sys->pic_opaque = sys->lock(sys->opaque, planes);
 
     for (unsigned i = 0; i < PICTURE_PLANE_MAX; i++) {
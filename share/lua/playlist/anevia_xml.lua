@@ -22,6 +22,9 @@
  51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 --]]
 
+-- Probe hints, checked before probe() is called
+probe_hints = { access = "http" }
+
 -- Probe function.
 function probe()
     return vlc.access == "http"
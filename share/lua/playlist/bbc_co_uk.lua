@@ -20,6 +20,9 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 --]]
 
+-- Probe hints, checked before probe() is called
+probe_hints = { access = "http", host = "bbc.co.uk" }
+
 -- Probe function.
 function probe()
     local path = vlc.path:gsub("^www%.", "")
@@ -19,6 +19,9 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 --]]
 
+-- Probe hints, checked before probe() is called
+probe_hints = { extension = "cue" }
+
 -- Probe function.
 function probe()
     if( not string.match( vlc.path, "%.[cC][uU][eE]$" ) ) then
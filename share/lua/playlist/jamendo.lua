@@ -22,6 +22,9 @@
 
 require "simplexml"
 
+-- Probe hints, checked before probe() is called
+probe_hints = { access = "http", host = "api.jamendo.com" }
+
 -- Probe function.
 function probe()
     return vlc.access == "http"
@@ -18,6 +18,9 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 --]]
 
+-- Probe hints, checked before probe() is called
+probe_hints = { access = "http", host = "metacafe.com" }
+
 -- Probe function.
 function probe()
     local path = vlc.path:gsub("^www%.", "")
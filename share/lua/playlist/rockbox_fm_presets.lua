@@ -23,6 +23,9 @@
 
 local MRL_base = "v4l2c:///dev/radio0:tuner-frequency="
 
+-- Probe hints, checked before probe() is called
+probe_hints = { extension = "fmr" }
+
 function probe()
 	if not string.match( vlc.path, "%.[fF][mM][rR]$" ) then return false end
 	local line = vlc.peek(256)
@@ -23,6 +23,9 @@
 -- Set to "mp3", "ogg", "flac" or "wav"
 local fmt = "mp3"
 
+-- Probe hints, checked before probe() is called
+probe_hints = { access = { "http", "https" }, host = "vocaroo.com" }
+
 -- Probe function.
 function probe()
     return ( vlc.access == "http" or vlc.access == "https" )
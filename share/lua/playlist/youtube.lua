@@ -285,6 +285,9 @@ function pick_stream( stream_map, js_url )
     return string.match( pick, '"url":"(.-)"' )
 end
 
+-- Probe hints, checked before probe() is called
+probe_hints = { access = { "http", "https" }, host = "youtube.com" }
+
 -- Probe function.
 function probe()
     return ( ( vlc.access == "http" or vlc.access == "https" )
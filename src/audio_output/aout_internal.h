@@ -26,6 +26,7 @@
 # include <stdatomic.h>
 
 # include <vlc_atomic.h>
+# include <vlc_input_item.h>
 # include <vlc_viewpoint.h>
 # include "../clock/clock.h"
 
@@ -98,6 +99,10 @@ typedef struct
     atomic_uint buffers_played;
     atomic_uchar restart;
 
+    struct vlc_tracer *tracer;
+    uintptr_t trace_id; /* ES identifier of the traces */
+    struct vlc_latency_histogram depth; /* decoder thread only */
+
     vlc_atomic_rc_t rc;
 } aout_owner_t;
 
@@ -147,10 +152,12 @@ void aout_FormatsPrint(vlc_object_t *, const char *,
 #define AOUT_DEC_FAILED VLC_EGENERIC
 
 int aout_DecNew(audio_output_t *, const audio_sample_format_t *, int profile,
-                struct vlc_clock_t *clock, const audio_replay_gain_t *);
+                struct vlc_clock_t *clock, const audio_replay_gain_t *,
+                int trace_id);
 void aout_DecDelete(audio_output_t *);
 int aout_DecPlay(audio_output_t *aout, block_t *block);
 void aout_DecGetResetStats(audio_output_t *, unsigned *, unsigned *);
+void aout_DecGetResetLatency(audio_output_t *, struct vlc_es_latency *);
 void aout_DecChangePause(audio_output_t *, bool b_paused, vlc_tick_t i_date);
 void aout_DecChangeRate(audio_output_t *aout, float rate);
 void aout_DecChangeDelay(audio_output_t *aout, vlc_tick_t delay);
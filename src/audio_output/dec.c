@@ -33,6 +33,7 @@
 
 #include <vlc_common.h>
 #include <vlc_aout.h>
+#include <vlc_tracer.h>
 
 #include "aout_internal.h"
 #include "clock/clock.h"
@@ -55,7 +56,7 @@ static void aout_Drain(audio_output_t *aout)
  */
 int aout_DecNew(audio_output_t *p_aout, const audio_sample_format_t *p_format,
                 int profile, vlc_clock_t *clock,
-                const audio_replay_gain_t *p_replay_gain)
+                const audio_replay_gain_t *p_replay_gain, int trace_id)
 {
     assert(p_aout);
     assert(p_format);
@@ -97,6 +98,7 @@ int aout_DecNew(audio_output_t *p_aout, const audio_sample_format_t *p_format,
     owner->filter_format = owner->mixer_format = owner->input_format = *p_format;
 
     owner->sync.clock = clock;
+    owner->trace_id = trace_id;
 
     owner->filters = NULL;
     owner->filters_cfg = AOUT_FILTERS_CFG_INIT;
@@ -286,6 +288,8 @@ static void aout_DecSynchronize(audio_output_t *aout, vlc_tick_t system_now,
     if (aout->time_get(aout, &delay) != 0)
         return; /* nothing can be done if timing is unknown */
 
+    vlc_latency_Add(&owner->depth, delay);
+
     if (owner->sync.discontinuity)
     {
         /* Chicken-egg situation for most aout modules that can't be started
@@ -421,6 +425,8 @@ int aout_DecPlay(audio_output_t *aout, block_t *block)
     block->i_length = vlc_tick_from_samples( block->i_nb_samples,
                                    owner->input_format.i_rate );
 
+    vlc_tick_t start = vlc_tracer_Now(owner->tracer);
+
     int ret = aout_CheckReady (aout);
     if (unlikely(ret == AOUT_DEC_FAILED))
         goto drop; /* Pipeline is unrecoverably broken :-( */
@@ -451,6 +457,8 @@ int aout_DecPlay(audio_output_t *aout, block_t *block)
         }
 
         block = aout_FiltersPlay(owner->filters, block, owner->sync.rate);
+        vlc_tracer_Span(owner->tracer, "aout", "filters", start,
+                        owner->trace_id, owner->original_pts);
         if (block == NULL)
             return ret;
     }
@@ -489,6 +497,8 @@ int aout_DecPlay(audio_output_t *aout, block_t *block)
     /* Output */
     owner->sync.discontinuity = false;
     aout->play(aout, block, play_date);
+    vlc_tracer_Span(owner->tracer, "aout", "play", start, owner->trace_id,
+                    original_pts);
 
     atomic_fetch_add_explicit(&owner->buffers_played, 1, memory_order_relaxed);
     return ret;
@@ -511,6 +521,15 @@ void aout_DecGetResetStats(audio_output_t *aout, unsigned *restrict lost,
                                        memory_order_relaxed);
 }
 
+void aout_DecGetResetLatency(audio_output_t *aout,
+                             struct vlc_es_latency *latency)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    vlc_latency_Merge(&latency->stages[VLC_LATENCY_AOUT_DEPTH], &owner->depth);
+    memset(&owner->depth, 0, sizeof (owner->depth));
+}
+
 void aout_DecChangePause (audio_output_t *aout, bool paused, vlc_tick_t date)
 {
     aout_owner_t *owner = aout_owner (aout);
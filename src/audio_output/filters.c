@@ -32,6 +32,7 @@
 #include <assert.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_dialog.h>
 #include <vlc_modules.h>
 #include <vlc_aout.h>
@@ -340,6 +341,137 @@ static void aout_FiltersPipelineChangeViewpoint(filter_t *const *filters,
         filter_ChangeViewpoint (filters[i], vp);
 }
 
+/*
+ * Output buffers pool
+ *
+ * Filters that cannot process their input in place request their output
+ * buffers with filter_NewAudioBuffer(). Once released, usually by the audio
+ * output after playing, the memory goes back to the pool of the chain and is
+ * handed to the next request, so that a running chain does not allocate.
+ * The pool outlives the chain as long as some of its blocks are in use.
+ */
+#define AOUT_POOL_MAX_FREE 8
+
+typedef struct
+{
+    struct filter_audio_callbacks cbs;
+    vlc_atomic_rc_t rc; /**< Chain and buffers in use */
+    vlc_mutex_t lock;
+    block_t *free; /**< Released buffers, ready for reuse */
+    unsigned free_count;
+} aout_buffer_pool_t;
+
+struct aout_buffer
+{
+    block_t self;
+    aout_buffer_pool_t *pool;
+    size_t size; /**< Allocated payload size */
+    max_align_t data[];
+};
+
+static void aout_BufferPoolRelease(aout_buffer_pool_t *pool)
+{
+    if (!vlc_atomic_rc_dec(&pool->rc))
+        return;
+
+    block_t *block = pool->free;
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+        free(container_of(block, struct aout_buffer, self));
+        block = next;
+    }
+    free(pool);
+}
+
+static void aout_BufferRelease(block_t *block)
+{
+    struct aout_buffer *buf = container_of(block, struct aout_buffer, self);
+    aout_buffer_pool_t *pool = buf->pool;
+
+    vlc_mutex_lock(&pool->lock);
+    if (pool->free_count < AOUT_POOL_MAX_FREE)
+    {
+        block->p_next = pool->free;
+        pool->free = block;
+        pool->free_count++;
+        buf = NULL;
+    }
+    vlc_mutex_unlock(&pool->lock);
+
+    free(buf);
+    aout_BufferPoolRelease(pool);
+}
+
+static const struct vlc_block_callbacks aout_buffer_cbs =
+{
+    aout_BufferRelease,
+};
+
+static block_t *aout_BufferNew(filter_t *filter, size_t size)
+{
+    aout_buffer_pool_t *pool =
+        container_of(filter->owner.audio, aout_buffer_pool_t, cbs);
+    struct aout_buffer *buf = NULL;
+    block_t **best = NULL;
+
+    /* Best fit, so that the chain does not hand a large buffer meant for
+     * multichannel data to a filter downstream of a downmixer */
+    vlc_mutex_lock(&pool->lock);
+    for (block_t **pp = &pool->free; *pp != NULL; pp = &(*pp)->p_next)
+    {
+        struct aout_buffer *cand = container_of(*pp, struct aout_buffer, self);
+        if (cand->size >= size && (buf == NULL || cand->size < buf->size))
+        {
+            buf = cand;
+            best = pp;
+        }
+    }
+    if (buf != NULL)
+    {
+        *best = (*best)->p_next;
+        pool->free_count--;
+    }
+    vlc_mutex_unlock(&pool->lock);
+
+    if (buf == NULL)
+    {
+        if (unlikely(size >> 27))
+            return NULL;
+
+        /* Round up with some margin, so that slightly varying block sizes
+         * share buffers */
+        size_t alloc = 4096;
+        while (alloc < size + size / 4)
+            alloc *= 2;
+
+        buf = malloc(sizeof (*buf) + alloc);
+        if (unlikely(buf == NULL))
+            return NULL;
+        buf->pool = pool;
+        buf->size = alloc;
+    }
+
+    vlc_atomic_rc_inc(&pool->rc);
+    block_Init(&buf->self, &aout_buffer_cbs, buf->data, buf->size);
+    buf->self.i_buffer = size;
+    return &buf->self;
+}
+
+static aout_buffer_pool_t *aout_BufferPoolNew(void)
+{
+    aout_buffer_pool_t *pool = malloc(sizeof (*pool));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    pool->cbs.buffer_new = aout_BufferNew;
+    vlc_atomic_rc_init(&pool->rc);
+    vlc_mutex_init(&pool->lock);
+    pool->free = NULL;
+    pool->free_count = 0;
+    return pool;
+}
+
 #define AOUT_MAX_FILTERS 10
 
 struct aout_filters
@@ -349,6 +481,7 @@ struct aout_filters
     filter_t *resampler; /**< The resampler */
     int resampling; /**< Current resampling (Hz) */
     vlc_clock_t *clock;
+    aout_buffer_pool_t *pool; /**< Output buffers of the filters */
 
     unsigned count; /**< Number of filters */
     filter_t *tab[AOUT_MAX_FILTERS]; /**< Configured user filters
@@ -486,6 +619,17 @@ static int AppendRemapFilter(vlc_object_t *obj, aout_filters_t *restrict filters
     return ret;
 }
 
+/**
+ * Hands the output buffers pool of the chain to all its filters.
+ */
+static void aout_FiltersSetPool(aout_filters_t *filters)
+{
+    for (unsigned i = 0; i < filters->count; i++)
+        filters->tab[i]->owner.audio = &filters->pool->cbs;
+    if (filters->resampler != NULL)
+        filters->resampler->owner.audio = &filters->pool->cbs;
+}
+
 aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *clock,
                                          const audio_sample_format_t *restrict infmt,
                                          const audio_sample_format_t *restrict outfmt,
@@ -499,14 +643,16 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
     filters->resampler = NULL;
     filters->resampling = 0;
     filters->count = 0;
+    filters->clock = NULL;
+    filters->pool = aout_BufferPoolNew();
+    if (unlikely(filters->pool == NULL))
+        goto error;
     if (clock)
     {
         filters->clock = vlc_clock_CreateSlave(clock, AUDIO_ES);
         if (!filters->clock)
             goto error;
     }
-    else
-        filters->clock = NULL;
 
     /* Prepare format structure */
     aout_FormatPrint (obj, "input", infmt);
@@ -529,6 +675,7 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
             }
             filters->count++;
         }
+        aout_FiltersSetPool(filters);
         return filters;
     }
     if (aout_FormatNbChannels(outfmt) == 0)
@@ -642,6 +789,7 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
     if (filters->rate_filter == NULL)
         filters->rate_filter = filters->resampler;
 
+    aout_FiltersSetPool(filters);
     return filters;
 
 error:
@@ -649,6 +797,8 @@ error:
     var_DelCallback(obj, "visual", VisualizationCallback, NULL);
     if (filters->clock)
         vlc_clock_Delete(filters->clock);
+    if (filters->pool)
+        aout_BufferPoolRelease(filters->pool);
     free (filters);
     return NULL;
 }
@@ -696,6 +846,7 @@ void aout_FiltersDelete (vlc_object_t *obj, aout_filters_t *filters)
     var_DelCallback(obj, "visual", VisualizationCallback, NULL);
     if (filters->clock)
         vlc_clock_Delete(filters->clock);
+    aout_BufferPoolRelease(filters->pool);
     free (filters);
 }
 
@@ -31,6 +31,7 @@
 #include <vlc_aout.h>
 #include <vlc_modules.h>
 #include <vlc_atomic.h>
+#include <vlc_tracer.h>
 
 #include "libvlc.h"
 #include "aout_internal.h"
@@ -224,6 +225,7 @@ audio_output_t *aout_New (vlc_object_t *parent)
     vlc_viewpoint_init (&owner->vp.value);
     atomic_init (&owner->vp.update, false);
     vlc_atomic_rc_init(&owner->rc);
+    owner->tracer = vlc_object_get_tracer(aout);
 
     /* Audio output module callbacks */
     var_Create (aout, "volume", VLC_VAR_FLOAT);
@@ -43,10 +43,12 @@
 #include <vlc_modules.h>
 #include <vlc_decoder.h>
 #include <vlc_picture_pool.h>
+#include <vlc_tracer.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
 #include "../clock/clock.h"
+#include "../misc/block_ring.h"
 #include "decoder.h"
 #include "resource.h"
 
@@ -67,6 +69,8 @@ struct vlc_input_decoder_t
     decoder_t        dec;
     input_resource_t*p_resource;
     vlc_clock_t     *p_clock;
+    struct vlc_tracer *tracer;
+    int              i_trace_id;
 
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_userdata;
@@ -92,8 +96,21 @@ struct vlc_input_decoder_t
     vlc_meta_t     *p_description;
     atomic_int     reload;
 
-    /* fifo */
+    /* fifo: blocks are queued to the lock-free ring, and only to the locked
+     * FIFO when the ring is full, or by other threads (CC sub decoders). The
+     * FIFO lock also protects the decoder thread state below. */
     block_fifo_t *p_fifo;
+    block_ring_t ring;
+    atomic_bool overflow; /* the FIFO must be consumed before the ring */
+    unsigned discard; /* ring position up to which blocks are flushed */
+    bool b_discard;
+
+    /* Latency statistics: only one block at a time is timed through the
+     * input queue. The decoder thread accumulates its own samples in
+     * latency_pending, and merges them into latency with the lock held. */
+    atomic_uintptr_t queue_sample;
+    atomic_int_least64_t queue_sample_date;
+    struct vlc_es_latency latency_pending;
 
     /* Lock for communication with decoder thread */
     vlc_mutex_t lock;
@@ -125,6 +142,7 @@ struct vlc_input_decoder_t
      * both ModuleThread and DecoderThread are stopped (from DecoderDelete()).
      */
     audio_output_t *p_aout;
+    bool aout_deferred; /* only accessed by the decoder thread */
 
     vout_thread_t   *p_vout;
     enum vlc_vout_order vout_order;
@@ -134,6 +152,9 @@ struct vlc_input_decoder_t
     /* Preroll */
     vlc_tick_t i_preroll_end;
 
+    /* Latency statistics */
+    struct vlc_es_latency latency;
+
 #define PREROLL_NONE    INT64_MIN // vlc_tick_t
 #define PREROLL_FORCED  INT64_MAX // vlc_tick_t
 
@@ -156,7 +177,7 @@ struct vlc_input_decoder_t
     bool flushing;
     bool b_draining;
     atomic_bool drained;
-    bool b_idle;
+    atomic_bool b_idle;
     bool aborting;
 
     /* CC */
@@ -182,6 +203,7 @@ struct vlc_input_decoder_t
 
 /* */
 #define DECODER_SPU_VOUT_WAIT_DURATION   VLC_TICK_FROM_MS(200)
+#define DECODER_RING_SIZE                256
 #define BLOCK_FLAG_CORE_PRIVATE_RELOADED (1 << BLOCK_FLAG_CORE_PRIVATE_SHIFT)
 
 #define decoder_Notify(decoder_priv, event, ...) \
@@ -316,6 +338,38 @@ static bool aout_replaygain_changed( const audio_replay_gain_t *a,
     return false;
 }
 
+static audio_output_t *ModuleThread_GetAout( decoder_t *p_dec )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    audio_sample_format_t format = p_dec->fmt_out.audio;
+    aout_FormatPrepare( &format );
+
+    const int i_force_dolby = var_InheritInteger( p_dec, "force-dolby-surround" );
+    if( i_force_dolby &&
+        format.i_physical_channels == (AOUT_CHAN_LEFT|AOUT_CHAN_RIGHT) )
+    {
+        if( i_force_dolby == 1 )
+            format.i_chan_mode |= AOUT_CHANMODE_DOLBYSTEREO;
+        else /* i_force_dolby == 2 */
+            format.i_chan_mode &= ~AOUT_CHANMODE_DOLBYSTEREO;
+    }
+
+    audio_output_t *p_aout = input_resource_GetAout( p_owner->p_resource );
+    if( p_aout )
+    {
+        if( aout_DecNew( p_aout, &format, p_dec->fmt_out.i_profile,
+                         p_owner->p_clock,
+                         &p_dec->fmt_out.audio_replay_gain,
+                         p_owner->i_trace_id ) )
+        {
+            input_resource_PutAout( p_owner->p_resource, p_aout );
+            p_aout = NULL;
+        }
+    }
+    return p_aout;
+}
+
 static int ModuleThread_UpdateAudioFormat( decoder_t *p_dec )
 {
     vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
@@ -352,32 +406,9 @@ static int ModuleThread_UpdateAudioFormat( decoder_t *p_dec )
     {
         p_dec->fmt_out.audio.i_format = p_dec->fmt_out.i_codec;
 
-        audio_sample_format_t format = p_dec->fmt_out.audio;
-        aout_FormatPrepare( &format );
-
-        const int i_force_dolby = var_InheritInteger( p_dec, "force-dolby-surround" );
-        if( i_force_dolby &&
-            format.i_physical_channels == (AOUT_CHAN_LEFT|AOUT_CHAN_RIGHT) )
-        {
-            if( i_force_dolby == 1 )
-                format.i_chan_mode |= AOUT_CHANMODE_DOLBYSTEREO;
-            else /* i_force_dolby == 2 */
-                format.i_chan_mode &= ~AOUT_CHANMODE_DOLBYSTEREO;
-        }
-
-        audio_output_t *p_aout;
-
-        p_aout = input_resource_GetAout( p_owner->p_resource );
-        if( p_aout )
-        {
-            if( aout_DecNew( p_aout, &format, p_dec->fmt_out.i_profile,
-                             p_owner->p_clock,
-                             &p_dec->fmt_out.audio_replay_gain ) )
-            {
-                input_resource_PutAout( p_owner->p_resource, p_aout );
-                p_aout = NULL;
-            }
-        }
+        audio_output_t *p_aout = NULL;
+        if( !p_owner->aout_deferred )
+            p_aout = ModuleThread_GetAout( p_dec );
 
         vlc_mutex_lock( &p_owner->lock );
         p_owner->p_aout = p_aout;
@@ -386,7 +417,7 @@ static int ModuleThread_UpdateAudioFormat( decoder_t *p_dec )
         aout_FormatPrepare( &p_owner->fmt.audio );
         vlc_mutex_unlock( &p_owner->lock );
 
-        if( p_aout == NULL )
+        if( p_aout == NULL && !p_owner->aout_deferred )
         {
             msg_Err( p_dec, "failed to create audio output" );
             return -1;
@@ -475,6 +506,7 @@ static int ModuleThread_UpdateVideoFormat( decoder_t *p_dec, vlc_video_context *
     vout_configuration_t cfg = {
         .vout = p_vout, .clock = p_owner->p_clock, .fmt = &p_dec->fmt_out.video,
         .mouse_event = MouseEvent, .mouse_opaque = p_dec,
+        .trace_id = p_owner->i_trace_id,
     };
     res = input_resource_StartVout( p_owner->p_resource, vctx, &cfg);
     if (res == 0)
@@ -982,6 +1014,128 @@ static void DecoderThread_ProcessSout( vlc_input_decoder_t *p_owner, block_t *p_
 }
 #endif
 
+/*****************************************************************************
+ * Input queue
+ *****************************************************************************/
+
+/* Queues blocks to the locked FIFO, behind those already in the ring.
+ * Any thread may call this. */
+static void DecoderQueueLocked( vlc_input_decoder_t *p_owner, block_t *p_block )
+{
+    vlc_fifo_Lock( p_owner->p_fifo );
+    vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
+    atomic_store( &p_owner->overflow, true );
+    vlc_fifo_Unlock( p_owner->p_fifo );
+}
+
+/* Queues a block from the input thread, without locking unless the ring is
+ * full or the decoder thread sleeps. */
+static void DecoderQueue( vlc_input_decoder_t *p_owner, block_t *p_block )
+{
+    vlc_tracer_Instant( p_owner->tracer, "decoder", "queue",
+                        p_owner->i_trace_id, p_block->i_dts );
+
+    /* The decoder thread clears the sample once it has read the date */
+    if( atomic_load_explicit( &p_owner->queue_sample,
+                              memory_order_acquire ) == 0 )
+    {
+        atomic_store_explicit( &p_owner->queue_sample_date, vlc_tick_now(),
+                               memory_order_relaxed );
+        atomic_store_explicit( &p_owner->queue_sample, (uintptr_t)p_block,
+                               memory_order_release );
+    }
+
+    if( p_block->p_next != NULL || atomic_load( &p_owner->overflow )
+     || !block_ring_Push( &p_owner->ring, p_block ) )
+    {
+        DecoderQueueLocked( p_owner, p_block );
+        return;
+    }
+
+    if( atomic_load( &p_owner->b_idle ) )
+    {
+        vlc_fifo_Lock( p_owner->p_fifo );
+        vlc_fifo_Signal( p_owner->p_fifo );
+        vlc_fifo_Unlock( p_owner->p_fifo );
+    }
+}
+
+/* Drops all queued blocks, from the input thread (FIFO locked) */
+static void DecoderQueueFlush( vlc_input_decoder_t *p_owner )
+{
+    block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    atomic_store( &p_owner->overflow, false );
+
+    /* Only the decoder thread can dequeue from the ring */
+    p_owner->discard = block_ring_Tail( &p_owner->ring );
+    p_owner->b_discard = true;
+
+    /* The timed block may be dropped */
+    atomic_store_explicit( &p_owner->queue_sample, 0, memory_order_relaxed );
+}
+
+/* Returns the number of queued blocks (FIFO locked) */
+static size_t DecoderQueueCount( vlc_input_decoder_t *p_owner )
+{
+    size_t count = vlc_fifo_GetCount( p_owner->p_fifo )
+                 + block_ring_GetCount( &p_owner->ring );
+    if( p_owner->b_discard )
+    {
+        unsigned stale = p_owner->discard - block_ring_Head( &p_owner->ring );
+        count = count > stale ? count - stale : 0;
+    }
+    return count;
+}
+
+/* Dequeues the next block to decode, from the decoder thread (FIFO locked) */
+static block_t *DecoderThread_Dequeue( vlc_input_decoder_t *p_owner )
+{
+    if( p_owner->b_discard )
+    {
+        block_ring_Discard( &p_owner->ring, p_owner->discard );
+        p_owner->b_discard = false;
+    }
+
+    block_t *p_block = block_ring_Pop( &p_owner->ring );
+
+    /* The FIFO cannot overflow while it is locked, and blocks are only queued
+     * to it while it is not empty or the ring is full. */
+    if( p_block == NULL && atomic_load( &p_owner->overflow ) )
+    {
+        p_block = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+        if( vlc_fifo_IsEmpty( p_owner->p_fifo ) )
+            atomic_store( &p_owner->overflow, false );
+    }
+
+    if( p_block != NULL
+     && atomic_load_explicit( &p_owner->queue_sample, memory_order_acquire )
+            == (uintptr_t)p_block )
+    {
+        vlc_tick_t date = atomic_load_explicit( &p_owner->queue_sample_date,
+                                                memory_order_relaxed );
+
+        atomic_store_explicit( &p_owner->queue_sample, 0,
+                               memory_order_release );
+        vlc_latency_Add( &p_owner->latency_pending.stages[VLC_LATENCY_DECODER_QUEUE],
+                         vlc_tick_now() - date );
+    }
+    return p_block;
+}
+
+/* Publishes the decoder thread latency samples (lock held) */
+static void DecoderThread_MergeLatency( vlc_input_decoder_t *p_owner )
+{
+    struct vlc_es_latency *pending = &p_owner->latency_pending;
+
+    for( unsigned i = 0; i < VLC_LATENCY_STAGE_COUNT; i++ )
+    {
+        if( pending->stages[i].count == 0 )
+            continue;
+        vlc_latency_Merge( &p_owner->latency.stages[i], &pending->stages[i] );
+        memset( &pending->stages[i], 0, sizeof (pending->stages[i]) );
+    }
+}
+
 static void DecoderPlayCc( vlc_input_decoder_t *p_owner, block_t *p_cc,
                            const decoder_cc_desc_t *p_desc )
 {
@@ -1002,11 +1156,11 @@ static void DecoderPlayCc( vlc_input_decoder_t *p_owner, block_t *p_cc,
 
         if( i_bitmap > 1 )
         {
-            block_FifoPut( p_ccowner->p_fifo, block_Duplicate(p_cc) );
+            DecoderQueueLocked( p_ccowner, block_Duplicate(p_cc) );
         }
         else
         {
-            block_FifoPut( p_ccowner->p_fifo, p_cc );
+            DecoderQueueLocked( p_ccowner, p_cc );
             p_cc = NULL; /* was last dec */
         }
     }
@@ -1118,6 +1272,8 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
         /* Ensure no earlier higher pts breaks still state */
         vout_Flush( p_vout, p_picture->date );
     }
+    vlc_tracer_Instant( p_owner->tracer, "decoder", "picture",
+                        p_owner->i_trace_id, p_picture->date );
     vout_PutPicture( p_vout, p_picture );
 
     return VLC_SUCCESS;
@@ -1131,6 +1287,10 @@ static void ModuleThread_UpdateStatVideo( vlc_input_decoder_t *p_owner,
     if( p_owner->p_vout != NULL )
     {
         vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost );
+
+        vlc_mutex_lock( &p_owner->lock );
+        vout_GetResetLatency( p_owner->p_vout, &p_owner->latency );
+        vlc_mutex_unlock( &p_owner->lock );
     }
     if (lost) vout_lost++;
 
@@ -1187,6 +1347,40 @@ static void ModuleThread_QueueThumbnail( decoder_t *p_dec, picture_t *p_pic )
 
 }
 
+/* The audio output of a prepared input is only taken once it is resumed: it
+ * is still used by the current input until then. */
+static int ModuleThread_TakeAout( vlc_input_decoder_t *p_owner )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    vlc_fifo_Lock( p_owner->p_fifo );
+    while( p_owner->paused && !p_owner->flushing )
+        vlc_fifo_Wait( p_owner->p_fifo );
+    const bool flushing = p_owner->flushing;
+    vlc_fifo_Unlock( p_owner->p_fifo );
+
+    if( flushing )
+        return VLC_EGENERIC; /* Seek or stop while prepared */
+
+    p_owner->aout_deferred = false;
+    audio_output_t *p_aout = ModuleThread_GetAout( p_dec );
+
+    vlc_mutex_lock( &p_owner->lock );
+    p_owner->p_aout = p_aout;
+    vlc_mutex_unlock( &p_owner->lock );
+
+    if( p_aout == NULL )
+    {
+        msg_Err( p_dec, "failed to create audio output" );
+        return VLC_EGENERIC;
+    }
+
+    vlc_fifo_Lock( p_owner->p_fifo );
+    p_owner->reset_out_state = true;
+    vlc_fifo_Unlock( p_owner->p_fifo );
+    return VLC_SUCCESS;
+}
+
 static int ModuleThread_PlayAudio( vlc_input_decoder_t *p_owner, block_t *p_audio )
 {
     decoder_t *p_dec = &p_owner->dec;
@@ -1233,6 +1427,12 @@ static int ModuleThread_PlayAudio( vlc_input_decoder_t *p_owner, block_t *p_audi
     DecoderWaitUnblock( p_owner );
     vlc_mutex_unlock( &p_owner->lock );
 
+    if( unlikely(p_owner->aout_deferred) && ModuleThread_TakeAout( p_owner ) )
+    {
+        block_Release( p_audio );
+        return VLC_SUCCESS;
+    }
+
     audio_output_t *p_aout = p_owner->p_aout;
 
     if( p_aout == NULL )
@@ -1266,6 +1466,10 @@ static void ModuleThread_UpdateStatAudio( vlc_input_decoder_t *p_owner,
     if( p_owner->p_aout != NULL )
     {
         aout_DecGetResetStats( p_owner->p_aout, &aout_lost, &played );
+
+        vlc_mutex_lock( &p_owner->lock );
+        aout_DecGetResetLatency( p_owner->p_aout, &p_owner->latency );
+        vlc_mutex_unlock( &p_owner->lock );
     }
     if (lost) aout_lost++;
 
@@ -1343,8 +1547,15 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
 static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_block )
 {
     decoder_t *p_dec = &p_owner->dec;
+    vlc_tick_t pts = p_block ? p_block->i_pts : VLC_TICK_INVALID;
+    vlc_tick_t start = vlc_tick_now();
 
     int ret = p_dec->pf_decode( p_dec, p_block );
+    if( p_block != NULL )
+        vlc_latency_Add( &p_owner->latency_pending.stages[VLC_LATENCY_DECODE],
+                         vlc_tick_now() - start );
+    vlc_tracer_Span( p_owner->tracer, "decoder", "decode", start,
+                     p_owner->i_trace_id, pts );
     switch( ret )
     {
         case VLCDEC_SUCCESS:
@@ -1404,6 +1615,7 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
 
         vlc_mutex_lock( &p_owner->lock );
         DecoderUpdatePreroll( &p_owner->i_preroll_end, p_block );
+        DecoderThread_MergeLatency( p_owner );
         vlc_mutex_unlock( &p_owner->lock );
         if( unlikely( p_block->i_flags & BLOCK_FLAG_CORE_PRIVATE_RELOADED ) )
         {
@@ -1704,24 +1916,33 @@ static void *DecoderThread( void *p_data )
 
         if( p_owner->paused && p_owner->frames_countdown == 0 )
         {   /* Wait for resumption from pause */
-            p_owner->b_idle = true;
+            atomic_store( &p_owner->b_idle, true );
             vlc_cond_signal( &p_owner->wait_acknowledge );
             vlc_fifo_Wait( p_owner->p_fifo );
-            p_owner->b_idle = false;
+            atomic_store( &p_owner->b_idle, false );
             continue;
         }
 
         vlc_cond_signal( &p_owner->wait_fifo );
 
-        block_t *p_block = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+        block_t *p_block = DecoderThread_Dequeue( p_owner );
+        if( p_owner->tracer != NULL )
+            vlc_tracer_Counter( p_owner->tracer, "decoder", "queue depth",
+                                p_owner->i_trace_id,
+                                DecoderQueueCount( p_owner ) );
         if( p_block == NULL )
         {
             if( likely(!p_owner->b_draining) )
             {   /* Wait for a block to decode (or a request to drain) */
-                p_owner->b_idle = true;
-                vlc_cond_signal( &p_owner->wait_acknowledge );
-                vlc_fifo_Wait( p_owner->p_fifo );
-                p_owner->b_idle = false;
+                atomic_store( &p_owner->b_idle, true );
+                /* The producer does not lock the FIFO unless it sees the
+                 * idle flag: check the ring again after setting it. */
+                if( block_ring_GetCount( &p_owner->ring ) == 0 )
+                {
+                    vlc_cond_signal( &p_owner->wait_acknowledge );
+                    vlc_fifo_Wait( p_owner->p_fifo );
+                }
+                atomic_store( &p_owner->b_idle, false );
                 continue;
             }
             /* We have emptied the FIFO and there is a pending request to
@@ -1826,6 +2047,9 @@ CreateDecoder( vlc_object_t *p_parent,
     p_owner->cbs = cbs;
     p_owner->cbs_userdata = cbs_userdata;
     p_owner->p_aout = NULL;
+    /* Set by the player on inputs opened ahead of time */
+    p_owner->aout_deferred = var_Type( p_parent, "prepared" ) != 0
+                          && var_GetBool( p_parent, "prepared" );
     p_owner->p_vout = NULL;
     p_owner->vout_thread_started = false;
     p_owner->i_spu_channel = VOUT_SPU_CHANNEL_INVALID;
@@ -1854,7 +2078,10 @@ CreateDecoder( vlc_object_t *p_parent,
     p_owner->b_draining = false;
     p_owner->drained = false;
     atomic_init( &p_owner->reload, RELOAD_NO_REQUEST );
-    p_owner->b_idle = false;
+    atomic_init( &p_owner->b_idle, false );
+
+    p_owner->tracer = vlc_object_get_tracer( p_dec );
+    p_owner->i_trace_id = fmt->i_id;
 
     p_owner->mouse_event = NULL;
     p_owner->mouse_opaque = NULL;
@@ -1868,6 +2095,16 @@ CreateDecoder( vlc_object_t *p_parent,
         vlc_object_delete(p_dec);
         return NULL;
     }
+    if( block_ring_Init( &p_owner->ring, DECODER_RING_SIZE ) )
+    {
+        block_FifoRelease( p_owner->p_fifo );
+        vlc_object_delete(p_dec);
+        return NULL;
+    }
+    atomic_init( &p_owner->overflow, false );
+    p_owner->b_discard = false;
+    atomic_init( &p_owner->queue_sample, 0 );
+    atomic_init( &p_owner->queue_sample_date, 0 );
 
     vlc_mutex_init( &p_owner->lock );
     vlc_mutex_init( &p_owner->mouse_lock );
@@ -1974,6 +2211,7 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
         vlc_video_context_Release( p_owner->vctx );
 
     /* Free all packets still in the decoder fifo. */
+    block_ring_Destroy( &p_owner->ring );
     block_FifoRelease( p_owner->p_fifo );
 
     /* Cleanup */
@@ -2214,31 +2452,41 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
 void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, block_t *p_block,
                                bool b_do_pace )
 {
-    vlc_fifo_Lock( p_owner->p_fifo );
     if( !b_do_pace )
     {
         /* FIXME: ideally we would check the time amount of data
          * in the FIFO instead of its size. */
         /* 400 MiB, i.e. ~ 50mb/s for 60s */
-        if( vlc_fifo_GetBytes( p_owner->p_fifo ) > 400*1024*1024 )
+        if( block_ring_GetBytes( &p_owner->ring ) > 400*1024*1024
+         || atomic_load( &p_owner->overflow ) )
         {
-            msg_Warn( &p_owner->dec, "decoder/packetizer fifo full (data not "
-                      "consumed quickly enough), resetting fifo!" );
-            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
-            p_block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+            vlc_fifo_Lock( p_owner->p_fifo );
+            if( !p_owner->b_discard
+             && vlc_fifo_GetBytes( p_owner->p_fifo )
+              + block_ring_GetBytes( &p_owner->ring ) > 400*1024*1024 )
+            {
+                msg_Warn( &p_owner->dec, "decoder/packetizer fifo full (data "
+                          "not consumed quickly enough), resetting fifo!" );
+                DecoderQueueFlush( p_owner );
+                p_block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+            }
+            vlc_fifo_Unlock( p_owner->p_fifo );
         }
     }
     else
-    if( !p_owner->b_waiting )
+    if( !p_owner->b_waiting
+     && ( block_ring_GetCount( &p_owner->ring ) >= 10
+       || atomic_load( &p_owner->overflow ) ) )
     {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
          * Locking is not necessary as b_waiting is only read, not written by
          * the decoder thread. */
-        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
+        vlc_fifo_Lock( p_owner->p_fifo );
+        while( DecoderQueueCount( p_owner ) >= 10 )
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
+        vlc_fifo_Unlock( p_owner->p_fifo );
     }
 
-    vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
-    vlc_fifo_Unlock( p_owner->p_fifo );
+    DecoderQueue( p_owner, p_block );
 }
 
 bool vlc_input_decoder_IsEmpty( vlc_input_decoder_t * p_owner )
@@ -2246,7 +2494,7 @@ bool vlc_input_decoder_IsEmpty( vlc_input_decoder_t * p_owner )
     assert( !p_owner->b_waiting );
 
     vlc_fifo_Lock( p_owner->p_fifo );
-    if( !vlc_fifo_IsEmpty( p_owner->p_fifo ) || p_owner->b_draining )
+    if( DecoderQueueCount( p_owner ) > 0 || p_owner->b_draining )
     {
         vlc_fifo_Unlock( p_owner->p_fifo );
         return false;
@@ -2297,7 +2545,7 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
     vlc_fifo_Lock( p_owner->p_fifo );
 
     /* Empty the fifo */
-    block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    DecoderQueueFlush( p_owner );
 
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
@@ -2495,7 +2743,7 @@ void vlc_input_decoder_Wait( vlc_input_decoder_t *p_owner )
         if( p_owner->paused )
             break;
         vlc_fifo_Lock( p_owner->p_fifo );
-        if( p_owner->b_idle && vlc_fifo_IsEmpty( p_owner->p_fifo ) )
+        if( atomic_load( &p_owner->b_idle ) && DecoderQueueCount( p_owner ) == 0 )
         {
             msg_Err( &p_owner->dec, "buffer deadlock prevented" );
             vlc_fifo_Unlock( p_owner->p_fifo );
@@ -2554,7 +2802,19 @@ bool vlc_input_decoder_HasFormatChanged( vlc_input_decoder_t *p_owner,
 
 size_t vlc_input_decoder_GetFifoSize( vlc_input_decoder_t *p_owner )
 {
-    return block_FifoSize( p_owner->p_fifo );
+    vlc_fifo_Lock( p_owner->p_fifo );
+    size_t size = vlc_fifo_GetBytes( p_owner->p_fifo )
+                + block_ring_GetBytes( &p_owner->ring );
+    vlc_fifo_Unlock( p_owner->p_fifo );
+    return size;
+}
+
+void vlc_input_decoder_GetLatency( vlc_input_decoder_t *p_owner,
+                                   struct vlc_es_latency *latency )
+{
+    vlc_mutex_lock( &p_owner->lock );
+    *latency = p_owner->latency;
+    vlc_mutex_unlock( &p_owner->lock );
 }
 
 static bool DecoderHasVbi( decoder_t *dec )
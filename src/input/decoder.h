@@ -134,6 +134,13 @@ bool vlc_input_decoder_HasFormatChanged( vlc_input_decoder_t *p_dec, es_format_t
  */
 size_t vlc_input_decoder_GetFifoSize( vlc_input_decoder_t *p_dec );
 
+/**
+ * This function returns the latency statistics of the decoder and of its
+ * output, since the decoder was created.
+ */
+void vlc_input_decoder_GetLatency( vlc_input_decoder_t *p_dec,
+                                   struct vlc_es_latency *latency );
+
 int vlc_input_decoder_GetVbiPage( vlc_input_decoder_t *, bool *opaque );
 int vlc_input_decoder_SetVbiPage( vlc_input_decoder_t *, unsigned page );
 int vlc_input_decoder_SetVbiOpaque( vlc_input_decoder_t *, bool opaque );
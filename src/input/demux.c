@@ -35,6 +35,7 @@
 #include <vlc_modules.h>
 #include <vlc_strings.h>
 #include "input_internal.h"
+#include "modules/modules.h"
 
 typedef const struct
 {
@@ -245,8 +246,24 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
     if( psz_module == NULL )
         psz_module = p_demux->psz_name;
 
-    priv->module = vlc_module_load(p_demux, "demux", psz_module,
-        !strcmp(psz_module, p_demux->psz_name), demux_Probe, p_demux);
+    /* Rule out the demuxers whose signatures do not match */
+    const uint8_t *p_peek;
+    ssize_t i_peek = vlc_stream_Peek( s, &p_peek, MODULE_SIGNATURE_PEEK );
+    if( i_peek < 0 )
+    {
+        p_peek = NULL;
+        i_peek = 0;
+    }
+
+    vlc_tick_t i_start = vlc_tick_now();
+    priv->module = vlc_module_load_peek(vlc_object_logger(p_demux), "demux",
+        psz_module, !strcmp(psz_module, p_demux->psz_name), p_peek, i_peek,
+        demux_Probe, p_demux);
+
+    if( priv->module != NULL && !b_preparsing )
+        msg_Dbg( p_demux, "demux \"%s\" opened in %"PRId64" us",
+                 module_get_object( priv->module ),
+                 US_FROM_VLC_TICK( vlc_tick_now() - i_start ) );
 
     if (priv->module == NULL)
     {
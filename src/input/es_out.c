@@ -205,7 +205,9 @@ typedef struct
     vlc_tick_t  i_tracks_pts_delay;
     vlc_tick_t  i_pts_jitter;
     int         i_cr_average;
-    float       rate;
+    float       rate; /* input_rate * rate_adjust */
+    float       input_rate;
+    float       rate_adjust; /* ES_OUT_SET_RATE_ADJUST */
 
     /* */
     bool        b_paused;
@@ -527,7 +529,8 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, input_source_t *main_source,
 
     p_sys->i_pause_date = -1;
 
-    p_sys->rate = rate;
+    p_sys->rate = p_sys->input_rate = rate;
+    p_sys->rate_adjust = 1.f;
 
     p_sys->b_buffering = true;
     p_sys->i_preroll_end = -1;
@@ -874,11 +877,13 @@ static void EsOutChangePause( es_out_t *out, bool b_paused, vlc_tick_t i_date )
     p_sys->i_pause_date = i_date;
 }
 
-static void EsOutChangeRate( es_out_t *out, float rate )
+static void EsOutChangeRate( es_out_t *out )
 {
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
     es_out_id_t *es;
 
+    const float rate = p_sys->input_rate * p_sys->rate_adjust;
+
     p_sys->rate = rate;
     EsOutProgramsChangeRate( out );
 
@@ -3438,6 +3443,21 @@ static int EsOutVaControlLocked( es_out_t *out, input_source_t *source,
             return vlc_input_decoder_SetSpuHighlight( p_es->p_dec, spu_hl );
         return VLC_EGENERIC;
     }
+    case ES_OUT_SET_RATE_ADJUST:
+    {
+        const float adjust = va_arg( args, double );
+
+        /* Only the main source drives the pace */
+        if( source != p_sys->main_source || !(adjust > 0.f) )
+            return VLC_EGENERIC;
+
+        if( adjust != p_sys->rate_adjust )
+        {
+            p_sys->rate_adjust = adjust;
+            EsOutChangeRate( out );
+        }
+        return VLC_SUCCESS;
+    }
     default: vlc_assert_unreachable();
     }
 }
@@ -3620,7 +3640,8 @@ static int EsOutVaPrivControlLocked( es_out_t *out, int query, va_list args )
         const float rate = va_arg( args, double );
 
         assert( src_rate == rate );
-        EsOutChangeRate( out, rate );
+        p_sys->input_rate = rate;
+        EsOutChangeRate( out );
 
         return VLC_SUCCESS;
     }
@@ -3740,6 +3761,20 @@ static int EsOutVaPrivControlLocked( es_out_t *out, int query, va_list args )
         }
         return ret;
     }
+    case ES_OUT_PRIV_UPDATE_LATENCY:
+    {
+        es_out_id_t *es;
+        foreach_es_then_es_slaves(es)
+        {
+            if( es->p_dec == NULL )
+                continue;
+
+            struct vlc_es_latency latency;
+            vlc_input_decoder_GetLatency( es->p_dec, &latency );
+            input_SendEventEsLatency( p_sys->p_input, &es->id, &latency );
+        }
+        return VLC_SUCCESS;
+    }
     default: vlc_assert_unreachable();
     }
 
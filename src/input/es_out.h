@@ -96,7 +96,10 @@ enum es_out_query_private_e
     ES_OUT_PRIV_SET_VBI_PAGE,                       /* arg1=unsigned res=can fail */
 
     /* Set VBI/Teletext menu transparent */
-    ES_OUT_PRIV_SET_VBI_TRANSPARENCY                /* arg1=bool res=can fail */
+    ES_OUT_PRIV_SET_VBI_TRANSPARENCY,               /* arg1=bool res=can fail */
+
+    /* Send the latency statistics of all decoded ES */
+    ES_OUT_PRIV_UPDATE_LATENCY,                     /* res=cannot fail */
 };
 
 static inline int es_out_vaPrivControl( es_out_t *out, int query, va_list args )
@@ -241,6 +244,11 @@ static inline int es_out_SetVbiTransparency( es_out_t *p_out, vlc_es_id_t *id,
     return es_out_PrivControl( p_out, ES_OUT_PRIV_SET_VBI_TRANSPARENCY, id,
                                enabled );
 }
+static inline void es_out_UpdateLatency( es_out_t *p_out )
+{
+    int i_ret = es_out_PrivControl( p_out, ES_OUT_PRIV_UPDATE_LATENCY );
+    assert( !i_ret );
+}
 
 es_out_t  *input_EsOutNew( input_thread_t *, input_source_t *main_source, float rate );
 es_out_t  *input_EsOutTimeshiftNew( input_thread_t *, es_out_t *, float i_rate );
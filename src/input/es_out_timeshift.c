@@ -754,6 +754,17 @@ static int ControlLocked( es_out_t *p_out, input_source_t *in, int i_query,
                                   i_system );
     }
 
+    case ES_OUT_SET_RATE_ADJUST:
+    {
+        const double f_adjust = va_arg( args, double );
+
+        /* The live edge is out of reach while delayed */
+        if( p_sys->b_delayed )
+            return VLC_EGENERIC;
+
+        return es_out_in_Control( p_sys->p_out, in, i_query, f_adjust );
+    }
+
     default:
         vlc_assert_unreachable();
         return VLC_EGENERIC;
@@ -842,6 +853,7 @@ static int PrivControlLocked( es_out_t *p_tsout, int i_query, va_list args )
     case ES_OUT_PRIV_SET_RECORD_STATE:
     case ES_OUT_PRIV_SET_VBI_PAGE:
     case ES_OUT_PRIV_SET_VBI_TRANSPARENCY:
+    case ES_OUT_PRIV_UPDATE_LATENCY:
     default: vlc_assert_unreachable();
     }
 }
@@ -88,6 +88,16 @@ static inline void input_SendEventStatistics(input_thread_t *p_input,
     });
 }
 
+static inline void input_SendEventEsLatency(input_thread_t *p_input,
+                                            vlc_es_id_t *id,
+                                            const struct vlc_es_latency *latency)
+{
+    input_SendEvent(p_input, &(struct vlc_input_event) {
+        .type = INPUT_EVENT_ES_LATENCY,
+        .es_latency = { id, latency },
+    });
+}
+
 static inline void input_SendEventRate(input_thread_t *p_input, float rate)
 {
     input_SendEvent(p_input, &(struct vlc_input_event) {
@@ -55,6 +55,7 @@
 #include <vlc_stream_extractor.h>
 #include <vlc_renderer_discovery.h>
 #include <vlc_hash.h>
+#include <vlc_tracer.h>
 
 /*****************************************************************************
  * Local prototypes
@@ -407,6 +408,7 @@ static input_thread_t *Create( vlc_object_t *p_parent,
         priv->stats = input_stats_Create();
     else
         priv->stats = NULL;
+    priv->tracer = vlc_object_get_tracer( p_input );
 
     priv->p_es_out_display = input_EsOutNew( p_input, priv->master, priv->rate );
     if( !priv->p_es_out_display )
@@ -547,7 +549,13 @@ static void MainLoopDemux( input_thread_t *p_input, bool *pb_changed )
     }
 
     if( i_ret == VLC_DEMUXER_SUCCESS )
+    {
+        vlc_tick_t start = vlc_tracer_Now( p_priv->tracer );
+
         i_ret = demux_Demux( p_demux );
+        vlc_tracer_Span( p_priv->tracer, "input", "demux", start, 0,
+                         VLC_TICK_INVALID );
+    }
 
     i_ret = i_ret > 0 ? VLC_DEMUXER_SUCCESS : ( i_ret < 0 ? VLC_DEMUXER_EGENERIC : VLC_DEMUXER_EOF);
 
@@ -655,6 +663,9 @@ static void MainLoopStatistics( input_thread_t *p_input )
     vlc_mutex_unlock( &priv->p_item->lock );
 
     input_SendEventStatistics( p_input, &new_stats );
+
+    if( priv->stats != NULL )
+        es_out_UpdateLatency( priv->p_es_out_display );
 }
 
 /**
@@ -1361,7 +1372,7 @@ error:
         if( input_priv(p_input)->p_sout )
             input_resource_RequestSout( input_priv(p_input)->p_resource,
                                          input_priv(p_input)->p_sout, NULL );
-        input_resource_SetInput( input_priv(p_input)->p_resource, NULL );
+        input_resource_UnsetInput( input_priv(p_input)->p_resource, p_input );
         if( input_priv(p_input)->p_resource )
         {
             input_resource_Release( input_priv(p_input)->p_resource );
@@ -1431,7 +1442,7 @@ static void End( input_thread_t * p_input )
     /* */
     input_resource_RequestSout( input_priv(p_input)->p_resource,
                                  input_priv(p_input)->p_sout, NULL );
-    input_resource_SetInput( input_priv(p_input)->p_resource, NULL );
+    input_resource_UnsetInput( input_priv(p_input)->p_resource, p_input );
     if( input_priv(p_input)->p_resource )
     {
         input_resource_Release( input_priv(p_input)->p_resource );
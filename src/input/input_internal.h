@@ -118,6 +118,8 @@ typedef enum input_event_type_e
 
     /* Input statistics have been updated */
     INPUT_EVENT_STATISTICS,
+    /* ES latency statistics have been updated */
+    INPUT_EVENT_ES_LATENCY,
     /* At least one of "signal-quality" or "signal-strength" has changed */
     INPUT_EVENT_SIGNAL,
 
@@ -242,6 +244,15 @@ struct vlc_input_event_es {
     bool forced;
 };
 
+struct vlc_input_event_es_latency {
+    /**
+     * ES track id: only valid from the event callback, unless the id is held
+     * by the user with vlc_es_Hold(). */
+    vlc_es_id_t *id;
+    /** Latency statistics, since the ES decoder was created */
+    const struct vlc_es_latency *latency;
+};
+
 struct vlc_input_event_signal {
     float quality;
     float strength;
@@ -285,6 +296,8 @@ struct vlc_input_event
         bool record;
         /* INPUT_EVENT_STATISTICS */
         const struct input_stats_t *stats;
+        /* INPUT_EVENT_ES_LATENCY */
+        struct vlc_input_event_es_latency es_latency;
         /* INPUT_EVENT_SIGNAL */
         struct vlc_input_event_signal signal;
         /* INPUT_EVENT_CACHE */
@@ -526,6 +539,7 @@ typedef struct input_thread_private_t
 
     /* Stats counters */
     struct input_stats *stats;
+    struct vlc_tracer *tracer;
 
     /* Buffer of pending actions */
     vlc_mutex_t lock_control;
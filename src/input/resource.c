@@ -313,11 +313,22 @@ void input_resource_SetInput( input_resource_t *p_resource, input_thread_t *p_in
 {
     vlc_mutex_lock( &p_resource->lock );
 
-    if( p_resource->p_input && !p_input )
-        assert( p_resource->i_vout == 0 || p_resource->p_vout_free == p_resource->pp_vout[0] );
+    /* An input opened ahead of time does not replace the current one */
+    if( p_resource->p_input == NULL )
+        p_resource->p_input = p_input;
 
-    /* */
-    p_resource->p_input = p_input;
+    vlc_mutex_unlock( &p_resource->lock );
+}
+
+void input_resource_UnsetInput( input_resource_t *p_resource, input_thread_t *p_input )
+{
+    vlc_mutex_lock( &p_resource->lock );
+
+    if( p_resource->p_input == p_input )
+    {
+        assert( p_resource->i_vout == 0 || p_resource->p_vout_free == p_resource->pp_vout[0] );
+        p_resource->p_input = NULL;
+    }
 
     vlc_mutex_unlock( &p_resource->lock );
 }
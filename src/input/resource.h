@@ -28,10 +28,15 @@
 #include "../video_output/vout_internal.h"
 
 /**
- * This function set the associated input.
+ * This function set the associated input, unless another one is set.
  */
 void input_resource_SetInput( input_resource_t *, input_thread_t * );
 
+/**
+ * This function unset the associated input, if it is the given one.
+ */
+void input_resource_UnsetInput( input_resource_t *, input_thread_t * );
+
 /**
  * This function handles sout request.
  */
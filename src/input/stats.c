@@ -24,6 +24,7 @@
 # include "config.h"
 #endif
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -137,3 +138,56 @@ void input_rate_Add(input_rate_t *counter, uintmax_t val)
     counter->samples[0].date = now;
     vlc_mutex_unlock(&counter->lock);
 }
+
+vlc_tick_t vlc_latency_GetJitter(const struct vlc_latency_histogram *h)
+{
+    if (h->count < 2)
+        return 0;
+
+    double mean = (double)h->sum / h->count;
+    double variance = h->sum_squares / h->count - mean * mean;
+
+    if (variance <= 0.)
+        return 0;
+    return llround(sqrt(variance));
+}
+
+/* Returns the end of a bucket, i.e. the first value of the next one */
+static vlc_tick_t vlc_latency_GetBucketEnd(unsigned bucket)
+{
+    if (bucket < VLC_LATENCY_SUB_BUCKETS)
+        return VLC_TICK_FROM_US(bucket + 1);
+
+    unsigned exp = bucket / VLC_LATENCY_SUB_BUCKETS + 1;
+    unsigned sub = bucket % VLC_LATENCY_SUB_BUCKETS;
+
+    return VLC_TICK_FROM_US((int64_t)(VLC_LATENCY_SUB_BUCKETS + sub + 1)
+                            << (exp - 2));
+}
+
+vlc_tick_t vlc_latency_GetPercentile(const struct vlc_latency_histogram *h,
+                                     unsigned percent)
+{
+    if (h->count == 0)
+        return 0;
+    if (percent > 100)
+        percent = 100;
+
+    /* Rank of the percentile sample, rounded up */
+    uint64_t rank = (h->count * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    if (rank == 0)
+        rank = 1;
+
+    for (unsigned i = 0; i < VLC_LATENCY_BUCKETS - 1; i++)
+    {
+        seen += h->buckets[i];
+        if (seen >= rank)
+        {
+            vlc_tick_t bound = vlc_latency_GetBucketEnd(i);
+            return (bound < h->max) ? bound : h->max;
+        }
+    }
+    return h->max;
+}
@@ -93,6 +93,18 @@ static const char *const ppsz_snap_formats[] =
 #define OPEN_LONGTEXT N_( \
     "This stream will always be opened at VLC startup." )
 
+#define LOG_ASYNC_TEXT N_("Asynchronous messages")
+#define LOG_ASYNC_LONGTEXT N_( \
+    "Format and output the log messages in a background thread, so that " \
+    "verbose logging does not slow down the playback threads. Debug " \
+    "messages may be dropped if they are emitted faster than they can be " \
+    "output.")
+
+#define TRACER_TEXT N_("Tracer module")
+#define TRACER_LONGTEXT N_( \
+    "Record the timings of the media pipeline stages with this module. " \
+    "Tracing is disabled by default.")
+
 #define COLOR_TEXT N_("Color messages")
 #define COLOR_LONGTEXT N_( \
     "This enables colorization of the messages sent to the console. " \
@@ -1194,6 +1206,18 @@ static const char *const clock_sources_text[] = {
 #define PREPARSE_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to preparse items" )
 
+#define PREPARSE_THREADS_MAX_TEXT N_( "Adaptive preparsing threads" )
+#define PREPARSE_THREADS_MAX_LONGTEXT N_( \
+    "Upper bound of the number of preparsing threads. When above the " \
+    "number of preparsing threads, threads are added or removed depending " \
+    "on the measured preparsing throughput." )
+
+#define PREPARSE_CACHE_TEXT N_( "Preparsing cache" )
+#define PREPARSE_CACHE_LONGTEXT N_( \
+    "Keep the results of the preparsing across sessions, so that unchanged " \
+    "files are not probed again. Remote files are checked with their " \
+    "entity tag or modification date, e.g. over HTTP." )
+
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
@@ -1256,6 +1280,12 @@ static const char *const psz_recursive_list_text[] = {
 #define SP_LONGTEXT N_( \
     "Pause each item in the playlist on the first frame." )
 
+#define PREPARE_NEXT_TEXT N_("Prepare the next item ahead (ms)")
+#define PREPARE_NEXT_LONGTEXT N_( \
+    "Open and buffer the next item of the playlist this many milliseconds " \
+    "before the end of the current one, and keep the same audio output, " \
+    "to shorten the gap between items. 0 disables it." )
+
 #define AUTOSTART_TEXT N_( "Auto start" )
 #define AUTOSTART_LONGTEXT N_( "Automatically start playing the playlist " \
                 "content once it's loaded." )
@@ -2183,6 +2213,9 @@ vlc_module_begin ()
     add_bool( "play-and-pause", 0, PAP_TEXT, PAP_LONGTEXT, true )
         change_safe()
     add_bool( "start-paused", 0, SP_TEXT, SP_LONGTEXT, false )
+    add_integer( "prepare-next-media", 0, PREPARE_NEXT_TEXT,
+                 PREPARE_NEXT_LONGTEXT, true )
+        change_integer_range( 0, 60000 )
     add_bool( "playlist-autostart", true,
               AUTOSTART_TEXT, AUTOSTART_LONGTEXT, false )
     add_bool( "playlist-cork", true, CORK_TEXT, CORK_LONGTEXT, false )
@@ -2215,6 +2248,12 @@ vlc_module_begin ()
     add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
                  PREPARSE_THREADS_LONGTEXT, false )
 
+    add_integer( "preparse-threads-max", 0, PREPARSE_THREADS_MAX_TEXT,
+                 PREPARSE_THREADS_MAX_LONGTEXT, true )
+
+    add_bool( "preparse-cache", false, PREPARSE_CACHE_TEXT,
+              PREPARSE_CACHE_LONGTEXT, true )
+
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT, false )
 
@@ -2257,6 +2296,8 @@ vlc_module_begin ()
     add_obsolete_string( "language" ) /* since 2.1.0 */
 #endif
 
+    add_bool( "log-async", false, LOG_ASYNC_TEXT, LOG_ASYNC_LONGTEXT, true )
+    add_module("tracer", "tracer", NULL, TRACER_TEXT, TRACER_LONGTEXT)
     add_bool( "color", true, COLOR_TEXT, COLOR_LONGTEXT, true )
         change_volatile ()
     add_obsolete_bool( "advanced" ) /* since 4.0.0 */
@@ -95,6 +95,7 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->tracer = NULL;
 
     vlc_ExitInit( &priv->exit );
 
@@ -179,6 +180,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
         goto error;
 
     vlc_LogInit(p_libvlc);
+    priv->tracer = vlc_TracerCreate(VLC_OBJECT(p_libvlc));
 
     /*
      * Support for gettext
@@ -391,6 +393,8 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
 
+    if (priv->tracer != NULL)
+        vlc_TracerDestroy(priv->tracer);
     vlc_LogDestroy(p_libvlc->obj.logger);
     /* Free module bank. It is refcounted, so we call this each time  */
     module_EndBank (true);
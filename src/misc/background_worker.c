@@ -184,18 +184,25 @@ static void TerminateTask(struct background_thread *thread, struct task *task)
     task_Destroy(worker, task);
 }
 
-static void RemoveThread(struct background_thread *thread)
+static void RemoveThreadLocked(struct background_thread *thread)
 {
     struct background_worker *worker = thread->owner;
 
-    vlc_mutex_lock(&worker->lock);
+    vlc_mutex_assert(&worker->lock);
 
     vlc_list_remove(&thread->node);
     worker->nthreads--;
     assert(worker->nthreads >= 0);
     if (!worker->nthreads)
         vlc_cond_signal(&worker->nothreads_wait);
+}
 
+static void RemoveThread(struct background_thread *thread)
+{
+    struct background_worker *worker = thread->owner;
+
+    vlc_mutex_lock(&worker->lock);
+    RemoveThreadLocked(thread);
     vlc_mutex_unlock(&worker->lock);
 
     background_thread_Destroy(thread);
@@ -209,6 +216,15 @@ static void* Thread( void* data )
     for (;;)
     {
         vlc_mutex_lock(&worker->lock);
+        if (worker->nthreads > worker->conf.max_threads)
+        {
+            /* the limit has been lowered, terminate this thread */
+            RemoveThreadLocked(thread);
+            vlc_mutex_unlock(&worker->lock);
+            background_thread_Destroy(thread);
+            return NULL;
+        }
+
         struct task *task = QueueTake(worker, 5000);
         if (!task)
         {
@@ -305,6 +321,21 @@ int background_worker_Push( struct background_worker* worker, void* entity,
     return VLC_SUCCESS;
 }
 
+void background_worker_SetMaxThreads( struct background_worker* worker,
+                                      int max_threads )
+{
+    assert(max_threads > 0);
+
+    vlc_mutex_lock(&worker->lock);
+    worker->conf.max_threads = max_threads;
+    /* threads in excess terminate after their current task */
+    while (worker->uncompleted > worker->nthreads
+            && worker->nthreads < worker->conf.max_threads)
+        if (!SpawnThread(worker))
+            break;
+    vlc_mutex_unlock(&worker->lock);
+}
+
 static void BackgroundWorkerCancelLocked(struct background_worker *worker,
                                          void *id)
 {
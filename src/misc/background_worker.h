@@ -171,6 +171,19 @@ void background_worker_RequestProbe( struct background_worker* worker );
 int background_worker_Push( struct background_worker* worker, void* entity,
     void* id, int timeout );
 
+/**
+ * Change the maximum number of threads of the background-worker
+ *
+ * If the limit is raised, new threads are spawned immediately for the pending
+ * entities. If it is lowered, the threads in excess terminate once their
+ * current task is completed.
+ *
+ * \param worker the background-worker
+ * \param max_threads the new maximum number of threads, greater than `0`
+ **/
+void background_worker_SetMaxThreads( struct background_worker* worker,
+    int max_threads );
+
 /**
  * Remove entities from the background-worker
  *
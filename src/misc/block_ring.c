@@ -0,0 +1,145 @@
+/*****************************************************************************
+ * block_ring.c: single producer single consumer block queue
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "block_ring.h"
+
+#define RING_CONSUMER 1 /* the consumer sleeps on the tail */
+#define RING_PRODUCER 2 /* the producer sleeps on the head */
+
+/* Wakes the other side up if it sleeps, once per transition */
+static void block_ring_Notify(block_ring_t *ring, atomic_uint *addr,
+                              unsigned sleeper)
+{
+    if ((atomic_load(&ring->sleepers) & sleeper)
+     && (atomic_fetch_and(&ring->sleepers, ~sleeper) & sleeper))
+        vlc_atomic_notify_one(addr);
+}
+
+int block_ring_Init(block_ring_t *ring, unsigned size)
+{
+    assert(size > 0 && (size & (size - 1)) == 0);
+
+    ring->slots = vlc_alloc(size, sizeof (*ring->slots));
+    if (unlikely(ring->slots == NULL))
+        return VLC_ENOMEM;
+
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->bytes, 0);
+    atomic_init(&ring->sleepers, 0);
+    return VLC_SUCCESS;
+}
+
+void block_ring_Destroy(block_ring_t *ring)
+{
+    block_ring_Discard(ring, atomic_load(&ring->tail));
+    free(ring->slots);
+}
+
+bool block_ring_Push(block_ring_t *ring, block_t *block)
+{
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    assert(block->p_next == NULL);
+
+    if (tail - head > ring->mask)
+        return false; /* full */
+
+    ring->slots[tail & ring->mask] = block;
+    atomic_fetch_add_explicit(&ring->bytes, block->i_buffer,
+                              memory_order_relaxed);
+
+    /* Sequentially consistent, so that either the consumer sees the block
+     * before it goes to sleep, or this thread sees the sleeping consumer. */
+    atomic_store(&ring->tail, tail + 1);
+
+    block_ring_Notify(ring, &ring->tail, RING_CONSUMER);
+    return true;
+}
+
+void block_ring_WaitPush(block_ring_t *ring, block_t *block)
+{
+    while (!block_ring_Push(ring, block))
+    {
+        unsigned head = atomic_load(&ring->tail) - (ring->mask + 1);
+
+        atomic_fetch_or(&ring->sleepers, RING_PRODUCER);
+        vlc_atomic_wait(&ring->head, head);
+    }
+}
+
+block_t *block_ring_Pop(block_ring_t *ring)
+{
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail)
+        return NULL; /* empty */
+
+    block_t *block = ring->slots[head & ring->mask];
+    atomic_fetch_sub_explicit(&ring->bytes, block->i_buffer,
+                              memory_order_relaxed);
+
+    /* See block_ring_Push() */
+    atomic_store(&ring->head, head + 1);
+
+    block_ring_Notify(ring, &ring->head, RING_PRODUCER);
+    return block;
+}
+
+block_t *block_ring_WaitPop(block_ring_t *ring)
+{
+    block_t *block;
+
+    while ((block = block_ring_Pop(ring)) == NULL)
+    {
+        unsigned tail = atomic_load(&ring->head);
+
+        atomic_fetch_or(&ring->sleepers, RING_CONSUMER);
+        vlc_atomic_wait(&ring->tail, tail);
+    }
+    return block;
+}
+
+unsigned block_ring_Discard(block_ring_t *ring, unsigned tail)
+{
+    unsigned count = 0;
+
+    while (atomic_load_explicit(&ring->head, memory_order_relaxed) != tail)
+    {
+        block_t *block = block_ring_Pop(ring);
+
+        assert(block != NULL);
+        block_Release(block);
+        count++;
+    }
+    return count;
+}
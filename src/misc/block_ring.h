@@ -0,0 +1,123 @@
+/*****************************************************************************
+ * block_ring.h: single producer single consumer block queue
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_BLOCK_RING_H
+# define LIBVLC_BLOCK_RING_H 1
+
+#include <vlc_atomic.h>
+
+/**
+ * Lock-free bounded queue of blocks.
+ *
+ * Exactly one thread may push blocks (the producer), and exactly one thread
+ * may pop them (the consumer). Either side may be serialized by a lock
+ * instead of being a single thread. The count and size of the queued blocks
+ * can be read from any thread.
+ *
+ * The blocking functions only issue a wake-up call when the other side is
+ * actually sleeping, that is on the empty and full transitions.
+ */
+typedef struct block_ring_t
+{
+    block_t **slots;
+    unsigned mask;
+
+    atomic_uint head; /**< Count of popped blocks, written by the consumer */
+    atomic_uint tail; /**< Count of pushed blocks, written by the producer */
+    atomic_size_t bytes;
+    atomic_uint sleepers;
+} block_ring_t;
+
+/**
+ * Initializes a ring.
+ *
+ * \param size maximum number of blocks (must be a power of two)
+ */
+VLC_API int block_ring_Init(block_ring_t *, unsigned size);
+
+/**
+ * Deinitializes a ring, releasing any queued block.
+ */
+VLC_API void block_ring_Destroy(block_ring_t *);
+
+/**
+ * Queues a block (producer side).
+ *
+ * \return false if the ring is full, true otherwise
+ */
+VLC_API bool block_ring_Push(block_ring_t *, block_t *);
+
+/**
+ * Queues a block, waiting for a free slot if the ring is full
+ * (producer side).
+ */
+VLC_API void block_ring_WaitPush(block_ring_t *, block_t *);
+
+/**
+ * Dequeues a block (consumer side).
+ *
+ * \return the oldest block, or NULL if the ring is empty
+ */
+VLC_API block_t *block_ring_Pop(block_ring_t *);
+
+/**
+ * Dequeues a block, waiting for one if the ring is empty (consumer side).
+ */
+VLC_API block_t *block_ring_WaitPop(block_ring_t *);
+
+/**
+ * Releases the queued blocks up to a given position (consumer side).
+ *
+ * \param tail a value previously returned by block_ring_Tail()
+ * \return the number of released blocks
+ */
+VLC_API unsigned block_ring_Discard(block_ring_t *, unsigned tail);
+
+/**
+ * Returns the consumer position, i.e. the number of popped blocks, modulo
+ * UINT_MAX + 1.
+ */
+static inline unsigned block_ring_Head(block_ring_t *ring)
+{
+    return atomic_load(&ring->head);
+}
+
+/**
+ * Returns the producer position, i.e. the number of pushed blocks, modulo
+ * UINT_MAX + 1 (producer side).
+ */
+static inline unsigned block_ring_Tail(block_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+static inline size_t block_ring_GetCount(block_ring_t *ring)
+{
+    unsigned head = atomic_load(&ring->head);
+
+    return (unsigned)(atomic_load(&ring->tail) - head);
+}
+
+static inline size_t block_ring_GetBytes(block_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->bytes, memory_order_relaxed);
+}
+
+#endif
@@ -244,7 +244,8 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
         filter->owner.sub = NULL;
 
     assert( capability != NULL );
-    if( name != NULL && chain->b_allow_fmt_out_change )
+    if( name != NULL && chain->b_allow_fmt_out_change
+     && capability == chain->filter_cap )
     {
         /* Append the "chain" video filter to the current list.
          * This filter will be used if the requested filter fails to load.
@@ -307,6 +308,13 @@ int filter_chain_AppendConverter( filter_chain_t *chain,
                                      fmt_out ) != NULL ? 0 : -1;
 }
 
+filter_t *filter_chain_AppendConverterByName( filter_chain_t *chain,
+    const char *name, const es_format_t *fmt_out )
+{
+    return filter_chain_AppendInner( chain, name, chain->conv_cap, NULL,
+                                     fmt_out );
+}
+
 void filter_chain_DeleteFilter( filter_chain_t *chain, filter_t *filter )
 {
     chained_filter_t *chained = (chained_filter_t *)filter;
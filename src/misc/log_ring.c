@@ -0,0 +1,582 @@
+/*****************************************************************************
+ * log_ring.c: lock-free queue of deferred log messages
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_memstream.h>
+#include "log_ring.h"
+
+#define LOG_RECORD_DATA 448
+#define LOG_SPEC_MAX    32
+
+/* Record flags */
+#define LOG_HEADER 1 /* a header follows the module name */
+#define LOG_TEXT   2 /* the message is preformatted text, not format+args */
+
+struct vlc_log_record
+{
+    atomic_uint seq;
+    unsigned char flags;
+    int type;
+    vlc_log_t meta;
+    char *heap; /**< Preformatted record, or NULL if data is used */
+    unsigned char data[LOG_RECORD_DATA];
+};
+
+struct vlc_log_ring
+{
+    unsigned mask;
+    unsigned head; /**< Consumer position */
+    atomic_uint tail; /**< Producer position */
+    atomic_uint wakeups;
+    atomic_bool waiting;
+    struct vlc_log_record records[];
+};
+
+/*** Conversion specifications ***/
+
+enum log_arg
+{
+    LOG_ARG_NONE, /* %% */
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_INTMAX,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LDOUBLE,
+    LOG_ARG_PTR,
+    LOG_ARG_STR,
+};
+
+struct log_spec
+{
+    enum log_arg arg;
+    unsigned char stars; /* number of '*' width and precision arguments */
+    bool star_precision; /* whether the last star is the precision */
+    int precision; /* literal precision or -1 */
+    char str[LOG_SPEC_MAX]; /* the specification as a format string */
+};
+
+/**
+ * Parses one conversion specification.
+ *
+ * \param p pointer to the percent character
+ * \return pointer past the specification, or NULL if it is not supported
+ */
+static const char *log_spec_Parse(const char *p, struct log_spec *spec)
+{
+    const char *start = p++;
+    enum { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_J, LEN_Z, LEN_T,
+           LEN_BIG_L } len = LEN_NONE;
+
+    spec->stars = 0;
+    spec->star_precision = false;
+    spec->precision = -1;
+
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL)
+        p++;
+
+    if (*p == '*')
+    {
+        spec->stars++;
+        p++;
+    }
+    else
+        while (*p >= '0' && *p <= '9')
+            p++;
+
+    if (*p == '$')
+        return NULL; /* positional arguments */
+
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '*')
+        {
+            spec->stars++;
+            spec->star_precision = true;
+            p++;
+        }
+        else
+        {
+            spec->precision = 0;
+            while (*p >= '0' && *p <= '9')
+                spec->precision = spec->precision * 10 + (*(p++) - '0');
+        }
+    }
+
+    switch (*p)
+    {
+        case 'h':
+            len = (p[1] == 'h') ? LEN_HH : LEN_H;
+            p += 1 + (len == LEN_HH);
+            break;
+        case 'l':
+            len = (p[1] == 'l') ? LEN_LL : LEN_L;
+            p += 1 + (len == LEN_LL);
+            break;
+        case 'j': len = LEN_J; p++; break;
+        case 'z': len = LEN_Z; p++; break;
+        case 't': len = LEN_T; p++; break;
+        case 'L': len = LEN_BIG_L; p++; break;
+    }
+
+    switch (*p)
+    {
+        case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+            switch (len)
+            {
+                case LEN_NONE: case LEN_HH: case LEN_H:
+                    spec->arg = LOG_ARG_INT; break;
+                case LEN_L:  spec->arg = LOG_ARG_LONG; break;
+                case LEN_LL: spec->arg = LOG_ARG_LLONG; break;
+                case LEN_J:  spec->arg = LOG_ARG_INTMAX; break;
+                case LEN_Z:  spec->arg = LOG_ARG_SIZE; break;
+                case LEN_T:  spec->arg = LOG_ARG_PTRDIFF; break;
+                default:     return NULL;
+            }
+            break;
+        case 'c':
+            if (len != LEN_NONE)
+                return NULL; /* wint_t */
+            spec->arg = LOG_ARG_INT;
+            break;
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+            if (len == LEN_BIG_L)
+                spec->arg = LOG_ARG_LDOUBLE;
+            else if (len == LEN_NONE || len == LEN_L)
+                spec->arg = LOG_ARG_DOUBLE;
+            else
+                return NULL;
+            break;
+        case 's':
+            if (len != LEN_NONE)
+                return NULL; /* wide string */
+            spec->arg = LOG_ARG_STR;
+            break;
+        case 'p':
+            spec->arg = LOG_ARG_PTR;
+            break;
+        case '%':
+            if (p != start + 1)
+                return NULL;
+            spec->arg = LOG_ARG_NONE;
+            break;
+        default: /* %n, %m and extensions */
+            return NULL;
+    }
+
+    p++;
+    if ((size_t)(p - start) >= sizeof (spec->str))
+        return NULL;
+    memcpy(spec->str, start, p - start);
+    spec->str[p - start] = '\0';
+    return p;
+}
+
+/*** Producer side ***/
+
+struct log_writer
+{
+    unsigned char *buf;
+    size_t len;
+};
+
+static bool log_Write(struct log_writer *w, const void *data, size_t len)
+{
+    if (len > LOG_RECORD_DATA - w->len)
+        return false;
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+    return true;
+}
+
+#define log_WriteArg(w, type, ap) \
+    do { \
+        type val_ = va_arg(ap, type); \
+        if (!log_Write(w, &val_, sizeof (val_))) \
+            return false; \
+    } while (0)
+
+static bool log_WriteString(struct log_writer *w, const char *str)
+{
+    return log_Write(w, str, strlen(str) + 1);
+}
+
+/**
+ * Stores the format string and the values of its arguments.
+ */
+static bool log_Encode(struct log_writer *w, const char *format, va_list ap)
+{
+    if (!log_WriteString(w, format))
+        return false;
+
+    for (const char *p = strchr(format, '%'); p != NULL; p = strchr(p, '%'))
+    {
+        struct log_spec spec;
+        int stars[2];
+
+        p = log_spec_Parse(p, &spec);
+        if (p == NULL)
+            return false;
+
+        for (unsigned i = 0; i < spec.stars; i++)
+        {
+            stars[i] = va_arg(ap, int);
+            if (!log_Write(w, &stars[i], sizeof (stars[i])))
+                return false;
+        }
+
+        switch (spec.arg)
+        {
+            case LOG_ARG_NONE:                                        break;
+            case LOG_ARG_INT:     log_WriteArg(w, int, ap);           break;
+            case LOG_ARG_LONG:    log_WriteArg(w, long, ap);          break;
+            case LOG_ARG_LLONG:   log_WriteArg(w, long long, ap);     break;
+            case LOG_ARG_INTMAX:  log_WriteArg(w, intmax_t, ap);      break;
+            case LOG_ARG_SIZE:    log_WriteArg(w, size_t, ap);        break;
+            case LOG_ARG_PTRDIFF: log_WriteArg(w, ptrdiff_t, ap);     break;
+            case LOG_ARG_DOUBLE:  log_WriteArg(w, double, ap);        break;
+            case LOG_ARG_LDOUBLE: log_WriteArg(w, long double, ap);   break;
+            case LOG_ARG_PTR:     log_WriteArg(w, void *, ap);        break;
+            case LOG_ARG_STR:
+            {
+                /* The string may be gone by the time it gets formatted */
+                const char *str = va_arg(ap, const char *);
+                int precision = spec.star_precision ? stars[spec.stars - 1]
+                                                    : spec.precision;
+                unsigned char null = str == NULL;
+
+                if (!log_Write(w, &null, 1))
+                    return false;
+                if (null)
+                    break;
+
+                size_t len = (precision >= 0) ? strnlen(str, precision)
+                                              : strlen(str);
+                if (!log_Write(w, str, len) || !log_Write(w, "", 1))
+                    return false;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Formats the message in the calling thread, for what cannot be deferred.
+ */
+static char *log_Format(const vlc_log_t *meta, const char *format, va_list ap)
+{
+    struct vlc_memstream ms;
+
+    vlc_memstream_open(&ms);
+    vlc_memstream_write(&ms, meta->psz_module, strlen(meta->psz_module) + 1);
+    if (meta->psz_header != NULL)
+        vlc_memstream_write(&ms, meta->psz_header,
+                            strlen(meta->psz_header) + 1);
+    vlc_memstream_vprintf(&ms, format, ap);
+    return (vlc_memstream_close(&ms) == 0) ? ms.ptr : NULL;
+}
+
+bool vlc_log_ring_Push(vlc_log_ring_t *ring, int type, const vlc_log_t *meta,
+                       const char *format, va_list ap)
+{
+    struct vlc_log_record *rec;
+    unsigned pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    /* Claim a slot */
+    for (;;)
+    {
+        rec = &ring->records[pos & ring->mask];
+
+        unsigned seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+        int diff = (int)(seq - pos);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return false; /* full */
+        else
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    }
+
+    rec->type = type;
+    rec->meta = *meta;
+    rec->flags = (meta->psz_header != NULL) ? LOG_HEADER : 0;
+    rec->heap = NULL;
+
+    struct log_writer w = { rec->data, 0 };
+    va_list aq;
+    bool ok;
+
+    va_copy(aq, ap);
+    ok = log_WriteString(&w, meta->psz_module)
+      && (meta->psz_header == NULL || log_WriteString(&w, meta->psz_header))
+      && log_Encode(&w, format, aq);
+    va_end(aq);
+
+    if (!ok)
+    {   /* Too large or not supported: format it now */
+        rec->flags |= LOG_TEXT;
+        rec->heap = log_Format(meta, format, ap);
+    }
+
+    /* Sequentially consistent, so that either the consumer sees the record
+     * before it goes to sleep, or this thread sees the waiting consumer. */
+    atomic_store(&rec->seq, pos + 1);
+
+    if (atomic_load(&ring->waiting) && atomic_exchange(&ring->waiting, false))
+        vlc_log_ring_Wake(ring);
+    return true;
+}
+
+/*** Consumer side ***/
+
+struct log_reader
+{
+    const unsigned char *buf;
+    size_t offset;
+};
+
+static const char *log_ReadString(struct log_reader *r)
+{
+    const char *str = (const char *)r->buf + r->offset;
+
+    r->offset += strlen(str) + 1;
+    return str;
+}
+
+static int log_ReadInt(struct log_reader *r)
+{
+    int val;
+
+    memcpy(&val, r->buf + r->offset, sizeof (val));
+    r->offset += sizeof (val);
+    return val;
+}
+
+#define log_Print(ms, spec, stars, val) \
+    do { \
+        switch ((spec)->stars) \
+        { \
+            case 0: \
+                vlc_memstream_printf(ms, (spec)->str, val); \
+                break; \
+            case 1: \
+                vlc_memstream_printf(ms, (spec)->str, stars[0], val); \
+                break; \
+            default: \
+                vlc_memstream_printf(ms, (spec)->str, stars[0], stars[1], \
+                                     val); \
+        } \
+    } while (0)
+
+#define log_PrintArg(ms, spec, stars, r, type) \
+    do { \
+        type val_; \
+        memcpy(&val_, (r)->buf + (r)->offset, sizeof (val_)); \
+        (r)->offset += sizeof (val_); \
+        log_Print(ms, spec, stars, val_); \
+    } while (0)
+
+static void log_Decode(struct vlc_memstream *ms, struct log_reader *r)
+{
+    const char *format = log_ReadString(r);
+    const char *p;
+
+    while ((p = strchr(format, '%')) != NULL)
+    {
+        struct log_spec spec;
+        int stars[2] = { 0, 0 };
+
+        vlc_memstream_write(ms, format, p - format);
+        format = log_spec_Parse(p, &spec);
+        assert(format != NULL); /* checked by log_Encode() */
+
+        for (unsigned i = 0; i < spec.stars; i++)
+            stars[i] = log_ReadInt(r);
+
+        switch (spec.arg)
+        {
+            case LOG_ARG_NONE:
+                vlc_memstream_putc(ms, '%');
+                break;
+            case LOG_ARG_INT:
+                log_PrintArg(ms, &spec, stars, r, int);
+                break;
+            case LOG_ARG_LONG:
+                log_PrintArg(ms, &spec, stars, r, long);
+                break;
+            case LOG_ARG_LLONG:
+                log_PrintArg(ms, &spec, stars, r, long long);
+                break;
+            case LOG_ARG_INTMAX:
+                log_PrintArg(ms, &spec, stars, r, intmax_t);
+                break;
+            case LOG_ARG_SIZE:
+                log_PrintArg(ms, &spec, stars, r, size_t);
+                break;
+            case LOG_ARG_PTRDIFF:
+                log_PrintArg(ms, &spec, stars, r, ptrdiff_t);
+                break;
+            case LOG_ARG_DOUBLE:
+                log_PrintArg(ms, &spec, stars, r, double);
+                break;
+            case LOG_ARG_LDOUBLE:
+                log_PrintArg(ms, &spec, stars, r, long double);
+                break;
+            case LOG_ARG_PTR:
+                log_PrintArg(ms, &spec, stars, r, void *);
+                break;
+            case LOG_ARG_STR:
+            {
+                const char *str = "(null)";
+
+                if (!r->buf[r->offset++])
+                    str = log_ReadString(r);
+                log_Print(ms, &spec, stars, str);
+                break;
+            }
+        }
+    }
+    vlc_memstream_puts(ms, format);
+}
+
+bool vlc_log_ring_Pop(vlc_log_ring_t *ring, vlc_log_ring_cb cb, void *opaque)
+{
+    unsigned pos = ring->head;
+    struct vlc_log_record *rec = &ring->records[pos & ring->mask];
+
+    /* See vlc_log_ring_Push() */
+    if (atomic_load(&rec->seq) != pos + 1)
+        return false; /* empty, or the oldest record is not complete yet */
+
+    if (rec->flags & LOG_TEXT)
+    {
+        if (rec->heap != NULL)
+        {
+            struct log_reader r = { (unsigned char *)rec->heap, 0 };
+
+            rec->meta.psz_module = log_ReadString(&r);
+            rec->meta.psz_header = (rec->flags & LOG_HEADER)
+                                   ? log_ReadString(&r) : NULL;
+            cb(opaque, rec->type, &rec->meta, log_ReadString(&r));
+            free(rec->heap);
+        }
+    }
+    else
+    {
+        struct log_reader r = { rec->data, 0 };
+        struct vlc_memstream ms;
+
+        rec->meta.psz_module = log_ReadString(&r);
+        rec->meta.psz_header = (rec->flags & LOG_HEADER)
+                               ? log_ReadString(&r) : NULL;
+
+        vlc_memstream_open(&ms);
+        log_Decode(&ms, &r);
+        if (vlc_memstream_close(&ms) == 0)
+        {
+            cb(opaque, rec->type, &rec->meta, ms.ptr);
+            free(ms.ptr);
+        }
+    }
+
+    atomic_store_explicit(&rec->seq, pos + ring->mask + 1,
+                          memory_order_release);
+    ring->head = pos + 1;
+    return true;
+}
+
+static bool vlc_log_ring_IsEmpty(vlc_log_ring_t *ring)
+{
+    unsigned pos = ring->head;
+
+    return atomic_load(&ring->records[pos & ring->mask].seq) != pos + 1;
+}
+
+void vlc_log_ring_Wait(vlc_log_ring_t *ring)
+{
+    unsigned val = atomic_load(&ring->wakeups);
+
+    atomic_store(&ring->waiting, true);
+    if (vlc_log_ring_IsEmpty(ring))
+        vlc_atomic_wait(&ring->wakeups, val);
+    atomic_store(&ring->waiting, false);
+}
+
+void vlc_log_ring_Wake(vlc_log_ring_t *ring)
+{
+    atomic_fetch_add(&ring->wakeups, 1);
+    vlc_atomic_notify_one(&ring->wakeups);
+}
+
+vlc_log_ring_t *vlc_log_ring_New(unsigned size)
+{
+    assert(size > 0 && (size & (size - 1)) == 0);
+
+    vlc_log_ring_t *ring = malloc(sizeof (*ring)
+                                  + size * sizeof (ring->records[0]));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    ring->mask = size - 1;
+    ring->head = 0;
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->wakeups, 0);
+    atomic_init(&ring->waiting, false);
+
+    for (unsigned i = 0; i < size; i++)
+        atomic_init(&ring->records[i].seq, i);
+    return ring;
+}
+
+static void log_Discard(void *opaque, int type, const vlc_log_t *meta,
+                        const char *msg)
+{
+    (void) opaque; (void) type; (void) meta; (void) msg;
+}
+
+void vlc_log_ring_Delete(vlc_log_ring_t *ring)
+{
+    while (vlc_log_ring_Pop(ring, log_Discard, NULL));
+    free(ring);
+}
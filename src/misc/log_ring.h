@@ -0,0 +1,77 @@
+/*****************************************************************************
+ * log_ring.h: lock-free queue of deferred log messages
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_LOG_RING_H
+# define LIBVLC_LOG_RING_H 1
+
+#include <stdarg.h>
+
+/**
+ * Bounded queue of binary log records.
+ *
+ * Any number of threads may queue messages concurrently without locking.
+ * A record holds a copy of the format string and the raw values of the
+ * arguments; the printf-style formatting is deferred to the single thread
+ * dequeuing the records.
+ */
+typedef struct vlc_log_ring vlc_log_ring_t;
+
+typedef void (*vlc_log_ring_cb)(void *opaque, int type, const vlc_log_t *,
+                                const char *msg);
+
+/**
+ * Creates a ring.
+ *
+ * \param size maximum number of records (must be a power of two)
+ */
+VLC_API vlc_log_ring_t *vlc_log_ring_New(unsigned size);
+
+/**
+ * Destroys a ring, discarding any queued record.
+ */
+VLC_API void vlc_log_ring_Delete(vlc_log_ring_t *);
+
+/**
+ * Queues a message (any thread).
+ *
+ * \return false if the ring is full, true otherwise
+ */
+VLC_API bool vlc_log_ring_Push(vlc_log_ring_t *, int type, const vlc_log_t *,
+                               const char *format, va_list ap);
+
+/**
+ * Dequeues, formats and passes a message to a callback (consumer side).
+ *
+ * \return false if the ring was empty, true otherwise
+ */
+VLC_API bool vlc_log_ring_Pop(vlc_log_ring_t *, vlc_log_ring_cb cb, void *opaque);
+
+/**
+ * Waits until the ring is non-empty or vlc_log_ring_Wake() is called
+ * (consumer side). Spurious wake-ups are possible.
+ */
+VLC_API void vlc_log_ring_Wait(vlc_log_ring_t *);
+
+/**
+ * Wakes the consumer up if it waits.
+ */
+VLC_API void vlc_log_ring_Wake(vlc_log_ring_t *);
+
+#endif
@@ -41,6 +41,7 @@
 #include <vlc_charset.h>
 #include <vlc_modules.h>
 #include "../libvlc.h"
+#include "log_ring.h"
 
 static void vlc_LogSpam(vlc_object_t *obj)
 {
@@ -439,6 +440,143 @@ static struct vlc_logger *vlc_LogModuleCreate(vlc_object_t *parent)
     return &module->frontend;
 }
 
+/**
+ * Asynchronous message log.
+ *
+ * A message log that queues messages without formatting them, and passes them
+ * to another log from a background thread. Debug messages are dropped if the
+ * queue is full, other messages are then passed synchronously.
+ */
+#define LOG_RING_SIZE 512
+
+struct vlc_logger_async {
+    struct vlc_logger frontend;
+    struct vlc_logger *sink;
+    vlc_log_ring_t *ring;
+    vlc_thread_t thread;
+    atomic_bool stop;
+    atomic_uint dropped;
+    vlc_tick_t last_report;
+};
+
+static void vlc_vaLogAsync(void *d, int type, const vlc_log_t *item,
+                           const char *format, va_list ap)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, frontend);
+
+    if (likely(vlc_log_ring_Push(async->ring, type, item, format, ap)))
+        return;
+
+    if (type == VLC_MSG_DBG)
+        atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+    else
+        async->sink->ops->log(async->sink, type, item, format, ap);
+}
+
+static void vlc_LogAsyncOutput(void *opaque, int type, const vlc_log_t *item,
+                               const char *msg)
+{
+    struct vlc_logger_async *async = opaque;
+
+    vlc_LogCallback(async->sink, type, item, "%s", msg);
+}
+
+static void vlc_LogAsyncReport(struct vlc_logger_async *async, bool force)
+{
+    vlc_tick_t now = vlc_tick_now();
+
+    /* Report overflows at most once per second */
+    if (!force && now - async->last_report < VLC_TICK_FROM_SEC(1))
+        return;
+
+    unsigned dropped = atomic_exchange_explicit(&async->dropped, 0,
+                                                memory_order_relaxed);
+    if (dropped == 0)
+        return;
+
+    vlc_log_t msg = {
+        .i_object_id = (uintptr_t)(void *)async,
+        .psz_object_type = "logger",
+        .psz_module = "core",
+        .line = -1,
+        .tid = vlc_thread_id(),
+    };
+
+    vlc_LogCallback(async->sink, VLC_MSG_WARN, &msg,
+                    "%u debug message(s) dropped (log queue overflow)",
+                    dropped);
+    async->last_report = now;
+}
+
+static void *vlc_LogAsyncThread(void *data)
+{
+    struct vlc_logger_async *async = data;
+
+    for (;;)
+    {
+        bool stop = atomic_load(&async->stop);
+
+        while (vlc_log_ring_Pop(async->ring, vlc_LogAsyncOutput, async));
+        vlc_LogAsyncReport(async, stop);
+
+        if (stop)
+            break;
+        vlc_log_ring_Wait(async->ring);
+    }
+    return NULL;
+}
+
+static void vlc_LogAsyncClose(void *d)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, frontend);
+    struct vlc_logger *sink = async->sink;
+
+    atomic_store(&async->stop, true);
+    vlc_log_ring_Wake(async->ring);
+    vlc_join(async->thread, NULL);
+
+    vlc_log_ring_Delete(async->ring);
+    free(async);
+    sink->ops->destroy(sink);
+}
+
+static const struct vlc_logger_operations async_ops = {
+    vlc_vaLogAsync,
+    vlc_LogAsyncClose,
+};
+
+static struct vlc_logger *vlc_LogAsyncCreate(struct vlc_logger *sink)
+{
+    struct vlc_logger_async *async = malloc(sizeof (*async));
+    if (unlikely(async == NULL))
+        return NULL;
+
+    async->ring = vlc_log_ring_New(LOG_RING_SIZE);
+    if (unlikely(async->ring == NULL))
+        goto error;
+
+    async->frontend.ops = &async_ops;
+    async->sink = sink;
+    atomic_init(&async->stop, false);
+    atomic_init(&async->dropped, 0);
+    async->last_report = VLC_TICK_0;
+
+    if (vlc_clone(&async->thread, vlc_LogAsyncThread, async,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_log_ring_Delete(async->ring);
+        goto error;
+    }
+    return &async->frontend;
+error:
+    free(async);
+    return NULL;
+}
+
 /**
  * Initializes the messages logging subsystem and drain the early messages to
  * the configured log.
@@ -448,6 +586,11 @@ void vlc_LogInit(libvlc_int_t *vlc)
     struct vlc_logger *logger = vlc_LogModuleCreate(VLC_OBJECT(vlc));
     if (logger == NULL)
         logger = &discard_log;
+    else if (var_InheritBool(vlc, "log-async")) {
+        struct vlc_logger *async = vlc_LogAsyncCreate(logger);
+        if (async != NULL)
+            logger = async;
+    }
 
     vlc_LogSwitch(vlc->obj.logger, logger);
 }
@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * tracer.c: pipeline tracing interface
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_tracer.h>
+#include "../libvlc.h"
+
+struct vlc_tracer {
+    struct vlc_object_t obj;
+    const struct vlc_tracer_operations *ops;
+    void *opaque;
+};
+
+void vlc_tracer_Trace(struct vlc_tracer *tracer,
+                      const struct vlc_tracer_event *ev)
+{
+    assert(tracer != NULL);
+    tracer->ops->trace(tracer->opaque, ev);
+}
+
+#undef vlc_object_get_tracer
+struct vlc_tracer *vlc_object_get_tracer(vlc_object_t *obj)
+{
+    return libvlc_priv(vlc_object_instance(obj))->tracer;
+}
+
+static int vlc_tracer_load(void *func, bool forced, va_list ap)
+{
+    const struct vlc_tracer_operations *(*activate)(vlc_object_t *,
+                                                    void **) = func;
+    struct vlc_tracer *tracer = va_arg(ap, struct vlc_tracer *);
+
+    (void) forced;
+    tracer->ops = activate(VLC_OBJECT(tracer), &tracer->opaque);
+    return (tracer->ops != NULL) ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+/**
+ * Creates the tracer selected by the configuration, if any.
+ */
+struct vlc_tracer *vlc_TracerCreate(vlc_object_t *parent)
+{
+    char *name = var_InheritString(parent, "tracer");
+    if (name == NULL || *name == '\0')
+    {
+        free(name);
+        return NULL; /* tracing disabled */
+    }
+
+    struct vlc_tracer *tracer = vlc_custom_create(parent, sizeof (*tracer),
+                                                  "tracer");
+    if (likely(tracer != NULL)
+     && vlc_module_load(VLC_OBJECT(tracer), "tracer", name, true,
+                        vlc_tracer_load, tracer) == NULL)
+    {
+        vlc_object_delete(VLC_OBJECT(tracer));
+        tracer = NULL;
+    }
+    free(name);
+    return tracer;
+}
+
+void vlc_TracerDestroy(struct vlc_tracer *tracer)
+{
+    if (tracer->ops->destroy != NULL)
+        tracer->ops->destroy(tracer->opaque);
+
+    vlc_object_delete(VLC_OBJECT(tracer));
+}
@@ -56,7 +56,7 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 36
+#define CACHE_SUBVERSION_NUM 37
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
@@ -303,6 +303,26 @@ static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
             LOAD_STRING(module->pp_shortcuts[j]);
     }
 
+    LOAD_IMMEDIATE(module->i_signatures);
+    if (module->i_signatures > MODULE_SIGNATURE_MAX)
+        goto error;
+    else if (module->i_signatures > 0)
+    {
+        module->p_signatures =
+            xmalloc (sizeof (*module->p_signatures) * module->i_signatures);
+        for (unsigned j = 0; j < module->i_signatures; j++)
+        {
+            struct vlc_module_signature *sig = &module->p_signatures[j];
+
+            LOAD_IMMEDIATE(sig->offset);
+            LOAD_IMMEDIATE(sig->length);
+            if (sig->length == 0
+             || sig->offset + sig->length > MODULE_SIGNATURE_PEEK)
+                goto error;
+            LOAD_ARRAY(sig->bytes, sig->length);
+        }
+    }
+
     LOAD_STRING(module->activate_name);
     LOAD_STRING(module->deactivate_name);
     LOAD_STRING(module->psz_capability);
@@ -574,6 +594,17 @@ static int CacheSaveModule(FILE *file, const module_t *module)
     for (size_t j = 0; j < module->i_shortcuts; j++)
          SAVE_STRING(module->pp_shortcuts[j]);
 
+    SAVE_IMMEDIATE(module->i_signatures);
+    for (size_t j = 0; j < module->i_signatures; j++)
+    {
+        const struct vlc_module_signature *sig = &module->p_signatures[j];
+
+        SAVE_IMMEDIATE(sig->offset);
+        SAVE_IMMEDIATE(sig->length);
+        if (fwrite(sig->bytes, 1, sig->length, file) != sig->length)
+            goto error;
+    }
+
     SAVE_STRING(module->activate_name);
     SAVE_STRING(module->deactivate_name);
     SAVE_STRING(module->psz_capability);
@@ -67,6 +67,8 @@ module_t *vlc_module_create(vlc_plugin_t *plugin)
     module->psz_help = NULL;
     module->pp_shortcuts = NULL;
     module->i_shortcuts = 0;
+    module->p_signatures = NULL;
+    module->i_signatures = 0;
     module->psz_capability = NULL;
     module->i_score = (parent != NULL) ? parent->i_score : 1;
     module->activate_name = NULL;
@@ -86,6 +88,7 @@ void vlc_module_destroy (module_t *module)
         module_t *next = module->next;
 
         free(module->pp_shortcuts);
+        free(module->p_signatures);
         free(module);
         module = next;
     }
@@ -259,6 +262,32 @@ static int vlc_plugin_desc_cb(void *ctx, void *tgt, int propid, ...)
             break;
         }
 
+        case VLC_MODULE_SIGNATURE:
+        {
+            unsigned offset = va_arg (ap, unsigned);
+            unsigned length = va_arg (ap, unsigned);
+            const char *bytes = va_arg (ap, const char *);
+            unsigned index = module->i_signatures;
+            /* Only that many bytes are peeked when probing */
+            assert(length > 0 && offset + length <= MODULE_SIGNATURE_PEEK);
+            /* The cache loader accept only a small number of signatures */
+            assert(index < MODULE_SIGNATURE_MAX);
+
+            struct vlc_module_signature *tab =
+                realloc (module->p_signatures, sizeof (*tab) * (index + 1));
+            if (unlikely(tab == NULL))
+            {
+                ret = -1;
+                break;
+            }
+            module->p_signatures = tab;
+            module->i_signatures = index + 1;
+            tab[index].offset = offset;
+            tab[index].length = length;
+            tab[index].bytes = (const uint8_t *)bytes;
+            break;
+        }
+
         case VLC_MODULE_CAPABILITY:
             module->psz_capability = va_arg (ap, const char *);
             break;
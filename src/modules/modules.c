@@ -127,28 +127,33 @@ static int module_load(vlc_logger_t *log, module_t *m,
 }
 
 /**
- * Finds and instantiates the best module of a certain type.
- * All candidates modules having the specified capability and name will be
- * sorted in decreasing order of priority. Then the probe callback will be
- * invoked for each module, until it succeeds (returns 0), or all candidate
- * module failed to initialize.
- *
- * The probe callback first parameter is the address of the module entry point.
- * Further parameters are passed as an argument list; it corresponds to the
- * variable arguments passed to this function. This scheme is meant to
- * support arbitrary prototypes for the module entry point.
+ * Checks whether some leading data may be handled by a module.
  *
- * \param log logger (or NULL to ignore)
- * \param capability capability, i.e. class of module
- * \param name name of the module asked, if any
- * \param strict if true, do not fallback to plugin with a different name
- *                 but the same capability
- * \param probe module probe callback
- * \return the module or NULL in case of a failure
+ * Modules without signatures may handle anything. Signatures extending
+ * beyond the available data cannot be ruled out either.
  */
-module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
-                            const char *name, bool strict,
-                            vlc_activate_t probe, ...)
+static bool module_match_signature(const module_t *m, const uint8_t *peek,
+                                   size_t size)
+{
+    if (peek == NULL || m->i_signatures == 0)
+        return true;
+
+    for (unsigned i = 0; i < m->i_signatures; i++)
+    {
+        const struct vlc_module_signature *sig = &m->p_signatures[i];
+
+        if ((size_t)sig->offset + sig->length > size
+         || memcmp(peek + sig->offset, sig->bytes, sig->length) == 0)
+            return true;
+    }
+    return false;
+}
+
+static module_t *vlc_module_vaload(struct vlc_logger *log,
+                                   const char *capability, const char *name,
+                                   bool strict, const uint8_t *peek,
+                                   size_t peek_size, vlc_activate_t probe,
+                                   va_list args)
 {
     if (name == NULL || name[0] == '\0')
         name = "any";
@@ -167,9 +172,9 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
     }
 
     module_t *module = NULL;
-    va_list args;
+    /* modules not probed as they will not recognize the data anyway */
+    unsigned skipped = 0;
 
-    va_start(args, probe);
     while (*name)
     {
         const char *shortcut = name;
@@ -190,6 +195,11 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
             if (!module_match_name(cand, shortcut, slen))
                 continue;
             mods[i] = NULL; // only try each module once at most...
+            if (!force && !module_match_signature(cand, peek, peek_size))
+            {
+                skipped++;
+                continue;
+            }
 
             int ret = module_load(log, cand, probe, force, args);
             switch (ret)
@@ -211,6 +221,11 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
             module_t *cand = mods[i];
             if (cand == NULL || module_get_score (cand) <= 0)
                 continue;
+            if (!module_match_signature(cand, peek, peek_size))
+            {
+                skipped++;
+                continue;
+            }
 
             int ret = module_load(log, cand, probe, false, args);
             switch (ret)
@@ -224,9 +239,11 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
         }
     }
 done:
-    va_end (args);
     module_list_free (mods);
 
+    if (skipped > 0)
+        vlc_debug(log, "skipped %u %s modules not matching the signature",
+                  skipped, capability);
     if (module != NULL)
         vlc_debug(log, "using %s module \"%s\"", capability,
                   module_get_object (module));
@@ -235,6 +252,53 @@ done:
     return module;
 }
 
+/**
+ * Finds and instantiates the best module of a certain type.
+ * All candidates modules having the specified capability and name will be
+ * sorted in decreasing order of priority. Then the probe callback will be
+ * invoked for each module, until it succeeds (returns 0), or all candidate
+ * module failed to initialize.
+ *
+ * The probe callback first parameter is the address of the module entry point.
+ * Further parameters are passed as an argument list; it corresponds to the
+ * variable arguments passed to this function. This scheme is meant to
+ * support arbitrary prototypes for the module entry point.
+ *
+ * \param log logger (or NULL to ignore)
+ * \param capability capability, i.e. class of module
+ * \param name name of the module asked, if any
+ * \param strict if true, do not fallback to plugin with a different name
+ *                 but the same capability
+ * \param probe module probe callback
+ * \return the module or NULL in case of a failure
+ */
+module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
+                            const char *name, bool strict,
+                            vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_vaload(log, capability, name, strict,
+                                         NULL, 0, probe, args);
+    va_end(args);
+    return module;
+}
+
+module_t *vlc_module_load_peek(struct vlc_logger *log, const char *capability,
+                               const char *name, bool strict,
+                               const uint8_t *peek, size_t peek_size,
+                               vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_vaload(log, capability, name, strict,
+                                         peek, peek_size, probe, args);
+    va_end(args);
+    return module;
+}
+
 static int generic_start(void *func, bool forced, va_list ap)
 {
     vlc_object_t *obj = va_arg(ap, vlc_object_t *);
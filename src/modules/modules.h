@@ -24,6 +24,7 @@
 # define LIBVLC_MODULES_H 1
 
 # include <stdatomic.h>
+# include <vlc_modules.h>
 
 /** VLC plugin */
 typedef struct vlc_plugin_t
@@ -63,6 +64,21 @@ extern struct vlc_plugin_t *vlc_plugins;
 
 #define MODULE_SHORTCUT_MAX 20
 
+/** Maximum number of signatures per module */
+#define MODULE_SIGNATURE_MAX 8
+/** Number of leading bytes that the signatures can cover */
+#define MODULE_SIGNATURE_PEEK 64
+
+/**
+ * Leading bytes of the data handled by a module
+ */
+struct vlc_module_signature
+{
+    uint16_t offset;
+    uint16_t length;
+    const uint8_t *bytes;
+};
+
 /** Plugin entry point prototype */
 typedef int (*vlc_plugin_cb) (int (*)(void *, void *, int, ...), void *);
 
@@ -81,6 +97,10 @@ struct module_t
     unsigned    i_shortcuts;
     const char **pp_shortcuts;
 
+    /** Signatures of the handled data (if any) */
+    unsigned    i_signatures;
+    struct vlc_module_signature *p_signatures;
+
     /*
      * Variables set by the module to identify itself
      */
@@ -115,6 +135,21 @@ void *module_Symbol(struct vlc_logger *, vlc_plugin_t *, const char *name);
 
 ssize_t module_list_cap (module_t ***, const char *);
 
+/**
+ * Finds and instantiates the best module matching some leading data.
+ *
+ * This works as vlc_module_load(), except that the candidate modules
+ * declaring signatures that do not match the data are skipped, unless they
+ * are requested explicitly.
+ *
+ * \param peek the first bytes of the data (or NULL to probe every module)
+ * \param peek_size number of bytes in peek
+ */
+module_t *vlc_module_load_peek(struct vlc_logger *log, const char *cap,
+                               const char *name, bool strict,
+                               const uint8_t *peek, size_t peek_size,
+                               vlc_activate_t probe, ...) VLC_USED;
+
 int vlc_bindtextdomain (const char *);
 
 /* Low-level OS-dependent handler */
@@ -26,6 +26,7 @@
 #include <vlc_interface.h>
 #include <vlc_memstream.h>
 #include "player.h"
+#include "input/resource.h"
 
 struct vlc_player_track_priv *
 vlc_player_input_FindTrackById(struct vlc_player_input *input, vlc_es_id_t *id,
@@ -90,9 +91,114 @@ vlc_player_input_UpdateTime(struct vlc_player_input *input)
                                         vlc_player_input_GetPos(input));
 }
 
+static void
+vlc_player_input_SelectPlayerTracks(struct vlc_player_input *input)
+{
+    vlc_player_t *player = input->player;
+
+    if (player->video_string_ids)
+        vlc_player_input_SelectTracksByStringIds(input, VIDEO_ES,
+                                                 player->video_string_ids);
+
+    if (player->audio_string_ids)
+        vlc_player_input_SelectTracksByStringIds(input, AUDIO_ES,
+                                                 player->audio_string_ids);
+
+    if (player->sub_string_ids)
+        vlc_player_input_SelectTracksByStringIds(input, SPU_ES,
+                                                 player->sub_string_ids);
+}
+
+static int
+vlc_player_input_Resume(struct vlc_player_input *input)
+{
+    vlc_player_t *player = input->player;
+    assert(input == player->input && input->started);
+
+    input->prepared = false;
+    var_SetBool(input->thread, "prepared", false);
+    /* The previous input left the resource when it was stopped */
+    input_resource_SetInput(player->resource, input->thread);
+
+    /* Notify what was gathered while it was prepared */
+    vlc_player_SendEvent(player, on_capabilities_changed, 0,
+                         input->capabilities);
+
+    struct vlc_player_program *prgm;
+    vlc_vector_foreach(prgm, &input->program_vector)
+    {
+        vlc_player_SendEvent(player, on_program_list_changed,
+                             VLC_PLAYER_LIST_ADDED, prgm);
+        if (prgm->selected)
+            vlc_player_SendEvent(player, on_program_selection_changed,
+                                 -1, prgm->group_id);
+    }
+
+    vlc_player_track_vector *vecs[] = {
+        &input->video_track_vector,
+        &input->audio_track_vector,
+        &input->spu_track_vector,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(vecs); ++i)
+    {
+        struct vlc_player_track_priv *trackpriv;
+        vlc_vector_foreach(trackpriv, vecs[i])
+        {
+            vlc_player_SendEvent(player, on_track_list_changed,
+                                 VLC_PLAYER_LIST_ADDED, &trackpriv->t);
+            if (trackpriv->t.selected)
+                vlc_player_SendEvent(player, on_track_selection_changed,
+                                     NULL, trackpriv->t.es_id);
+        }
+    }
+    if (input->teletext_menu)
+        vlc_player_SendEvent(player, on_teletext_menu_changed, true);
+
+    if (input->titles)
+    {
+        const struct vlc_player_title *title =
+            &input->titles->array[input->title_selected];
+        vlc_player_SendEvent(player, on_titles_changed, input->titles);
+        vlc_player_SendEvent(player, on_title_selection_changed, title,
+                             input->title_selected);
+        if (input->chapter_selected < title->chapter_count)
+            vlc_player_SendEvent(player, on_chapter_selection_changed, title,
+                                 input->title_selected,
+                                 &title->chapters[input->chapter_selected],
+                                 input->chapter_selected);
+    }
+
+    vlc_player_input_RestoreMlStates(input, false);
+    if (input->ml.delay_restore)
+    {
+        vlc_player_SendEvent(player, on_playback_restore_queried);
+        input->ml.delay_restore = false;
+    }
+
+    /* The video output was still used by the previous input: video tracks
+     * are only selected now */
+    if (var_GetBool(player, "video"))
+    {
+        var_SetBool(input->thread, "video", true);
+        if (!player->video_string_ids && input->video_track_vector.size > 0)
+            input_ControlPushEsHelper(input->thread, INPUT_CONTROL_SET_ES,
+                                      input->video_track_vector.data[0]->t.es_id);
+    }
+
+    /* The track preferences set for this media, for all categories */
+    vlc_player_input_SelectPlayerTracks(input);
+
+    vlc_value_t val = { .i_int = PLAYING_S };
+    return input_ControlPushHelper(input->thread, INPUT_CONTROL_SET_STATE,
+                                   &val);
+}
+
 int
 vlc_player_input_Start(struct vlc_player_input *input)
 {
+    if (input->prepared)
+        return vlc_player_input_Resume(input);
+
     int ret = input_Start(input->thread);
     if (ret != VLC_SUCCESS)
         return ret;
@@ -129,6 +235,37 @@ vlc_player_input_HandleState(struct vlc_player_input *input,
 {
     vlc_player_t *player = input->player;
 
+    if (input->prepared)
+    {
+        /* Not the current input yet: the player state is not affected */
+        input->state = state;
+        switch (state)
+        {
+            case VLC_PLAYER_STATE_STOPPING:
+                input->started = false;
+                if (player->next_input == input)
+                    player->next_input = NULL;
+                break;
+            case VLC_PLAYER_STATE_STOPPED:
+                if (input->titles)
+                {
+                    vlc_player_title_list_Release(input->titles);
+                    input->titles = NULL;
+                }
+                break;
+            default:
+                break;
+        }
+
+        /* A media set while this input was being discarded waits for the
+         * last stopped input: handle it as a regular one in that case */
+        if (state != VLC_PLAYER_STATE_STOPPED || player->input != NULL
+         || !vlc_player_destructor_IsLastInput(player, input))
+            return;
+        input->prepared = false;
+        input->error = VLC_PLAYER_ERROR_NONE;
+    }
+
     /* The STOPPING state can be set earlier by the player. In that case,
      * ignore all future events except the STOPPED one */
     if (input->state == VLC_PLAYER_STATE_STOPPING
@@ -615,6 +752,50 @@ vlc_player_input_HandleVoutEvent(struct vlc_player_input *input,
     }
 }
 
+static void
+vlc_player_input_HandlePreparedEvent(struct vlc_player_input *input,
+                                     const struct vlc_input_event *event)
+{
+    vlc_player_t *player = input->player;
+
+    /* Keep the lists up to date, but the listeners still refer to the current
+     * media: they are notified when this input is resumed */
+    player->events_muted = true;
+    switch (event->type)
+    {
+        case INPUT_EVENT_STATE:
+            vlc_player_input_HandleStateEvent(input, event->state.value,
+                                              event->state.date);
+            break;
+        case INPUT_EVENT_CAPABILITIES:
+            input->capabilities = event->capabilities;
+            break;
+        case INPUT_EVENT_PROGRAM:
+            vlc_player_input_HandleProgramEvent(input, &event->program);
+            break;
+        case INPUT_EVENT_ES:
+            vlc_player_input_HandleEsEvent(input, &event->es);
+            break;
+        case INPUT_EVENT_TITLE:
+            vlc_player_input_HandleTitleEvent(input, &event->title);
+            break;
+        case INPUT_EVENT_CHAPTER:
+            vlc_player_input_HandleChapterEvent(input, &event->chapter);
+            break;
+        case INPUT_EVENT_DEAD:
+            if (input->started)
+                vlc_player_input_HandleState(input, VLC_PLAYER_STATE_STOPPING,
+                                             VLC_TICK_INVALID);
+            vlc_player_destructor_AddJoinableInput(player, input);
+            break;
+        default:
+            /* Times, statistics and cache are sent again once resumed. There
+             * is no output yet, hence no clock or vout events. */
+            break;
+    }
+    player->events_muted = false;
+}
+
 static void
 input_thread_Events(input_thread_t *input_thread,
                     const struct vlc_input_event *event, void *user_data)
@@ -653,6 +834,13 @@ input_thread_Events(input_thread_t *input_thread,
 
     vlc_mutex_lock(&player->lock);
 
+    if (input->prepared)
+    {
+        vlc_player_input_HandlePreparedEvent(input, event);
+        vlc_mutex_unlock(&player->lock);
+        return;
+    }
+
     switch (event->type)
     {
         case INPUT_EVENT_STATE:
@@ -716,6 +904,12 @@ input_thread_Events(input_thread_t *input_thread,
                 vlc_player_UpdateTimer(player, NULL, false, &point,
                                        input->normal_time, 0, 0);
             }
+
+            if (input == player->input && player->prepare_delay > 0
+             && input->length != VLC_TICK_INVALID
+             && input->time != VLC_TICK_INVALID
+             && input->length - input->time <= player->prepare_delay)
+                vlc_player_PrepareNextInput(player);
             break;
         }
         case INPUT_EVENT_PROGRAM:
@@ -738,6 +932,18 @@ input_thread_Events(input_thread_t *input_thread,
             input->stats = *event->stats;
             vlc_player_SendEvent(player, on_statistics_changed, &input->stats);
             break;
+        case INPUT_EVENT_ES_LATENCY:
+        {
+            struct vlc_player_track_priv *trackpriv =
+                vlc_player_input_FindTrackById(input, event->es_latency.id,
+                                               NULL);
+            if (trackpriv)
+            {
+                trackpriv->latency = *event->es_latency.latency;
+                trackpriv->has_latency = true;
+            }
+            break;
+        }
         case INPUT_EVENT_SIGNAL:
             input->signal_quality = event->signal.quality;
             input->signal_strength = event->signal.strength;
@@ -827,7 +1033,7 @@ vlc_player_input_GetSelectedTrackStringIds(struct vlc_player_input *input,
 }
 
 struct vlc_player_input *
-vlc_player_input_New(vlc_player_t *player, input_item_t *item)
+vlc_player_input_New(vlc_player_t *player, input_item_t *item, bool prepared)
 {
     struct vlc_player_input *input = malloc(sizeof(*input));
     if (!input)
@@ -835,6 +1041,7 @@ vlc_player_input_New(vlc_player_t *player, input_item_t *item)
 
     input->player = player;
     input->started = false;
+    input->prepared = prepared;
 
     input->state = VLC_PLAYER_STATE_STOPPED;
     input->error = VLC_PLAYER_ERROR_NONE;
@@ -885,19 +1092,25 @@ vlc_player_input_New(vlc_player_t *player, input_item_t *item)
         free(input);
         return NULL;
     }
-    vlc_player_input_RestoreMlStates(input, false);
 
-    if (player->video_string_ids)
-        vlc_player_input_SelectTracksByStringIds(input, VIDEO_ES,
-                                                 player->video_string_ids);
-
-    if (player->audio_string_ids)
-        vlc_player_input_SelectTracksByStringIds(input, AUDIO_ES,
-                                                 player->audio_string_ids);
-
-    if (player->sub_string_ids)
-        vlc_player_input_SelectTracksByStringIds(input, SPU_ES,
-                                                 player->sub_string_ids);
+    if (prepared)
+    {
+        /* Opened ahead of the end of the current input: buffer it paused,
+         * without taking its audio and video outputs. The medialibrary
+         * states are restored once it is resumed. */
+        var_Create(input->thread, "start-paused", VLC_VAR_BOOL);
+        var_SetBool(input->thread, "start-paused", true);
+        var_Create(input->thread, "prepared", VLC_VAR_BOOL);
+        var_SetBool(input->thread, "prepared", true);
+        var_SetBool(input->thread, "video", false);
+    }
+    else
+    {
+        /* The track preferences of a prepared input are only known once it
+         * is the current one: they are applied on resume */
+        vlc_player_input_RestoreMlStates(input, false);
+        vlc_player_input_SelectPlayerTracks(input);
+    }
 
     /* Initial sub/audio delay */
     const vlc_tick_t cat_delays[DATA_ES] = {
@@ -49,6 +49,10 @@ static_assert(VLC_PLAYER_TITLE_MENU == INPUT_TITLE_MENU &&
 #define vlc_player_foreach_inputs(it) \
     for (struct vlc_player_input *it = player->input; it != NULL; it = NULL)
 
+static void
+vlc_player_destructor_AddInput(vlc_player_t *player,
+                               struct vlc_player_input *input);
+
 void
 vlc_player_PrepareNextMedia(vlc_player_t *player)
 {
@@ -97,8 +101,24 @@ vlc_player_OpenNextMedia(vlc_player_t *player)
         player->media = player->next_media;
         player->next_media = NULL;
 
-        struct vlc_player_input *input = player->input =
-            vlc_player_input_New(player, player->media);
+        struct vlc_player_input *input = player->next_input;
+        /* The input is playing once opened, then paused: if it is still
+         * playing, it could not be paused and was played muted meanwhile */
+        if (input && player->started
+         && input->state != VLC_PLAYER_STATE_PLAYING)
+        {
+            /* Already opened and buffered: vlc_player_input_Start() will
+             * resume it */
+            assert(input_GetItem(input->thread) == player->media);
+            player->next_input = NULL;
+            player->input = input;
+        }
+        else
+        {
+            vlc_player_DiscardNextInput(player);
+            input = player->input =
+                vlc_player_input_New(player, player->media, false);
+        }
         if (!input)
         {
             input_item_Release(player->media);
@@ -115,6 +135,50 @@ vlc_player_OpenNextMedia(vlc_player_t *player)
     return ret;
 }
 
+void
+vlc_player_PrepareNextInput(vlc_player_t *player)
+{
+    vlc_player_assert_locked(player);
+
+    if (player->next_media_requested
+     || player->media_stopped_action == VLC_PLAYER_MEDIA_STOPPED_PAUSE)
+        return;
+
+    vlc_player_PrepareNextMedia(player);
+    if (!player->next_media)
+        return;
+
+    assert(player->next_input == NULL);
+
+    /* The listeners are only notified about this input once it becomes the
+     * current one */
+    player->events_muted = true;
+    struct vlc_player_input *input =
+        vlc_player_input_New(player, player->next_media, true);
+    player->events_muted = false;
+    if (!input)
+        return;
+
+    if (input_Start(input->thread) != VLC_SUCCESS)
+    {
+        vlc_player_input_Delete(input);
+        return;
+    }
+    input->started = true;
+    player->next_input = input;
+}
+
+void
+vlc_player_DiscardNextInput(vlc_player_t *player)
+{
+    struct vlc_player_input *input = player->next_input;
+    if (input)
+    {
+        player->next_input = NULL;
+        vlc_player_destructor_AddInput(player, input);
+    }
+}
+
 static void
 vlc_player_CancelWaitError(vlc_player_t *player)
 {
@@ -194,6 +258,17 @@ static bool vlc_player_destructor_IsEmpty(vlc_player_t *player)
         && vlc_list_is_empty(&player->destructor.joinable_inputs);
 }
 
+bool
+vlc_player_destructor_IsLastInput(vlc_player_t *player,
+                                  struct vlc_player_input *input)
+{
+    struct vlc_list *joinable_inputs = &player->destructor.joinable_inputs;
+    return vlc_list_is_empty(&player->destructor.inputs)
+        && vlc_list_is_empty(&player->destructor.stopping_inputs)
+        && vlc_list_is_first(&input->node, joinable_inputs)
+        && vlc_list_is_last(&input->node, joinable_inputs);
+}
+
 static void *
 vlc_player_destructor_Thread(void *data)
 {
@@ -219,7 +294,8 @@ vlc_player_destructor_Thread(void *data)
                                          VLC_TICK_INVALID);
             vlc_player_destructor_AddStoppingInput(player, input);
 
-            vlc_player_UpdateMLStates(player, input);
+            if (!input->prepared)
+                vlc_player_UpdateMLStates(player, input);
             input_Stop(input->thread);
         }
 
@@ -402,6 +478,14 @@ vlc_player_GetTrack(vlc_player_t *player, vlc_es_id_t *id)
     return trackpriv ? &trackpriv->t : NULL;
 }
 
+const struct vlc_es_latency *
+vlc_player_GetTrackLatency(vlc_player_t *player, vlc_es_id_t *id)
+{
+    struct vlc_player_track_priv *trackpriv =
+        vlc_player_GetPrivTrack(player, id);
+    return trackpriv && trackpriv->has_latency ? &trackpriv->latency : NULL;
+}
+
 vout_thread_t *
 vlc_player_GetEsIdVout(vlc_player_t *player, vlc_es_id_t *es_id,
                        enum vlc_vout_order *order)
@@ -1141,7 +1225,7 @@ vlc_player_InvalidateNextMedia(vlc_player_t *player)
         player->next_media = NULL;
     }
     player->next_media_requested = false;
-
+    vlc_player_DiscardNextInput(player);
 }
 
 int
@@ -1171,7 +1255,7 @@ vlc_player_Start(vlc_player_t *player)
     if (!player->input)
     {
         /* Possible if the player was stopped by the user */
-        player->input = vlc_player_input_New(player, player->media);
+        player->input = vlc_player_input_New(player, player->media, false);
 
         if (!player->input)
             return VLC_ENOMEM;
@@ -1217,6 +1301,12 @@ vlc_player_SetMediaStoppedAction(vlc_player_t *player,
 {
     vlc_player_assert_locked(player);
     player->media_stopped_action = action;
+
+    /* The prepared next media won't be played automatically anymore */
+    if (player->next_input
+     && (action == VLC_PLAYER_MEDIA_STOPPED_PAUSE
+      || action == VLC_PLAYER_MEDIA_STOPPED_STOP))
+        vlc_player_InvalidateNextMedia(player);
     var_SetBool(player, "play-and-pause",
                 action == VLC_PLAYER_MEDIA_STOPPED_PAUSE);
     vlc_player_SendEvent(player, on_media_stopped_action_changed, action);
@@ -1887,6 +1977,7 @@ vlc_player_Delete(vlc_player_t *player)
 
     if (player->input)
         vlc_player_destructor_AddInput(player, player->input);
+    vlc_player_DiscardNextInput(player);
 
     player->deleting = true;
     vlc_cond_signal(&player->destructor.wait);
@@ -1955,6 +2046,10 @@ vlc_player_New(vlc_object_t *parent, enum vlc_player_lock_type lock_type,
     player->releasing_media = false;
     player->next_media_requested = false;
     player->next_media = NULL;
+    player->next_input = NULL;
+    player->prepare_delay =
+        VLC_TICK_FROM_MS(var_InheritInteger(player, "prepare-next-media"));
+    player->events_muted = false;
 
     player->video_string_ids = player->audio_string_ids =
     player->sub_string_ids = NULL;
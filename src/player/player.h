@@ -38,6 +38,9 @@ struct vlc_player_track_priv
     enum vlc_vout_order vout_order;
     /* Used to save or not the track selection */
     bool selected_by_user;
+    /* only valid if has_latency is true */
+    struct vlc_es_latency latency;
+    bool has_latency;
 };
 
 typedef struct VLC_VECTOR(struct vlc_player_program *)
@@ -58,6 +61,8 @@ struct vlc_player_input
     input_thread_t *thread;
     vlc_player_t *player;
     bool started;
+    /* opened ahead of time, paused and muted until it becomes current */
+    bool prepared;
 
     enum vlc_player_state state;
     enum vlc_player_error error;
@@ -235,6 +240,10 @@ struct vlc_player_t
     bool releasing_media;
     bool next_media_requested;
     input_item_t *next_media;
+    /* next_media, already opened and buffered */
+    struct vlc_player_input *next_input;
+    vlc_tick_t prepare_delay;
+    bool events_muted;
 
     char *video_string_ids;
     char *audio_string_ids;
@@ -285,6 +294,8 @@ vlc_player_get_input_locked(vlc_player_t *player)
 
 #define vlc_player_SendEvent(player, event, ...) do { \
     vlc_player_listener_id *listener; \
+    if (player->events_muted) \
+        break; /* the event is about a prepared input */ \
     vlc_list_foreach(listener, &player->listeners, node) \
     { \
         if (listener->cbs->event) \
@@ -317,6 +328,12 @@ vlc_player_OpenNextMedia(vlc_player_t *player);
 void
 vlc_player_PrepareNextMedia(vlc_player_t *player);
 
+void
+vlc_player_PrepareNextInput(vlc_player_t *player);
+
+void
+vlc_player_DiscardNextInput(vlc_player_t *player);
+
 void
 vlc_player_destructor_AddStoppingInput(vlc_player_t *player,
                                        struct vlc_player_input *input);
@@ -325,6 +342,10 @@ void
 vlc_player_destructor_AddJoinableInput(vlc_player_t *player,
                                        struct vlc_player_input *input);
 
+bool
+vlc_player_destructor_IsLastInput(vlc_player_t *player,
+                                  struct vlc_player_input *input);
+
 /*
  * player_track.c
  */
@@ -391,7 +412,7 @@ vlc_player_input_FindTrackById(struct vlc_player_input *input, vlc_es_id_t *id,
                                size_t *idx);
 
 struct vlc_player_input *
-vlc_player_input_New(vlc_player_t *player, input_item_t *item);
+vlc_player_input_New(vlc_player_t *player, input_item_t *item, bool prepared);
 
 void
 vlc_player_input_Delete(struct vlc_player_input *input);
@@ -114,6 +114,7 @@ vlc_player_track_priv_New(vlc_es_id_t *id, const char *name, const es_format_t *
     trackpriv->vout = NULL;
     trackpriv->vout_order = VLC_VOUT_ORDER_NONE;
     trackpriv->selected_by_user = false;
+    trackpriv->has_latency = false;
 
     track->name = strdup(name);
     if (!track->name)
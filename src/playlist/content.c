@@ -22,6 +22,10 @@
 # include "config.h"
 #endif
 
+#ifdef HAVE_SEARCH_H
+# include <search.h>
+#endif
+
 #include "content.h"
 
 #include "control.h"
@@ -30,12 +34,98 @@
 #include "playlist.h"
 #include "preparse.h"
 
+/*
+ * The items are stored in a vector, so that listeners receive contiguous
+ * arrays, but finding the position of an item must not require a linear scan:
+ * it is needed for every removal, move or update of an item.
+ *
+ * Each item stores a hint of its position. Modifications record how they
+ * shifted the items in playlist->hints, and a lookup corrects the hint from
+ * these shifts, in a bounded number of steps (see hints.c).
+ *
+ * The items are also referenced by media in a binary tree, the items sharing
+ * the same media being chained.
+ */
+
+void
+vlc_playlist_ResetIndices(vlc_playlist_t *playlist)
+{
+    vlc_playlist_hints_Reset(&playlist->hints,
+                             (void *const *) playlist->items.data,
+                             playlist->items.size,
+                             offsetof(vlc_playlist_item_t, hint));
+}
+
+static int
+vlc_playlist_CompareMedia(const void *lhs, const void *rhs)
+{
+    uintptr_t a = (uintptr_t) ((const vlc_playlist_item_t *) lhs)->media;
+    uintptr_t b = (uintptr_t) ((const vlc_playlist_item_t *) rhs)->media;
+    return (a > b) - (a < b);
+}
+
+static bool
+vlc_playlist_MediaTreeAdd(vlc_playlist_t *playlist, vlc_playlist_item_t *item)
+{
+    vlc_playlist_item_t **node = tsearch(item, &playlist->media_tree,
+                                         vlc_playlist_CompareMedia);
+    if (unlikely(!node))
+        return false;
+
+    if (*node != item)
+    {
+        /* the media is already in the playlist, chain the item */
+        item->media_next = (*node)->media_next;
+        (*node)->media_next = item;
+    }
+    return true;
+}
+
+static void
+vlc_playlist_MediaTreeRemove(vlc_playlist_t *playlist,
+                             vlc_playlist_item_t *item)
+{
+    vlc_playlist_item_t **node = tfind(item, &playlist->media_tree,
+                                       vlc_playlist_CompareMedia);
+    assert(node);
+
+    if (*node == item)
+    {
+        if (item->media_next)
+            /* same media, so the tree order is preserved */
+            *node = item->media_next;
+        else
+            tdelete(item, &playlist->media_tree, vlc_playlist_CompareMedia);
+    }
+    else
+    {
+        vlc_playlist_item_t *prev = *node;
+        while (prev->media_next != item)
+            prev = prev->media_next;
+        prev->media_next = item->media_next;
+    }
+    item->media_next = NULL;
+}
+
+static void
+vlc_playlist_MediaTreeNoFree(void *item)
+{
+    VLC_UNUSED(item);
+}
+
 void
 vlc_playlist_ClearItems(vlc_playlist_t *playlist)
 {
+    tdestroy(playlist->media_tree, vlc_playlist_MediaTreeNoFree);
+    playlist->media_tree = NULL;
+    vlc_playlist_hints_Init(&playlist->hints);
+
     vlc_playlist_item_t *item;
     vlc_vector_foreach(item, &playlist->items)
+    {
+        item->media_next = NULL;
         vlc_playlist_item_Release(item);
+    }
     vlc_vector_clear(&playlist->items);
 }
 
@@ -60,6 +150,11 @@ vlc_playlist_ItemsReset(vlc_playlist_t *playlist)
 static void
 vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count)
 {
+    vlc_playlist_hints_Shift(&playlist->hints, index, SIZE_MAX, count);
+    for (size_t i = index; i < index + count; ++i)
+        vlc_playlist_hints_Set(&playlist->hints,
+                               &playlist->items.data[i]->hint, i);
+
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
         randomizer_Add(&playlist->randomizer,
                        &playlist->items.data[index], count);
@@ -87,6 +182,15 @@ static void
 vlc_playlist_ItemsMoved(vlc_playlist_t *playlist, size_t index, size_t count,
                         size_t target)
 {
+    if (index < target)
+        vlc_playlist_hints_Shift(&playlist->hints, index + count,
+                                 target + count, -(ssize_t) count);
+    else
+        vlc_playlist_hints_Shift(&playlist->hints, target, index, count);
+    for (size_t i = target; i < target + count; ++i)
+        vlc_playlist_hints_Set(&playlist->hints,
+                               &playlist->items.data[i]->hint, i);
+
     struct vlc_playlist_state state;
     vlc_playlist_state_Save(playlist, &state);
 
@@ -133,6 +237,9 @@ vlc_playlist_ItemsRemoving(vlc_playlist_t *playlist, size_t index, size_t count)
 static bool
 vlc_playlist_ItemsRemoved(vlc_playlist_t *playlist, size_t index, size_t count)
 {
+    vlc_playlist_hints_Shift(&playlist->hints, index + count, SIZE_MAX,
+                             -(ssize_t) count);
+
     struct vlc_playlist_state state;
     vlc_playlist_state_Save(playlist, &state);
 
@@ -197,9 +304,10 @@ vlc_playlist_IndexOf(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    ssize_t index;
-    vlc_vector_index_of(&playlist->items, item, &index);
-    return index;
+    return vlc_playlist_hints_Find(&playlist->hints,
+                                   (void *const *) playlist->items.data,
+                                   playlist->items.size,
+                                   offsetof(vlc_playlist_item_t, hint), item);
 }
 
 ssize_t
@@ -207,11 +315,22 @@ vlc_playlist_IndexOfMedia(vlc_playlist_t *playlist, const input_item_t *media)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->media == media)
-            return i;
-    return -1;
+    vlc_playlist_item_t key = { .media = (input_item_t *) media };
+    vlc_playlist_item_t **node = tfind(&key, &playlist->media_tree,
+                                       vlc_playlist_CompareMedia);
+    if (!node)
+        return -1;
+
+    /* return the first occurrence of the media */
+    ssize_t index = -1;
+    for (vlc_playlist_item_t *item = *node; item; item = item->media_next)
+    {
+        ssize_t i = vlc_playlist_IndexOf(playlist, item);
+        assert(i != -1);
+        if (index == -1 || i < index)
+            index = i;
+    }
+    return index;
 }
 
 ssize_t
@@ -250,12 +369,20 @@ vlc_playlist_MediaToItems(vlc_playlist_t *playlist, input_item_t *const media[],
         items[i] = vlc_playlist_item_New(media[i], id);
         if (unlikely(!items[i]))
             break;
+        if (unlikely(!vlc_playlist_MediaTreeAdd(playlist, items[i])))
+        {
+            vlc_playlist_item_Release(items[i]);
+            break;
+        }
     }
     if (i < count)
     {
         /* allocation failure, release partial items */
-        while (i)
-            vlc_playlist_item_Release(items[--i]);
+        while (i--)
+        {
+            vlc_playlist_MediaTreeRemove(playlist, items[i]);
+            vlc_playlist_item_Release(items[i]);
+        }
         return VLC_ENOMEM;
     }
     return VLC_SUCCESS;
@@ -311,7 +438,11 @@ vlc_playlist_Remove(vlc_playlist_t *playlist, size_t index, size_t count)
     vlc_playlist_ItemsRemoving(playlist, index, count);
 
     for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_Release(playlist->items.data[index + i]);
+    {
+        vlc_playlist_item_t *item = playlist->items.data[index + i];
+        vlc_playlist_MediaTreeRemove(playlist, item);
+        vlc_playlist_item_Release(item);
+    }
 
     vlc_vector_remove_slice(&playlist->items, index, count);
 
@@ -335,6 +466,12 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
     if (!item)
         return VLC_ENOMEM;
 
+    if (!vlc_playlist_MediaTreeAdd(playlist, item))
+    {
+        vlc_playlist_item_Release(item);
+        return VLC_ENOMEM;
+    }
+
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
     {
         randomizer_Remove(&playlist->randomizer,
@@ -342,8 +479,10 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
         randomizer_Add(&playlist->randomizer, &item, 1);
     }
 
+    vlc_playlist_MediaTreeRemove(playlist, playlist->items.data[index]);
     vlc_playlist_item_Release(playlist->items.data[index]);
     playlist->items.data[index] = item;
+    vlc_playlist_hints_Set(&playlist->hints, &item->hint, index);
 
     vlc_playlist_ItemReplaced(playlist, index);
     return VLC_SUCCESS;
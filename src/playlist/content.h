@@ -28,6 +28,10 @@ typedef struct input_item_t input_item_t;
 void
 vlc_playlist_ClearItems(vlc_playlist_t *playlist);
 
+/* called when the items are reordered */
+void
+vlc_playlist_ResetIndices(vlc_playlist_t *playlist);
+
 /* expand an item (replace it by the given media array) */
 int
 vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
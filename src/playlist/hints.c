@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * playlist/hints.c
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "hints.h"
+
+/*
+ * Finding the position of an item in a vector must not require a linear scan,
+ * so each item stores a hint of its position, along with the generation of the
+ * vector it was right in.
+ *
+ * Every insertion, removal or move shifting a range of items is a new
+ * generation, recorded in a short log rather than applied to the hints of all
+ * the items shifted. A lookup replays the shifts recorded since the generation
+ * of the hint, then caches the result: it costs at most
+ * VLC_PLAYLIST_HINTS_MAX_SHIFTS steps, and a single one until the next shift.
+ *
+ * Once the log is full, the next lookup refreshes the hints from the lowest
+ * position shifted, which costs about as much as the largest memmove() among
+ * the shifts since the previous refresh. It is not done by the shift itself,
+ * as the vector may be in the middle of a modification.
+ *
+ * After a refresh, the hints of the items are right in the generation of the
+ * refresh if they are older (the items before the lowest position shifted
+ * were not moved since their hints were set).
+ */
+
+static inline struct vlc_playlist_hint *
+vlc_playlist_hints_Get(const void *item, size_t offset)
+{
+    /* the hint is a cache, updated even on lookups */
+    return (struct vlc_playlist_hint *) ((const char *) item + offset);
+}
+
+void
+vlc_playlist_hints_Init(struct vlc_playlist_hints *hints)
+{
+    hints->base = 0;
+    hints->count = 0;
+    hints->low = SIZE_MAX;
+    hints->overflow = false;
+}
+
+static void
+vlc_playlist_hints_Refresh(struct vlc_playlist_hints *hints,
+                           void *const *data, size_t size, size_t offset)
+{
+    hints->base += hints->count + 1;
+    hints->count = 0;
+
+    for (size_t i = hints->low; i < size; ++i)
+        vlc_playlist_hints_Set(hints, vlc_playlist_hints_Get(data[i], offset),
+                               i);
+    hints->low = SIZE_MAX;
+    hints->overflow = false;
+}
+
+void
+vlc_playlist_hints_Reset(struct vlc_playlist_hints *hints,
+                         void *const *data, size_t size, size_t offset)
+{
+    hints->low = 0;
+    vlc_playlist_hints_Refresh(hints, data, size, offset);
+}
+
+void
+vlc_playlist_hints_Shift(struct vlc_playlist_hints *hints, size_t begin,
+                         size_t end, ssize_t delta)
+{
+    if (begin >= end || delta == 0)
+        return;
+
+    /* the lowest position of the shifted items, before or after the shift */
+    size_t low = delta < 0 ? begin + delta : begin;
+    if (low < hints->low)
+        hints->low = low;
+
+    if (hints->overflow || hints->count == VLC_PLAYLIST_HINTS_MAX_SHIFTS)
+    {
+        /* refreshed on the next lookup */
+        hints->overflow = true;
+        return;
+    }
+
+    hints->shifts[hints->count].begin = begin;
+    hints->shifts[hints->count].end = end;
+    hints->shifts[hints->count].delta = delta;
+    hints->count++;
+}
+
+ssize_t
+vlc_playlist_hints_Find(struct vlc_playlist_hints *hints,
+                        void *const *data, size_t size, size_t offset,
+                        const void *item)
+{
+    if (hints->overflow)
+        vlc_playlist_hints_Refresh(hints, data, size, offset);
+
+    struct vlc_playlist_hint *hint = vlc_playlist_hints_Get(item, offset);
+    size_t index = hint->index;
+    size_t i = hint->gen > hints->base ? hint->gen - hints->base : 0;
+
+    for (; i < hints->count; ++i)
+        if (index >= hints->shifts[i].begin && index < hints->shifts[i].end)
+            index += hints->shifts[i].delta;
+
+    if (index >= size || data[index] != item)
+        /* the item is not in the vector (anymore) */
+        return -1;
+
+    vlc_playlist_hints_Set(hints, hint, index);
+    return index;
+}
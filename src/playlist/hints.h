@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * playlist/hints.h
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PLAYLIST_HINTS_H
+#define VLC_PLAYLIST_HINTS_H
+
+#include <vlc_common.h>
+
+/* maximum number of shifts replayed by a lookup */
+#define VLC_PLAYLIST_HINTS_MAX_SHIFTS 64
+
+/**
+ * Position hint of an item in a vector (see hints.c).
+ */
+struct vlc_playlist_hint
+{
+    size_t index;
+    uint64_t gen; /* generation of the vector the index was right in */
+};
+
+/**
+ * Shifts of the items of a vector since its hints were last refreshed.
+ */
+struct vlc_playlist_hints
+{
+    uint64_t base; /* generation of the last refresh */
+    size_t count; /* number of shifts logged since base */
+    size_t low; /* lowest position shifted since base */
+    bool overflow; /* whether shifts were not logged */
+    struct {
+        size_t begin;
+        size_t end;
+        ssize_t delta;
+    } shifts[VLC_PLAYLIST_HINTS_MAX_SHIFTS];
+};
+
+/* The vectors hold pointers to the items, the hint being at the given offset
+ * in each item. The vector must be consistent when it is passed. */
+
+void
+vlc_playlist_hints_Init(struct vlc_playlist_hints *hints);
+
+/* refresh the hints of all the items, after they are reordered */
+void
+vlc_playlist_hints_Reset(struct vlc_playlist_hints *hints,
+                         void *const *data, size_t size, size_t offset);
+
+/* record that the items at [begin, end) moved by delta */
+void
+vlc_playlist_hints_Shift(struct vlc_playlist_hints *hints, size_t begin,
+                         size_t end, ssize_t delta);
+
+/* set the hint of an item put at the given index */
+static inline void
+vlc_playlist_hints_Set(const struct vlc_playlist_hints *hints,
+                       struct vlc_playlist_hint *hint, size_t index)
+{
+    hint->index = index;
+    hint->gen = hints->base + hints->count;
+}
+
+/* return the index of the item, or -1 if it is not in the vector */
+ssize_t
+vlc_playlist_hints_Find(struct vlc_playlist_hints *hints,
+                        void *const *data, size_t size, size_t offset,
+                        const void *item);
+
+#endif
@@ -37,6 +37,11 @@ vlc_playlist_item_New(input_item_t *media, uint64_t id)
     vlc_atomic_rc_init(&item->rc);
     item->id = id;
     item->media = media;
+    item->hint.index = SIZE_MAX;
+    item->hint.gen = 0;
+    item->random_hint.index = SIZE_MAX;
+    item->random_hint.gen = 0;
+    item->media_next = NULL;
     input_item_Hold(media);
     return item;
 }
@@ -23,6 +23,8 @@
 
 #include <vlc_atomic.h>
 
+#include "hints.h"
+
 typedef struct vlc_playlist_item vlc_playlist_item_t;
 typedef struct input_item_t input_item_t;
 
@@ -31,6 +33,10 @@ struct vlc_playlist_item
     input_item_t *media;
     uint64_t id;
     vlc_atomic_rc_t rc;
+    /* private data for the playlist and randomizer indexes */
+    struct vlc_playlist_hint hint; /**< position hint in the playlist */
+    struct vlc_playlist_hint random_hint; /**< position hint in the randomizer */
+    vlc_playlist_item_t *media_next; /**< next item with the same media */
 };
 
 /* _New() is private, it is called when inserting new media in the playlist */
@@ -45,6 +45,8 @@ vlc_playlist_New(vlc_object_t *parent)
     }
 
     vlc_vector_init(&playlist->items);
+    vlc_playlist_hints_Init(&playlist->hints);
+    playlist->media_tree = NULL;
     randomizer_Init(&playlist->randomizer);
     playlist->current = -1;
     playlist->has_prev = false;
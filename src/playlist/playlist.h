@@ -25,6 +25,7 @@
 #include <vlc_playlist.h>
 #include <vlc_vector.h>
 #include "../player/player.h"
+#include "hints.h"
 #include "randomizer.h"
 
 typedef struct input_item_t input_item_t;
@@ -53,6 +54,8 @@ struct vlc_playlist
     /* all remaining fields are protected by the lock of the player */
     struct vlc_player_listener_id *player_listener;
     playlist_item_vector_t items;
+    struct vlc_playlist_hints hints; /**< shifts of the items (see content.c) */
+    void *media_tree; /**< items by media (see content.c) */
     struct randomizer randomizer;
     ssize_t current;
     bool has_prev;
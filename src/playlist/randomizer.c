@@ -32,6 +32,16 @@
 #include <vlc_rand.h>
 #include "randomizer.h"
 
+#ifdef TEST_RANDOMIZER
+/* fake structure to simplify tests */
+struct vlc_playlist_item {
+    size_t index;
+    struct vlc_playlist_hint random_hint;
+};
+#else
+# include "item.h"
+#endif
+
 /**
  * \addtogroup playlist_randomizer Playlist randomizer helper
  * \ingroup playlist
@@ -249,6 +259,11 @@
  *               <-------->     <-------------->
  *              determinated     history range
  *                 range
+ *
+ * To find an item without scanning the vector, each item stores a hint of its
+ * position (random_hint). Like in the playlist, the shifts of the items are
+ * recorded to correct the hints on lookup (see hints.c). Swaps update the
+ * hints directly.
  */
 
 /* On auto-reshuffle, avoid to select the same item before at least
@@ -269,6 +284,7 @@ randomizer_Init(struct randomizer *r)
     r->head = 0;
     r->next = 0;
     r->history = 0;
+    vlc_playlist_hints_Init(&r->hints);
 }
 
 void
@@ -283,12 +299,20 @@ randomizer_SetLoop(struct randomizer *r, bool loop)
     r->loop = loop;
 }
 
-static inline ssize_t
+static inline void
+randomizer_SetIndex(struct randomizer *r, size_t index)
+{
+    vlc_playlist_hints_Set(&r->hints, &r->items.data[index]->random_hint,
+                           index);
+}
+
+static ssize_t
 randomizer_IndexOf(struct randomizer *r, const vlc_playlist_item_t *item)
 {
-    ssize_t index;
-    vlc_vector_index_of(&r->items, item, &index);
-    return index;
+    return vlc_playlist_hints_Find(&r->hints, (void *const *) r->items.data,
+                                   r->items.size,
+                                   offsetof(vlc_playlist_item_t, random_hint),
+                                   item);
 }
 
 bool
@@ -312,6 +336,8 @@ swap_items(struct randomizer *r, int i, int j)
     vlc_playlist_item_t *item = r->items.data[i];
     r->items.data[i] = r->items.data[j];
     r->items.data[j] = item;
+    randomizer_SetIndex(r, i);
+    randomizer_SetIndex(r, j);
 }
 
 static inline void
@@ -425,6 +451,9 @@ randomizer_Add(struct randomizer *r, vlc_playlist_item_t *items[], size_t count)
 {
     if (!vlc_vector_insert_all(&r->items, r->history, items, count))
         return false;
+    vlc_playlist_hints_Shift(&r->hints, r->history, SIZE_MAX, count);
+    for (size_t i = 0; i < count; ++i)
+        randomizer_SetIndex(r, r->history + i);
     /* the insertion shifted history (and possibly next) */
     if (r->next > r->history)
         r->next += count;
@@ -443,6 +472,7 @@ randomizer_SelectIndex(struct randomizer *r, size_t index)
             memmove(&r->items.data[r->history + 1],
                     &r->items.data[r->history],
                     (index - r->history) * sizeof(selected));
+            vlc_playlist_hints_Shift(&r->hints, r->history, index, 1);
             index = r->history;
         }
         r->history = (r->history + 1) % r->items.size;
@@ -452,6 +482,8 @@ randomizer_SelectIndex(struct randomizer *r, size_t index)
     {
         r->items.data[index] = r->items.data[r->head];
         r->items.data[r->head] = selected;
+        randomizer_SetIndex(r, index);
+        randomizer_SetIndex(r, r->head);
         r->head++;
     }
     else if (index < r->items.size - 1)
@@ -459,7 +491,9 @@ randomizer_SelectIndex(struct randomizer *r, size_t index)
         memmove(&r->items.data[index],
                 &r->items.data[index + 1],
                 (r->head - index - 1) * sizeof(selected));
+        vlc_playlist_hints_Shift(&r->hints, index + 1, r->head, -1);
         r->items.data[r->head - 1] = selected;
+        randomizer_SetIndex(r, r->head - 1);
     }
 
     r->next = r->head;
@@ -493,6 +527,7 @@ randomizer_RemoveAt(struct randomizer *r, size_t index)
         memmove(&r->items.data[index],
                 &r->items.data[index + 1],
                 (r->head - index - 1) * sizeof(*r->items.data));
+        vlc_playlist_hints_Shift(&r->hints, index + 1, r->head, -1);
         r->head--;
         index = r->head; /* the new index to remove */
     }
@@ -501,6 +536,7 @@ randomizer_RemoveAt(struct randomizer *r, size_t index)
     {
         /* this part is unordered, no need to shift all items */
         r->items.data[index] = r->items.data[r->history - 1];
+        randomizer_SetIndex(r, index);
         index = r->history - 1;
         r->history--;
     }
@@ -511,6 +547,7 @@ randomizer_RemoveAt(struct randomizer *r, size_t index)
         memmove(&r->items.data[index],
                 &r->items.data[index + 1],
                 (r->items.size - index - 1) * sizeof(*r->items.data));
+        vlc_playlist_hints_Shift(&r->hints, index + 1, SIZE_MAX, -1);
     }
 
     r->items.size--;
@@ -541,16 +578,12 @@ randomizer_Clear(struct randomizer *r)
     r->head = 0;
     r->next = 0;
     r->history = 0;
+    vlc_playlist_hints_Init(&r->hints);
 }
 
 #ifndef DOC
 #ifdef TEST_RANDOMIZER
 
-/* fake structure to simplify tests */
-struct vlc_playlist_item {
-    size_t index;
-};
-
 static void
 ArrayInit(vlc_playlist_item_t *array[], size_t len)
 {
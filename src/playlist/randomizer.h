@@ -23,6 +23,7 @@
 
 #include <vlc_common.h>
 #include <vlc_vector.h>
+#include "hints.h"
 
 typedef struct vlc_playlist_item vlc_playlist_item_t;
 
@@ -43,6 +44,7 @@ struct randomizer {
     size_t head;
     size_t next;
     size_t history;
+    struct vlc_playlist_hints hints; /* shifts of the items */
 };
 
 /**
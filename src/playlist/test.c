@@ -1061,10 +1061,208 @@ test_index_of(void)
     assert(vlc_playlist_IndexOf(playlist, item) == -1);
     vlc_playlist_item_Release(item);
 
+    /* the same media may be added several times */
+    ret = vlc_playlist_Insert(playlist, 1, &media[6], 1);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[6]) == 1);
+
+    vlc_playlist_RemoveOne(playlist, 1);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[6]) == 5);
+
+    vlc_playlist_Move(playlist, 5, 1, 0);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[6]) == 0);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == 1);
+
     DestroyMediaArray(media, 10);
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_index_of_shifts(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[100];
+    CreateDummyMediaArray(media, 100);
+
+    int ret = vlc_playlist_Append(playlist, media, 100);
+    assert(ret == VLC_SUCCESS);
+
+    /* the randomizer records the shifts of its items too */
+    vlc_playlist_SetPlaybackOrder(playlist, VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM);
+
+    uint32_t seed = 42;
+    for (unsigned i = 0; i < 5000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        unsigned rnd = seed >> 8;
+        size_t size = vlc_playlist_Count(playlist);
+        size_t index = rnd % (size + 1);
+        size_t count = 1 + (rnd >> 8) % 3;
+
+        switch ((rnd >> 12) % 8)
+        {
+            case 0:
+            case 1:
+                ret = vlc_playlist_Insert(playlist, index,
+                                          &media[(rnd >> 16) % 98], count);
+                assert(ret == VLC_SUCCESS);
+                break;
+            case 2:
+            case 3:
+                if (index + count <= size)
+                {
+                    vlc_playlist_item_t *item = vlc_playlist_Get(playlist,
+                                                                 index);
+                    vlc_playlist_item_Hold(item);
+                    vlc_playlist_Remove(playlist, index, count);
+                    assert(vlc_playlist_IndexOf(playlist, item) == -1);
+                    vlc_playlist_item_Release(item);
+                }
+                break;
+            case 4:
+            case 5:
+            {
+                size_t target = (rnd >> 16) % (size + 1);
+                if (index + count <= size && target + count <= size)
+                    vlc_playlist_Move(playlist, index, count, target);
+                break;
+            }
+            case 6:
+                /* select items in the randomizer */
+                if (index < size)
+                    vlc_playlist_GoTo(playlist, index);
+                else if (vlc_playlist_HasNext(playlist))
+                    vlc_playlist_Next(playlist);
+                break;
+            default:
+                if ((rnd >> 16) % 32 == 0)
+                    vlc_playlist_Shuffle(playlist);
+                break;
+        }
+
+        /* check a few items, so that the other hints get older than the
+         * recorded shifts, then all of them once in a while */
+        size = vlc_playlist_Count(playlist);
+        size_t step = i % 64 ? 17 : 1;
+        for (size_t j = rnd % 17; j < size; j += step)
+        {
+            vlc_playlist_item_t *item = vlc_playlist_Get(playlist, j);
+            assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) j);
+        }
+    }
+
+    DestroyMediaArray(media, 100);
+    vlc_playlist_Delete(playlist);
+}
+
+/* single removals near the front (region 0), in the middle (1) or near the
+ * end (2), as done by a user or a script */
+static vlc_tick_t
+bench_remove(vlc_playlist_t *playlist, unsigned ops, unsigned region)
+{
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < ops; ++i)
+    {
+        size_t size = vlc_playlist_Count(playlist);
+        size_t span = size / 16;
+        size_t index = (size - span) * region / 2 + (i * 7919) % span;
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, index);
+        int ret = vlc_playlist_RequestRemove(playlist, &item, 1, -1);
+        assert(ret == VLC_SUCCESS);
+    }
+    return vlc_tick_now() - start;
+}
+
+/* a lookup near the end after each removal near the front, which shifts
+ * nearly all the items */
+static vlc_tick_t
+bench_lookup_after_remove(vlc_playlist_t *playlist, unsigned ops)
+{
+    vlc_tick_t lookup = 0;
+    for (unsigned i = 0; i < ops; ++i)
+    {
+        size_t size = vlc_playlist_Count(playlist);
+        vlc_playlist_RemoveOne(playlist, (i * 7919) % (size / 16));
+
+        size_t index = size - 2 - (i * 7919) % (size / 16);
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, index);
+        vlc_tick_t start = vlc_tick_now();
+        assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) index);
+        lookup += vlc_tick_now() - start;
+    }
+    return lookup;
+}
+
+static void
+bench_index_of(size_t count, unsigned ops)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t **media = malloc(count * sizeof(*media));
+    assert(media);
+    CreateDummyMediaArray(media, count);
+
+    int ret = vlc_playlist_Append(playlist, media, count);
+    assert(ret == VLC_SUCCESS);
+
+    /* the randomizer is updated on removal too */
+    vlc_playlist_SetPlaybackOrder(playlist, VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM);
+
+    /* update notifications, as sent when items are preparsed */
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < ops; ++i)
+    {
+        size_t index = (i * 7919) % count;
+        assert(vlc_playlist_IndexOfMedia(playlist, media[index]) ==
+               (ssize_t) index);
+    }
+    vlc_tick_t lookup = vlc_tick_now() - start;
+
+    vlc_tick_t remove_end = bench_remove(playlist, ops, 2);
+    vlc_tick_t remove_middle = bench_remove(playlist, ops, 1);
+    vlc_tick_t remove_front = bench_remove(playlist, ops, 0);
+    vlc_tick_t lookup_end = bench_lookup_after_remove(playlist, ops);
+
+    /* bulk removal of scattered items */
+    vlc_playlist_item_t **items = malloc(ops * sizeof(*items));
+    assert(items);
+    size_t size = vlc_playlist_Count(playlist);
+    for (unsigned i = 0; i < ops; ++i)
+        items[i] = vlc_playlist_Get(playlist, i * (size / ops));
+
+    start = vlc_tick_now();
+    ret = vlc_playlist_RequestRemove(playlist, items, ops, -1);
+    assert(ret == VLC_SUCCESS);
+    vlc_tick_t bulk = vlc_tick_now() - start;
+    assert(vlc_playlist_Count(playlist) == size - ops);
+    free(items);
+
+    fprintf(stderr, "%zu items: %u lookups in %" PRId64 " us, "
+            "%u removals at the end/middle/front in %" PRId64 "/%" PRId64
+            "/%" PRId64 " us, %u lookups at the end after removals at the "
+            "front in %" PRId64 " us, bulk removal of %u items in %" PRId64
+            " us\n", count, ops, US_FROM_VLC_TICK(lookup), ops,
+            US_FROM_VLC_TICK(remove_end), US_FROM_VLC_TICK(remove_middle),
+            US_FROM_VLC_TICK(remove_front), ops, US_FROM_VLC_TICK(lookup_end),
+            ops, US_FROM_VLC_TICK(bulk));
+
+    DestroyMediaArray(media, count);
+    free(media);
+    vlc_playlist_Delete(playlist);
+}
+
+static void
+test_index_of_scaling(void)
+{
+    /* the cost per operation must not grow linearly with the size */
+    bench_index_of(1000, 200);
+    bench_index_of(10000, 200);
+    bench_index_of(100000, 200);
+}
+
 static void
 test_prev(void)
 {
@@ -2367,6 +2565,8 @@ int main(void)
     test_playback_order_changed_callbacks();
     test_callbacks_on_add_listener();
     test_index_of();
+    test_index_of_shifts();
+    test_index_of_scaling();
     test_prev();
     test_next();
     test_goto();
@@ -0,0 +1,600 @@
+/*****************************************************************************
+ * cache.c: persistent preparsing results
+ *****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_arrays.h>
+#include <vlc_configuration.h>
+#include <vlc_es.h>
+#include <vlc_fs.h>
+#include <vlc_list.h>
+#include <vlc_memstream.h>
+#include <vlc_meta.h>
+#include <vlc_stream.h>
+#include <vlc_url.h>
+
+#include "input/item.h"
+#include "cache.h"
+
+#define CACHE_NAME  "preparser.cache"
+#define CACHE_MAGIC "VLC preparser cache 1"
+
+/* Least recently used entries are dropped beyond this count */
+#ifndef CACHE_MAX_ENTRIES /* lowered by the tests */
+# define CACHE_MAX_ENTRIES  10000
+#endif
+/* New entries are saved at most this late, not to lose them on a crash */
+#ifndef CACHE_SAVE_DELAY
+# define CACHE_SAVE_DELAY   VLC_TICK_FROM_SEC(30)
+#endif
+
+/*
+ * Every entry is a line made of the encoded MRL, the size, the modification
+ * time, the duration and, for remote resources, the validator, then a field
+ * per meta data ("m<type>=<value>") and per track
+ * ("e<cat>:<codec>:<width>:<height>:<channels>:<rate>:<language>").
+ * Strings are URI-encoded, fields are separated by tabulations. Entries are
+ * saved from the least to the most recently used.
+ */
+
+typedef struct
+{
+    struct vlc_list node;
+    char *psz_key;
+    char *psz_value; /* serialized entry */
+} cache_entry_t;
+
+struct input_preparser_cache_t
+{
+    vlc_object_t *owner;
+    char *psz_path;
+
+    vlc_mutex_t lock;
+    bool b_loaded;
+    bool b_dirty;
+    vlc_tick_t i_saved;
+    vlc_dictionary_t entries; /* MRL -> cache_entry_t */
+    struct vlc_list lru; /* from the least to the most recently used */
+    unsigned i_count;
+};
+
+input_preparser_cache_t *input_preparser_cache_New( vlc_object_t *owner )
+{
+    input_preparser_cache_t *cache = malloc( sizeof( *cache ) );
+    if( unlikely( !cache ) )
+        return NULL;
+
+    char *psz_dir = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_dir || asprintf( &cache->psz_path, "%s"DIR_SEP CACHE_NAME,
+                              psz_dir ) == -1 )
+    {
+        free( psz_dir );
+        free( cache );
+        return NULL;
+    }
+    free( psz_dir );
+
+    cache->owner = owner;
+    vlc_mutex_init( &cache->lock );
+    cache->b_loaded = false;
+    cache->b_dirty = false;
+    cache->i_saved = vlc_tick_now();
+    vlc_dictionary_init( &cache->entries, 4096 );
+    vlc_list_init( &cache->lru );
+    cache->i_count = 0;
+
+    return cache;
+}
+
+static void FreeEntry( void *p_entry, void *obj )
+{
+    cache_entry_t *entry = p_entry;
+    VLC_UNUSED( obj );
+    free( entry->psz_key );
+    free( entry->psz_value );
+    free( entry );
+}
+
+static void RemoveEntry( input_preparser_cache_t *cache, cache_entry_t *entry )
+{
+    vlc_dictionary_remove_value_for_key( &cache->entries, entry->psz_key,
+                                         NULL, NULL );
+    vlc_list_remove( &entry->node );
+    cache->i_count--;
+    FreeEntry( entry, NULL );
+}
+
+/**
+ * Adds or replaces an entry as the most recently used one, and drops the
+ * least recently used one if the cache is full. Takes ownership of the value.
+ */
+static void PutEntry( input_preparser_cache_t *cache, const char *psz_key,
+                      char *psz_value )
+{
+    vlc_mutex_assert( &cache->lock );
+
+    cache_entry_t *entry = vlc_dictionary_value_for_key( &cache->entries,
+                                                         psz_key );
+    if( entry != NULL )
+    {
+        free( entry->psz_value );
+        entry->psz_value = psz_value;
+        vlc_list_remove( &entry->node );
+        vlc_list_append( &entry->node, &cache->lru );
+        return;
+    }
+
+    entry = malloc( sizeof( *entry ) );
+    if( unlikely( entry == NULL ) )
+    {
+        free( psz_value );
+        return;
+    }
+    entry->psz_key = strdup( psz_key );
+    if( unlikely( entry->psz_key == NULL ) )
+    {
+        free( psz_value );
+        free( entry );
+        return;
+    }
+    entry->psz_value = psz_value;
+
+    vlc_dictionary_insert( &cache->entries, psz_key, entry );
+    vlc_list_append( &entry->node, &cache->lru );
+    if( ++cache->i_count > CACHE_MAX_ENTRIES )
+        RemoveEntry( cache, vlc_list_first_entry_or_null( &cache->lru,
+                                                          cache_entry_t,
+                                                          node ) );
+}
+
+static void CacheLoad( input_preparser_cache_t *cache )
+{
+    vlc_mutex_assert( &cache->lock );
+
+    cache->b_loaded = true;
+
+    FILE *file = vlc_fopen( cache->psz_path, "rt" );
+    if( file == NULL )
+        return;
+
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    unsigned count = 0;
+
+    if( getline( &line, &len, file ) <= 0 ||
+        strncmp( line, CACHE_MAGIC"\n", sizeof( CACHE_MAGIC ) ) )
+    {
+        msg_Warn( cache->owner, "ignoring invalid preparser cache %s",
+                  cache->psz_path );
+        goto out;
+    }
+
+    while( ( read = getline( &line, &len, file ) ) > 0 )
+    {
+        if( line[read - 1] == '\n' )
+            line[read - 1] = '\0';
+
+        char *psz_entry = strchr( line, '\t' );
+        if( psz_entry == NULL )
+            continue;
+        *psz_entry++ = '\0';
+
+        char *psz_value = strdup( psz_entry );
+        if( unlikely( psz_value == NULL ) || vlc_uri_decode( line ) == NULL )
+        {
+            free( psz_value );
+            continue;
+        }
+
+        PutEntry( cache, line, psz_value );
+        count++;
+    }
+
+    msg_Dbg( cache->owner, "loaded %u entries from preparser cache %s",
+             count, cache->psz_path );
+out:
+    free( line );
+    fclose( file );
+}
+
+static int CacheSaveEntries( input_preparser_cache_t *cache, FILE *file )
+{
+    if( fputs( CACHE_MAGIC"\n", file ) == EOF )
+        return -1;
+
+    cache_entry_t *entry;
+    vlc_list_foreach( entry, &cache->lru, node )
+    {
+        char *psz_key = vlc_uri_encode( entry->psz_key );
+        if( unlikely( psz_key == NULL ) )
+            return -1;
+        int ret = fprintf( file, "%s\t%s\n", psz_key, entry->psz_value );
+        free( psz_key );
+        if( ret < 0 )
+            return -1;
+    }
+
+    return fflush( file ) ? -1 : 0;
+}
+
+static void CacheSave( input_preparser_cache_t *cache )
+{
+    vlc_mutex_assert( &cache->lock );
+
+    /* Retried after the delay if this one fails */
+    cache->i_saved = vlc_tick_now();
+
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.%"PRIu32, cache->psz_path,
+                  (uint32_t)getpid() ) == -1 )
+        return;
+
+    char *psz_dir = config_GetUserDir( VLC_CACHE_DIR );
+    if( psz_dir )
+        vlc_mkdir( psz_dir, 0700 );
+    free( psz_dir );
+
+    FILE *file = vlc_fopen( psz_tmp, "wt" );
+    if( file == NULL )
+    {
+        msg_Warn( cache->owner, "cannot create %s: %s", psz_tmp,
+                  vlc_strerror_c( errno ) );
+        free( psz_tmp );
+        return;
+    }
+
+    if( CacheSaveEntries( cache, file ) )
+    {
+        msg_Warn( cache->owner, "cannot write %s: %s", psz_tmp,
+                  vlc_strerror_c( errno ) );
+        fclose( file );
+        vlc_unlink( psz_tmp );
+        free( psz_tmp );
+        return;
+    }
+
+#if !defined( _WIN32 ) && !defined( __OS2__ )
+    vlc_rename( psz_tmp, cache->psz_path ); /* atomically replace old cache */
+    fclose( file );
+#else
+    vlc_unlink( cache->psz_path );
+    fclose( file );
+    vlc_rename( psz_tmp, cache->psz_path );
+#endif
+    free( psz_tmp );
+    cache->b_dirty = false;
+}
+
+void input_preparser_cache_Delete( input_preparser_cache_t *cache )
+{
+    vlc_mutex_lock( &cache->lock );
+    if( cache->b_dirty )
+        CacheSave( cache );
+    vlc_mutex_unlock( &cache->lock );
+
+    vlc_dictionary_clear( &cache->entries, FreeEntry, NULL );
+    free( cache->psz_path );
+    free( cache );
+}
+
+/**
+ * Version of the resource of an item: local files are identified by their
+ * size and modification time, remote resources by their size and validator
+ * (e.g. the HTTP entity tag).
+ */
+typedef struct
+{
+    uint64_t i_size;
+    int64_t i_mtime;
+    char *psz_validator;
+} cache_version_t;
+
+/**
+ * Returns the MRL of an item that may be cached.
+ */
+static char *GetItemUri( input_item_t *item, bool *b_net )
+{
+    vlc_mutex_lock( &item->lock );
+    char *psz_uri = item->i_type == ITEM_TYPE_FILE && item->psz_uri ?
+                    strdup( item->psz_uri ) : NULL;
+    *b_net = item->b_net;
+    vlc_mutex_unlock( &item->lock );
+    return psz_uri;
+}
+
+static bool GetLocalVersion( const char *psz_uri, cache_version_t *version )
+{
+    char *psz_path = vlc_uri2path( psz_uri );
+    struct stat st;
+    bool b_ret = psz_path != NULL && vlc_stat( psz_path, &st ) == 0
+              && S_ISREG( st.st_mode );
+    free( psz_path );
+    if( !b_ret )
+        return false;
+
+    version->i_size = st.st_size;
+    version->i_mtime = st.st_mtime;
+    version->psz_validator = NULL;
+    return true;
+}
+
+/* Opens the access only, without reading the resource: for HTTP, that is a
+ * single request whose body is not transferred. */
+static bool GetRemoteVersion( input_preparser_cache_t *cache,
+                              const char *psz_uri, cache_version_t *version )
+{
+    stream_t *access = vlc_access_NewMRL( cache->owner, psz_uri );
+    if( access == NULL )
+        return false;
+
+    if( vlc_stream_GetSize( access, &version->i_size ) )
+        version->i_size = 0;
+    version->i_mtime = 0;
+    version->psz_validator = stream_Validator( access );
+    vlc_stream_Delete( access );
+    return version->psz_validator != NULL;
+}
+
+static bool GetVersion( input_preparser_cache_t *cache, const char *psz_uri,
+                        bool b_net, cache_version_t *version )
+{
+    return b_net ? GetRemoteVersion( cache, psz_uri, version )
+                 : GetLocalVersion( psz_uri, version );
+}
+
+static void ApplyTrack( input_item_t *item, char *psz_track )
+{
+    int i_cat;
+    vlc_fourcc_t i_codec;
+    unsigned i_width, i_height, i_channels, i_rate;
+    int i_lang = -1;
+
+    if( sscanf( psz_track, "%d:%"SCNx32":%u:%u:%u:%u:%n", &i_cat, &i_codec,
+                &i_width, &i_height, &i_channels, &i_rate, &i_lang ) < 6
+     || i_lang < 0 )
+        return;
+
+    es_format_t fmt;
+    es_format_Init( &fmt, i_cat, i_codec );
+    switch( i_cat )
+    {
+        case VIDEO_ES:
+            fmt.video.i_width = fmt.video.i_visible_width = i_width;
+            fmt.video.i_height = fmt.video.i_visible_height = i_height;
+            break;
+        case AUDIO_ES:
+            fmt.audio.i_channels = i_channels;
+            fmt.audio.i_rate = i_rate;
+            break;
+        default:
+            break;
+    }
+    if( psz_track[i_lang] != '\0' )
+        fmt.psz_language = vlc_uri_decode_duplicate( &psz_track[i_lang] );
+
+    input_item_UpdateTracksInfo( item, &fmt );
+    es_format_Clean( &fmt );
+}
+
+/**
+ * Parses the version at the start of an entry, and returns its fields.
+ */
+static char *ParseVersion( char *psz_entry, cache_version_t *version,
+                           int64_t *i_duration )
+{
+    int i_fields;
+
+    if( sscanf( psz_entry, "%"SCNu64" %"SCNd64" %"SCNd64"%n", &version->i_size,
+                &version->i_mtime, i_duration, &i_fields ) < 3 )
+        return NULL;
+
+    char *psz_fields = &psz_entry[i_fields];
+    version->psz_validator = NULL;
+    if( *psz_fields == ' ' )
+    {
+        version->psz_validator = ++psz_fields;
+        psz_fields += strcspn( psz_fields, "\t" );
+        if( *psz_fields != '\0' )
+            *psz_fields++ = '\0';
+        if( vlc_uri_decode( version->psz_validator ) == NULL )
+            return NULL;
+    }
+    return psz_fields;
+}
+
+static bool VersionEquals( const cache_version_t *a, const cache_version_t *b )
+{
+    if( a->i_size != b->i_size || a->i_mtime != b->i_mtime )
+        return false;
+    if( a->psz_validator == NULL || b->psz_validator == NULL )
+        return a->psz_validator == b->psz_validator;
+    return !strcmp( a->psz_validator, b->psz_validator );
+}
+
+bool input_preparser_cache_Lookup( input_preparser_cache_t *cache,
+                                   input_item_t *item )
+{
+    cache_version_t version, entry_version;
+    int64_t i_duration;
+    bool b_net;
+
+    char *psz_uri = GetItemUri( item, &b_net );
+    if( psz_uri == NULL )
+        return false;
+
+    /* Local files are checked first, remote resources only if cached */
+    if( !b_net && !GetLocalVersion( psz_uri, &version ) )
+    {
+        free( psz_uri );
+        return false;
+    }
+
+    vlc_mutex_lock( &cache->lock );
+    if( !cache->b_loaded )
+        CacheLoad( cache );
+    cache_entry_t *entry = vlc_dictionary_value_for_key( &cache->entries,
+                                                         psz_uri );
+    char *psz_entry = NULL;
+    if( entry != NULL )
+    {
+        vlc_list_remove( &entry->node );
+        vlc_list_append( &entry->node, &cache->lru );
+        psz_entry = strdup( entry->psz_value );
+    }
+    vlc_mutex_unlock( &cache->lock );
+
+    if( psz_entry != NULL && b_net
+     && !GetRemoteVersion( cache, psz_uri, &version ) )
+        FREENULL( psz_entry );
+    free( psz_uri );
+
+    if( psz_entry == NULL )
+        return false;
+
+    char *psz_fields = ParseVersion( psz_entry, &entry_version, &i_duration );
+    bool b_valid = psz_fields != NULL
+                && VersionEquals( &entry_version, &version );
+    free( version.psz_validator );
+    if( !b_valid )
+    {
+        free( psz_entry );
+        return false;
+    }
+
+    input_item_SetDuration( item, i_duration );
+
+    char *psz_save;
+    for( char *psz_field = strtok_r( psz_fields, "\t", &psz_save );
+         psz_field != NULL; psz_field = strtok_r( NULL, "\t", &psz_save ) )
+    {
+        if( psz_field[0] == 'm' )
+        {
+            char *psz_meta = strchr( psz_field, '=' );
+            if( psz_meta == NULL )
+                continue;
+            int i_type = atoi( &psz_field[1] );
+            if( i_type < 0 || i_type >= VLC_META_TYPE_COUNT
+             || vlc_uri_decode( ++psz_meta ) == NULL )
+                continue;
+            input_item_SetMeta( item, i_type, psz_meta );
+        }
+        else if( psz_field[0] == 'e' )
+            ApplyTrack( item, &psz_field[1] );
+    }
+
+    free( psz_entry );
+    return true;
+}
+
+static void PutString( struct vlc_memstream *ms, const char *psz )
+{
+    char *psz_enc = vlc_uri_encode( psz );
+    if( psz_enc )
+        vlc_memstream_puts( ms, psz_enc );
+    free( psz_enc );
+}
+
+void input_preparser_cache_Store( input_preparser_cache_t *cache,
+                                  input_item_t *item )
+{
+    cache_version_t version;
+    bool b_net;
+
+    char *psz_uri = GetItemUri( item, &b_net );
+    if( psz_uri == NULL )
+        return;
+    if( !GetVersion( cache, psz_uri, b_net, &version ) )
+    {
+        free( psz_uri );
+        return;
+    }
+
+    struct vlc_memstream ms;
+    vlc_memstream_open( &ms );
+
+    vlc_mutex_lock( &item->lock );
+    vlc_memstream_printf( &ms, "%"PRIu64" %"PRId64" %"PRId64, version.i_size,
+                          version.i_mtime, item->i_duration );
+    if( version.psz_validator != NULL )
+    {
+        vlc_memstream_putc( &ms, ' ' );
+        PutString( &ms, version.psz_validator );
+        free( version.psz_validator );
+    }
+
+    for( int i = 0; item->p_meta && i < VLC_META_TYPE_COUNT; i++ )
+    {
+        const char *psz_meta = vlc_meta_Get( item->p_meta, i );
+        if( psz_meta == NULL )
+            continue;
+        vlc_memstream_printf( &ms, "\tm%d=", i );
+        PutString( &ms, psz_meta );
+    }
+
+    for( int i = 0; i < item->i_es; i++ )
+    {
+        const es_format_t *fmt = item->es[i];
+        unsigned i_width = 0, i_height = 0, i_channels = 0, i_rate = 0;
+
+        if( fmt->i_cat == VIDEO_ES )
+        {
+            i_width = fmt->video.i_visible_width;
+            i_height = fmt->video.i_visible_height;
+        }
+        else if( fmt->i_cat == AUDIO_ES )
+        {
+            i_channels = fmt->audio.i_channels;
+            i_rate = fmt->audio.i_rate;
+        }
+        vlc_memstream_printf( &ms, "\te%d:%"PRIx32":%u:%u:%u:%u:", fmt->i_cat,
+                              fmt->i_codec, i_width, i_height, i_channels,
+                              i_rate );
+        if( fmt->psz_language )
+            PutString( &ms, fmt->psz_language );
+    }
+    vlc_mutex_unlock( &item->lock );
+
+    if( vlc_memstream_close( &ms ) )
+    {
+        free( psz_uri );
+        return;
+    }
+
+    vlc_mutex_lock( &cache->lock );
+    if( !cache->b_loaded )
+        CacheLoad( cache );
+    PutEntry( cache, psz_uri, ms.ptr );
+    cache->b_dirty = true;
+    if( vlc_tick_now() - cache->i_saved >= CACHE_SAVE_DELAY )
+        CacheSave( cache );
+    vlc_mutex_unlock( &cache->lock );
+
+    free( psz_uri );
+}
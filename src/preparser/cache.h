@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * cache.h: persistent preparsing results
+ *****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSER_CACHE_H
+#define _INPUT_PREPARSER_CACHE_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * Preparser cache opaque structure.
+ *
+ * The cache keeps the duration, meta data and tracks of the preparsed files,
+ * keyed by MRL. Local files are validated against their size and
+ * modification time, remote ones against their size and validator (e.g. the
+ * HTTP entity tag), which only opens their access. It is loaded from, and
+ * saved to, the user cache directory. Only the most recently used entries
+ * are kept.
+ */
+typedef struct input_preparser_cache_t input_preparser_cache_t;
+
+input_preparser_cache_t *input_preparser_cache_New( vlc_object_t * );
+
+/**
+ * Saves the cache if it was modified, and destroys it.
+ */
+void input_preparser_cache_Delete( input_preparser_cache_t * );
+
+/**
+ * Fills the item from the cache.
+ *
+ * A remote item is checked on the network only if it is in the cache.
+ *
+ * @return true if the item was found and is still valid
+ */
+bool input_preparser_cache_Lookup( input_preparser_cache_t *, input_item_t * );
+
+/**
+ * Stores the result of a successful preparsing of the item.
+ *
+ * The validator of a remote item is requested again, as the input does not
+ * expose it.
+ *
+ * The cache is saved if it was last saved long enough ago.
+ */
+void input_preparser_cache_Store( input_preparser_cache_t *, input_item_t * );
+
+#endif
@@ -30,13 +30,37 @@
 #include "input/input_internal.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "cache.h"
+
+/* Throughput is measured, and the number of threads adapted, over periods of
+ * that duration */
+#define PREPARSER_WINDOW VLC_TICK_FROM_SEC(1)
 
 struct input_preparser_t
 {
     vlc_object_t* owner;
     input_fetcher_t* fetcher;
+    input_preparser_cache_t* cache;
     struct background_worker* worker;
     atomic_bool deactivated;
+
+    struct
+    {
+        vlc_mutex_t lock;
+        /* lifetime statistics */
+        vlc_tick_t start;
+        unsigned tasks;
+        unsigned hits;
+        vlc_tick_t latency; /**< smoothed duration of the parsed tasks */
+        /* adaptive concurrency */
+        int min_threads;
+        int max_threads;
+        int threads;
+        int step; /**< +1 or -1: direction of the last change */
+        vlc_tick_t window_start;
+        unsigned window_tasks;
+        unsigned last_rate; /**< tasks per minute of the previous window */
+    } stats;
 };
 
 typedef struct input_preparser_req_t
@@ -54,6 +78,9 @@ typedef struct input_preparser_task_t
     input_preparser_t* preparser;
     int preparse_status;
     input_item_parser_id_t *parser;
+    vlc_tick_t start;
+    bool cached;
+    bool subtree;
     atomic_int state;
     atomic_bool done;
 } input_preparser_task_t;
@@ -109,6 +136,7 @@ static void OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
     input_preparser_task_t* task = task_;
     input_preparser_req_t *req = task->req;
 
+    task->subtree = true;
     if (req->cbs && req->cbs->on_subtree_added)
         req->cbs->on_subtree_added(req->item, subtree, req->userdata);
 }
@@ -133,10 +161,25 @@ static int PreparserOpenInput( void* preparser_, void* req_, void** out )
     task->preparser = preparser_;
     task->req = req;
     task->preparse_status = -1;
-    task->parser = input_item_Parse( req->item, preparser->owner, &cbs,
-                                     task );
-    if( !task->parser )
-        goto error;
+    task->start = vlc_tick_now();
+    task->subtree = false;
+    task->cached = preparser->cache
+                && input_preparser_cache_Lookup( preparser->cache, req->item );
+    if( task->cached )
+    {
+        /* No input needed, let the worker stop the task right away */
+        task->parser = NULL;
+        atomic_store( &task->state, VLC_SUCCESS );
+        atomic_store( &task->done, true );
+        background_worker_RequestProbe( preparser->worker );
+    }
+    else
+    {
+        task->parser = input_item_Parse( req->item, preparser->owner, &cbs,
+                                         task );
+        if( !task->parser )
+            goto error;
+    }
 
     *out = task;
 
@@ -176,6 +219,69 @@ static const input_fetcher_callbacks_t input_fetcher_callbacks = {
     .on_art_fetch_ended = on_art_fetch_ended,
 };
 
+/**
+ * Accounts a completed task, and adapts the number of threads.
+ *
+ * Preparsing is mostly bound by the I/O latency: as long as adding a thread
+ * increases the throughput, another one is added, and once it decreases the
+ * direction is reversed, between preparse-threads and preparse-threads-max.
+ */
+static void PreparserUpdateStats( input_preparser_t *preparser,
+                                  input_preparser_task_t *task )
+{
+    vlc_tick_t now = vlc_tick_now();
+    int threads = 0;
+
+    vlc_mutex_lock( &preparser->stats.lock );
+    preparser->stats.tasks++;
+    if( task->cached )
+        preparser->stats.hits++;
+    else
+    {
+        vlc_tick_t latency = now - task->start;
+        preparser->stats.latency = preparser->stats.latency == 0 ? latency
+                                 : ( 7 * preparser->stats.latency + latency ) / 8;
+    }
+
+    preparser->stats.window_tasks++;
+    vlc_tick_t elapsed = now - preparser->stats.window_start;
+    if( preparser->stats.max_threads > preparser->stats.min_threads
+     && elapsed >= PREPARSER_WINDOW )
+    {
+        unsigned rate = preparser->stats.window_tasks * VLC_TICK_FROM_SEC(60)
+                      / elapsed;
+
+        /* Do not adapt on idle periods: the workers were not saturated */
+        if( preparser->stats.window_tasks >= (unsigned) preparser->stats.threads
+         && elapsed < 4 * PREPARSER_WINDOW )
+        {
+            if( rate < preparser->stats.last_rate )
+                preparser->stats.step = -preparser->stats.step;
+
+            int count = VLC_CLIP( preparser->stats.threads + preparser->stats.step,
+                                  preparser->stats.min_threads,
+                                  preparser->stats.max_threads );
+            if( count == preparser->stats.threads )
+                preparser->stats.step = -preparser->stats.step;
+            else
+                threads = preparser->stats.threads = count;
+        }
+
+        preparser->stats.last_rate = rate;
+        preparser->stats.window_start = now;
+        preparser->stats.window_tasks = 0;
+    }
+    vlc_tick_t latency = preparser->stats.latency;
+    vlc_mutex_unlock( &preparser->stats.lock );
+
+    if( threads > 0 )
+    {
+        msg_Dbg( preparser->owner, "using %d preparser threads (latency %"
+                 PRId64" ms)", threads, MS_FROM_VLC_TICK(latency) );
+        background_worker_SetMaxThreads( preparser->worker, threads );
+    }
+}
+
 static void PreparserCloseInput( void* preparser_, void* task_ )
 {
     input_preparser_task_t* task = task_;
@@ -198,7 +304,17 @@ static void PreparserCloseInput( void* preparser_, void* task_ )
             break;
     }
 
-    input_item_parser_id_Release( task->parser );
+    if( task->parser )
+    {
+        input_item_parser_id_Release( task->parser );
+
+        /* Items expanding to a playlist are not cached, the subitems would
+         * have to be parsed again anyway */
+        if( status == ITEM_PREPARSE_DONE && preparser->cache && !task->subtree )
+            input_preparser_cache_Store( preparser->cache, item );
+    }
+
+    PreparserUpdateStats( preparser, task );
 
     if( preparser->fetcher && (req->options & META_REQUEST_OPTION_FETCH_ANY) )
     {
@@ -226,10 +342,12 @@ static void ReqReleaseVoid(void *item) { ReqRelease(item); }
 input_preparser_t* input_preparser_New( vlc_object_t *parent )
 {
     input_preparser_t* preparser = malloc( sizeof *preparser );
+    int threads = var_InheritInteger( parent, "preparse-threads" );
+    int max_threads = var_InheritInteger( parent, "preparse-threads-max" );
 
     struct background_worker_config conf = {
         .default_timeout = VLC_TICK_FROM_MS(var_InheritInteger( parent, "preparse-timeout" )),
-        .max_threads = var_InheritInteger( parent, "preparse-threads" ),
+        .max_threads = threads,
         .pf_start = PreparserOpenInput,
         .pf_probe = PreparserProbeInput,
         .pf_stop = PreparserCloseInput,
@@ -249,11 +367,25 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
 
     preparser->owner = parent;
     preparser->fetcher = input_fetcher_New( parent );
+    preparser->cache = var_InheritBool( parent, "preparse-cache" )
+                     ? input_preparser_cache_New( parent ) : NULL;
     atomic_init( &preparser->deactivated, false );
 
     if( unlikely( !preparser->fetcher ) )
         msg_Warn( parent, "unable to create art fetcher" );
 
+    vlc_mutex_init( &preparser->stats.lock );
+    preparser->stats.start = preparser->stats.window_start = vlc_tick_now();
+    preparser->stats.tasks = 0;
+    preparser->stats.hits = 0;
+    preparser->stats.latency = 0;
+    preparser->stats.min_threads = threads;
+    preparser->stats.max_threads = __MAX( threads, max_threads );
+    preparser->stats.threads = threads;
+    preparser->stats.step = 1;
+    preparser->stats.window_tasks = 0;
+    preparser->stats.last_rate = 0;
+
     return preparser;
 }
 
@@ -324,5 +456,18 @@ void input_preparser_Delete( input_preparser_t *preparser )
     if( preparser->fetcher )
         input_fetcher_Delete( preparser->fetcher );
 
+    vlc_tick_t elapsed = vlc_tick_now() - preparser->stats.start;
+    if( preparser->stats.tasks > 0 && elapsed > 0 )
+        msg_Dbg( preparser->owner, "preparsed %u items in %"PRId64" ms "
+                 "(%.2f items/s), %u from the cache, %u parsed (%"PRId64" ms "
+                 "per item)", preparser->stats.tasks, MS_FROM_VLC_TICK(elapsed),
+                 (double) preparser->stats.tasks * CLOCK_FREQ / elapsed,
+                 preparser->stats.hits,
+                 preparser->stats.tasks - preparser->stats.hits,
+                 MS_FROM_VLC_TICK(preparser->stats.latency) );
+
+    if( preparser->cache )
+        input_preparser_cache_Delete( preparser->cache );
+
     free( preparser );
 }
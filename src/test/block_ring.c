@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * block_ring.c: Test for the single producer single consumer block queue
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "../misc/block_ring.h"
+
+#define RING_SIZE    64
+#define BENCH_BLOCKS 200000
+
+static block_t *block_New(unsigned seq)
+{
+    block_t *block = block_Alloc(seq % 100);
+
+    assert(block != NULL);
+    block->i_dts = seq;
+    return block;
+}
+
+static void test_ring(void)
+{
+    block_ring_t ring;
+    size_t bytes = 0;
+
+    assert(block_ring_Init(&ring, RING_SIZE) == VLC_SUCCESS);
+    assert(block_ring_Pop(&ring) == NULL);
+
+    for (unsigned i = 0; i < RING_SIZE; i++)
+    {
+        assert(block_ring_Push(&ring, block_New(i)));
+        bytes += i % 100;
+    }
+
+    block_t *extra = block_New(RING_SIZE);
+    assert(!block_ring_Push(&ring, extra)); /* full */
+    assert(block_ring_GetCount(&ring) == RING_SIZE);
+    assert(block_ring_GetBytes(&ring) == bytes);
+
+    for (unsigned i = 0; i < RING_SIZE / 2; i++)
+    {
+        block_t *block = block_ring_Pop(&ring);
+        assert(block != NULL && block->i_dts == i);
+        block_Release(block);
+    }
+    assert(block_ring_Push(&ring, extra));
+
+    /* Flush the current content, but not the blocks queued afterwards */
+    unsigned tail = block_ring_Tail(&ring);
+    assert(block_ring_Push(&ring, block_New(RING_SIZE + 1)));
+    assert(block_ring_Discard(&ring, tail) == RING_SIZE / 2 + 1);
+    assert(block_ring_GetCount(&ring) == 1);
+
+    block_t *block = block_ring_Pop(&ring);
+    assert(block != NULL && block->i_dts == RING_SIZE + 1);
+    block_Release(block);
+    assert(block_ring_Pop(&ring) == NULL);
+    assert(block_ring_GetBytes(&ring) == 0);
+
+    /* Remaining blocks are released */
+    assert(block_ring_Push(&ring, block_New(0)));
+    block_ring_Destroy(&ring);
+}
+
+static void *ring_producer(void *data)
+{
+    block_ring_t *ring = data;
+
+    for (unsigned i = 0; i < BENCH_BLOCKS; i++)
+        block_ring_WaitPush(ring, block_New(i));
+    return NULL;
+}
+
+static void *fifo_producer(void *data)
+{
+    block_fifo_t *fifo = data;
+
+    for (unsigned i = 0; i < BENCH_BLOCKS; i++)
+        block_FifoPut(fifo, block_New(i));
+    return NULL;
+}
+
+static void test_ring_threads(void)
+{
+    block_ring_t ring;
+    vlc_thread_t th;
+
+    assert(block_ring_Init(&ring, RING_SIZE) == VLC_SUCCESS);
+
+    vlc_tick_t start = vlc_tick_now();
+    assert(vlc_clone(&th, ring_producer, &ring, VLC_THREAD_PRIORITY_LOW) == 0);
+
+    for (unsigned i = 0; i < BENCH_BLOCKS; i++)
+    {
+        block_t *block = block_ring_WaitPop(&ring);
+        assert(block->i_dts == i);
+        block_Release(block);
+    }
+    vlc_join(th, NULL);
+
+    fprintf(stderr, "block ring: %u blocks in %"PRId64" ms\n", BENCH_BLOCKS,
+            MS_FROM_VLC_TICK(vlc_tick_now() - start));
+    assert(block_ring_GetCount(&ring) == 0);
+    assert(block_ring_GetBytes(&ring) == 0);
+    block_ring_Destroy(&ring);
+}
+
+static void test_fifo_threads(void)
+{
+    block_fifo_t *fifo = block_FifoNew();
+    vlc_thread_t th;
+
+    assert(fifo != NULL);
+
+    vlc_tick_t start = vlc_tick_now();
+    assert(vlc_clone(&th, fifo_producer, fifo, VLC_THREAD_PRIORITY_LOW) == 0);
+
+    for (unsigned i = 0; i < BENCH_BLOCKS; i++)
+    {
+        block_t *block = block_FifoGet(fifo);
+        assert(block->i_dts == i);
+        block_Release(block);
+    }
+    vlc_join(th, NULL);
+
+    fprintf(stderr, "block FIFO: %u blocks in %"PRId64" ms\n", BENCH_BLOCKS,
+            MS_FROM_VLC_TICK(vlc_tick_now() - start));
+    block_FifoRelease(fifo);
+}
+
+int main(void)
+{
+    test_ring();
+    test_ring_threads();
+    test_fifo_threads();
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * latency.c: Test for the latency histograms
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+
+static void test_buckets(void)
+{
+    /* linear below 4 us */
+    for (unsigned i = 0; i < VLC_LATENCY_SUB_BUCKETS; i++)
+        assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(i)) == i);
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(-5)) == 0);
+
+    /* then 4 buckets per power of two */
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(4)) == 4);
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(7)) == 7);
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(8)) == 8);
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(9)) == 8);
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(10)) == 9);
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(15)) == 11);
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_US(16)) == 12);
+
+    /* 1 ms is 0b1111101000: power 9, sub-bucket 3 */
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_MS(1)) == 8 * 4 + 3);
+
+    /* consecutive and increasing */
+    unsigned last = 0;
+    for (vlc_tick_t us = 0; us < INT64_C(1) << 26; us += 1 + us / 64)
+    {
+        unsigned bucket = vlc_latency_GetBucket(VLC_TICK_FROM_US(us));
+        assert(bucket == last || bucket == last + 1);
+        last = bucket;
+    }
+    assert(last == VLC_LATENCY_BUCKETS - 1);
+    assert(vlc_latency_GetBucket(VLC_TICK_FROM_SEC(3600))
+           == VLC_LATENCY_BUCKETS - 1);
+}
+
+static void test_stats(void)
+{
+    struct vlc_latency_histogram h = { 0 };
+
+    assert(vlc_latency_GetMean(&h) == 0);
+    assert(vlc_latency_GetJitter(&h) == 0);
+    assert(vlc_latency_GetPercentile(&h, 50) == 0);
+
+    /* constant values have no jitter */
+    for (int i = 0; i < 10; i++)
+        vlc_latency_Add(&h, VLC_TICK_FROM_US(1500));
+    assert(h.count == 10);
+    assert(vlc_latency_GetMean(&h) == VLC_TICK_FROM_US(1500));
+    assert(vlc_latency_GetJitter(&h) == 0);
+    assert(vlc_latency_GetPercentile(&h, 95) == VLC_TICK_FROM_US(1500));
+    assert(h.max == VLC_TICK_FROM_US(1500));
+
+    /* 1, 2, ..., 100 us: mean 50.5, standard deviation 28.87 */
+    struct vlc_latency_histogram ramp = { 0 };
+    for (int i = 1; i <= 100; i++)
+        vlc_latency_Add(&ramp, VLC_TICK_FROM_US(i));
+    assert(vlc_latency_GetMean(&ramp) == VLC_TICK_FROM_US(50));
+    assert(vlc_latency_GetJitter(&ramp) == VLC_TICK_FROM_US(29));
+    assert(vlc_latency_GetPercentile(&ramp, 100) == VLC_TICK_FROM_US(100));
+
+    /* the bound of the bucket, at most 25% above the exact percentile */
+    for (unsigned percent = 1; percent <= 100; percent++)
+    {
+        vlc_tick_t bound = vlc_latency_GetPercentile(&ramp, percent);
+        assert(bound >= VLC_TICK_FROM_US(percent));
+        assert(bound * 4 <= VLC_TICK_FROM_US(percent) * 5 + 4);
+    }
+
+    /* 95th percentile of 95 fast and 5 slow decodes */
+    struct vlc_latency_histogram decode = { 0 };
+    for (int i = 0; i < 95; i++)
+        vlc_latency_Add(&decode, VLC_TICK_FROM_US(300));
+    for (int i = 0; i < 5; i++)
+        vlc_latency_Add(&decode, VLC_TICK_FROM_MS(40));
+    vlc_tick_t p95 = vlc_latency_GetPercentile(&decode, 95);
+    assert(p95 >= VLC_TICK_FROM_US(300) && p95 <= VLC_TICK_FROM_US(320));
+    assert(vlc_latency_GetPercentile(&decode, 96) == VLC_TICK_FROM_MS(40));
+
+    /* merging is the same as adding all the samples */
+    struct vlc_latency_histogram merged = h;
+    vlc_latency_Merge(&merged, &ramp);
+
+    struct vlc_latency_histogram all = h;
+    for (int i = 1; i <= 100; i++)
+        vlc_latency_Add(&all, VLC_TICK_FROM_US(i));
+    assert(merged.count == all.count && merged.sum == all.sum
+        && merged.max == all.max && merged.sum_squares == all.sum_squares);
+    for (unsigned i = 0; i < VLC_LATENCY_BUCKETS; i++)
+        assert(merged.buckets[i] == all.buckets[i]);
+
+    /* early values count as zero */
+    struct vlc_latency_histogram early = { 0 };
+    vlc_latency_Add(&early, VLC_TICK_FROM_MS(-3));
+    assert(early.count == 1 && early.sum == 0 && early.buckets[0] == 1);
+}
+
+int main(void)
+{
+    test_buckets();
+    test_stats();
+    return 0;
+}
@@ -0,0 +1,274 @@
+/*****************************************************************************
+ * log_ring.c: Test for the deferred log messages queue
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include "../misc/log_ring.h"
+
+#define RING_SIZE    16
+#define THREADS      4
+#define BENCH_MSGS   50000
+
+static const vlc_log_t meta = {
+    .i_object_id = 42,
+    .psz_object_type = "test",
+    .psz_module = "log_ring",
+    .psz_header = NULL,
+    .file = __FILE__,
+    .line = -1,
+    .func = NULL,
+    .tid = 0,
+};
+
+static const char *expected;
+static unsigned popped;
+
+static void check_cb(void *opaque, int type, const vlc_log_t *item,
+                     const char *msg)
+{
+    assert(opaque == &popped);
+    assert(type == VLC_MSG_DBG);
+    assert(item->i_object_id == meta.i_object_id);
+    assert(!strcmp(item->psz_module, "log_ring"));
+    assert(item->psz_header == NULL || !strcmp(item->psz_header, "hdr"));
+
+    if (strcmp(msg, expected))
+    {
+        fprintf(stderr, "got \"%s\", expected \"%s\"\n", msg, expected);
+        abort();
+    }
+    popped++;
+}
+
+static bool push_meta(vlc_log_ring_t *ring, const vlc_log_t *m,
+                      const char *format, ...)
+{
+    va_list ap;
+    bool ret;
+
+    va_start(ap, format);
+    ret = vlc_log_ring_Push(ring, VLC_MSG_DBG, m, format, ap);
+    va_end(ap);
+    return ret;
+}
+
+#define push(ring, ...) push_meta(ring, &meta, __VA_ARGS__)
+
+static void test_format(vlc_log_ring_t *ring, const char *format, ...)
+{
+    va_list ap;
+    char *str;
+
+    va_start(ap, format);
+    assert(vasprintf(&str, format, ap) >= 0);
+    va_end(ap);
+
+    va_start(ap, format);
+    assert(vlc_log_ring_Push(ring, VLC_MSG_DBG, &meta, format, ap));
+    va_end(ap);
+
+    expected = str;
+    popped = 0;
+    assert(vlc_log_ring_Pop(ring, check_cb, &popped));
+    assert(popped == 1);
+    assert(!vlc_log_ring_Pop(ring, check_cb, &popped));
+    free(str);
+}
+
+static void test_formats(void)
+{
+    vlc_log_ring_t *ring = vlc_log_ring_New(RING_SIZE);
+    char str[] = "temporary string";
+    char big[1000];
+
+    assert(ring != NULL);
+    memset(big, 'b', sizeof (big) - 1);
+    big[sizeof (big) - 1] = '\0';
+
+    test_format(ring, "no argument");
+    test_format(ring, "percent %% sign %d%%", 100);
+    test_format(ring, "%d %i %u %x %X %o %c", -1, 2, 3u, 0xab, 0xcd, 8, 'z');
+    test_format(ring, "%hhd %hu %ld %llu %jd %zu %td", 300, 70000, -5L,
+                18446744073709551615ULL, INTMAX_MIN, (size_t)7,
+                (ptrdiff_t)-8);
+    test_format(ring, "%"PRId64" %"PRIu32" %"PRIx8, INT64_MIN, UINT32_MAX, 255);
+    test_format(ring, "%f %.3e %g %a %10.2Lf", 1.5, 12345.678, 0.1, 2.0,
+                (long double)3.25);
+    test_format(ring, "%-8d|%+d|% d|%#x|%08.3f", 5, 6, 7, 8, 9.0);
+    test_format(ring, "%*d|%-*d|%.*f|%*.*s|", 6, 1, 6, 2, 2, 3.14159, 8, 3,
+                str);
+    test_format(ring, "%s and %.4s then %s", str, str, (char *)NULL);
+    test_format(ring, "%p %p", (void *)ring, (void *)NULL);
+
+    /* String arguments must be copied, not referenced */
+    char *dup = strdup(str);
+    assert(dup != NULL);
+    test_format(ring, "[%s]", dup);
+    free(dup);
+
+    /* Precision bounds a string without nul terminator */
+    char unterminated[4] = { 'a', 'b', 'c', 'd' };
+    test_format(ring, "%.4s|%.*s", unterminated, 2, unterminated);
+
+    /* Fallbacks: too large, or not supported */
+    test_format(ring, "big: %s", big);
+    test_format(ring, "%2$s %1$s", "world", "hello");
+    test_format(ring, "%ls", L"wide");
+
+    vlc_log_ring_Delete(ring);
+}
+
+static void test_headers(void)
+{
+    vlc_log_ring_t *ring = vlc_log_ring_New(RING_SIZE);
+    vlc_log_t hmeta = meta;
+
+    assert(ring != NULL);
+    hmeta.psz_header = "hdr";
+    expected = "header 1";
+
+    assert(push_meta(ring, &hmeta, "header %d", 1));
+    popped = 0;
+    assert(vlc_log_ring_Pop(ring, check_cb, &popped));
+    assert(popped == 1);
+    vlc_log_ring_Delete(ring);
+}
+
+static void test_overflow(void)
+{
+    vlc_log_ring_t *ring = vlc_log_ring_New(RING_SIZE);
+
+    assert(ring != NULL);
+
+    for (unsigned i = 0; i < RING_SIZE; i++)
+        assert(push(ring, "message %u", i));
+    assert(!push(ring, "message %u", RING_SIZE)); /* full */
+
+    for (unsigned i = 0; i < RING_SIZE; i++)
+    {
+        char str[16];
+
+        snprintf(str, sizeof (str), "message %u", i);
+        expected = str;
+        popped = 0;
+        assert(vlc_log_ring_Pop(ring, check_cb, &popped));
+        assert(popped == 1);
+
+        assert(push(ring, "again"));
+    }
+
+    /* Queued records are discarded */
+    vlc_log_ring_Delete(ring);
+}
+
+struct bench
+{
+    vlc_log_ring_t *ring;
+    unsigned id;
+    unsigned full;
+};
+
+static void *producer(void *data)
+{
+    struct bench *b = data;
+
+    for (unsigned i = 0; i < BENCH_MSGS; i++)
+        while (!push(b->ring, "producer %u message %u %s", b->id, i,
+                     "payload"))
+        {
+            b->full++;
+            vlc_tick_wait(vlc_tick_now() + VLC_TICK_FROM_US(10));
+        }
+    return NULL;
+}
+
+static void count_cb(void *opaque, int type, const vlc_log_t *item,
+                     const char *msg)
+{
+    unsigned *next = opaque;
+    unsigned id, seq;
+
+    (void) type; (void) item;
+    assert(sscanf(msg, "producer %u message %u payload", &id, &seq) == 2);
+    assert(id < THREADS);
+    assert(seq == next[id]); /* per-thread order is preserved */
+    next[id]++;
+}
+
+static void test_threads(void)
+{
+    vlc_log_ring_t *ring = vlc_log_ring_New(256);
+    struct bench b[THREADS];
+    vlc_thread_t th[THREADS];
+    unsigned next[THREADS] = { 0 };
+    unsigned total = 0, full = 0;
+
+    assert(ring != NULL);
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < THREADS; i++)
+    {
+        b[i].ring = ring;
+        b[i].id = i;
+        b[i].full = 0;
+        assert(vlc_clone(&th[i], producer, &b[i],
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    }
+
+    while (total < THREADS * BENCH_MSGS)
+    {
+        if (vlc_log_ring_Pop(ring, count_cb, next))
+            total++;
+        else
+            vlc_log_ring_Wait(ring);
+    }
+
+    for (unsigned i = 0; i < THREADS; i++)
+    {
+        vlc_join(th[i], NULL);
+        assert(next[i] == BENCH_MSGS);
+        full += b[i].full;
+    }
+
+    fprintf(stderr, "log ring: %u messages in %"PRId64" ms (%u retries)\n",
+            total, MS_FROM_VLC_TICK(vlc_tick_now() - start), full);
+    assert(!vlc_log_ring_Pop(ring, count_cb, next));
+    vlc_log_ring_Delete(ring);
+}
+
+int main(void)
+{
+    test_formats();
+    test_headers();
+    test_overflow();
+    test_threads();
+    return 0;
+}
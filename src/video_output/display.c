@@ -426,7 +426,8 @@ picture_pool_t *vout_GetPool(vout_display_t *vd, unsigned count)
     vout_display_priv_t *osys = container_of(vd, vout_display_priv_t, display);
 
     if (osys->pool == NULL)
-        osys->pool = picture_pool_NewFromFormat(&vd->fmt, count);
+        osys->pool = vd->pool != NULL ? vd->pool(vd, count)
+                                      : picture_pool_NewFromFormat(&vd->fmt, count);
     return osys->pool;
 }
 
@@ -776,6 +777,7 @@ vout_display_t *vout_display_New(vlc_object_t *parent,
     video_format_Copy(&vd->source, source);
     vd->info = (vout_display_info_t){ };
     vd->cfg = &osys->cfg;
+    vd->pool = NULL;
     vd->prepare = NULL;
     vd->display = NULL;
     vd->control = NULL;
@@ -23,6 +23,7 @@
 #ifndef LIBVLC_VOUT_STATISTIC_H
 # define LIBVLC_VOUT_STATISTIC_H
 # include <stdatomic.h>
+# include <vlc_input_item.h>
 
 /* NOTE: Both statistics are atomic on their own, so one might be older than
  * the other one. Currently, only one of them is updated at a time, so this
@@ -30,12 +31,26 @@
 typedef struct {
     atomic_uint displayed;
     atomic_uint lost;
+
+    /* Only one picture at a time is timed through the decoder FIFO, so that
+     * queuing does not cost more than an atomic load per picture. */
+    atomic_uintptr_t queue_sample;
+    atomic_int_least64_t queue_sample_date;
+
+    vlc_mutex_t lock;
+    struct vlc_latency_histogram queue;
+    struct vlc_latency_histogram lateness;
 } vout_statistic_t;
 
 static inline void vout_statistic_Init(vout_statistic_t *stat)
 {
     atomic_init(&stat->displayed, 0);
     atomic_init(&stat->lost, 0);
+    atomic_init(&stat->queue_sample, 0);
+    atomic_init(&stat->queue_sample_date, 0);
+    vlc_mutex_init(&stat->lock);
+    memset(&stat->queue, 0, sizeof (stat->queue));
+    memset(&stat->lateness, 0, sizeof (stat->lateness));
 }
 
 static inline void vout_statistic_Clean(vout_statistic_t *stat)
@@ -64,4 +79,59 @@ static inline void vout_statistic_AddLost(vout_statistic_t *stat, int lost)
     atomic_fetch_add_explicit(&stat->lost, lost, memory_order_relaxed);
 }
 
+/* Called when a picture is queued, if no other picture is being timed */
+static inline void vout_statistic_QueuePicture(vout_statistic_t *stat,
+                                               const picture_t *picture)
+{
+    if (atomic_load_explicit(&stat->queue_sample, memory_order_acquire) != 0)
+        return;
+
+    atomic_store_explicit(&stat->queue_sample_date, vlc_tick_now(),
+                          memory_order_relaxed);
+    atomic_store_explicit(&stat->queue_sample, (uintptr_t)picture,
+                          memory_order_release);
+}
+
+/* Called when a picture is dequeued */
+static inline void vout_statistic_DequeuePicture(vout_statistic_t *stat,
+                                                 const picture_t *picture)
+{
+    if (atomic_load_explicit(&stat->queue_sample, memory_order_acquire)
+         != (uintptr_t)picture)
+        return;
+
+    vlc_tick_t wait = vlc_tick_now()
+        - atomic_load_explicit(&stat->queue_sample_date, memory_order_relaxed);
+
+    atomic_store_explicit(&stat->queue_sample, 0, memory_order_release);
+    vlc_mutex_lock(&stat->lock);
+    vlc_latency_Add(&stat->queue, wait);
+    vlc_mutex_unlock(&stat->lock);
+}
+
+/* Called when queued pictures are dropped */
+static inline void vout_statistic_FlushQueue(vout_statistic_t *stat)
+{
+    atomic_store_explicit(&stat->queue_sample, 0, memory_order_relaxed);
+}
+
+static inline void vout_statistic_AddLateness(vout_statistic_t *stat,
+                                              vlc_tick_t late)
+{
+    vlc_mutex_lock(&stat->lock);
+    vlc_latency_Add(&stat->lateness, late);
+    vlc_mutex_unlock(&stat->lock);
+}
+
+static inline void vout_statistic_GetResetLatency(vout_statistic_t *stat,
+                                                  struct vlc_es_latency *lat)
+{
+    vlc_mutex_lock(&stat->lock);
+    vlc_latency_Merge(&lat->stages[VLC_LATENCY_VOUT_QUEUE], &stat->queue);
+    vlc_latency_Merge(&lat->stages[VLC_LATENCY_LATENESS], &stat->lateness);
+    memset(&stat->queue, 0, sizeof (stat->queue));
+    memset(&stat->lateness, 0, sizeof (stat->lateness));
+    vlc_mutex_unlock(&stat->lock);
+}
+
 #endif
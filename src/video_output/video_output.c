@@ -48,6 +48,7 @@
 #include <vlc_image.h>
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
+#include <vlc_tracer.h>
 
 #include <libvlc.h>
 #include "vout_internal.h"
@@ -221,6 +222,12 @@ void vout_GetResetStatistic(vout_thread_t *vout, unsigned *restrict displayed,
     vout_statistic_GetReset( &vout->p->statistic, displayed, lost );
 }
 
+void vout_GetResetLatency(vout_thread_t *vout, struct vlc_es_latency *latency)
+{
+    assert(!vout->p->dummy);
+    vout_statistic_GetResetLatency(&vout->p->statistic, latency);
+}
+
 bool vout_IsEmpty(vout_thread_t *vout)
 {
     assert(!vout->p->dummy);
@@ -347,6 +354,7 @@ void vout_PutPicture(vout_thread_t *vout, picture_t *picture)
 {
     assert(!vout->p->dummy);
     picture->p_next = NULL;
+    vout_statistic_QueuePicture(&vout->p->statistic, picture);
     picture_fifo_Push(vout->p->decoder_fifo, picture);
     vout_control_Wake(&vout->p->control);
 }
@@ -894,6 +902,7 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse,
             decoded = picture_fifo_Pop(vout->p->decoder_fifo);
 
             if (decoded) {
+                vout_statistic_DequeuePicture(&vout->p->statistic, decoded);
                 if (is_late_dropped && !decoded->b_force) {
                     const vlc_tick_t date = vlc_tick_now();
                     const vlc_tick_t system_pts =
@@ -919,6 +928,10 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse,
                         late_threshold = VOUT_DISPLAY_LATE_THRESHOLD;
                     if (late > late_threshold) {
                         msg_Warn(vout, "picture is too late to be displayed (missing %"PRId64" ms)", MS_FROM_VLC_TICK(late));
+                        vlc_tracer_Instant(sys->tracer, "vout", "late drop",
+                                           sys->trace_id,
+                                           decoded->date);
+                        vout_statistic_AddLateness(&vout->p->statistic, late);
                         picture_Release(decoded);
                         vout_statistic_AddLost(&vout->p->statistic, 1);
                         continue;
@@ -953,7 +966,10 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse,
         vout->p->displayed.timestamp     = decoded->date;
         vout->p->displayed.is_interlaced = !decoded->b_progressive;
 
+        vlc_tick_t start = vlc_tracer_Now(sys->tracer);
         picture = filter_chain_VideoFilter(vout->p->filter.chain_static, decoded);
+        vlc_tracer_Span(sys->tracer, "vout", "static filters", start,
+                        sys->trace_id, vout->p->displayed.timestamp);
     }
 
     vlc_mutex_unlock(&vout->p->filter.lock);
@@ -1040,9 +1056,12 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
 
     vout_chrono_Start(&sys->render);
 
+    vlc_tick_t start = vlc_tracer_Now(sys->tracer);
     vlc_mutex_lock(&sys->filter.lock);
     picture_t *filtered = filter_chain_VideoFilter(sys->filter.chain_interactive, torender);
     vlc_mutex_unlock(&sys->filter.lock);
+    vlc_tracer_Span(sys->tracer, "vout", "interactive filters", start,
+                    sys->trace_id, sys->displayed.current->date);
 
     if (!filtered)
         return VLC_EGENERIC;
@@ -1220,7 +1239,12 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     const unsigned frame_rate_base = todisplay->format.i_frame_rate_base;
 
     if (vd->prepare != NULL)
+    {
+        start = vlc_tracer_Now(sys->tracer);
         vd->prepare(vd, todisplay, do_dr_spu ? subpic : NULL, system_pts);
+        vlc_tracer_Span(sys->tracer, "vout", "prepare", start, sys->trace_id,
+                        pts);
+    }
 
     vout_chrono_Stop(&sys->render);
 #if 0
@@ -1235,6 +1259,7 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     system_now = vlc_tick_now();
     if (!is_forced)
     {
+        vout_statistic_AddLateness(&sys->statistic, system_now - system_pts);
         if (unlikely(system_now > system_pts))
         {
             /* vd->prepare took too much time. Tell the clock that the pts was
@@ -1262,7 +1287,10 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
                           frame_rate, frame_rate_base);
 
     /* Display the direct buffer returned by vout_RenderPicture */
+    start = vlc_tracer_Now(sys->tracer);
     vout_display_Display(vd, todisplay);
+    vlc_tracer_Span(sys->tracer, "vout", "display", start, sys->trace_id,
+                    pts);
     vlc_mutex_unlock(&sys->display_lock);
 
     if (subpic)
@@ -1404,6 +1432,7 @@ static void vout_FlushUnlocked(vout_thread_t *vout, bool below,
     }
 
     picture_fifo_Flush(sys->decoder_fifo, date, below);
+    vout_statistic_FlushQueue(&sys->statistic);
 
     assert(sys->display != NULL);
     vlc_mutex_lock(&sys->display_lock);
@@ -1542,6 +1571,7 @@ static int vout_Start(vout_thread_t *vout, vlc_video_context *vctx, const vout_c
     vlc_mouse_Init(&sys->mouse);
 
     sys->decoder_fifo = picture_fifo_New();
+    vout_statistic_FlushQueue(&sys->statistic);
     sys->display_pool = NULL;
     sys->private_pool = NULL;
 
@@ -1909,6 +1939,8 @@ vout_thread_t *vout_Create(vlc_object_t *object)
     sys->source.crop.mode = VOUT_CROP_NONE;
     sys->snapshot = vout_snapshot_New();
     vout_statistic_Init(&sys->statistic);
+    sys->tracer = vlc_object_get_tracer(vout);
+    sys->trace_id = 0;
 
     /* Initialize subpicture unit */
     sys->spu = var_InheritBool(vout, "spu") || var_InheritBool(vout, "osd") ?
@@ -2053,6 +2085,7 @@ int vout_Request(const vout_configuration_t *cfg, vlc_video_context *vctx, input
     sys->delay = 0;
     sys->rate = 1.f;
     sys->clock = cfg->clock;
+    sys->trace_id = cfg->trace_id;
     sys->delay = 0;
 
     if (vout_Start(vout, vctx, cfg))
@@ -51,6 +51,7 @@ typedef struct {
     const video_format_t *fmt;
     vlc_mouse_event      mouse_event;
     void                 *mouse_opaque;
+    int                  trace_id; /* ES identifier of the traces */
 } vout_configuration_t;
 #include "control.h"
 
@@ -107,6 +108,8 @@ struct vout_thread_sys_t
 
     /* Statistics */
     vout_statistic_t statistic;
+    struct vlc_tracer *tracer;
+    uintptr_t trace_id;
 
     /* Subpicture unit */
     vlc_mutex_t     spu_lock;
@@ -330,6 +333,13 @@ void vout_MouseState(vout_thread_t *, const vlc_mouse_t *);
 void vout_GetResetStatistic( vout_thread_t *p_vout, unsigned *pi_displayed,
                              unsigned *pi_lost );
 
+/**
+ * This function will add the internal latency statistics to \p latency and
+ * reset them.
+ */
+void vout_GetResetLatency( vout_thread_t *p_vout,
+                           struct vlc_es_latency *latency );
+
 /**
  * This function will force to display the next picture while paused
  */
@@ -209,6 +209,69 @@ static void test_media_player_pause_stop(const char** argv, int argc)
     libvlc_release (vlc);
 }
 
+static void test_latency_stats(const libvlc_latency_stats_t *stats)
+{
+    assert(stats->i_mean >= 0 && stats->i_mean <= stats->i_max);
+    assert(stats->i_jitter >= 0 && stats->i_jitter <= stats->i_max);
+    assert(stats->i_p95 <= stats->i_max);
+    if (stats->i_samples == 0)
+        assert(stats->i_max == 0);
+}
+
+static void test_media_player_track_latency(const char** argv, int argc)
+{
+    test_log ("Testing track latency\n");
+
+    libvlc_instance_t *vlc = libvlc_new (argc, argv);
+    assert (vlc != NULL);
+
+    libvlc_media_t *md = libvlc_media_new_location (vlc,
+        "mock://video_track_count=1;audio_track_count=0;length=100000000");
+    assert (md != NULL);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media (md);
+    assert (mp != NULL);
+    libvlc_media_release (md);
+
+    /* The statistics are sent with the times */
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    vlc_sem_t sem;
+    vlc_sem_init(&sem, 0);
+    int res = libvlc_event_attach(em, libvlc_MediaPlayerTimeChanged,
+                                  on_event, &sem);
+    assert(!res);
+
+    libvlc_track_latency_t latency;
+    play_and_wait(mp);
+
+    int track;
+    while ((track = libvlc_video_get_track(mp)) == -1)
+        vlc_sem_wait(&sem);
+    assert(!libvlc_media_player_get_track_latency(mp, track + 1, &latency));
+
+    while (!libvlc_media_player_get_track_latency(mp, track, &latency)
+        || latency.decode.i_samples == 0
+        || latency.lateness.i_samples == 0)
+        vlc_sem_wait(&sem);
+    libvlc_event_detach(em, libvlc_MediaPlayerTimeChanged, on_event, &sem);
+
+    test_latency_stats(&latency.decoder_queue);
+    test_latency_stats(&latency.decode);
+    test_latency_stats(&latency.vout_queue);
+    test_latency_stats(&latency.lateness);
+    test_latency_stats(&latency.aout_depth);
+    assert(latency.decode.i_max > 0);
+    assert(latency.aout_depth.i_samples == 0); /* video only */
+
+    test_log ("decode: %"PRIu64" samples, mean %"PRId64" us, "
+              "p95 %"PRId64" us, max %"PRId64" us\n",
+              latency.decode.i_samples, latency.decode.i_mean,
+              latency.decode.i_p95, latency.decode.i_max);
+
+    libvlc_media_player_stop_async (mp);
+    libvlc_media_player_release (mp);
+    libvlc_release (vlc);
+}
 
 int main (void)
 {
@@ -217,6 +280,7 @@ int main (void)
     test_media_player_set_media (test_defaults_args, test_defaults_nargs);
     test_media_player_play_stop (test_defaults_args, test_defaults_nargs);
     test_media_player_pause_stop (test_defaults_args, test_defaults_nargs);
+    test_media_player_track_latency (test_defaults_args, test_defaults_nargs);
 
     return 0;
 }
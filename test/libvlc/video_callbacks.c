@@ -0,0 +1,184 @@
+/*****************************************************************************
+ * video_callbacks.c: libvlc video callbacks test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "test.h"
+#include <vlc_common.h>
+
+#include <inttypes.h>
+#include <string.h>
+
+#define WIDTH  3840
+#define HEIGHT 2160
+#define FRAMES 50
+#define MAX_BUFFERS 64
+
+struct vmem
+{
+    bool pool;
+    vlc_sem_t done;
+    unsigned frames;
+    vlc_tick_t start;
+    vlc_tick_t end;
+
+    void *buffers[MAX_BUFFERS];
+    bool locked[MAX_BUFFERS];
+    unsigned count;
+};
+
+static unsigned Setup(void **opaque, char *chroma, unsigned *width,
+                      unsigned *height, unsigned *pitches, unsigned *lines)
+{
+    (void) opaque;
+    /* 4K pictures, converted to RGB as most processing expects */
+    memcpy(chroma, "RV32", 4);
+    *width = WIDTH;
+    *height = HEIGHT;
+    pitches[0] = WIDTH * 4;
+    lines[0] = HEIGHT;
+    return 1;
+}
+
+static void *Lock(void *opaque, void **planes)
+{
+    struct vmem *vmem = opaque;
+
+    /* Without pool, the same buffer is locked for every picture */
+    if (vmem->pool || vmem->count == 0)
+    {
+        assert(vmem->count < MAX_BUFFERS);
+        void *buf = malloc(WIDTH * 4 * HEIGHT);
+        assert(buf != NULL);
+        vmem->buffers[vmem->count++] = buf;
+    }
+    unsigned i = vmem->count - 1;
+    assert(!vmem->locked[i]);
+    vmem->locked[i] = true;
+    planes[0] = vmem->buffers[i];
+    return vmem->buffers[i];
+}
+
+static void Unlock(void *opaque, void *id, void *const *planes)
+{
+    struct vmem *vmem = opaque;
+
+    assert(id == planes[0]);
+    for (unsigned i = 0; i < vmem->count; i++)
+        if (vmem->buffers[i] == id)
+        {
+            assert(vmem->locked[i]);
+            vmem->locked[i] = false;
+            return;
+        }
+    assert(!"unknown buffer");
+}
+
+static void Display(void *opaque, void *id)
+{
+    struct vmem *vmem = opaque;
+    bool known = false;
+
+    for (unsigned i = 0; i < vmem->count; i++)
+        known |= vmem->buffers[i] == id;
+    assert(known);
+
+    /* Measure from the first picture, once the pipeline is running */
+    if (vmem->frames == 0)
+        vmem->start = vlc_tick_now();
+    if (++vmem->frames == FRAMES + 1)
+    {
+        vmem->end = vlc_tick_now();
+        vlc_sem_post(&vmem->done);
+    }
+}
+
+static void Cleanup(void *opaque)
+{
+    struct vmem *vmem = opaque;
+
+    /* All the buffers are given back first */
+    for (unsigned i = 0; i < vmem->count; i++)
+    {
+        assert(!vmem->locked[i] || !vmem->pool);
+        free(vmem->buffers[i]);
+    }
+    vmem->count = 0;
+}
+
+/* Returns false if no picture reached the display callback */
+static bool test_decode(libvlc_instance_t *vlc, bool pool)
+{
+    struct vmem vmem = { .pool = pool };
+    vlc_sem_init(&vmem.done, 0);
+
+    libvlc_media_t *md = libvlc_media_new_location(vlc,
+        "mock://video_track_count=1;length=100000000;video_chroma=I420"
+        ";video_width=3840;video_height=2160;video_frame_rate=1000");
+    assert(md != NULL);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    libvlc_video_set_callbacks(mp, Lock, Unlock, Display, &vmem);
+    libvlc_video_set_format_callbacks(mp, Setup, Cleanup);
+    libvlc_video_set_pool(mp, pool);
+
+    libvlc_media_player_play(mp);
+    int timeout = vlc_sem_timedwait(&vmem.done,
+                                    vlc_tick_now() + VLC_TICK_FROM_SEC(10));
+    libvlc_media_player_stop_async(mp);
+    libvlc_media_player_release(mp);
+    assert(vmem.count == 0);
+
+    if (timeout)
+    {
+        test_log("%s: %u pictures only\n", pool ? "pool" : "copy",
+                 vmem.frames);
+        /* without any picture, there is no converter to RV32 */
+        assert(vmem.frames == 0);
+        return false;
+    }
+
+    vlc_tick_t time = vmem.end - vmem.start;
+    test_log("%s: %d 4K pictures in %" PRId64 " us, %.1f fps\n",
+             pool ? "pool" : "copy", FRAMES, US_FROM_VLC_TICK(time),
+             FRAMES / secf_from_vlc_tick(time));
+    return true;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    /* skipped without a converter to RV32, the pool needs one too */
+    bool ok = test_decode(vlc, false);
+    if (ok)
+    {
+        ok = test_decode(vlc, true);
+        assert(ok);
+    }
+
+    libvlc_release(vlc);
+    return ok ? 0 : 77;
+}
@@ -0,0 +1,179 @@
+/*****************************************************************************
+ * uring.c: test the io_uring file access
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <liburing.h>
+#include <stdio.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_stream.h>
+
+/* not a multiple of the block size, nor of the alignment */
+#define FILE_SIZE (3 * 1024 * 1024 + 12345)
+#define READ_SIZE 10007
+
+static char file_path[] = "/tmp/vlc-test-uring-XXXXXX";
+
+static uint8_t pattern(uint64_t offset)
+{
+    return offset ^ (offset >> 9) ^ (offset >> 17);
+}
+
+static void create_file(void)
+{
+    int fd = mkstemp(file_path);
+    assert(fd != -1);
+
+    uint8_t *buf = malloc(FILE_SIZE);
+    assert(buf != NULL);
+    for (uint64_t i = 0; i < FILE_SIZE; i++)
+        buf[i] = pattern(i);
+
+    ssize_t val = write(fd, buf, FILE_SIZE);
+    assert(val == FILE_SIZE);
+    free(buf);
+    close(fd);
+}
+
+/* Reads from the current position, and checks the data is in order */
+static size_t check_read(stream_t *s, size_t len)
+{
+    uint8_t buf[READ_SIZE];
+    uint64_t offset = vlc_stream_Tell(s);
+
+    assert(len <= sizeof (buf));
+    ssize_t val = vlc_stream_Read(s, buf, len);
+    assert(val >= 0);
+
+    for (ssize_t i = 0; i < val; i++)
+        assert(buf[i] == pattern(offset + i));
+    assert(vlc_stream_Tell(s) == offset + val);
+    return val;
+}
+
+static void test_sequential(stream_t *s)
+{
+    uint64_t total = 0;
+    size_t val;
+
+    while ((val = check_read(s, READ_SIZE)) > 0)
+        total += val;
+    assert(total == FILE_SIZE);
+    assert(vlc_stream_Eof(s));
+}
+
+static void test_seek(stream_t *s)
+{
+    uint64_t offset = 0;
+
+    /* unaligned, backward and forward */
+    for (unsigned i = 0; i < 200; i++)
+    {
+        offset = (offset * 6364136223846793005ULL + 1442695040888963407ULL);
+        uint64_t pos = (offset >> 33) % FILE_SIZE;
+
+        assert(vlc_stream_Seek(s, pos) == 0);
+        size_t len = __MIN(READ_SIZE, FILE_SIZE - pos);
+        assert(check_read(s, READ_SIZE) == len);
+
+        /* within the next queued block */
+        if (pos + 2 * READ_SIZE + 100 < FILE_SIZE)
+        {
+            assert(vlc_stream_Seek(s, pos + READ_SIZE + 100) == 0);
+            assert(check_read(s, READ_SIZE) == READ_SIZE);
+        }
+    }
+
+    /* beyond the end */
+    assert(vlc_stream_Seek(s, FILE_SIZE + 1) == 0);
+    assert(check_read(s, READ_SIZE) == 0);
+
+    /* back to the start after the end of file */
+    assert(vlc_stream_Seek(s, 0) == 0);
+    assert(check_read(s, READ_SIZE) == READ_SIZE);
+}
+
+static void test_access(const char *const *extra_args, unsigned extra_count)
+{
+    const char *args[test_defaults_nargs + 4];
+    unsigned count = 0;
+
+    for (int i = 0; i < test_defaults_nargs; i++)
+        args[count++] = test_defaults_args[i];
+    assert(extra_count <= 4);
+    for (unsigned i = 0; i < extra_count; i++)
+        args[count++] = extra_args[i];
+
+    libvlc_instance_t *vlc = libvlc_new(count, args);
+    assert(vlc != NULL);
+
+    char *mrl;
+    int ret = asprintf(&mrl, "uring://%s", file_path);
+    assert(ret != -1);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    stream_t *s = vlc_access_NewMRL(obj, mrl);
+    assert(s != NULL);
+    uint64_t size;
+    assert(vlc_stream_GetSize(s, &size) == 0 && size == FILE_SIZE);
+    test_sequential(s);
+    test_seek(s);
+    vlc_stream_Delete(s);
+
+    /* closed with reads in flight */
+    s = vlc_access_NewMRL(obj, mrl);
+    assert(s != NULL);
+    assert(check_read(s, READ_SIZE) == READ_SIZE);
+    assert(vlc_stream_Seek(s, FILE_SIZE / 2) == 0);
+    assert(check_read(s, READ_SIZE) == READ_SIZE);
+    vlc_stream_Delete(s);
+
+    free(mrl);
+    libvlc_release(vlc);
+}
+
+int main(void)
+{
+    struct io_uring ring;
+
+    if (io_uring_queue_init(1, &ring, 0) < 0)
+        return 77; /* the kernel lacks io_uring, or it is disabled */
+    io_uring_queue_exit(&ring);
+
+    test_init();
+    create_file();
+
+    static const char *const small_args[] = {
+        "--uring-block-size=4", "--uring-depth=8",
+    };
+    static const char *const direct_args[] = {
+        "--uring-direct", "--uring-depth=2",
+    };
+
+    test_access(NULL, 0);
+    test_access(small_args, ARRAY_SIZE(small_args));
+    test_access(direct_args, ARRAY_SIZE(direct_args));
+
+    unlink(file_path);
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*****************************************************************************
+ * biquad.c: biquad filters SIMD implementations test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../modules/audio_filter/biquad.h"
+
+#define RATE   48000
+#define FRAMES 1024
+#define BANDS  10
+#define STAGES 5
+
+static const float frequencies[BANDS] = {
+    60, 170, 310, 600, 1000, 3000, 6000, 12000, 14000, 16000,
+};
+
+struct bank_coeffs
+{
+    float alpha[BANDS], beta[BANDS], gamma[BANDS], amp[BANDS];
+};
+
+/* Same design as the equalizer, one octave per band */
+static void bank_Init(struct bank_coeffs *c, biquad_bank_t *bank)
+{
+    const float octave = powf(2.f, .5f);
+    for (unsigned i = 0; i < BANDS; i++)
+    {
+        float theta1 = 2.f * (float)M_PI * frequencies[i] / RATE;
+        float theta2 = theta1 / octave;
+        float sin_prd = sinf(theta2 * .5f * (octave + 1.f))
+                      * sinf(theta2 * .5f * (octave - 1.f));
+        float sin_hlf = sinf(theta2) * .5f;
+        float den = sin_hlf + sin_prd;
+
+        c->alpha[i] = sin_prd / den;
+        c->beta[i] = (sin_hlf - sin_prd) / den;
+        c->gamma[i] = sinf(theta2) * cosf(theta1) / den;
+        c->amp[i] = .25f * (powf(10.f, ((int)i - 5) / 20.f) - 1.f);
+    }
+    bank->bands = BANDS;
+    bank->alpha = c->alpha;
+    bank->beta = c->beta;
+    bank->gamma = c->gamma;
+    bank->amp = c->amp;
+}
+
+/* RBJ peaking filters, as in the parametric equalizer */
+static void cascade_Init(float *coeffs, biquad_cascade_t *cascade)
+{
+    for (unsigned i = 0; i < STAGES; i++)
+    {
+        float A = powf(10.f, (3.f * i - 6.f) / 40.f);
+        float w0 = 2.f * (float)M_PI * frequencies[2 * i] / RATE;
+        float alpha = sinf(w0) / (2.f * 3.f);
+        float a0 = 1.f + alpha / A;
+
+        coeffs[5 * i + 0] = (1.f + alpha * A) / a0;
+        coeffs[5 * i + 1] = -2.f * cosf(w0) / a0;
+        coeffs[5 * i + 2] = (1.f - alpha * A) / a0;
+        coeffs[5 * i + 3] = -2.f * cosf(w0) / a0;
+        coeffs[5 * i + 4] = (1.f - alpha / A) / a0;
+    }
+    cascade->stages = STAGES;
+    cascade->coeffs = coeffs;
+}
+
+static void signal_Fill(float *buf, unsigned frames, unsigned channels,
+                        uint32_t *seed)
+{
+    for (unsigned i = 0; i < frames * channels; i++)
+    {
+        *seed = *seed * 1103515245 + 12345;
+        buf[i] = ((int32_t)*seed >> 8) / (float)(1 << 23);
+    }
+}
+
+static void test_bitexact(unsigned channels)
+{
+    struct bank_coeffs bc;
+    biquad_bank_t bank;
+    float coeffs[5 * STAGES];
+    biquad_cascade_t cascade;
+    static float ref[FRAMES * BIQUAD_MAX_CHANNELS];
+    static float out[FRAMES * BIQUAD_MAX_CHANNELS];
+    const biquad_impl_t *c = biquad_GetImpl(channels, false);
+    const biquad_impl_t *simd = biquad_GetImpl(channels, true);
+
+    bank_Init(&bc, &bank);
+    cascade_Init(coeffs, &cascade);
+
+    float *bank_ref = biquad_BankStateNew(BANDS, channels);
+    float *bank_out = biquad_BankStateNew(BANDS, channels);
+    float *cascade_ref = biquad_CascadeStateNew(STAGES, channels);
+    float *cascade_out = biquad_CascadeStateNew(STAGES, channels);
+    assert(bank_ref && bank_out && cascade_ref && cascade_out);
+
+    uint32_t seed = channels;
+    for (unsigned block = 0; block < 16; block++)
+    {
+        /* the last blocks are silent: the states decay towards zero */
+        if (block < 12)
+            signal_Fill(ref, FRAMES, channels, &seed);
+        else
+            memset(ref, 0, sizeof (ref));
+        memcpy(out, ref, FRAMES * channels * sizeof (float));
+
+        biquad_BankProcess(c, &bank, bank_ref, ref, FRAMES, channels,
+                           .25f, 1.5f);
+        biquad_BankProcess(simd, &bank, bank_out, out, FRAMES, channels,
+                           .25f, 1.5f);
+        biquad_CascadeProcess(c, &cascade, cascade_ref, ref, FRAMES,
+                              channels);
+        biquad_CascadeProcess(simd, &cascade, cascade_out, out, FRAMES,
+                              channels);
+        assert(!memcmp(ref, out, FRAMES * channels * sizeof (float)));
+
+        /* but never through denormals */
+        for (unsigned i = 0; i < (2 + 2 * BANDS) * biquad_Lanes(channels); i++)
+            assert(fpclassify(bank_out[i]) != FP_SUBNORMAL);
+        for (unsigned i = 0; i < 4 * STAGES * biquad_Lanes(channels); i++)
+            assert(fpclassify(cascade_out[i]) != FP_SUBNORMAL);
+    }
+
+    aligned_free(bank_ref);
+    aligned_free(bank_out);
+    aligned_free(cascade_ref);
+    aligned_free(cascade_out);
+}
+
+static void bench(const biquad_impl_t *impl, unsigned channels)
+{
+    struct bank_coeffs bc;
+    biquad_bank_t bank;
+    float coeffs[5 * STAGES];
+    biquad_cascade_t cascade;
+    static float buf[FRAMES * BIQUAD_MAX_CHANNELS];
+    const unsigned blocks = 10 * RATE / FRAMES; /* 10 seconds */
+
+    bank_Init(&bc, &bank);
+    cascade_Init(coeffs, &cascade);
+    float *bank_state = biquad_BankStateNew(BANDS, channels);
+    float *cascade_state = biquad_CascadeStateNew(STAGES, channels);
+    assert(bank_state && cascade_state);
+
+    uint32_t seed = 1;
+    signal_Fill(buf, FRAMES, channels, &seed);
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < blocks; i++)
+        biquad_BankProcess(impl, &bank, bank_state, buf, FRAMES, channels,
+                           .25f, 1.f);
+    vlc_tick_t bank_time = vlc_tick_now() - start;
+
+    start = vlc_tick_now();
+    for (unsigned i = 0; i < blocks; i++)
+        biquad_CascadeProcess(impl, &cascade, cascade_state, buf, FRAMES,
+                              channels);
+    vlc_tick_t cascade_time = vlc_tick_now() - start;
+
+    printf("%-4s %2u channels, 10s: bank %6" PRId64 " us, cascade %6" PRId64
+           " us\n", biquad_ImplName(impl), channels,
+           US_FROM_VLC_TICK(bank_time), US_FROM_VLC_TICK(cascade_time));
+
+    aligned_free(bank_state);
+    aligned_free(cascade_state);
+}
+
+int main(void)
+{
+    static const unsigned channels[] = { 1, 2, 6, 8, 11, BIQUAD_MAX_CHANNELS };
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+        test_bitexact(channels[i]);
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        const biquad_impl_t *c = biquad_GetImpl(channels[i], false);
+        const biquad_impl_t *simd = biquad_GetImpl(channels[i], true);
+
+        bench(c, channels[i]);
+        if (simd != c)
+            bench(simd, channels[i]);
+    }
+    return 0;
+}
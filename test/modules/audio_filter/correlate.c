@@ -0,0 +1,192 @@
+/*****************************************************************************
+ * correlate.c: scaletempo overlap search test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../modules/audio_filter/correlate.h"
+
+/* scaletempo defaults */
+#define MS_STRIDE  30
+#define OVERLAP    .20
+#define MS_SEARCH  14
+
+struct search
+{
+    unsigned channels;
+    unsigned frames_overlap;
+    unsigned frames_search;
+    unsigned frames_stride;
+    float *window;
+    float *pattern;
+    float *signal;
+    size_t signal_frames;
+};
+
+/* A few tones and some noise, different on each channel */
+static void signal_Fill(float *buf, size_t frames, unsigned channels,
+                        unsigned rate)
+{
+    uint32_t seed = rate + channels;
+
+    for (size_t n = 0; n < frames; n++)
+        for (unsigned c = 0; c < channels; c++)
+        {
+            float t = (float)n / rate;
+            seed = seed * 1103515245 + 12345;
+            *buf++ = .4f * sinf(2.f * (float)M_PI * (220.f + 55.f * c) * t)
+                   + .2f * sinf(2.f * (float)M_PI * 1234.5f * t + c)
+                   + .1f * ((int32_t)seed >> 8) / (float)(1 << 23);
+        }
+}
+
+static void search_Init(struct search *s, unsigned rate, unsigned channels,
+                        unsigned seconds)
+{
+    s->channels = channels;
+    s->frames_stride = MS_STRIDE * rate / 1000;
+    s->frames_overlap = s->frames_stride * OVERLAP;
+    s->frames_search = MS_SEARCH * rate / 1000;
+    s->signal_frames = (size_t)seconds * rate + s->frames_search
+                     + s->frames_overlap;
+
+    s->window = malloc((s->frames_overlap - 1) * channels * sizeof (float));
+    s->pattern = malloc((s->frames_overlap - 1) * channels * sizeof (float));
+    s->signal = malloc(s->signal_frames * channels * sizeof (float));
+    assert(s->window != NULL && s->pattern != NULL && s->signal != NULL);
+
+    float *pw = s->window;
+    for (unsigned i = 1; i < s->frames_overlap; i++)
+        for (unsigned c = 0; c < channels; c++)
+            *pw++ = i * (s->frames_overlap - i);
+
+    signal_Fill(s->signal, s->signal_frames, channels, rate);
+}
+
+static void search_Clean(struct search *s)
+{
+    free(s->window);
+    free(s->pattern);
+    free(s->signal);
+}
+
+/* Same as scaletempo: the windowed overlap of a previous position is matched
+ * against the positions following the next stride */
+static unsigned search_Run(const struct search *s,
+                           const correlate_impl_t *impl, size_t frame)
+{
+    const unsigned samples = (s->frames_overlap - 1) * s->channels;
+    const float *po = &s->signal[(frame + 1) * s->channels];
+
+    for (unsigned i = 0; i < samples; i++)
+        s->pattern[i] = s->window[i] * po[i];
+
+    return correlate_BestOffset(impl, s->pattern, samples,
+                                &s->signal[(frame + s->frames_stride / 2 + 1)
+                                           * s->channels],
+                                s->frames_search, s->channels);
+}
+
+static void test_offsets(unsigned rate, unsigned channels)
+{
+    const correlate_impl_t *c = correlate_GetImpl(false);
+    const correlate_impl_t *simd = correlate_GetImpl(true);
+    struct search s;
+    unsigned found = 0;
+
+    search_Init(&s, rate, channels, 1);
+
+    for (size_t frame = 0;
+         frame + s.frames_stride + s.frames_search + s.frames_overlap
+             < s.signal_frames;
+         frame += s.frames_stride / 3)
+    {
+        unsigned ref = search_Run(&s, c, frame);
+        unsigned off = search_Run(&s, simd, frame);
+
+        assert(ref == off);
+        assert(off < s.frames_search);
+        found |= off != 0;
+    }
+    assert(found);
+
+    /* A silent pattern correlates nowhere: the first position is kept */
+    memset(s.pattern, 0, (s.frames_overlap - 1) * channels * sizeof (float));
+    assert(correlate_BestOffset(simd, s.pattern,
+                                (s.frames_overlap - 1) * channels, s.signal,
+                                s.frames_search, channels) == 0);
+
+    search_Clean(&s);
+}
+
+static void bench(const correlate_impl_t *impl, unsigned rate,
+                  unsigned channels)
+{
+    struct search s;
+
+    search_Init(&s, rate, channels, 10);
+
+    /* 10 seconds of output at normal speed */
+    vlc_tick_t start = vlc_tick_now();
+    for (size_t frame = 0;
+         frame + s.frames_stride + s.frames_search + s.frames_overlap
+             < s.signal_frames;
+         frame += s.frames_stride)
+        search_Run(&s, impl, frame);
+    vlc_tick_t time = vlc_tick_now() - start;
+
+    printf("%-4s %6u Hz %u channels, 10s: %7" PRId64 " us\n",
+           correlate_ImplName(impl), rate, channels, US_FROM_VLC_TICK(time));
+
+    search_Clean(&s);
+}
+
+int main(void)
+{
+    static const unsigned rates[] = { 22050, 44100, 48000, 96000 };
+    static const unsigned channels[] = { 1, 2, 6, 8 };
+    const correlate_impl_t *c = correlate_GetImpl(false);
+    const correlate_impl_t *simd = correlate_GetImpl(true);
+
+    for (size_t i = 0; i < ARRAY_SIZE(rates); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(channels); j++)
+            test_offsets(rates[i], channels[j]);
+
+    for (size_t i = 0; i < ARRAY_SIZE(rates); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(channels); j++)
+        {
+            bench(c, rates[i], channels[j]);
+            if (simd != c)
+                bench(simd, rates[i], channels[j]);
+        }
+    return 0;
+}
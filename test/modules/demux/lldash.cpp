@@ -0,0 +1,257 @@
+/*****************************************************************************
+ * lldash.cpp: low latency DASH chunked transfer and catch-up test
+ *****************************************************************************
+ * Copyright (C) 2020 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <sys/types.h>
+#ifdef HAVE_SYS_SOCKET_H
+# include <sys/socket.h>
+#endif
+#ifdef HAVE_NETINET_IN_H
+# include <netinet/in.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_network.h>
+#include <vlc_tls.h>
+#include "../../../lib/libvlc_internal.h"
+#include <vlc/vlc.h>
+
+#include "../modules/demux/adaptive/http/HTTPConnection.hpp"
+#include "../modules/demux/adaptive/http/Transport.hpp"
+#include "../modules/demux/adaptive/logic/CatchUpLogic.hpp"
+
+using namespace adaptive::http;
+using namespace adaptive::logic;
+
+const char vlc_module_name[] = "test_lldash";
+
+/* Stand-in for a low latency origin: CMAF chunks of a segment are sent
+ * with chunked transfer encoding as soon as they are "encoded" */
+
+#define CHUNK_COUNT 3
+
+struct origin
+{
+    vlc_object_t *obj;
+    int *fds;
+    vlc_sem_t produce; /* posted by the client after each chunk */
+    bool paced;
+};
+
+static size_t chunk_size(unsigned i)
+{
+    return 100 + 37 * i; /* much smaller than the client reads */
+}
+
+static void fill_chunk(uint8_t *buf, unsigned i)
+{
+    for(size_t j = 0; j < chunk_size(i); j++)
+        buf[j] = i * 16 + j;
+}
+
+static void write_chunk(vlc_tls_t *tls, unsigned i)
+{
+    uint8_t buf[256];
+    char header[16];
+
+    fill_chunk(buf, i);
+    int len = snprintf(header, sizeof (header), "%zx\r\n", chunk_size(i));
+    assert(vlc_tls_Write(tls, header, len) == len);
+    assert(vlc_tls_Write(tls, buf, chunk_size(i)) == (ssize_t)chunk_size(i));
+    assert(vlc_tls_Write(tls, "\r\n", 2) == 2);
+}
+
+static void *origin_thread(void *data)
+{
+    struct origin *o = static_cast<struct origin *>(data);
+
+    int fd = net_Accept(o->obj, o->fds);
+    assert(fd >= 0);
+    vlc_tls_t *tls = vlc_tls_SocketOpen(fd);
+    assert(tls != NULL);
+
+    /* request line and headers */
+    char *line;
+    while((line = vlc_tls_GetLine(tls)) != NULL && *line)
+        free(line);
+    assert(line != NULL);
+    free(line);
+
+    static const char reply[] = "HTTP/1.1 200 OK\r\n"
+                                "Content-Type: video/mp4\r\n"
+                                "Transfer-Encoding: chunked\r\n"
+                                "Connection: close\r\n"
+                                "\r\n";
+    assert(vlc_tls_Write(tls, reply, strlen(reply)) == (ssize_t)strlen(reply));
+
+    for(unsigned i = 0; i < CHUNK_COUNT; i++)
+    {
+        /* the next chunk is not produced until the previous one was received */
+        if(o->paced && i > 0)
+            vlc_sem_wait(&o->produce);
+        write_chunk(tls, i);
+    }
+    assert(vlc_tls_Write(tls, "0\r\n\r\n", 5) == 5);
+
+    vlc_tls_Close(tls);
+    return NULL;
+}
+
+static HTTPConnection *connect_origin(vlc_object_t *obj, unsigned port)
+{
+    std::string url = "http://127.0.0.1:" + std::to_string(port) + "/seg-1.m4s";
+    ConnectionParams params(url);
+
+    HTTPConnection *conn = new HTTPConnection(obj, NULL, new Transport(),
+                                              ConnectionParams(), false);
+    assert(conn->prepare(params));
+    assert(conn->request(params.getPath(), BytesRange()) == RequestStatus::Success);
+    return conn;
+}
+
+static void test_origin(vlc_object_t *obj, bool paced)
+{
+    struct origin o;
+    vlc_thread_t th;
+
+    o.obj = obj;
+    o.paced = paced;
+    vlc_sem_init(&o.produce, 0);
+    o.fds = net_ListenTCP(obj, "127.0.0.1", 0);
+    assert(o.fds != NULL);
+
+    struct sockaddr_storage addr;
+    socklen_t addrlen = sizeof (addr);
+    assert(getsockname(o.fds[0], (struct sockaddr *)&addr, &addrlen) == 0);
+    unsigned port = ntohs(((struct sockaddr_in *)&addr)->sin_port);
+
+    assert(vlc_clone(&th, origin_thread, &o, VLC_THREAD_PRIORITY_LOW) == 0);
+
+    HTTPConnection *conn = connect_origin(obj, port);
+    uint8_t buf[32768], ref[256];
+
+    if(paced)
+    {
+        /* Each chunk must be returned as soon as it is received,
+         * otherwise the client would wait for a chunk that is never sent */
+        for(unsigned i = 0; i < CHUNK_COUNT; i++)
+        {
+            ssize_t ret = conn->readSome(buf, sizeof (buf));
+            assert(ret == (ssize_t)chunk_size(i));
+            fill_chunk(ref, i);
+            assert(!memcmp(buf, ref, chunk_size(i)));
+            vlc_sem_post(&o.produce);
+        }
+        assert(conn->readSome(buf, sizeof (buf)) == 0);
+    }
+    else
+    {
+        /* Whole segment reads still get all the chunks in one go */
+        size_t total = 0;
+        for(unsigned i = 0; i < CHUNK_COUNT; i++)
+            total += chunk_size(i);
+        ssize_t ret = conn->read(buf, sizeof (buf));
+        assert(ret == (ssize_t)total);
+        size_t offset = 0;
+        for(unsigned i = 0; i < CHUNK_COUNT; i++)
+        {
+            fill_chunk(ref, i);
+            assert(!memcmp(&buf[offset], ref, chunk_size(i)));
+            offset += chunk_size(i);
+        }
+    }
+
+    delete conn;
+    vlc_join(th, NULL);
+    net_ListenClose(o.fds);
+}
+
+static void test_catchup(void)
+{
+    const vlc_tick_t target = VLC_TICK_FROM_SEC(3);
+    CatchUpLogic c;
+
+    /* no target, no catch-up */
+    assert(c.update(VLC_TICK_FROM_SEC(10)) == 1.0);
+
+    c.setTargetLatency(target);
+    assert(c.update(target) == 1.0);
+    assert(c.update(target + CatchUpLogic::TOLERANCE) == 1.0);
+
+    /* speeds up with the excess, up to the maximum rate */
+    double prev = 1.0;
+    for(vlc_tick_t excess = CatchUpLogic::TOLERANCE + VLC_TICK_FROM_MS(10);
+        excess < 2 * CatchUpLogic::RANGE; excess += VLC_TICK_FROM_MS(50))
+    {
+        double rate = c.update(target + excess);
+        assert(rate > 1.0 && rate >= prev);
+        assert(rate <= CatchUpLogic::DEFAULT_MAX_RATE);
+        prev = rate;
+    }
+    assert(prev == CatchUpLogic::DEFAULT_MAX_RATE);
+
+    /* keeps catching up within the tolerance until the target is reached */
+    assert(c.update(target + CatchUpLogic::TOLERANCE / 2) > 1.0);
+    assert(c.update(target) == 1.0);
+    assert(c.update(target + CatchUpLogic::TOLERANCE / 2) == 1.0);
+
+    /* playing at the chosen rate drains the excess latency */
+    vlc_tick_t latency = target + VLC_TICK_FROM_SEC(2);
+    const vlc_tick_t step = VLC_TICK_FROM_MS(100);
+    unsigned i;
+    for(i = 0; i < 2000 && c.update(latency) > 1.0; i++)
+        latency -= (c.getRate() - 1.0) * step;
+    assert(i > 0 && i < 2000);
+    assert(latency <= target && latency > target - step);
+    assert(c.getRate() == 1.0);
+
+    /* a rate of 1 disables catching up */
+    c.setMaxRate(1.0);
+    assert(c.update(target + VLC_TICK_FROM_SEC(10)) == 1.0);
+}
+
+int main(void)
+{
+    test_catchup();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if(vlc == NULL)
+        return 77;
+
+    alarm(10); /* a blocking read would hang forever */
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    /* options of the http access and adaptive plugins */
+    var_Create(obj, "http-referrer", VLC_VAR_STRING);
+    var_Create(obj, "adaptive-use-access", VLC_VAR_BOOL);
+    test_origin(obj, true);
+    test_origin(obj, false);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,273 @@
+/*****************************************************************************
+ * oggseek.c: test the persistent ogg seek index
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_demux.h>
+#include <vlc_fs.h>
+
+#include <ogg/ogg.h>
+#include <stdio.h>
+#include <time.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include "../../../modules/demux/ogg.h"
+#include "../../../modules/demux/oggseek.h"
+
+#define STREAM_LENGTH   INT64_C(10000000)
+#define PRUNE_FILES     300
+
+/* only the seek index is tested, not the skeleton */
+bool Ogg_GetBoundsUsingSkeletonIndex( logical_stream_t *p_stream,
+                                      vlc_tick_t i_time,
+                                      int64_t *pi_lower, int64_t *pi_upper )
+{
+    VLC_UNUSED(p_stream); VLC_UNUSED(i_time);
+    VLC_UNUSED(pi_lower); VLC_UNUSED(pi_upper);
+    return false;
+}
+
+static char *cache_dir;
+
+static void sys_Init(demux_sys_t *sys, logical_stream_t *streams,
+                     logical_stream_t **pp_streams, int64_t length)
+{
+    memset(sys, 0, sizeof (*sys));
+    for (int i = 0; i < 2; i++)
+    {
+        memset(&streams[i], 0, sizeof (streams[i]));
+        streams[i].i_serial_no = 1000 + i;
+        streams[i].i_data_start = 4096;
+        pp_streams[i] = &streams[i];
+    }
+    sys->i_streams = 2;
+    sys->pp_stream = pp_streams;
+    sys->i_total_length = length;
+}
+
+static void sys_Clean(demux_sys_t *sys)
+{
+    for (int i = 0; i < sys->i_streams; i++)
+        oggseek_index_entries_free(sys->pp_stream[i]->idx);
+}
+
+static unsigned count_files(const char *path)
+{
+    DIR *dir = vlc_opendir(path);
+    assert(dir != NULL);
+
+    unsigned count = 0;
+    const char *name;
+    while ((name = vlc_readdir(dir)) != NULL)
+        if (name[0] != '.')
+            count++;
+    closedir(dir);
+    return count;
+}
+
+static void remove_dir(const char *path)
+{
+    DIR *dir = vlc_opendir(path);
+    if (dir == NULL)
+        return;
+
+    const char *name;
+    while ((name = vlc_readdir(dir)) != NULL)
+    {
+        if (!strcmp(name, ".") || !strcmp(name, ".."))
+            continue;
+
+        char *child;
+        if (asprintf(&child, "%s/%s", path, name) == -1)
+            continue;
+        struct stat st;
+        if (vlc_stat(child, &st) == 0 && S_ISDIR(st.st_mode))
+            remove_dir(child);
+        else
+            vlc_unlink(child);
+        free(child);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+static void test_roundtrip(demux_t *demux)
+{
+    demux_sys_t sys;
+    logical_stream_t streams[2], *pp_streams[2];
+
+    sys_Init(&sys, streams, pp_streams, STREAM_LENGTH);
+    demux->p_sys = &sys;
+
+    /* nothing cached yet */
+    Oggseek_IndexLoad(demux);
+    assert(sys.b_index_cache);
+    assert(streams[0].i_idx == 0 && streams[1].i_idx == 0);
+
+    for (int i = 0; i < 100; i++)
+    {
+        assert(OggSeek_IndexAdd(&streams[0],
+                                VLC_TICK_0 + VLC_TICK_FROM_SEC(i),
+                                8192 + i * 4096));
+        if (i % 2 == 0)
+            assert(OggSeek_IndexAdd(&streams[1],
+                                    VLC_TICK_0 + VLC_TICK_FROM_SEC(i),
+                                    8192 + i * 4096 + 100));
+    }
+    sys.b_index_dirty = true;
+    Oggseek_IndexSave(demux);
+    assert(!sys.b_index_dirty);
+
+    /* the same stream reopened gets the same entries */
+    demux_sys_t sys2;
+    logical_stream_t streams2[2], *pp_streams2[2];
+
+    sys_Init(&sys2, streams2, pp_streams2, STREAM_LENGTH);
+    demux->p_sys = &sys2;
+    Oggseek_IndexLoad(demux);
+    for (int i = 0; i < 2; i++)
+    {
+        assert(streams2[i].i_idx == streams[i].i_idx);
+        for (size_t j = 0; j < streams[i].i_idx; j++)
+        {
+            assert(streams2[i].idx[j].i_value == streams[i].idx[j].i_value);
+            assert(streams2[i].idx[j].i_pagepos == streams[i].idx[j].i_pagepos);
+        }
+    }
+    /* rewritten on close, to be kept as recently used */
+    assert(sys2.b_index_dirty);
+    sys_Clean(&sys2);
+
+    /* a stream of another size is not the same stream anymore */
+    sys_Init(&sys2, streams2, pp_streams2, STREAM_LENGTH + 1);
+    Oggseek_IndexLoad(demux);
+    assert(sys2.b_index_cache);
+    assert(streams2[0].i_idx == 0 && streams2[1].i_idx == 0);
+    sys_Clean(&sys2);
+
+    sys_Clean(&sys);
+    demux->p_sys = NULL;
+}
+
+static void test_prune(demux_t *demux)
+{
+    char *ogg_dir;
+    int ret = asprintf(&ogg_dir, "%s/ogg", cache_dir);
+    assert(ret != -1);
+
+    /* fill the cache with older entries than the one saved below, some of
+     * them too old to be kept at all */
+    time_t now = time(NULL);
+    for (int i = 0; i < PRUNE_FILES; i++)
+    {
+        char *path;
+        ret = asprintf(&path, "%s/old%03d", ogg_dir, i);
+        assert(ret != -1);
+        FILE *file = vlc_fopen(path, "wt");
+        assert(file != NULL);
+        fclose(file);
+
+        struct utimbuf times;
+        times.actime = times.modtime = i < 10 ? now - 365 * 24 * 3600
+                                              : now - 3600 - i;
+        ret = utime(path, &times);
+        assert(ret == 0);
+        free(path);
+    }
+    assert(count_files(ogg_dir) == PRUNE_FILES + 1);
+
+    demux_sys_t sys;
+    logical_stream_t streams[2], *pp_streams[2];
+
+    sys_Init(&sys, streams, pp_streams, STREAM_LENGTH);
+    demux->p_sys = &sys;
+    Oggseek_IndexLoad(demux);
+    assert(sys.b_index_dirty);
+    Oggseek_IndexSave(demux);
+
+    /* the entry that was just written is kept */
+    assert(count_files(ogg_dir) == 256);
+    sys_Clean(&sys);
+    sys_Init(&sys, streams, pp_streams, STREAM_LENGTH);
+    Oggseek_IndexLoad(demux);
+    assert(streams[0].i_idx == 100 && streams[1].i_idx == 50);
+    sys_Clean(&sys);
+
+    /* the expired and the oldest entries are gone */
+    for (int i = 0; i < PRUNE_FILES; i++)
+    {
+        char *path;
+        ret = asprintf(&path, "%s/old%03d", ogg_dir, i);
+        assert(ret != -1);
+        struct stat st;
+        bool kept = vlc_stat(path, &st) == 0;
+        assert(kept == (i >= 10 && i < 10 + 255));
+        free(path);
+    }
+
+    free(ogg_dir);
+    demux->p_sys = NULL;
+}
+
+int main(void)
+{
+    char tmpl[] = "/tmp/vlc-test-oggseek-XXXXXX";
+    cache_dir = mkdtemp(tmpl);
+    if (cache_dir == NULL)
+        return 77;
+    setenv("XDG_CACHE_HOME", cache_dir, 1);
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    /* never touch the cache of the user */
+    char *user_dir = config_GetUserDir(VLC_CACHE_DIR);
+    if (user_dir == NULL || strncmp(user_dir, cache_dir, strlen(cache_dir)))
+    {
+        free(user_dir);
+        libvlc_release(vlc);
+        remove_dir(cache_dir);
+        return 77;
+    }
+    free(user_dir);
+
+    demux_t *demux = vlc_object_create(VLC_OBJECT(vlc->p_libvlc_int),
+                                       sizeof (*demux));
+    assert(demux != NULL);
+    demux->psz_url = "file:///tmp/oggseek-test.ogg";
+    var_Create(demux, "ogg-seek-cache", VLC_VAR_BOOL);
+    var_SetBool(demux, "ogg-seek-cache", true);
+
+    test_roundtrip(demux);
+    test_prune(demux);
+
+    demux->psz_url = NULL;
+    vlc_object_delete(demux);
+    libvlc_release(vlc);
+    remove_dir(cache_dir);
+    return 0;
+}
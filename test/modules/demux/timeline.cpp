@@ -0,0 +1,301 @@
+/*****************************************************************************
+ * timeline.cpp: DASH SegmentTimeline storage and parsing test
+ *****************************************************************************
+ * Copyright (C) 2020 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_xml.h>
+#include "../../../lib/libvlc_internal.h"
+#include <vlc/vlc.h>
+
+#include "../modules/demux/adaptive/playlist/SegmentTimeline.h"
+#include "../modules/demux/adaptive/xml/DOMParser.h"
+#include "../modules/demux/adaptive/xml/DOMHelper.h"
+#include "../modules/demux/dash/mpd/TimelineElementHandler.h"
+
+using namespace adaptive::playlist;
+using namespace adaptive::xml;
+using namespace dash::mpd;
+
+const char vlc_module_name[] = "test_timeline";
+
+/* Roughly a day of 2s segments, as in a long DVR window */
+#define SEGMENT_COUNT 50000
+#define START_NUMBER  100
+
+/* Generated timeline: runs of equal durations, with a few gaps */
+struct reference
+{
+    std::vector<stime_t> t;
+    std::vector<stime_t> d;
+    std::vector<bool> gap; /* starts after a discontinuity */
+};
+
+static void generate(struct reference *ref, size_t count)
+{
+    uint32_t seed = 42;
+    stime_t t = 1000;
+    stime_t d = 2000;
+    for(size_t i = 0; i < count; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        bool gap = (i % 5000) == 4999;
+        if(gap)
+            t += 500;
+        if(((seed >> 16) & 63) == 0) /* end of run */
+            d = (d == 2000) ? 1980 : 2000;
+        ref->t.push_back(t);
+        ref->d.push_back(d);
+        ref->gap.push_back(gap);
+        t += d;
+    }
+}
+
+/* One S per segment, or run length merged as compacting packagers do.
+ * Mixed writes every other S as an element with content, <S ...></S> */
+static std::string generate_mpd(const struct reference &ref, size_t first,
+                                size_t count, bool compact, bool mixed)
+{
+    std::ostringstream mpd;
+    mpd << "<?xml version=\"1.0\"?>\n"
+           "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"dynamic\">"
+           "<Period id=\"0\"><AdaptationSet mimeType=\"video/mp4\">"
+           "<SegmentTemplate timescale=\"1000\" media=\"$Number$.m4s\""
+           " startNumber=\"" << START_NUMBER + first << "\">"
+           "<SegmentTimeline>\n";
+    for(size_t i = first; i < first + count; i++)
+    {
+        size_t r = 0;
+        if(compact)
+        {
+            while(i + r + 1 < first + count && !ref.gap[i + r + 1] &&
+                  ref.d[i + r + 1] == ref.d[i])
+                r++;
+        }
+        mpd << "<S";
+        if(i == first || ref.gap[i])
+            mpd << " t=\"" << ref.t[i] << "\"";
+        mpd << " d=\"" << ref.d[i] << "\"";
+        if(r)
+            mpd << " r=\"" << r << "\"";
+        if(mixed && (i & 1))
+            mpd << ">\n</S>\n";
+        else
+            mpd << "/>\n";
+        i += r;
+    }
+    mpd << "</SegmentTimeline></SegmentTemplate>"
+           "<Representation id=\"v\" bandwidth=\"1000000\"/>"
+           "</AdaptationSet></Period></MPD>\n";
+    return mpd.str();
+}
+
+static void fill_timeline(SegmentTimeline *timeline, const struct reference &ref,
+                          size_t first, size_t count)
+{
+    for(size_t i = first; i < first + count; i++)
+    {
+        if(i == first || ref.gap[i])
+            timeline->addElement(START_NUMBER + i, ref.d[i], 0, ref.t[i]);
+        else
+            timeline->addElement(START_NUMBER + i, ref.d[i]);
+    }
+}
+
+static void check_timeline(const SegmentTimeline *timeline, const struct reference &ref,
+                           size_t first, size_t count)
+{
+    assert(timeline->minElementNumber() == START_NUMBER + first);
+    assert(timeline->maxElementNumber() == START_NUMBER + first + count - 1);
+
+    stime_t total = 0, ahead = 0;
+    for(size_t i = first; i < first + count; i++)
+        total += ref.d[i];
+    assert(timeline->getTotalLength() == total);
+
+    for(size_t i = first + count; i-- > first; )
+    {
+        const uint64_t number = START_NUMBER + i;
+        stime_t time, duration;
+        assert(timeline->getScaledPlaybackTimeDurationBySegmentNumber(number, &time, &duration));
+        assert(time == ref.t[i]);
+        assert(duration == ref.d[i]);
+
+        assert(timeline->getElementNumberByScaledPlaybackTime(ref.t[i]) == number);
+        assert(timeline->getElementNumberByScaledPlaybackTime(ref.t[i] + ref.d[i] - 1) == number);
+        if(i + 1 < first + count && ref.gap[i + 1]) /* within a gap */
+            assert(timeline->getElementNumberByScaledPlaybackTime(ref.t[i] + ref.d[i]) == number);
+
+        assert(timeline->getMinAheadScaledTime(number) == ahead);
+        ahead += ref.d[i];
+    }
+
+    stime_t time, duration;
+    assert(!timeline->getScaledPlaybackTimeDurationBySegmentNumber(START_NUMBER + first - 1,
+                                                                   &time, &duration));
+    assert(!timeline->getScaledPlaybackTimeDurationBySegmentNumber(START_NUMBER + first + count,
+                                                                   &time, &duration));
+    assert(timeline->getElementNumberByScaledPlaybackTime(0) == START_NUMBER + first);
+    assert(timeline->getElementNumberByScaledPlaybackTime(INT64_MAX / 2) ==
+           START_NUMBER + first + count - 1);
+}
+
+static void test_timeline(const struct reference &ref)
+{
+    SegmentTimeline timeline(1000);
+    fill_timeline(&timeline, ref, 0, SEGMENT_COUNT);
+
+    /* one element per run, not per segment */
+    assert(timeline.getElementCount() < SEGMENT_COUNT / 16);
+    check_timeline(&timeline, ref, 0, SEGMENT_COUNT);
+
+    /* lookups */
+    vlc_tick_t start = vlc_tick_now();
+    for(size_t i = 0; i < SEGMENT_COUNT; i++)
+        assert(timeline.getElementNumberByScaledPlaybackTime(ref.t[i]) == START_NUMBER + i);
+    printf("%d time lookups: %" PRId64 " us, %zu elements\n", SEGMENT_COUNT,
+           US_FROM_VLC_TICK(vlc_tick_now() - start), timeline.getElementCount());
+
+    /* sliding window: prune the head, merge a refreshed manifest */
+    const size_t window = SEGMENT_COUNT / 2;
+    const size_t step = 1234;
+    assert(timeline.pruneBySequenceNumber(START_NUMBER + SEGMENT_COUNT - window) ==
+           SEGMENT_COUNT - window);
+    check_timeline(&timeline, ref, SEGMENT_COUNT - window, window);
+
+    struct reference refreshed; /* same sequence, live edge moved forward */
+    generate(&refreshed, SEGMENT_COUNT + step);
+    SegmentTimeline *update = new SegmentTimeline(1000);
+    fill_timeline(update, refreshed, SEGMENT_COUNT - window + step, window);
+
+    start = vlc_tick_now();
+    timeline.updateWith(*update);
+    printf("merge of %zu segments refresh: %" PRId64 " us\n", window,
+           US_FROM_VLC_TICK(vlc_tick_now() - start));
+    delete update;
+
+    check_timeline(&timeline, refreshed, SEGMENT_COUNT - window, window + step);
+}
+
+static Node *parse_mpd(vlc_object_t *obj, const std::string &mpd,
+                       ElementHandler *handler, DOMParser **parserp)
+{
+    stream_t *s = vlc_stream_MemoryNew(obj, (uint8_t *) mpd.data(), mpd.size(), true);
+    assert(s != NULL);
+
+    DOMParser *parser = new DOMParser(s);
+    parser->setElementHandler(handler);
+    vlc_tick_t start = vlc_tick_now();
+    assert(parser->parse(true));
+    printf("MPD parsing, %zu bytes, %s: %" PRId64 " us\n", mpd.size(),
+           handler ? "timeline handler" : "DOM",
+           US_FROM_VLC_TICK(vlc_tick_now() - start));
+    vlc_stream_Delete(s);
+    *parserp = parser;
+
+    std::vector<Node *> nodes =
+        DOMHelper::getElementByTagName(parser->getRootNode(), "SegmentTimeline", false);
+    assert(nodes.size() == 1);
+    return nodes.front();
+}
+
+static void test_mpd(vlc_object_t *obj, const struct reference &ref,
+                     bool compact, bool mixed)
+{
+    std::string mpd = generate_mpd(ref, 0, SEGMENT_COUNT, compact, mixed);
+    DOMParser *parser;
+
+    /* full DOM */
+    Node *node = parse_mpd(obj, mpd, NULL, &parser);
+    assert(compact || DOMHelper::getElementByTagName(node, "S", false).size() == SEGMENT_COUNT);
+    delete parser;
+
+    /* S entries collected, already merged */
+    TimelineElementHandler handler;
+    node = parse_mpd(obj, mpd, &handler, &parser);
+    assert(node->getSubNodes().empty());
+    const std::vector<TimelineElementHandler::Entry> *entries = handler.getEntries(node);
+    assert(entries != NULL);
+    assert(entries->size() < SEGMENT_COUNT / 16);
+
+    SegmentTimeline timeline(1000);
+    uint64_t number = START_NUMBER;
+    std::vector<TimelineElementHandler::Entry>::const_iterator it;
+    for(it = entries->begin(); it != entries->end(); ++it)
+    {
+        if((*it).hasTime)
+            timeline.addElement(number, (*it).d, (*it).r, (*it).t);
+        else
+            timeline.addElement(number, (*it).d, (*it).r);
+        number += 1 + (*it).r;
+    }
+    check_timeline(&timeline, ref, 0, SEGMENT_COUNT);
+    delete parser;
+}
+
+static bool has_xml_reader(vlc_object_t *obj)
+{
+    static const char xml[] = "<MPD/>";
+    stream_t *s = vlc_stream_MemoryNew(obj, (uint8_t *) xml, sizeof(xml) - 1, true);
+    assert(s != NULL);
+    xml_reader_t *reader = xml_ReaderCreate(obj, s);
+    if(reader)
+        xml_ReaderDelete(reader);
+    vlc_stream_Delete(s);
+    return reader != NULL;
+}
+
+int main(void)
+{
+    struct reference ref;
+    generate(&ref, SEGMENT_COUNT);
+
+    test_timeline(ref);
+
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if(vlc == NULL)
+        return 77;
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    if(!has_xml_reader(obj))
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+    test_mpd(obj, ref, false, false);
+    test_mpd(obj, ref, true, false);
+    test_mpd(obj, ref, false, true);
+    test_mpd(obj, ref, true, true);
+
+    libvlc_release(vlc);
+    return 0;
+}
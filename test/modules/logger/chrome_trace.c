@@ -0,0 +1,226 @@
+/*****************************************************************************
+ * chrome_trace.c: test the traces of the playback pipeline
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+
+#include "../../../modules/misc/webservices/json.h"
+
+static void on_event(const struct libvlc_event_t *event, void *data)
+{
+    (void) event;
+    vlc_sem_t *sem = data;
+    vlc_sem_post(sem);
+}
+
+/* Plays one video and one audio track for a while, with the traces written
+ * to the given file: the mock tracks are numbered from 0 per category, so
+ * that the selected ones are the video 1 and the audio 2 */
+static void trace_Play(const char *path)
+{
+    char *file_arg;
+    int ret = asprintf(&file_arg, "--chrome-trace-file=%s", path);
+    assert(ret != -1);
+
+    const char *argv[] = {
+        "-v", "--vout=vdummy", "--aout=adummy", "--tracer=chrome_trace",
+        file_arg,
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    libvlc_media_t *md = libvlc_media_new_location(vlc,
+        "mock://video_track_count=2;audio_track_count=3;length=100000000");
+    assert(md != NULL);
+    libvlc_media_add_option(md, ":video-track=1");
+    libvlc_media_add_option(md, ":audio-track=2");
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    vlc_sem_t sem;
+    vlc_sem_init(&sem, 0);
+    ret = libvlc_event_attach(em, libvlc_MediaPlayerTimeChanged, on_event,
+                              &sem);
+    assert(!ret);
+
+    libvlc_media_player_play(mp);
+    while (libvlc_media_player_get_time(mp) < 500)
+        vlc_sem_wait(&sem);
+    libvlc_event_detach(em, libvlc_MediaPlayerTimeChanged, on_event, &sem);
+
+    libvlc_media_player_stop_async(mp);
+    libvlc_media_player_release(mp);
+    /* the trace file is closed with the instance */
+    libvlc_release(vlc);
+    free(file_arg);
+}
+
+static char *trace_Read(const char *path)
+{
+    FILE *stream = fopen(path, "rt");
+    assert(stream != NULL);
+
+    char *buf = NULL;
+    size_t size = 0;
+    for (;;)
+    {
+        buf = realloc(buf, size + 4096 + 1);
+        assert(buf != NULL);
+        size_t len = fread(buf + size, 1, 4096, stream);
+        size += len;
+        if (len < 4096)
+            break;
+    }
+    buf[size] = '\0';
+    fclose(stream);
+    return buf;
+}
+
+static const json_value *trace_Get(const json_value *ev, const char *name)
+{
+    for (unsigned i = 0; i < ev->u.object.length; i++)
+        if (!strcmp(ev->u.object.values[i].name, name))
+            return ev->u.object.values[i].value;
+    return NULL;
+}
+
+static const char *trace_GetString(const json_value *ev, const char *name)
+{
+    const json_value *value = trace_Get(ev, name);
+    assert(value != NULL && value->type == json_string);
+    return value->u.string.ptr;
+}
+
+static int64_t trace_GetInteger(const json_value *ev, const char *name)
+{
+    const json_value *value = trace_Get(ev, name);
+    assert(value != NULL && value->type == json_integer);
+    return value->u.integer;
+}
+
+struct trace_ids
+{
+    int64_t decode[2]; /* the ES identifiers of the decoders */
+    unsigned decoders;
+    int64_t picture;
+    int64_t vout;
+    int64_t aout;
+    unsigned vout_spans;
+    unsigned aout_spans;
+};
+
+/* All the events of an output are traced with the same ES identifier */
+static void trace_SetId(int64_t *ids, int64_t id)
+{
+    assert(*ids == -1 || *ids == id);
+    *ids = id;
+}
+
+static void trace_Check(const json_value *trace)
+{
+    struct trace_ids ids = {
+        .decode = { -1, -1 }, .picture = -1, .vout = -1, .aout = -1,
+    };
+
+    assert(trace->type == json_array);
+    for (unsigned i = 0; i < trace->u.array.length; i++)
+    {
+        const json_value *ev = trace->u.array.values[i];
+        assert(ev->type == json_object);
+
+        const char *name = trace_GetString(ev, "name");
+        const char *cat = trace_GetString(ev, "cat");
+        const char *ph = trace_GetString(ev, "ph");
+        assert(trace_GetInteger(ev, "ts") >= 0);
+        trace_GetInteger(ev, "tid");
+
+        if (!strcmp(ph, "C"))
+        {
+            trace_GetInteger(ev, "id");
+            continue;
+        }
+        assert(!strcmp(ph, "X") || !strcmp(ph, "i"));
+        if (!strcmp(ph, "X"))
+            assert(trace_GetInteger(ev, "dur") >= 0);
+
+        const json_value *args = trace_Get(ev, "args");
+        assert(args != NULL && args->type == json_object);
+        int64_t id = trace_GetInteger(args, "id");
+
+        if (!strcmp(cat, "decoder") && !strcmp(name, "decode"))
+        {
+            if (ids.decoders == 0 || (ids.decoders == 1 && ids.decode[0] != id))
+                ids.decode[ids.decoders++] = id;
+            assert(id == ids.decode[0] || id == ids.decode[1]);
+        }
+        else if (!strcmp(cat, "decoder") && !strcmp(name, "picture"))
+            trace_SetId(&ids.picture, id);
+        else if (!strcmp(cat, "vout"))
+        {
+            trace_SetId(&ids.vout, id);
+            ids.vout_spans++;
+        }
+        else if (!strcmp(cat, "aout"))
+        {
+            trace_SetId(&ids.aout, id);
+            ids.aout_spans++;
+        }
+    }
+
+    test_log("%u events, %u vout and %u aout spans\n", trace->u.array.length,
+             ids.vout_spans, ids.aout_spans);
+
+    /* the outputs are traced with the ES of their decoders */
+    assert(ids.decoders == 2);
+    assert(ids.vout_spans > 0 && ids.aout_spans > 0);
+    assert(ids.decode[0] == 1 || ids.decode[1] == 1);
+    assert(ids.decode[0] == 2 || ids.decode[1] == 2);
+    assert(ids.picture == 1);
+    assert(ids.vout == 1);
+    assert(ids.aout == 2);
+}
+
+int main(void)
+{
+    char path[] = "/tmp/vlc-test-trace-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd == -1)
+        return 77;
+    close(fd);
+
+    test_init();
+    trace_Play(path);
+
+    char *buf = trace_Read(path);
+    unlink(path);
+    json_value *trace = json_parse(buf);
+    assert(trace != NULL);
+    trace_Check(trace);
+
+    json_value_free(trace);
+    free(buf);
+    return 0;
+}
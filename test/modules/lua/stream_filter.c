@@ -0,0 +1,256 @@
+/*****************************************************************************
+ * stream_filter.c: test the registry of the Lua playlist scripts
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <time.h>
+#include <utime.h>
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_input_item.h>
+#include <vlc_stream.h>
+
+static char *test_dir;
+
+/* The scripts return a single item named after them */
+#define SCRIPT(hints, name) \
+    "probe_hints = " hints "\n" \
+    "function probe() return true end\n" \
+    "function parse() return { { path = \"test://\", name = \"" name "\" } }" \
+    " end\n"
+
+static const char host_script[] =
+    SCRIPT("{ access = \"http\", host = \"example.com\" }", "host");
+static const char ext_script[] =
+    SCRIPT("{ extension = { \"m3ux\", \"plsx\" } }", "ext");
+/* of the same size, so that only the date tells them apart */
+static const char version1_script[] =
+    SCRIPT("{ access = \"version\" }", "v1");
+static const char version2_script[] =
+    SCRIPT("{ access = \"version\" }", "v2");
+
+static char *test_Path(const char *dir, const char *name)
+{
+    char *path;
+    int ret = asprintf(&path, "%s/%s/%s", test_dir, dir, name);
+    assert(ret != -1);
+    return path;
+}
+
+static void test_WriteScript(const char *name, const char *content,
+                             time_t mtime)
+{
+    char *path = test_Path("data/vlc/lua/playlist", name);
+    FILE *file = vlc_fopen(path, "wt");
+    assert(file != NULL);
+    size_t len = strlen(content);
+    assert(fwrite(content, 1, len, file) == len);
+    fclose(file);
+
+    struct utimbuf times = { .actime = mtime, .modtime = mtime };
+    int ret = utime(path, &times);
+    assert(ret == 0);
+    free(path);
+}
+
+/* Returns the name of the script parsing the URL, or NULL if none does */
+static char *test_Parse(vlc_object_t *obj, const char *url)
+{
+    static const char data[] = "#EXTM3U\n";
+    stream_t *source = vlc_stream_MemoryNew(obj, (uint8_t *)data,
+                                            sizeof (data) - 1, true);
+    assert(source != NULL);
+    source->psz_url = strdup(url);
+    assert(source->psz_url != NULL);
+
+    stream_t *s = vlc_stream_FilterNew(source, "luaplaylist");
+    if (s == NULL)
+    {
+        vlc_stream_Delete(source);
+        return NULL;
+    }
+
+    input_item_t *root = input_item_New("test://", "root");
+    assert(root != NULL);
+    input_item_node_t *node = input_item_node_Create(root);
+    assert(node != NULL);
+    int ret = vlc_stream_ReadDir(s, node);
+    assert(ret == VLC_SUCCESS);
+    assert(node->i_children == 1);
+    char *name = input_item_GetName(node->pp_children[0]->p_item);
+
+    input_item_node_Delete(node);
+    input_item_Release(root);
+    vlc_stream_Delete(s);
+    return name;
+}
+
+static void test_Expect(vlc_object_t *obj, const char *url, const char *name)
+{
+    char *parsed = test_Parse(obj, url);
+
+    test_log("%s: %s\n", url, parsed ? parsed : "not parsed");
+    if (name != NULL)
+        assert(parsed != NULL && !strcmp(parsed, name));
+    else
+        assert(parsed == NULL);
+    free(parsed);
+}
+
+/* Only the scripts whose hints match are probed */
+static void test_hints(vlc_object_t *obj)
+{
+    /* the host or its subdomains, on a dot boundary */
+    test_Expect(obj, "http://example.com/list", "host");
+    test_Expect(obj, "http://www.example.com/list", "host");
+    test_Expect(obj, "http://EXAMPLE.COM:8080/list?x=1", "host");
+    test_Expect(obj, "http://badexample.com/list", NULL);
+    test_Expect(obj, "http://example.com.org/list", NULL);
+    test_Expect(obj, "http://com/list", NULL);
+    test_Expect(obj, "ftp://example.com/list", NULL);
+
+    /* the extension, after a dot */
+    test_Expect(obj, "file:///tmp/list.m3ux", "ext");
+    test_Expect(obj, "file:///tmp/list.PLSX", "ext");
+    test_Expect(obj, "file:///tmp/listm3ux", NULL);
+    test_Expect(obj, "file:///tmp/m3ux", NULL);
+    test_Expect(obj, "file:///tmp/list.m3u", NULL);
+    test_Expect(obj, "file:///tmp/list.xm3ux", NULL);
+}
+
+/* Runs the registry in a new process, as it is loaded once per process */
+static void test_Run(const char *version)
+{
+    pid_t pid = fork();
+    assert(pid != -1);
+
+    if (pid == 0)
+    {
+        libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                            test_defaults_args);
+        assert(vlc != NULL);
+        vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+        if (version != NULL && !strcmp(version, "v1"))
+            test_hints(obj);
+        test_Expect(obj, "version://list", version);
+
+        libvlc_release(vlc);
+        exit(0);
+    }
+
+    int status;
+    pid_t ret = waitpid(pid, &status, 0);
+    assert(ret == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void test_reload(void)
+{
+    time_t now = time(NULL);
+
+    test_WriteScript("ext.lua", ext_script, now - 60);
+    test_WriteScript("host.lua", host_script, now - 60);
+    test_WriteScript("version.lua", version1_script, now - 60);
+
+    /* compiled and saved */
+    test_Run("v1");
+    char *cache = test_Path("cache", "vlc/lua_playlist.dat");
+    struct stat st;
+    int ret = vlc_stat(cache, &st);
+    assert(ret == 0);
+
+    /* unchanged as far as the registry can tell: reloaded from the cache */
+    assert(sizeof (version1_script) == sizeof (version2_script));
+    test_WriteScript("version.lua", version2_script, now - 60);
+    test_Run("v1");
+
+    /* then compiled again once its date changed */
+    test_WriteScript("version.lua", version2_script, now - 30);
+    test_Run("v2");
+    test_Run("v2");
+
+    /* removed scripts are dropped */
+    static const char *const names[] = { "version.lua", "ext.lua", "host.lua" };
+    for (size_t i = 0; i < ARRAY_SIZE(names); i++)
+    {
+        char *path = test_Path("data/vlc/lua/playlist", names[i]);
+        vlc_unlink(path);
+        free(path);
+        if (i == 0)
+            test_Run(NULL);
+    }
+
+    vlc_unlink(cache);
+    free(cache);
+}
+
+int main(void)
+{
+    char tmpl[] = "/tmp/vlc-test-lua-XXXXXX";
+    test_dir = mkdtemp(tmpl);
+    if (test_dir == NULL)
+        return 77;
+
+    test_init();
+
+    static const char *const dirs[] = {
+        "data", "data/vlc", "data/vlc/lua", "data/vlc/lua/playlist", "cache",
+        "cache/vlc",
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(dirs); i++)
+    {
+        char *path;
+        int ret = asprintf(&path, "%s/%s", test_dir, dirs[i]);
+        assert(ret != -1);
+        ret = vlc_mkdir(path, 0700);
+        assert(ret == 0);
+        free(path);
+    }
+
+    /* only the scripts of the test */
+    char *dir = test_Path("data", "");
+    setenv("XDG_DATA_HOME", dir, 1);
+    setenv("VLC_DATA_PATH", dir, 1);
+    setenv("VLC_LIB_PATH", dir, 1);
+    free(dir);
+    dir = test_Path("cache", "");
+    setenv("XDG_CACHE_HOME", dir, 1);
+    free(dir);
+
+    test_reload();
+
+    for (size_t i = ARRAY_SIZE(dirs); i > 0; i--)
+    {
+        char *path;
+        int ret = asprintf(&path, "%s/%s", test_dir, dirs[i - 1]);
+        assert(ret != -1);
+        rmdir(path);
+        free(path);
+    }
+    rmdir(test_dir);
+    return 0;
+}
@@ -0,0 +1,203 @@
+/*****************************************************************************
+ * csa.c: CSA scrambler tests
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <inttypes.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../../../modules/mux/mpeg/csa.h"
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+const char vlc_module_name[] = "test_csa";
+
+#define PACKETS 200
+
+static vlc_object_t *obj;
+static uint32_t seed = 0x1234567;
+
+static uint8_t Random( void )
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static void FillPackets( uint8_t (*pkts)[188], int i_count )
+{
+    for( int k = 0; k < i_count; k++ )
+    {
+        for( int i = 0; i < 188; i++ )
+            pkts[k][i] = Random();
+        pkts[k][0] = 0x47;
+        pkts[k][3] &= 0x3f;
+        /* Adaptation fields of all sizes, including too long for a single
+         * cypher block */
+        if( pkts[k][3] & 0x20 )
+            pkts[k][4] = Random() % 184;
+    }
+}
+
+static int TestBatch( csa_t *csa, int i_count, int i_pkt_size )
+{
+    static uint8_t ref[PACKETS][188], out[PACKETS][188];
+    uint8_t *pp_pkts[PACKETS];
+
+    FillPackets( ref, i_count );
+    memcpy( out, ref, sizeof(ref) );
+
+    for( int k = 0; k < i_count; k++ )
+    {
+        csa_Encrypt( csa, ref[k], i_pkt_size );
+        pp_pkts[k] = out[k];
+    }
+    int i_sliced = csa_EncryptBatch( csa, pp_pkts, i_count, i_pkt_size );
+
+    /* only the batches too small are scrambled one by one */
+    int i_expected = 0;
+    for( int i = 0; i < i_count; i += CSA_BATCH_SIZE )
+        if( __MIN( i_count - i, CSA_BATCH_SIZE ) >= CSA_BATCH_MIN )
+            i_expected += __MIN( i_count - i, CSA_BATCH_SIZE );
+    if( i_sliced != i_expected )
+    {
+        fprintf( stderr, "%d/%d packets bitsliced, expected %d\n",
+                 i_sliced, i_count, i_expected );
+        return 1;
+    }
+
+    for( int k = 0; k < i_count; k++ )
+    {
+        if( memcmp( ref[k], out[k], 188 ) )
+        {
+            fprintf( stderr, "packet %d/%d of %d bytes differs\n",
+                     k, i_count, i_pkt_size );
+            return 1;
+        }
+    }
+
+    /* Check we still get the clear data back */
+    FillPackets( ref, i_count );
+    memcpy( out, ref, sizeof(ref) );
+    csa_EncryptBatch( csa, pp_pkts, i_count, i_pkt_size );
+    for( int k = 0; k < i_count; k++ )
+    {
+        csa_Decrypt( csa, out[k], i_pkt_size );
+        if( memcmp( ref[k], out[k], 188 ) )
+        {
+            fprintf( stderr, "packet %d/%d of %d bytes not decrypted\n",
+                     k, i_count, i_pkt_size );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int TestKeys( csa_t *csa, const char *psz_odd, const char *psz_even )
+{
+    char odd[19], even[19];
+    strcpy( odd, psz_odd );
+    strcpy( even, psz_even );
+    if( csa_SetCW( obj, csa, odd, true ) ||
+        csa_SetCW( obj, csa, even, false ) )
+        return 1;
+
+    static const int sizes[] = { 188, 184, 100, 12 };
+    static const int counts[] = { 1, CSA_BATCH_MIN, CSA_BATCH_SIZE - 1,
+                                  CSA_BATCH_SIZE, PACKETS };
+
+    for( int use_odd = 0; use_odd < 2; use_odd++ )
+    {
+        csa_UseKey( obj, csa, use_odd );
+        for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+            for( size_t j = 0; j < ARRAY_SIZE(counts); j++ )
+                if( TestBatch( csa, counts[j], sizes[i] ) )
+                {
+                    fprintf( stderr, "with keys %s/%s (%s)\n", psz_odd,
+                             psz_even, use_odd ? "odd" : "even" );
+                    return 1;
+                }
+    }
+    return 0;
+}
+
+static void Bench( csa_t *csa )
+{
+    static uint8_t pkts[CSA_BATCH_SIZE][188];
+    uint8_t *pp_pkts[CSA_BATCH_SIZE];
+
+    FillPackets( pkts, CSA_BATCH_SIZE );
+    for( int k = 0; k < CSA_BATCH_SIZE; k++ )
+        pp_pkts[k] = pkts[k];
+
+    vlc_tick_t start = vlc_tick_now();
+    for( int i = 0; i < 1000; i++ )
+        for( int k = 0; k < CSA_BATCH_SIZE; k++ )
+            csa_Encrypt( csa, pkts[k], 188 );
+    vlc_tick_t one = vlc_tick_now() - start;
+
+    start = vlc_tick_now();
+    for( int i = 0; i < 1000; i++ )
+        csa_EncryptBatch( csa, pp_pkts, CSA_BATCH_SIZE, 188 );
+    vlc_tick_t batch = vlc_tick_now() - start;
+
+    printf( "%d packets: one by one %" PRId64 " us, bitsliced %" PRId64
+            " us\n", 1000 * CSA_BATCH_SIZE, US_FROM_VLC_TICK(one),
+            US_FROM_VLC_TICK(batch) );
+}
+
+int main( void )
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new( test_defaults_nargs,
+                                         test_defaults_args );
+    assert( vlc != NULL );
+    obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    csa_t *csa = csa_New();
+    assert( csa );
+
+    if( TestKeys( csa, "0x1122334455667788", "a5b4c3d2e1f00f1e" ) ||
+        TestKeys( csa, "0000000000000000", "ffffffffffffffff" ) )
+        return 1;
+
+    for( int i = 0; i < 8; i++ )
+    {
+        char odd[17], even[17];
+        for( int j = 0; j < 16; j++ )
+        {
+            odd[j] = "0123456789abcdef"[Random() & 0xf];
+            even[j] = "0123456789abcdef"[Random() & 0xf];
+        }
+        odd[16] = even[16] = '\0';
+        if( TestKeys( csa, odd, even ) )
+            return 1;
+    }
+
+    Bench( csa );
+
+    csa_Delete( csa );
+    libvlc_release( vlc );
+    return 0;
+}
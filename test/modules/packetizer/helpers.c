@@ -30,6 +30,7 @@
 #include <vlc_block_helper.h>
 
 #include "../modules/packetizer/startcode_helper.h"
+#include "../modules/packetizer/hxxx_ep3b.h"
 
 struct results_s
 {
@@ -64,6 +65,32 @@ static int check_set( const uint8_t *p_set, const uint8_t *p_end,
     return 0;
 }
 
+static const uint8_t * find_annexb_c( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_FindZeroes_C( p, end, 0x01 );
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+static const uint8_t * find_annexb_sse2( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_FindZeroes_SSE2( p, end, 0x01 );
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+static const uint8_t * find_annexb_avx2( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_FindZeroes_AVX2( p, end, 0x01 );
+}
+#endif
+
+#ifdef STARTCODE_NEON
+static const uint8_t * find_annexb_neon( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_FindZeroes_NEON( p, end, 0x01 );
+}
+#endif
+
 static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
                             const struct results_s *p_results, size_t i_results,
                             ssize_t i_results_offset )
@@ -87,6 +114,84 @@ static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
     }
     else printf("asm not built in, skipping test:\n");
 
+    printf("checking vectors code:\n");
+    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                       find_annexb_c );
+#ifdef HAVE_SSE2_INTRINSICS
+    if( i_ret == 0 && vlc_CPU_SSE2() )
+        i_ret = check_set( p_set, p_end, p_results, i_results,
+                           i_results_offset, find_annexb_sse2 );
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if( i_ret == 0 && vlc_CPU_AVX2() )
+        i_ret = check_set( p_set, p_end, p_results, i_results,
+                           i_results_offset, find_annexb_avx2 );
+#endif
+#ifdef STARTCODE_NEON
+    if( i_ret == 0 && vlc_CPU_ARM_NEON() )
+        i_ret = check_set( p_set, p_end, p_results, i_results,
+                           i_results_offset, find_annexb_neon );
+#endif
+    return i_ret;
+}
+
+/* Unescaped size, forwarding byte per byte as the bitstream reader does */
+static size_t ep3b_size_bytewise( const uint8_t *p, const uint8_t *p_end )
+{
+    unsigned i_prev = 0;
+    size_t i = 0;
+    while( p < p_end )
+    {
+        p = hxxx_ep3b_to_rbsp( (uint8_t *)p, (uint8_t *)p_end, &i_prev, 1 );
+        ++i;
+    }
+    return i;
+}
+
+static int run_ep3b_sets( void )
+{
+    const uint8_t set[] = { 0, 0, 3, 1, /* first byte is not escaped */
+                            0, 0, 3, 0, 0, 3, 0, 0, 3, 3, 0x22,
+                            0, 0, 3, 0, 3, 0, 0, 3, /* last one neither */
+                          };
+    uint8_t *p_data = malloc( 4096 );
+    if( !p_data )
+        return 0;
+
+    /* every tail of the set, at both ends of a larger buffer */
+    for( size_t i = 0; i < sizeof(set); i++ )
+    {
+        const size_t i_size = sizeof(set) - i;
+        memset( p_data, 0x42, 4096 );
+        memcpy( &p_data[4096 - i_size], &set[i], i_size );
+        if( ep3b_size_bytewise( &set[i], &set[sizeof(set)] ) !=
+            hxxx_ep3b_total_size( &set[i], &set[sizeof(set)] ) ||
+            ep3b_size_bytewise( p_data, p_data + 4096 ) !=
+            hxxx_ep3b_total_size( p_data, p_data + 4096 ) )
+        {
+            free( p_data );
+            return 1;
+        }
+    }
+
+    /* pseudo random streams of zeroes and threes */
+    uint32_t seed = 1;
+    for( size_t i = 0; i < 4096; i++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        p_data[i] = (seed >> 16) & 2 ? 0 : 3;
+    }
+    for( size_t i = 0; i < 4096; i += 61 )
+    {
+        if( ep3b_size_bytewise( &p_data[i], p_data + 4096 ) !=
+            hxxx_ep3b_total_size( &p_data[i], p_data + 4096 ) )
+        {
+            free( p_data );
+            return 1;
+        }
+    }
+
+    free( p_data );
     return 0;
 }
 
@@ -134,5 +239,6 @@ int main( void )
             return i_ret;
     }
 
-    return 0;
+    printf("* Running emulation prevention tests:\n");
+    return run_ep3b_sets();
 }
@@ -0,0 +1,361 @@
+/*****************************************************************************
+ * throughput.c: packetizers and startcode scanners benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_codec.h>
+#include <vlc_block.h>
+#include <vlc_meta.h>
+#include <vlc_tick.h>
+
+#include "../modules/packetizer/startcode_helper.h"
+#include "../modules/packetizer/hxxx_ep3b.h"
+
+#define STREAM_SIZE  (32 << 20)
+#define PAYLOAD_SIZE (16 << 10)
+#define BLOCK_SIZE   (64 << 10)
+
+/* Synthetic Annex-B streams: the parameters sets of the unit tests samples,
+ * then access units made of the headers of their first picture, followed by
+ * a random payload as large as the one of an HD picture. */
+struct codec_s
+{
+    const char *name;
+    vlc_fourcc_t codec;
+    const uint8_t *p_headers;
+    size_t i_headers;
+    const uint8_t *p_au;
+    size_t i_au;
+    bool b_escape; /* emulation prevention */
+};
+
+static const uint8_t h264_headers[] = {
+    0x00, 0x00, 0x00, 0x01, 0x67, 0xf4, 0x00, 0x0a, 0x91, 0x9b, 0x2b, 0xd0,
+    0x80, 0x00, 0x00, 0x03, 0x00, 0x80, 0x00, 0x00, 0x19, 0x07, 0x89, 0x12,
+    0xcb, 0x00, 0x00, 0x00, 0x01, 0x68, 0xeb, 0xec, 0x44, 0x84, 0x40,
+};
+static const uint8_t h264_au[] = {
+    0x00, 0x00, 0x00, 0x01, 0x09, 0xf0, /* access unit delimiter */
+    0x00, 0x00, 0x01, 0x65, 0x88, 0x84, 0x00, 0x37, 0xff, 0xfe, 0xf5, 0xdb,
+    0xf3, 0x2c, 0xac, 0x66, 0x67, 0xff,
+};
+
+static const uint8_t hevc_headers[] = {
+    0x00, 0x00, 0x00, 0x01, 0x40, 0x01, 0x0c, 0x01, 0xff, 0xff, 0x04, 0x08,
+    0x00, 0x00, 0x03, 0x00, 0x9e, 0x08, 0x00, 0x00, 0x03, 0x00, 0x00, 0x1e,
+    0x95, 0x98, 0x09, 0x00, 0x00, 0x00, 0x01, 0x42, 0x01, 0x01, 0x04, 0x08,
+    0x00, 0x00, 0x03, 0x00, 0x9e, 0x08, 0x00, 0x00, 0x03, 0x00, 0x00, 0x1e,
+    0x90, 0x11, 0x08, 0xb2, 0xca, 0xcd, 0x57, 0x95, 0xcd, 0x40, 0x80, 0x80,
+    0x01, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x03, 0x00, 0x19, 0x08,
+    0x00, 0x00, 0x00, 0x01, 0x44, 0x01, 0xc1, 0x73, 0x18, 0x31, 0x08, 0x90,
+};
+static const uint8_t hevc_au[] = {
+    0x00, 0x00, 0x00, 0x01, 0x46, 0x01, 0x50, /* access unit delimiter */
+    0x00, 0x00, 0x01, 0x28, 0x01, 0xaf, 0x19, 0x80, 0xef, 0xef, 0xcb, 0x5f,
+    0xfe, 0x52, 0x0b, 0xfe, 0xbb, 0x6d, 0xfd, 0x0f, 0xf8,
+};
+
+static const uint8_t mpgv_headers[] = {
+    0x00, 0x00, 0x01, 0xb3, 0x01, 0x00, 0x10, 0x13, 0xff, 0xff, 0xe0, 0x00,
+    0x00, 0x00, 0x01, 0xb5, 0x14, 0x8a, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x01, 0xb8, 0x00, 0x08, 0x00, 0x40,
+};
+static const uint8_t mpgv_au[] = {
+    0x00, 0x00, 0x01, 0x00, 0x00, 0x0f, 0xff, 0xf8,
+    0x00, 0x00, 0x01, 0xb5, 0x8f, 0xff, 0xf3, 0x41, 0x80,
+    0x00, 0x00, 0x01, 0x01, 0x13, 0xf8, 0x7d, 0x29, 0x48, 0x88,
+};
+
+static const struct codec_s codecs[] = {
+    { "h264", VLC_CODEC_H264, h264_headers, sizeof(h264_headers),
+      h264_au, sizeof(h264_au), true },
+    { "hevc", VLC_CODEC_HEVC, hevc_headers, sizeof(hevc_headers),
+      hevc_au, sizeof(hevc_au), true },
+    { "mpgv", VLC_CODEC_MPGV, mpgv_headers, sizeof(mpgv_headers),
+      mpgv_au, sizeof(mpgv_au), false },
+};
+
+/* Random payload, with enough zeroes for the scanners to stop often. Start
+ * codes are escaped with 0x03 when the codec does, otherwise avoided. */
+static size_t payload_Fill(uint8_t *p, size_t i_size, bool b_escape,
+                           uint32_t *seed)
+{
+    size_t i = 0;
+    unsigned i_zeroes = 0;
+
+    while (i + 2 < i_size)
+    {
+        *seed = *seed * 1103515245 + 12345;
+        uint8_t v = (*seed >> 16) & 0x0F ? *seed >> 24 : 0;
+
+        if (i_zeroes >= 2 && v <= 3)
+        {
+            if (b_escape)
+            {
+                p[i++] = 0x03;
+                i_zeroes = 0;
+            }
+            else
+                v |= 0x80;
+        }
+        p[i++] = v;
+        i_zeroes = v ? 0 : i_zeroes + 1;
+    }
+    p[i++] = 0x80; /* stop bit */
+    return i;
+}
+
+static uint8_t *stream_Create(const struct codec_s *c, size_t *pi_size)
+{
+    uint8_t *p = malloc(STREAM_SIZE + PAYLOAD_SIZE);
+    if (p == NULL)
+        return NULL;
+
+    uint32_t seed = 1;
+    size_t i = 0;
+    memcpy(p, c->p_headers, c->i_headers);
+    i += c->i_headers;
+    while (i < STREAM_SIZE)
+    {
+        memcpy(&p[i], c->p_au, c->i_au);
+        i += c->i_au;
+        i += payload_Fill(&p[i], PAYLOAD_SIZE - c->i_au, c->b_escape, &seed);
+    }
+    *pi_size = i;
+    return p;
+}
+
+static void delete_packetizer(decoder_t *p_pack)
+{
+    if (p_pack->p_module)
+        module_unneed(p_pack, p_pack->p_module);
+    es_format_Clean(&p_pack->fmt_in);
+    es_format_Clean(&p_pack->fmt_out);
+    if (p_pack->p_description)
+        vlc_meta_Delete(p_pack->p_description);
+    vlc_object_delete(p_pack);
+}
+
+static decoder_t *create_packetizer(libvlc_instance_t *vlc, vlc_fourcc_t codec)
+{
+    decoder_t *p_pack = vlc_object_create(vlc->p_libvlc_int, sizeof(*p_pack));
+    if (!p_pack)
+        return NULL;
+    p_pack->pf_decode = NULL;
+    p_pack->pf_packetize = NULL;
+
+    es_format_Init(&p_pack->fmt_in, VIDEO_ES, codec);
+    es_format_Init(&p_pack->fmt_out, VIDEO_ES, 0);
+    p_pack->fmt_in.b_packetized = false;
+
+    p_pack->p_module = module_need(p_pack, "packetizer", NULL, false);
+    if (!p_pack->p_module)
+    {
+        delete_packetizer(p_pack);
+        return NULL;
+    }
+    return p_pack;
+}
+
+static double MBps(size_t i_size, vlc_tick_t time)
+{
+    return i_size / (double)US_FROM_VLC_TICK(time ? time : 1);
+}
+
+static int bench_packetizer(libvlc_instance_t *vlc, const struct codec_s *c,
+                            const uint8_t *p_data, size_t i_data)
+{
+    decoder_t *p = create_packetizer(vlc, c->codec);
+    if (p == NULL)
+    {
+        printf("%s: no packetizer, skipping\n", c->name);
+        return 0;
+    }
+
+    unsigned i_count = 0;
+    size_t i_out = 0;
+    vlc_tick_t start = vlc_tick_now();
+
+    /* the last iteration drains the packetizer */
+    for (size_t i = 0; i < i_data + BLOCK_SIZE; i += BLOCK_SIZE)
+    {
+        block_t *in = NULL;
+        if (i < i_data)
+        {
+            size_t i_size = __MIN(BLOCK_SIZE, i_data - i);
+            in = block_Alloc(i_size);
+            if (in == NULL)
+                break;
+            memcpy(in->p_buffer, &p_data[i], i_size);
+            if (i == 0)
+                in->i_dts = VLC_TICK_0;
+        }
+
+        block_t *out;
+        /* keep passing the consumed block until no more output, so that
+         * the packetizer does not drain before the end */
+        while ((out = p->pf_packetize(p, i < i_data ? &in : NULL)) != NULL)
+        {
+            for (block_t *b = out; b != NULL; b = b->p_next)
+            {
+                i_out += b->i_buffer;
+                i_count++;
+            }
+            block_ChainRelease(out);
+        }
+    }
+
+    vlc_tick_t time = vlc_tick_now() - start;
+    delete_packetizer(p);
+
+    printf("%s packetizer: %zu MB in %6" PRId64 " us, %7.1f MB/s, "
+           "%u blocks out\n", c->name, i_data >> 20,
+           US_FROM_VLC_TICK(time), MBps(i_data, time), i_count);
+
+    return i_count > 0 && i_out > 0 ? 0 : 1;
+}
+
+static void bench_find(const char *name, const uint8_t *p_data, size_t i_data,
+                       const uint8_t *(*pf_find)(const uint8_t *,
+                                                 const uint8_t *))
+{
+    const uint8_t *p_end = p_data + i_data;
+    unsigned i_count = 0;
+    vlc_tick_t start = vlc_tick_now();
+
+    for (const uint8_t *p = pf_find(p_data, p_end); p != NULL;
+         p = pf_find(p + 3, p_end))
+        i_count++;
+
+    vlc_tick_t time = vlc_tick_now() - start;
+    printf("  startcode %-12s %7.1f MB/s, %u startcodes\n", name,
+           MBps(i_data, time), i_count);
+}
+
+static const uint8_t * find_annexb_c(const uint8_t *p, const uint8_t *end)
+{
+    return startcode_FindZeroes_C(p, end, 0x01);
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+static const uint8_t * find_annexb_sse2(const uint8_t *p, const uint8_t *end)
+{
+    return startcode_FindZeroes_SSE2(p, end, 0x01);
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+static const uint8_t * find_annexb_avx2(const uint8_t *p, const uint8_t *end)
+{
+    return startcode_FindZeroes_AVX2(p, end, 0x01);
+}
+#endif
+
+#ifdef STARTCODE_NEON
+static const uint8_t * find_annexb_neon(const uint8_t *p, const uint8_t *end)
+{
+    return startcode_FindZeroes_NEON(p, end, 0x01);
+}
+#endif
+
+/* Unescaped size, forwarding byte per byte as the bitstream reader does */
+static size_t ep3b_size_bytewise(const uint8_t *p, const uint8_t *p_end)
+{
+    unsigned i_prev = 0;
+    size_t i = 0;
+    while (p < p_end)
+    {
+        p = hxxx_ep3b_to_rbsp((uint8_t *)p, (uint8_t *)p_end, &i_prev, 1);
+        ++i;
+    }
+    return i;
+}
+
+static int bench_ep3b(const uint8_t *p_data, size_t i_data)
+{
+    vlc_tick_t start = vlc_tick_now();
+    size_t i_ref = ep3b_size_bytewise(p_data, p_data + i_data);
+    vlc_tick_t ref_time = vlc_tick_now() - start;
+
+    start = vlc_tick_now();
+    size_t i_size = hxxx_ep3b_total_size(p_data, p_data + i_data);
+    vlc_tick_t time = vlc_tick_now() - start;
+
+    printf("  emulation prevention: bytewise %7.1f MB/s, scan %7.1f MB/s, "
+           "%zu bytes escaped\n", MBps(i_data, ref_time), MBps(i_data, time),
+           i_data - i_size);
+    return i_size == i_ref ? 0 : 1;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (!vlc)
+        return 1;
+
+    int i_ret = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(codecs) && i_ret == 0; i++)
+    {
+        size_t i_data;
+        uint8_t *p_data = stream_Create(&codecs[i], &i_data);
+        if (p_data == NULL)
+            break;
+
+        printf("%s stream:\n", codecs[i].name);
+        bench_find("bits", p_data, i_data, startcode_FindAnnexB_Bits);
+        bench_find("C", p_data, i_data, find_annexb_c);
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+        if (vlc_CPU_SSE2())
+        {
+            bench_find("SSE2 aligned", p_data, i_data,
+                       startcode_FindAnnexB_SSE2);
+# ifdef HAVE_SSE2_INTRINSICS
+            bench_find("SSE2", p_data, i_data, find_annexb_sse2);
+# endif
+        }
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+        if (vlc_CPU_AVX2())
+            bench_find("AVX2", p_data, i_data, find_annexb_avx2);
+#endif
+#ifdef STARTCODE_NEON
+        if (vlc_CPU_ARM_NEON())
+            bench_find("NEON", p_data, i_data, find_annexb_neon);
+#endif
+        if (codecs[i].b_escape)
+            i_ret = bench_ep3b(p_data, i_data);
+
+        if (i_ret == 0)
+            i_ret = bench_packetizer(vlc, &codecs[i], p_data, i_data);
+        free(p_data);
+    }
+
+    libvlc_release(vlc);
+    return i_ret;
+}
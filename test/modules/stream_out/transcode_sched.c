@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * transcode_sched.c: test the sharing of CPUs between transcoding chains
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_tick.h>
+
+#include "../../../modules/stream_out/transcode/scheduler.h"
+
+const char vlc_module_name[] = "test_transcode_sched";
+
+#define FRAME_DURATION VLC_TICK_FROM_MS(40)
+
+static unsigned cpus;
+static vlc_tick_t now;
+
+/* Encodes frames at 25 fps for a while, taking the given fraction of a CPU
+ * for each chain */
+static void run(transcode_sched_chain_t *a, unsigned a_load,
+                transcode_sched_chain_t *b, unsigned b_load,
+                vlc_tick_t duration)
+{
+    for (vlc_tick_t end = now + duration; now < end; now += FRAME_DURATION)
+    {
+        transcode_sched_chain_Report(a, now, FRAME_DURATION * a_load / 100,
+                                     FRAME_DURATION);
+        if (b != NULL)
+            transcode_sched_chain_Report(b, now, FRAME_DURATION * b_load / 100,
+                                         FRAME_DURATION);
+    }
+}
+
+static void check_share(transcode_sched_chain_t *chain, unsigned expected)
+{
+    unsigned threads = transcode_sched_chain_GetThreads(chain);
+    assert(threads >= 1 && threads <= cpus);
+    assert(threads == VLC_CLIP(expected, 1, cpus));
+}
+
+/* Shares are only moved by more than a quarter, so as not to restart the
+ * encoders too often */
+static void check_share_near(transcode_sched_chain_t *chain, unsigned load,
+                             unsigned total)
+{
+    unsigned threads = transcode_sched_chain_GetThreads(chain);
+    unsigned expected = (cpus * load + total / 2) / total;
+
+    expected = VLC_CLIP(expected, 1, cpus);
+    assert(threads >= 1 && threads <= cpus);
+    assert(4 * (threads > expected ? threads - expected
+                                   : expected - threads) <= threads);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    cpus = vlc_GetCPUCount();
+    now = vlc_tick_now();
+
+    /* a single chain gets all the CPUs */
+    transcode_sched_chain_t *a = transcode_sched_chain_New(obj);
+    assert(a != NULL);
+    check_share(a, cpus);
+
+    /* the CPUs are split as soon as another chain comes */
+    transcode_sched_chain_t *b = transcode_sched_chain_New(obj);
+    assert(b != NULL);
+    check_share(a, (cpus + 1) / 2);
+    check_share(b, (cpus + 1) / 2);
+
+    /* then in proportion of the measured loads */
+    run(a, 120, b, 60, VLC_TICK_FROM_SEC(60));
+    check_share_near(a, 120, 180);
+    check_share_near(b, 60, 180);
+    unsigned a_threads = transcode_sched_chain_GetThreads(a);
+    unsigned b_threads = transcode_sched_chain_GetThreads(b);
+    assert(a_threads >= b_threads);
+
+    /* a small change of load does not restart the encoders */
+    run(a, 120, b, 63, VLC_TICK_FROM_SEC(2));
+    run(a, 120, b, 60, VLC_TICK_FROM_SEC(2));
+    assert(transcode_sched_chain_GetThreads(a) == a_threads);
+    assert(transcode_sched_chain_GetThreads(b) == b_threads);
+
+    /* the remaining chain gets the CPUs back */
+    transcode_sched_chain_Delete(b);
+    check_share(a, cpus);
+
+    /* an idle chain keeps a share */
+    b = transcode_sched_chain_New(obj);
+    assert(b != NULL);
+    run(a, 200, b, 0, VLC_TICK_FROM_SEC(60));
+    check_share_near(a, 200, 210);
+    check_share_near(b, 10, 210);
+    assert(transcode_sched_chain_GetThreads(a)
+           >= transcode_sched_chain_GetThreads(b));
+
+    transcode_sched_chain_Delete(b);
+    transcode_sched_chain_Delete(a);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,248 @@
+/*****************************************************************************
+ * chain.c: test video converters chains creation
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <inttypes.h>
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_filter.h>
+#include <vlc_tick.h>
+#include <vlc_atomic.h>
+
+#define CHAIN_COUNT 20
+
+/* The chain module built with the test, whose failures expire after
+ * PATH_NONE_DELAY */
+#define TEST_CHAIN "test_chain"
+
+const char vlc_module_name[] = "test_chain";
+
+static void format_Init(es_format_t *fmt, vlc_fourcc_t chroma,
+                        unsigned width, unsigned height)
+{
+    es_format_Init(fmt, VIDEO_ES, chroma);
+    video_format_Setup(&fmt->video, chroma, width, height, width, height,
+                       1, 1);
+}
+
+static vlc_tick_t chain_Create(vlc_object_t *obj, const char *name,
+                               const es_format_t *in, const es_format_t *out,
+                               bool *created)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    es_format_Copy(&filter->fmt_in, in);
+    es_format_Copy(&filter->fmt_out, out);
+
+    vlc_tick_t start = vlc_tick_now();
+    filter->p_module = module_need(filter, "video converter", name, true);
+    vlc_tick_t time = vlc_tick_now() - start;
+
+    *created = filter->p_module != NULL;
+    if (filter->p_module != NULL)
+        module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+    return time;
+}
+
+/* The first chain probes the converters, the next ones reuse its path */
+static void test_chain(vlc_object_t *obj, vlc_fourcc_t in_chroma,
+                       unsigned in_width, unsigned in_height,
+                       vlc_fourcc_t out_chroma,
+                       unsigned out_width, unsigned out_height)
+{
+    es_format_t in, out;
+    bool first, created;
+
+    format_Init(&in, in_chroma, in_width, in_height);
+    format_Init(&out, out_chroma, out_width, out_height);
+
+    vlc_tick_t first_time = chain_Create(obj, "chain", &in, &out, &first);
+    vlc_tick_t next_time = 0;
+    for (unsigned i = 1; i < CHAIN_COUNT; i++)
+    {
+        next_time += chain_Create(obj, "chain", &in, &out, &created);
+        assert(created == first);
+    }
+
+    printf("%4.4s %ux%u to %4.4s %ux%u %s: first %6" PRId64 " us, "
+           "next %6" PRId64 " us\n",
+           (const char *)&in_chroma, in_width, in_height,
+           (const char *)&out_chroma, out_width, out_height,
+           first ? "created" : "failed", US_FROM_VLC_TICK(first_time),
+           US_FROM_VLC_TICK(next_time / (CHAIN_COUNT - 1)));
+
+    es_format_Clean(&in);
+    es_format_Clean(&out);
+}
+
+/*****************************************************************************
+ * Fake converter, counting how many times it is probed: it converts
+ * FAKE_IN to FAKE_MID, and resizes FAKE_MID.
+ *****************************************************************************/
+#define FAKE_IN   VLC_FOURCC('T','S','T','0')
+#define FAKE_MID  VLC_FOURCC('T','S','T','1')
+#define FAKE_NONE VLC_FOURCC('T','S','T','2')
+
+static atomic_uint fake_probes;
+
+static picture_t *FakeFilter(filter_t *filter, picture_t *pic)
+{
+    (void) filter;
+    return pic;
+}
+
+static int OpenFake(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+    const bool resize = in->i_width != out->i_width
+                     || in->i_height != out->i_height;
+
+    atomic_fetch_add(&fake_probes, 1);
+    if (in->i_chroma == FAKE_IN && out->i_chroma == FAKE_MID && !resize)
+        ;
+    else if (in->i_chroma == FAKE_MID && out->i_chroma == FAKE_MID && resize)
+        ;
+    else
+        return VLC_EGENERIC;
+    filter->pf_video_filter = FakeFilter;
+    return VLC_SUCCESS;
+}
+
+#undef MODULE_NAME
+#undef MODULE_STRING
+#define MODULE_NAME test_chain_fake
+#define MODULE_STRING "test_chain_fake"
+#include <vlc_plugin.h>
+
+vlc_module_begin()
+    set_capability("video converter", 10000)
+    set_callbacks(OpenFake, NULL)
+vlc_module_end()
+
+int vlc_entry__test_chain(int (*)(void *, void *, int, ...), void *);
+
+__attribute__((visibility("default")))
+int (*vlc_static_modules[])(int (*)(void *, void *, int, ...), void *) = {
+    vlc_entry__test_chain_fake, vlc_entry__test_chain, NULL
+};
+
+static unsigned fake_Probes(vlc_object_t *obj, const char *name,
+                            const es_format_t *in, const es_format_t *out,
+                            bool *created)
+{
+    unsigned probes = atomic_load(&fake_probes);
+    chain_Create(obj, name, in, out, created);
+    return atomic_load(&fake_probes) - probes;
+}
+
+/* A cached path appends its converters by name, without any other probe */
+static void test_cache_hit(vlc_object_t *obj)
+{
+    es_format_t in, out;
+    bool created;
+
+    format_Init(&in, FAKE_IN, 640, 480);
+    format_Init(&out, FAKE_MID, 1280, 720);
+
+    /* resize then chroma fails, chroma then resize works */
+    unsigned first = fake_Probes(obj, TEST_CHAIN, &in, &out, &created);
+    assert(created);
+    assert(first > 2);
+
+    for (unsigned i = 1; i < CHAIN_COUNT; i++)
+    {
+        unsigned next = fake_Probes(obj, TEST_CHAIN, &in, &out, &created);
+        assert(created);
+        assert(next == 2); /* one per step */
+    }
+    printf("cache hit: %u probes first, then 2\n", first);
+
+    es_format_Clean(&in);
+    es_format_Clean(&out);
+}
+
+/* A missing path fails at once, until it is probed again after a while */
+static void test_cache_none(vlc_object_t *obj)
+{
+    es_format_t in, out;
+    bool created;
+
+    format_Init(&in, FAKE_IN, 640, 480);
+    format_Init(&out, FAKE_NONE, 640, 480);
+
+    /* the failure expires between these two */
+    vlc_tick_t cached = vlc_tick_now() + PATH_NONE_DELAY;
+    unsigned first = fake_Probes(obj, TEST_CHAIN, &in, &out, &created);
+    vlc_tick_t expired = vlc_tick_now() + PATH_NONE_DELAY;
+    assert(!created);
+    assert(first > 0);
+
+    /* no probe until then, unless the machine is very slow */
+    unsigned next = fake_Probes(obj, TEST_CHAIN, &in, &out, &created);
+    assert(!created);
+    assert(next == 0 || vlc_tick_now() >= cached);
+
+    /* probed again, though the nested chains may still have their own
+     * failures cached */
+    vlc_tick_wait(expired);
+    next = fake_Probes(obj, TEST_CHAIN, &in, &out, &created);
+    assert(!created);
+    assert(next > 0);
+
+    printf("cache miss: %u probes, then none for %" PRId64 " ms\n", first,
+           MS_FROM_VLC_TICK(PATH_NONE_DELAY));
+
+    es_format_Clean(&in);
+    es_format_Clean(&out);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* chroma through a middle man */
+    test_chain(obj, VLC_CODEC_YUYV, 640, 480, VLC_CODEC_I420_10L, 640, 480);
+    test_chain(obj, VLC_CODEC_YUYV, 640, 480, VLC_CODEC_RGB32, 640, 480);
+    /* chroma and resize */
+    test_chain(obj, VLC_CODEC_I420, 640, 480, VLC_CODEC_RGB32, 1280, 720);
+    /* no converter to an opaque chroma without a decoder device */
+    test_chain(obj, VLC_CODEC_I420, 640, 480, VLC_CODEC_VAAPI_420, 640, 480);
+
+    test_cache_hit(obj);
+    test_cache_none(obj);
+
+    libvlc_release(vlc);
+    return 0;
+}
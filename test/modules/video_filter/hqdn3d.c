@@ -0,0 +1,238 @@
+/*****************************************************************************
+ * hqdn3d.c: hqdn3d denoiser parallel passes test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_tick.h>
+
+#include "../modules/video_filter/hqdn3d.h"
+
+#define FRAMES 8
+#define PITCH_PAD 13
+
+struct passes
+{
+    const char *name;
+    void (*horizontal)(const unsigned char *, unsigned int *,
+                       int, int, int, int, int *, int *);
+    void (*vertical)(const unsigned char *, const unsigned int *,
+                     unsigned char *, unsigned int *, unsigned short *,
+                     int, int, int, int, int, int, int *, int *);
+};
+
+static const struct passes passes_c = {
+    "C", deNoiseHorizontal, deNoiseVertical,
+};
+#ifdef HAVE_AVX2_INTRINSICS
+static const struct passes passes_avx2 = {
+    "AVX2", deNoiseHorizontalAVX2, deNoiseVerticalAVX2,
+};
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+static const struct passes passes_sse4 = {
+    "SSE4.1", deNoiseHorizontalSSE4, deNoiseVerticalSSE4,
+};
+#endif
+#ifdef __ARM_NEON
+static const struct passes passes_neon = {
+    "NEON", deNoiseHorizontalNEON, deNoiseVerticalNEON,
+};
+#endif
+
+struct plane
+{
+    int w, h;
+    unsigned int *line, *horiz;
+    unsigned short *ant;
+    unsigned char *out;
+};
+
+static void plane_Init(struct plane *p, int w, int h)
+{
+    p->w = w;
+    p->h = h;
+    p->line = malloc(w * sizeof (*p->line));
+    p->horiz = malloc(w * h * sizeof (*p->horiz));
+    p->out = malloc(h * w);
+    p->ant = NULL;
+    assert(p->line && p->horiz && p->out);
+}
+
+static void plane_Clean(struct plane *p)
+{
+    free(p->line);
+    free(p->horiz);
+    free(p->out);
+    free(p->ant);
+}
+
+/* Moving gradient with noise */
+static void frame_Fill(unsigned char *buf, int w, int h, int pitch,
+                       unsigned n, uint32_t *seed)
+{
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+        {
+            *seed = *seed * 1103515245 + 12345;
+            int v = (x + y + 4 * n) % 200 + 20 + (int)((*seed >> 16) % 31) - 15;
+            buf[y * pitch + x] = v;
+        }
+}
+
+/* Runs the split passes on bands, as the filter threads do */
+static void split_Run(struct plane *p, const unsigned char *src, int pitch,
+                      const struct passes *passes, unsigned bands,
+                      int *spat, int *temp)
+{
+    unsigned short *ant = deNoiseFrameAnt(src, &p->ant, p->w, p->h, pitch);
+    assert(ant != NULL);
+
+    /* Bands of unaligned lines, unlike the filter, to cover the tails */
+    if (spat[0])
+        for (unsigned i = 0; i < bands; i++)
+            passes->horizontal(src, p->horiz, p->w, p->h * i / bands,
+                               p->h * (i + 1) / bands, pitch, spat, temp);
+
+    int vectors = (p->w + 7) / 8;
+    for (unsigned i = 0; i < bands; i++)
+    {
+        int x0 = 8 * (vectors * i / bands);
+        int x1 = 8 * (vectors * (i + 1) / bands);
+        if (x1 > p->w)
+            x1 = p->w;
+        if (x0 < x1)
+            passes->vertical(src, spat[0] ? p->horiz : NULL, p->out, p->line, ant,
+                     p->w, p->h, x0, x1, pitch, p->w, spat, temp);
+    }
+}
+
+static void test_bitexact(int w, int h, double spat_strength,
+                          double temp_strength, const struct passes *passes,
+                          unsigned bands)
+{
+    static int spat[512*16], temp[512*16];
+    const int pitch = w + PITCH_PAD;
+    unsigned char *src = malloc(pitch * h);
+    struct plane ref, out;
+
+    assert(src != NULL);
+    plane_Init(&ref, w, h);
+    plane_Init(&out, w, h);
+    PrecalcCoefs(spat, spat_strength);
+    PrecalcCoefs(temp, temp_strength);
+
+    uint32_t seed = w * h;
+    for (unsigned n = 0; n < FRAMES; n++)
+    {
+        frame_Fill(src, w, h, pitch, n, &seed);
+
+        deNoise(src, ref.out, ref.line, &ref.ant, w, h, pitch, w,
+                spat, spat, temp);
+        split_Run(&out, src, pitch, passes, bands, spat, temp);
+
+        assert(!memcmp(ref.out, out.out, w * h));
+        assert(!memcmp(ref.ant, out.ant, w * h * sizeof (*ref.ant)));
+    }
+
+    plane_Clean(&ref);
+    plane_Clean(&out);
+    free(src);
+}
+
+static void bench(const struct passes *passes, int w, int h)
+{
+    static int spat[512*16], temp[512*16];
+    const int pitch = w;
+    unsigned char *src = malloc(pitch * h);
+    struct plane p;
+
+    assert(src != NULL);
+    plane_Init(&p, w, h);
+    PrecalcCoefs(spat, PARAM1_DEFAULT);
+    PrecalcCoefs(temp, PARAM3_DEFAULT);
+    uint32_t seed = 1;
+    frame_Fill(src, w, h, pitch, 0, &seed);
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned n = 0; n < 50; n++)
+        if (passes == NULL)
+            deNoise(src, p.out, p.line, &p.ant, w, h, pitch, w,
+                    spat, spat, temp);
+        else
+            split_Run(&p, src, pitch, passes, 1, spat, temp);
+    vlc_tick_t time = vlc_tick_now() - start;
+
+    printf("%-8s %dx%d, 50 frames: %6" PRId64 " us\n",
+           passes ? passes->name : "original", w, h,
+           US_FROM_VLC_TICK(time));
+
+    plane_Clean(&p);
+    free(src);
+}
+
+int main(void)
+{
+    static const struct { int w, h; } sizes[] = {
+        { 64, 48 }, { 67, 31 }, { 5, 3 }, { 7, 20 }, { 360, 288 },
+    };
+    static const struct { double spat, temp; } strengths[] = {
+        { PARAM1_DEFAULT, PARAM3_DEFAULT }, /* spatial and temporal */
+        { PARAM1_DEFAULT, 0. },             /* spatial only */
+        { 0., PARAM3_DEFAULT },             /* temporal only */
+        { 0., 0. },                         /* history update only */
+        { 254., 254. },
+    };
+    const struct passes *impls[4] = { &passes_c, NULL, NULL, NULL };
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        impls[1] = &passes_avx2;
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE4_1())
+        impls[2] = &passes_sse4;
+#endif
+#ifdef __ARM_NEON
+    if (vlc_CPU_ARM_NEON())
+        impls[3] = &passes_neon;
+#endif
+
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(strengths); j++)
+            for (size_t k = 0; k < ARRAY_SIZE(impls); k++)
+                if (impls[k] != NULL)
+                    for (unsigned bands = 1; bands <= 4; bands++)
+                        test_bitexact(sizes[i].w, sizes[i].h,
+                                      strengths[j].spat, strengths[j].temp,
+                                      impls[k], bands);
+
+    bench(NULL, 1920, 1080);
+    for (size_t k = 0; k < ARRAY_SIZE(impls); k++)
+        if (impls[k] != NULL)
+            bench(impls[k], 1920, 1080);
+    return 0;
+}
@@ -0,0 +1,205 @@
+/*****************************************************************************
+ * scene.c: test the encoding queue of the scene video filter
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_image.h>
+#include <vlc_picture.h>
+#include <vlc_url.h>
+
+#include "../../../modules/video_filter/scene_queue.h"
+
+const char vlc_module_name[] = "test_scene";
+
+#define WIDTH  64
+#define HEIGHT 48
+
+static char *scene_dir;
+
+static picture_t *picture_Create(void)
+{
+    picture_t *pic = picture_New(VLC_CODEC_I420, WIDTH, HEIGHT, 1, 1);
+    assert(pic != NULL);
+    for (int i = 0; i < pic->i_planes; i++)
+        memset(pic->p[i].p_pixels, 0x80,
+               pic->p[i].i_pitch * pic->p[i].i_lines);
+    return pic;
+}
+
+static char *scene_Path(const char *name)
+{
+    char *path;
+    int ret = asprintf(&path, "%s/%s", scene_dir, name);
+    assert(ret != -1);
+    return path;
+}
+
+static void scene_Push(scene_queue_t *queue, picture_t *pic, const char *name,
+                       int32_t width, int32_t height)
+{
+    scene_queue_Push(queue, pic, scene_Path(name), width, height);
+}
+
+/* Removes the saved image, returning whether it was written: the image
+ * writer leaves an empty file when there is no encoder */
+static bool scene_Remove(const char *name)
+{
+    char *path = scene_Path(name);
+    struct stat st;
+    bool written = vlc_stat(path, &st) == 0 && st.st_size > 0;
+
+    vlc_unlink(path);
+    free(path);
+    return written;
+}
+
+/* Returns the width of the saved image */
+static unsigned scene_Width(vlc_object_t *obj, const char *name)
+{
+    char *path = scene_Path(name);
+    char *url = vlc_path2uri(path, NULL);
+    assert(url != NULL);
+
+    image_handler_t *image = image_HandlerCreate(obj);
+    assert(image != NULL);
+    video_format_t fmt;
+    video_format_Init(&fmt, 0);
+    picture_t *pic = image_ReadUrl(image, url, &fmt);
+    assert(pic != NULL);
+    unsigned width = fmt.i_width;
+
+    picture_Release(pic);
+    video_format_Clean(&fmt);
+    image_HandlerDelete(image);
+    vlc_unlink(path);
+    free(url);
+    free(path);
+    return width;
+}
+
+/* The images beyond the backlog are dropped, the queued ones are saved */
+static bool test_backlog(vlc_object_t *obj)
+{
+    static const char *const names[] = {
+        "scene00001.png", "scene00002.png", "scene00003.png",
+        "scene00004.png", "scene00005.png", "scene00006.png",
+    };
+    scene_queue_t queue;
+    picture_t *pic = picture_Create();
+
+    /* no workers, so that the images stay queued */
+    scene_queue_Init(&queue, obj, VLC_CODEC_PNG, 3, false);
+    for (size_t i = 0; i < ARRAY_SIZE(names); i++)
+    {
+        scene_Push(&queue, pic, names[i], WIDTH, HEIGHT);
+        assert(queue.i_pending == __MIN(i + 1, 3));
+    }
+    assert(queue.i_dropped == 3);
+
+    /* the oldest images are kept, in order */
+    scene_job_t *job;
+    unsigned count = 0;
+    vlc_list_foreach(job, &queue.jobs, node)
+    {
+        const char *name = strrchr(job->psz_filename, '/') + 1;
+        assert(count < 3);
+        assert(!strcmp(name, names[count]));
+        count++;
+    }
+    assert(count == 3);
+
+    /* saved once the workers come */
+    int ret = scene_queue_StartWorkers(&queue, 2);
+    assert(ret == VLC_SUCCESS);
+    scene_queue_StopWorkers(&queue);
+    assert(queue.i_pending == 0);
+    scene_queue_Clean(&queue);
+    picture_Release(pic);
+
+    bool written = scene_Remove(names[0]);
+    for (size_t i = 1; i < ARRAY_SIZE(names); i++)
+        assert(scene_Remove(names[i]) == (written && i < 3));
+    return written; /* no PNG encoder otherwise */
+}
+
+/* A newer image of the single file supersedes the pending one, so that the
+ * last image is always the one written last */
+static void test_replace(vlc_object_t *obj, bool encoder)
+{
+    scene_queue_t queue;
+    picture_t *pic = picture_Create();
+
+    scene_queue_Init(&queue, obj, VLC_CODEC_PNG, 2, true);
+    for (int i = 1; i <= 5; i++)
+    {
+        scene_Push(&queue, pic, "scene.png", 8 * i, 6 * i);
+        assert(queue.i_pending == 1);
+
+        scene_job_t *job =
+            vlc_list_first_entry_or_null(&queue.jobs, scene_job_t, node);
+        assert(job != NULL && job->i_width == 8 * i);
+    }
+    assert(queue.i_dropped == 0);
+
+    /* superseded while being encoded */
+    int ret = scene_queue_StartWorkers(&queue, 1);
+    assert(ret == VLC_SUCCESS);
+    for (int i = 1; i <= 50; i++)
+        scene_Push(&queue, pic, "scene.png", 8 * i, 6 * i);
+    assert(queue.i_dropped == 0);
+    scene_queue_Clean(&queue);
+    picture_Release(pic);
+
+    if (encoder)
+        assert(scene_Width(obj, "scene.png") == 8 * 50);
+    else
+        assert(!scene_Remove("scene.png"));
+    assert(!scene_Remove("scene.png.swp"));
+}
+
+int main(void)
+{
+    char tmpl[] = "/tmp/vlc-test-scene-XXXXXX";
+    scene_dir = mkdtemp(tmpl);
+    if (scene_dir == NULL)
+        return 77;
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* without an encoder, only the queue is checked */
+    bool encoder = test_backlog(obj);
+    test_replace(obj, encoder);
+    int ret = encoder ? 0 : 77;
+
+    libvlc_release(vlc);
+    rmdir(scene_dir);
+    return ret;
+}
@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * filters.c: test audio filters chain buffers
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+
+#define BLOCK_COUNT 200
+#define MAX_BUFFERS 16
+
+/* Distinct output buffers handed by the chain, i.e. its allocations */
+struct buffers
+{
+    const void *tab[MAX_BUFFERS];
+    unsigned count;
+};
+
+static void buffers_Add(struct buffers *bufs, const block_t *block)
+{
+    for (unsigned i = 0; i < bufs->count; i++)
+        if (bufs->tab[i] == block->p_start)
+            return;
+    assert(bufs->count < MAX_BUFFERS);
+    bufs->tab[bufs->count++] = block->p_start;
+}
+
+static void format_Init(audio_sample_format_t *fmt, vlc_fourcc_t codec,
+                        uint16_t channels)
+{
+    memset(fmt, 0, sizeof (*fmt));
+    fmt->i_format = codec;
+    fmt->i_rate = 48000;
+    fmt->i_physical_channels = channels;
+    fmt->channel_type = AUDIO_CHANNEL_TYPE_BITMAP;
+    aout_FormatPrepare(fmt);
+}
+
+static block_t *input_New(const audio_sample_format_t *fmt, unsigned i)
+{
+    /* Decoders output frames of slightly varying sizes */
+    size_t frames = 1024 + (i % 7) * 16;
+    block_t *block = block_Alloc(frames * fmt->i_bytes_per_frame);
+    assert(block != NULL);
+
+    memset(block->p_buffer, 0, block->i_buffer);
+    block->i_nb_samples = frames;
+    block->i_pts = block->i_dts = VLC_TICK_0 + i * VLC_TICK_FROM_MS(20);
+    block->i_length = VLC_TICK_FROM_MS(20);
+    return block;
+}
+
+static void test_chain(vlc_object_t *obj, vlc_fourcc_t in_codec,
+                       uint16_t in_channels, uint16_t out_channels)
+{
+    audio_sample_format_t infmt, outfmt;
+    format_Init(&infmt, in_codec, in_channels);
+    format_Init(&outfmt, VLC_CODEC_FL32, out_channels);
+
+    aout_filters_t *filters = aout_FiltersNew(obj, &infmt, &outfmt, NULL);
+    assert(filters != NULL);
+
+    /* The audio output may hold a few blocks before releasing them */
+    block_t *queue[3] = { NULL, NULL, NULL };
+    struct buffers bufs = { .count = 0 };
+
+    for (unsigned i = 0; i < BLOCK_COUNT; i++)
+    {
+        block_t *out = aout_FiltersPlay(filters, input_New(&infmt, i), 1.f);
+        assert(out != NULL);
+        assert(out->i_nb_samples == 1024 + (i % 7) * 16);
+        assert(out->i_buffer == out->i_nb_samples * outfmt.i_bytes_per_frame);
+        buffers_Add(&bufs, out);
+
+        block_t **slot = &queue[i % ARRAY_SIZE(queue)];
+        if (*slot != NULL)
+            block_Release(*slot);
+        *slot = out;
+    }
+
+    printf("%4.4s %u channels to %4.4s %u channels: %u buffers for %u blocks\n",
+           (const char *)&infmt.i_format, infmt.i_channels,
+           (const char *)&outfmt.i_format, outfmt.i_channels,
+           bufs.count, BLOCK_COUNT);
+    assert(bufs.count <= ARRAY_SIZE(queue) + 1);
+
+    /* Blocks may be released after the chain */
+    aout_FiltersDelete(obj, filters);
+    for (size_t i = 0; i < ARRAY_SIZE(queue); i++)
+        block_Release(queue[i]);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* format converter */
+    test_chain(obj, VLC_CODEC_S16N, AOUT_CHANS_STEREO, AOUT_CHANS_STEREO);
+    /* format converter and downmixer */
+    test_chain(obj, VLC_CODEC_S16N, AOUT_CHANS_5_1, AOUT_CHANS_STEREO);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*****************************************************************************
+ * demux_signature.c: test the demuxers skipped by their signatures
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_stream.h>
+
+const char vlc_module_name[] = "test_demux_signature";
+
+/*****************************************************************************
+ * Demuxers, in decreasing order of priority
+ *****************************************************************************/
+enum { DEMUX_A, DEMUX_B, DEMUX_ANY, DEMUX_COUNT };
+
+static unsigned probes[DEMUX_COUNT];
+
+static int Demux(demux_t *demux)
+{
+    (void) demux;
+    return VLC_DEMUXER_EOF;
+}
+
+static int Control(demux_t *demux, int query, va_list args)
+{
+    (void) demux; (void) query; (void) args;
+    return VLC_EGENERIC;
+}
+
+/* Accepts the data if it starts with the given bytes */
+static int Open(vlc_object_t *obj, unsigned index, const char *bytes)
+{
+    demux_t *demux = (demux_t *)obj;
+    size_t len = strlen(bytes);
+    const uint8_t *peek;
+
+    probes[index]++;
+    if (vlc_stream_Peek(demux->s, &peek, len) < (ssize_t)len
+     || memcmp(peek, bytes, len))
+        return VLC_EGENERIC;
+
+    demux->pf_demux = Demux;
+    demux->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static int OpenA(vlc_object_t *obj)
+{
+    return Open(obj, DEMUX_A, "AAAA");
+}
+
+static int OpenB(vlc_object_t *obj)
+{
+    demux_t *demux = (demux_t *)obj;
+    const uint8_t *peek;
+
+    /* also accepts the second signature */
+    if (vlc_stream_Peek(demux->s, &peek, 12) == 12
+     && !memcmp(peek + 8, "bb\0b", 4))
+        return Open(obj, DEMUX_B, "");
+    return Open(obj, DEMUX_B, "BBBB");
+}
+
+static int OpenAny(vlc_object_t *obj)
+{
+    return Open(obj, DEMUX_ANY, "");
+}
+
+#define MODULE_NAME test_demux_signature
+#define MODULE_STRING "test_demux_signature"
+#include <vlc_plugin.h>
+
+vlc_module_begin()
+    set_capability("demux", 100)
+    add_shortcut("sig_a")
+    add_signature(0, "AAAA")
+    set_callback(OpenA)
+add_submodule()
+    set_capability("demux", 90)
+    add_shortcut("sig_b")
+    add_signature(0, "BBBB")
+    add_signature(8, "bb\0b")
+    set_callback(OpenB)
+add_submodule()
+    set_capability("demux", 1)
+    add_shortcut("sig_any")
+    set_callback(OpenAny)
+vlc_module_end()
+
+__attribute__((visibility("default")))
+int (*vlc_static_modules[])(int (*)(void *, void *, int, ...), void *) = {
+    vlc_entry__test_demux_signature, NULL
+};
+
+/*****************************************************************************
+ * Tests
+ *****************************************************************************/
+
+static void test_signatures(vlc_object_t *obj)
+{
+    static const struct
+    {
+        const char *name;
+        const char *data;
+        size_t size;
+        unsigned probes[DEMUX_COUNT];
+        bool opened;
+    } tests[] = {
+        /* matching the highest priority */
+        { "any", "AAAAxxxxxxxxxxxx", 16, { 1, 0, 0 }, true },
+        /* the other signatures are skipped */
+        { "any", "BBBBxxxxxxxxxxxx", 16, { 0, 1, 0 }, true },
+        { "any", "xxxxxxxxbb\0bxxxx", 16, { 0, 1, 0 }, true },
+        /* none matching: only the modules without signatures are probed */
+        { "any", "xxxxxxxxxxxxxxxx", 16, { 0, 0, 1 }, true },
+        { "any", "AAABBBBxbb\0axxxx", 16, { 0, 0, 1 }, true },
+        /* signatures beyond the data cannot be ruled out */
+        { "any", "BB", 2, { 1, 1, 1 }, true },
+        { "any", "xxxxxxxxbb", 10, { 0, 1, 1 }, true },
+        { "any", "", 0, { 1, 1, 1 }, true },
+        /* modules requested explicitly are probed anyway */
+        { "sig_a", "xxxxxxxxxxxxxxxx", 16, { 1, 0, 0 }, false },
+        { "sig_b,any", "xxxxxxxxxxxxxxxx", 16, { 0, 1, 1 }, true },
+        { "sig_b,sig_a", "AAAAxxxxxxxxxxxx", 16, { 1, 1, 0 }, true },
+        { "none", "AAAAxxxxxxxxxxxx", 16, { 0, 0, 0 }, false },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(tests); i++)
+    {
+        unsigned counts[DEMUX_COUNT];
+        stream_t *s = vlc_stream_MemoryNew(obj, (uint8_t *)tests[i].data,
+                                           tests[i].size, true);
+        assert(s != NULL);
+
+        memset(probes, 0, sizeof (probes));
+        demux_t *demux = demux_New(obj, tests[i].name, s, NULL);
+        memcpy(counts, probes, sizeof (probes));
+
+        test_log("%s, %zu bytes: %u %u %u probes\n", tests[i].name,
+                 tests[i].size, counts[DEMUX_A], counts[DEMUX_B],
+                 counts[DEMUX_ANY]);
+        for (unsigned j = 0; j < DEMUX_COUNT; j++)
+            assert(counts[j] == tests[i].probes[j]);
+        assert((demux != NULL) == tests[i].opened);
+
+        if (demux != NULL)
+            demux_Delete(demux);
+        else
+            vlc_stream_Delete(s);
+    }
+}
+
+int main(void)
+{
+    test_init();
+    /* only the demuxers of the test */
+    setenv("VLC_PLUGIN_PATH", "/nonexistent", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    test_signatures(VLC_OBJECT(vlc->p_libvlc_int));
+
+    libvlc_release(vlc);
+    return 0;
+}
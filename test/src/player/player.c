@@ -214,6 +214,8 @@ struct ctx
 
     size_t program_switch_count;
     size_t extra_start_count;
+    size_t prepared_count; /* medias with known tracks once current */
+    const char *str_ids[DATA_ES]; /* selected when a media becomes current */
     struct media_params params;
     float rate;
 
@@ -264,6 +266,13 @@ player_on_current_media_changed(vlc_player_t *player,
     struct ctx *ctx = get_ctx(player, data);
     if (new_media)
         input_item_Hold(new_media);
+    /* A new input is not started yet, while a prepared one already has its
+     * tracks */
+    if (new_media && vlc_player_GetTrackCount(player, AUDIO_ES) > 0)
+        ctx->prepared_count++;
+    for (int cat = VIDEO_ES; cat < DATA_ES; ++cat)
+        if (new_media && ctx->str_ids[cat])
+            vlc_player_SelectTracksByStringIds(player, cat, ctx->str_ids[cat]);
     VEC_PUSH(on_current_media_changed, new_media);
 }
 
@@ -644,6 +653,9 @@ REPORT_LIST
     vlc_vector_clear(&ctx->played_medias);
 
     ctx->extra_start_count = 0;
+    ctx->prepared_count = 0;
+    for (int cat = VIDEO_ES; cat < DATA_ES; ++cat)
+        ctx->str_ids[cat] = NULL;
     ctx->program_switch_count = 1;
     ctx->rate = 1.f;
 
@@ -1839,6 +1851,79 @@ test_next_media(struct ctx *ctx)
     test_end(ctx);
 }
 
+/* Counts the selections of the given track in the whole playback */
+static size_t
+vec_on_track_selection_count(vec_on_track_selection_changed *vec,
+                             enum es_format_category_e cat, const char *str_id)
+{
+    size_t count = 0;
+    struct report_track_selection report;
+    vlc_vector_foreach(report, vec)
+    {
+        if (report.selected_id && vlc_es_id_GetCat(report.selected_id) == cat
+         && strcmp(vlc_es_id_GetStrId(report.selected_id), str_id) == 0)
+            count++;
+    }
+    return count;
+}
+
+static void
+test_prepared_media(struct ctx *ctx)
+{
+    test_log("prepared_media\n");
+    const char *media_names[] = { "media1", "media2", "media3" };
+    const size_t media_count = ARRAY_SIZE(media_names);
+    vlc_player_t *player = ctx->player;
+
+    /* Longer than the caching, so that the prepared input is paused before
+     * its end, and than the prepare delay */
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_SEC(2));
+    params.track_count[VIDEO_ES] = 2;
+    params.track_count[AUDIO_ES] = 2;
+    params.track_count[SPU_ES] = 2;
+
+    /* The preferences are set for each media once current, including the
+     * prepared ones */
+    ctx->str_ids[VIDEO_ES] = "video/1";
+    ctx->str_ids[AUDIO_ES] = "audio/1";
+    ctx->str_ids[SPU_ES] = "spu/1";
+
+    for (size_t i = 0; i < media_count; ++i)
+        player_set_next_mock_media(ctx, media_names[i], &params);
+
+    audio_output_t *aout = vlc_player_aout_Hold(player);
+    assert(aout);
+    player_set_rate(ctx, 4.f);
+    player_start(ctx);
+
+    test_prestop(ctx);
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+    assert_normal_state(ctx);
+
+    /* the next medias were played by their prepared input */
+    vec_on_current_media_changed *vec = &ctx->report.on_current_media_changed;
+    assert(vec->size == media_count);
+    for (size_t i = 0; i < vec->size; ++i)
+        assert_media_name(vec->data[i], media_names[i]);
+    assert(ctx->prepared_count == media_count - 1);
+
+    /* the preferred tracks were selected for each media, and not the first
+     * video track */
+    vec_on_track_selection_changed *sel = &ctx->report.on_track_selection_changed;
+    assert(vec_on_track_selection_count(sel, VIDEO_ES, "video/1") == media_count);
+    assert(vec_on_track_selection_count(sel, VIDEO_ES, "video/0") == 0);
+    assert(vec_on_track_selection_count(sel, AUDIO_ES, "audio/1") == media_count);
+    assert(vec_on_track_selection_count(sel, SPU_ES, "spu/1") == media_count);
+
+    /* and the audio output was kept */
+    audio_output_t *same_aout = vlc_player_aout_Hold(player);
+    assert(same_aout == aout);
+    aout_Release(same_aout);
+    aout_Release(aout);
+
+    test_end(ctx);
+}
+
 static void
 test_set_current_media(struct ctx *ctx)
 {
@@ -2020,7 +2105,7 @@ REPORT_LIST
 }
 
 static void
-ctx_init(struct ctx *ctx, bool use_outputs)
+ctx_init(struct ctx *ctx, bool use_outputs, int prepare_next_ms)
 {
     const char * argv[] = {
         "-v",
@@ -2053,6 +2138,7 @@ REPORT_LIST
         .played_medias = VLC_VECTOR_INITIALIZER,
         .program_switch_count = 1,
         .extra_start_count = 0,
+        .prepared_count = 0,
         .rate = 1.f,
         .wait = VLC_STATIC_COND,
     };
@@ -2062,6 +2148,11 @@ REPORT_LIST
     int ret = var_SetString(vlc->p_libvlc_int, "window", "wdummy");
     assert(ret == VLC_SUCCESS);
 
+    /* Open the next media ahead of time */
+    ret = var_Create(vlc->p_libvlc_int, "prepare-next-media", VLC_VAR_INTEGER);
+    assert(ret == VLC_SUCCESS);
+    var_SetInteger(vlc->p_libvlc_int, "prepare-next-media", prepare_next_ms);
+
     ctx->player = vlc_player_New(VLC_OBJECT(vlc->p_libvlc_int),
                                  VLC_PLAYER_LOCK_NORMAL, &provider, ctx);
     assert(ctx->player);
@@ -2436,10 +2527,10 @@ main(void)
     struct ctx ctx;
 
     /* Test with --aout=none --vout=none */
-    ctx_init(&ctx, false);
+    ctx_init(&ctx, false, 0);
     test_no_outputs(&ctx);
     ctx_destroy(&ctx);
-    ctx_init(&ctx, true);
+    ctx_init(&ctx, true, 0);
 
     test_outputs(&ctx); /* Must be the first test */
 
@@ -2462,6 +2553,13 @@ main(void)
     test_delete_while_playback(VLC_OBJECT(ctx.vlc->p_libvlc_int), true);
     test_delete_while_playback(VLC_OBJECT(ctx.vlc->p_libvlc_int), false);
 
+    ctx_destroy(&ctx);
+
+    /* Test with the next medias opened and buffered ahead of time: the events
+     * must be the same as with regular openings */
+    ctx_init(&ctx, true, 1000);
+    test_next_media(&ctx);
+    test_prepared_media(&ctx);
     ctx_destroy(&ctx);
     return 0;
 }
@@ -0,0 +1,528 @@
+/*****************************************************************************
+ * cache.c: test the persistent preparsing results
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_fs.h>
+#include <vlc_input_item.h>
+#include <vlc_url.h>
+
+/* The cache is built with the test, with CACHE_MAX_ENTRIES entries and
+ * saved after CACHE_SAVE_DELAY */
+#include "preparser/cache.h"
+#include "input/item.h"
+
+const char vlc_module_name[] = "test_preparser_cache";
+
+static char *test_dir;
+
+/* Used by the cache to restore the tracks */
+void input_item_UpdateTracksInfo(input_item_t *item, const es_format_t *fmt)
+{
+    es_format_t *copy = malloc(sizeof (*copy));
+    assert(copy != NULL);
+    es_format_Copy(copy, fmt);
+
+    vlc_mutex_lock(&item->lock);
+    TAB_APPEND(item->i_es, item->es, copy);
+    vlc_mutex_unlock(&item->lock);
+}
+
+/*****************************************************************************
+ * Remote access, with a validator
+ *****************************************************************************/
+static const char *remote_validator;
+static unsigned remote_opens;
+
+static ssize_t RemoteRead(stream_t *access, void *buf, size_t len)
+{
+    (void) access; (void) buf; (void) len;
+    return 0;
+}
+
+static int RemoteControl(stream_t *access, int query, va_list args)
+{
+    (void) access;
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = false;
+            break;
+        case STREAM_GET_SIZE:
+            *va_arg(args, uint64_t *) = 4242;
+            break;
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = 0;
+            break;
+        case STREAM_GET_VALIDATOR:
+            if (remote_validator == NULL)
+                return VLC_EGENERIC;
+            *va_arg(args, char **) = strdup(remote_validator);
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int OpenRemote(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+
+    remote_opens++;
+    access->pf_read = RemoteRead;
+    access->pf_control = RemoteControl;
+    return VLC_SUCCESS;
+}
+
+#define MODULE_NAME test_preparser_cache
+#define MODULE_STRING "test_preparser_cache"
+#include <vlc_plugin.h>
+
+vlc_module_begin()
+    set_capability("access", 0)
+    add_shortcut("cachetest")
+    set_callbacks(OpenRemote, NULL)
+vlc_module_end()
+
+__attribute__((visibility("default")))
+int (*vlc_static_modules[])(int (*)(void *, void *, int, ...), void *) = {
+    vlc_entry__test_preparser_cache, NULL
+};
+
+/*****************************************************************************
+ * Items
+ *****************************************************************************/
+static char *test_Path(const char *name)
+{
+    char *path;
+    int ret = asprintf(&path, "%s/%s", test_dir, name);
+    assert(ret != -1);
+    return path;
+}
+
+static void file_Write(const char *name, size_t size)
+{
+    char *path = test_Path(name);
+    FILE *file = vlc_fopen(path, "wb");
+    assert(file != NULL);
+    for (size_t i = 0; i < size; i++)
+        putc(i & 0xff, file);
+    fclose(file);
+    free(path);
+}
+
+static void file_Remove(const char *name)
+{
+    char *path = test_Path(name);
+    vlc_unlink(path);
+    free(path);
+}
+
+static input_item_t *item_New(unsigned i)
+{
+    char name[16];
+    snprintf(name, sizeof (name), "item%u", i);
+
+    char *path = test_Path(name);
+    char *uri = vlc_path2uri(path, NULL);
+    assert(uri != NULL);
+    input_item_t *item = input_item_NewFile(uri, name, INPUT_DURATION_UNSET,
+                                            ITEM_LOCAL);
+    assert(item != NULL);
+    free(uri);
+    free(path);
+    return item;
+}
+
+static input_item_t *item_NewRemote(const char *name)
+{
+    char uri[64];
+    snprintf(uri, sizeof (uri), "cachetest://server/%s", name);
+
+    input_item_t *item = input_item_NewFile(uri, name, INPUT_DURATION_UNSET,
+                                            ITEM_NET);
+    assert(item != NULL);
+    return item;
+}
+
+/* Stores the item as if preparsed: the duration and the title depend on i */
+static void item_Store(input_preparser_cache_t *cache, input_item_t *item,
+                       unsigned i)
+{
+    char title[16];
+    snprintf(title, sizeof (title), "title %u", i);
+
+    input_item_SetDuration(item, VLC_TICK_FROM_SEC(i + 1));
+    input_item_SetTitle(item, title);
+
+    es_format_t fmt;
+    es_format_Init(&fmt, AUDIO_ES, VLC_CODEC_S16L);
+    fmt.audio.i_channels = 2;
+    fmt.audio.i_rate = 44100 + i;
+    fmt.psz_language = strdup("fr");
+    input_item_UpdateTracksInfo(item, &fmt);
+    es_format_Clean(&fmt);
+
+    input_preparser_cache_Store(cache, item);
+}
+
+static void item_Check(input_item_t *item, unsigned i)
+{
+    char title[16];
+    snprintf(title, sizeof (title), "title %u", i);
+
+    assert(input_item_GetDuration(item) == VLC_TICK_FROM_SEC(i + 1));
+    char *str = input_item_GetTitle(item);
+    assert(str != NULL && !strcmp(str, title));
+    free(str);
+
+    vlc_mutex_lock(&item->lock);
+    assert(item->i_es == 1);
+    assert(item->es[0]->i_cat == AUDIO_ES);
+    assert(item->es[0]->i_codec == VLC_CODEC_S16L);
+    assert(item->es[0]->audio.i_channels == 2);
+    assert(item->es[0]->audio.i_rate == 44100 + i);
+    assert(!strcmp(item->es[0]->psz_language, "fr"));
+    vlc_mutex_unlock(&item->lock);
+}
+
+/* Looks the item up, in a new item not to mix with the stored results */
+static bool cache_Lookup(input_preparser_cache_t *cache, unsigned i)
+{
+    input_item_t *item = item_New(i);
+    bool found = input_preparser_cache_Lookup(cache, item);
+    if (found)
+        item_Check(item, i);
+    input_item_Release(item);
+    return found;
+}
+
+static void cache_Store(input_preparser_cache_t *cache, unsigned i)
+{
+    input_item_t *item = item_New(i);
+    item_Store(cache, item, i);
+    input_item_Release(item);
+}
+
+static bool cache_Saved(void)
+{
+    char *path = test_Path("vlc/preparser.cache");
+    struct stat st;
+    bool saved = vlc_stat(path, &st) == 0;
+    free(path);
+    return saved;
+}
+
+static void cache_Clear(void)
+{
+    file_Remove("vlc/preparser.cache");
+}
+
+/*****************************************************************************
+ * Tests
+ *****************************************************************************/
+#define ITEM_COUNT (CACHE_MAX_ENTRIES + 2)
+
+/* Beyond CACHE_MAX_ENTRIES, the least recently used entry is dropped */
+static void test_bound(vlc_object_t *obj)
+{
+    input_preparser_cache_t *cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+
+    for (unsigned i = 0; i <= CACHE_MAX_ENTRIES; i++)
+        cache_Store(cache, i);
+    assert(!cache_Lookup(cache, 0));
+    for (unsigned i = 1; i <= CACHE_MAX_ENTRIES; i++)
+        assert(cache_Lookup(cache, i));
+
+    /* a lookup makes the entry the most recently used one */
+    assert(cache_Lookup(cache, 1));
+    cache_Store(cache, CACHE_MAX_ENTRIES + 1);
+    assert(!cache_Lookup(cache, 2));
+    assert(cache_Lookup(cache, 1));
+
+    /* saved in that order: from 3 to CACHE_MAX_ENTRIES + 1, then 1 */
+    input_preparser_cache_Delete(cache);
+    assert(cache_Saved());
+
+    cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+    cache_Store(cache, 0);
+    assert(!cache_Lookup(cache, 3));
+    assert(cache_Lookup(cache, 1));
+    assert(cache_Lookup(cache, 0));
+    input_preparser_cache_Delete(cache);
+    cache_Clear();
+}
+
+/* A modified file is parsed again */
+static void test_modified(vlc_object_t *obj)
+{
+    input_preparser_cache_t *cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+
+    cache_Store(cache, 0);
+    assert(cache_Lookup(cache, 0));
+    file_Write("item0", 2000);
+    assert(!cache_Lookup(cache, 0));
+    file_Write("item0", 1000);
+
+    /* not cached at all without a file */
+    file_Remove("item1");
+    cache_Store(cache, 1);
+    file_Write("item1", 1000);
+    assert(!cache_Lookup(cache, 1));
+
+    input_preparser_cache_Delete(cache);
+    cache_Clear();
+}
+
+/* The new entries are saved as the cache grows, not only at the end */
+static void test_save(vlc_object_t *obj)
+{
+    /* the first save is due between these two */
+    vlc_tick_t early = vlc_tick_now() + CACHE_SAVE_DELAY;
+    input_preparser_cache_t *cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+    vlc_tick_t deadline = vlc_tick_now() + CACHE_SAVE_DELAY;
+
+    cache_Store(cache, 0);
+    if (vlc_tick_now() < early)
+        assert(!cache_Saved());
+
+    vlc_tick_wait(deadline);
+    cache_Store(cache, 1);
+    assert(cache_Saved());
+
+    /* as if the first one had crashed */
+    input_preparser_cache_t *next = input_preparser_cache_New(obj);
+    assert(next != NULL);
+    assert(cache_Lookup(next, 0));
+    assert(cache_Lookup(next, 1));
+    input_preparser_cache_Delete(next);
+
+    input_preparser_cache_Delete(cache);
+    cache_Clear();
+}
+
+static bool remote_Lookup(input_preparser_cache_t *cache, const char *name,
+                          unsigned i)
+{
+    input_item_t *item = item_NewRemote(name);
+    bool found = input_preparser_cache_Lookup(cache, item);
+    if (found)
+        item_Check(item, i);
+    input_item_Release(item);
+    return found;
+}
+
+/* Remote items are checked against their validator, which only opens their
+ * access, and only once cached */
+static void test_remote(vlc_object_t *obj)
+{
+    input_preparser_cache_t *cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+
+    remote_validator = "\"v1\"";
+    assert(!remote_Lookup(cache, "a", 0));
+    assert(remote_opens == 0);
+
+    input_item_t *item = item_NewRemote("a");
+    item_Store(cache, item, 0);
+    input_item_Release(item);
+    assert(remote_opens == 1);
+
+    assert(remote_Lookup(cache, "a", 0));
+    assert(remote_opens == 2);
+    assert(!remote_Lookup(cache, "b", 0));
+    assert(remote_opens == 2);
+
+    /* modified */
+    remote_validator = "\"v2\"";
+    assert(!remote_Lookup(cache, "a", 0));
+    assert(remote_opens == 3);
+
+    /* not cached without a validator */
+    remote_validator = NULL;
+    item = item_NewRemote("b");
+    item_Store(cache, item, 1);
+    input_item_Release(item);
+    remote_validator = "\"v1\"";
+    assert(!remote_Lookup(cache, "b", 1));
+
+    /* kept across sessions */
+    input_preparser_cache_Delete(cache);
+    cache = input_preparser_cache_New(obj);
+    assert(cache != NULL);
+    assert(remote_Lookup(cache, "a", 0));
+
+    input_preparser_cache_Delete(cache);
+    cache_Clear();
+}
+
+/*****************************************************************************
+ * Throughput of the preparser, with and without the cache
+ *****************************************************************************/
+#define PARSE_COUNT 200
+
+static void wav_Write(const char *path)
+{
+    static const uint8_t header[] = {
+        'R', 'I', 'F', 'F', 36 + 64, 0, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 16, 0, 0, 0,
+        1, 0, 2, 0, 0x44, 0xac, 0, 0, 0x10, 0xb1, 2, 0, 4, 0, 16, 0,
+        'd', 'a', 't', 'a', 64, 0, 0, 0,
+    };
+    FILE *file = vlc_fopen(path, "wb");
+    assert(file != NULL);
+    fwrite(header, 1, sizeof (header), file);
+    for (int i = 0; i < 64; i++)
+        putc(0, file);
+    fclose(file);
+}
+
+static void on_parsed(const libvlc_event_t *event, void *data)
+{
+    (void) event;
+    vlc_sem_post(data);
+}
+
+/* Returns the number of items parsed per second */
+static double parse_Run(char **paths, unsigned *done)
+{
+    const char *argv[] = { "-v", "--preparse-cache", "--preparse-threads=4" };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    libvlc_media_t *medias[PARSE_COUNT];
+    vlc_sem_t sem;
+    vlc_sem_init(&sem, 0);
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < PARSE_COUNT; i++)
+    {
+        medias[i] = libvlc_media_new_path(vlc, paths[i]);
+        assert(medias[i] != NULL);
+        libvlc_event_attach(libvlc_media_event_manager(medias[i]),
+                            libvlc_MediaParsedChanged, on_parsed, &sem);
+        int ret = libvlc_media_parse_with_options(medias[i],
+                                                  libvlc_media_parse_local, -1);
+        assert(ret == 0);
+    }
+    for (unsigned i = 0; i < PARSE_COUNT; i++)
+        vlc_sem_wait(&sem);
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    *done = 0;
+    for (unsigned i = 0; i < PARSE_COUNT; i++)
+    {
+        if (libvlc_media_get_parsed_status(medias[i])
+         == libvlc_media_parsed_status_done)
+            (*done)++;
+        libvlc_event_detach(libvlc_media_event_manager(medias[i]),
+                            libvlc_MediaParsedChanged, on_parsed, &sem);
+        libvlc_media_release(medias[i]);
+    }
+    libvlc_release(vlc);
+    return (double) PARSE_COUNT * CLOCK_FREQ / elapsed;
+}
+
+static void test_throughput(void)
+{
+    char *paths[PARSE_COUNT];
+    for (unsigned i = 0; i < PARSE_COUNT; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof (name), "parse%u.wav", i);
+        paths[i] = test_Path(name);
+        wav_Write(paths[i]);
+    }
+
+    unsigned parsed, cached;
+    double without = parse_Run(paths, &parsed);
+    assert(cache_Saved());
+    double with = parse_Run(paths, &cached);
+    assert(cached == parsed);
+
+    test_log("preparsed %u items: %.0f items/s without the cache, "
+             "%.0f items/s with the cache\n", parsed, without, with);
+
+    for (unsigned i = 0; i < PARSE_COUNT; i++)
+    {
+        vlc_unlink(paths[i]);
+        free(paths[i]);
+    }
+    cache_Clear();
+}
+
+int main(void)
+{
+    char tmpl[] = "/tmp/vlc-test-preparser-XXXXXX";
+    test_dir = mkdtemp(tmpl);
+    if (test_dir == NULL)
+        return 77;
+    /* the cache is in "vlc" under the test directory */
+    setenv("XDG_CACHE_HOME", test_dir, 1);
+
+    for (unsigned i = 0; i < ITEM_COUNT; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof (name), "item%u", i);
+        file_Write(name, 1000);
+    }
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    test_bound(obj);
+    test_modified(obj);
+    test_save(obj);
+    test_remote(obj);
+    libvlc_release(vlc);
+
+    test_throughput();
+
+    for (unsigned i = 0; i < ITEM_COUNT; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof (name), "item%u", i);
+        file_Remove(name);
+    }
+    char *path = test_Path("vlc");
+    rmdir(path);
+    free(path);
+    rmdir(test_dir);
+    return 0;
+}